@@ -19,3 +19,4 @@ group ""
 include "XYZEngine"
 include "XYZEditor"	
 include "XYZScriptCore"
+include "XYZBenchmark"
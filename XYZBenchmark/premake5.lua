@@ -0,0 +1,91 @@
+project "XYZBenchmark"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "off"
+		
+		targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+		objdir ("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
+		
+		XYZEngineDll = "%{wks.location}/bin/" .. outputdir .."/XYZEngine/XYZEngine.dll"
+
+		-- Shader benchmark reads Resources of the editor
+		debugdir "%{wks.location}/XYZEditor"
+
+		-- Voxel world is part of the editor, benchmarks build its sources directly
+		files
+		{
+			"src/**.h",
+			"src/**.cpp",
+			"%{wks.location}/XYZEditor/src/Voxel/VoxelWorld.*",
+			"%{wks.location}/XYZEditor/src/Voxel/VoxelChunkStore.*",
+			"%{wks.location}/XYZEditor/src/Voxel/VoxelTerrainGenerator.*"
+		}
+		
+		includedirs
+		{
+			"src",
+			"%{wks.location}/XYZEditor/src",
+			"%{wks.location}/XYZEngine/vendor/spdlog/include",
+			"%{wks.location}/XYZEngine/vendor",
+			"%{wks.location}/XYZEngine/src",
+			"%{IncludeDir.entt}",
+			"%{IncludeDir.ozz_animation}",
+			"%{IncludeDir.ImGui}",
+			"%{IncludeDir.yaml}",
+			"%{IncludeDir.glm}",
+			"%{IncludeDir.Asio}",
+			"%{IncludeDir.box2d}",
+			"%{IncludeDir.VulkanSDK}",
+			"%{IncludeDir.optick}",
+			"%{IncludeDir.PerlinNoise}"
+		}
+		filter "options:sharedimport"
+			links
+			{
+				"ImGui",
+				"ozz_base",
+				"ozz_animation",
+				"ozz_animation_offline", 
+				"optick",
+				"%{wks.location}/bin/" .. outputdir .."/XYZEngine/XYZEngine.lib"
+			}
+			
+		filter "options:static"
+			links
+			{
+				"XYZEngine"
+			}
+		
+		filter "system:windows"
+				systemversion "latest"
+		
+		filter "configurations:Debug"
+				defines "XYZ_DEBUG"
+				runtime "Debug"
+				symbols "on"
+
+		postbuildcommands 
+		{
+			'{COPY} "../XYZEngine/vendor/mono/bin/Debug/mono-2.0-sgen.dll" "%{cfg.targetdir}"',
+			'{COPY} "%{Binaries.Assimp_Debug}" "%{cfg.targetdir}"',
+			"{COPYDIR} \"%{LibraryDir.VulkanSDK_DebugDLL}\" \"%{cfg.targetdir}\""
+		}
+		
+		filter "configurations:Release"
+				defines "XYZ_RELEASE"
+				runtime "Release"
+				optimize "on"
+
+		postbuildcommands 
+		{
+			'{COPY} "../XYZEngine/vendor/mono/bin/Release/mono-2.0-sgen.dll" "%{cfg.targetdir}"',
+			'{COPY} "%{Binaries.Assimp_Release}" "%{cfg.targetdir}"'
+		}
+
+		filter{}
+		filter "options:sharedimport"
+			postbuildcommands
+			{
+				'{COPY} "%{XYZEngineDll}" "%{cfg.targetdir}"'
+			}
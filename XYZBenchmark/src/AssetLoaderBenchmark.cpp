@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Asset/AssetLoader.h"
+#include "XYZ/Asset/AssetImporter.h"
+
+#include <chrono>
+#include <unordered_set>
+
+namespace XYZ {
+
+	static constexpr AssetType sc_BenchmarkAssetType = AssetType::Audio;
+
+	class BenchmarkAsset : public Asset
+	{
+	public:
+		virtual AssetType GetAssetType() const override { return sc_BenchmarkAssetType; }
+	};
+
+	// Loading sleeps for load cost, every tenth asset depends on two previous assets like material on its textures.
+	// Small part of assets throws same as malformed file
+	class BenchmarkAssetSerializer : public AssetSerializer
+	{
+	public:
+		virtual void Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const override {}
+
+		virtual bool TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const override
+		{
+			if (Broken.count(metadata.Handle))
+				throw std::runtime_error("Broken benchmark asset");
+
+			std::this_thread::sleep_for(LoadCost);
+			asset = Ref<BenchmarkAsset>::Create();
+			return true;
+		}
+
+		virtual std::vector<AssetHandle> GetDependencies(const AssetMetadata& metadata) const override
+		{
+			auto it = Dependencies.find(metadata.Handle);
+			if (it != Dependencies.end())
+				return it->second;
+			return {};
+		}
+
+		std::chrono::microseconds LoadCost{ 0 };
+		std::unordered_map<AssetHandle, std::vector<AssetHandle>> Dependencies;
+		std::unordered_set<AssetHandle> Broken;
+	};
+
+	static void RunAssetLoader(uint32_t assetCount, std::chrono::microseconds loadCost)
+	{
+		AssetRegistry registry;
+		auto serializer = CreateScope<BenchmarkAssetSerializer>();
+		serializer->LoadCost = loadCost;
+
+		std::vector<AssetHandle> handles(assetCount);
+		for (uint32_t i = 0; i < assetCount; ++i)
+		{
+			AssetMetadata metadata;
+			metadata.Handle = handles[i];
+			metadata.Type = sc_BenchmarkAssetType;
+			metadata.FilePath = "Benchmark/Asset" + std::to_string(i);
+			registry.StoreMetadata(metadata);
+
+			if (i % 10 == 9)
+				serializer->Dependencies[handles[i]] = { handles[i - 1], handles[i - 2] };
+			if (i % 1000 == 7)
+				serializer->Broken.insert(handles[i]);
+		}
+		const uint32_t brokenCount = static_cast<uint32_t>(serializer->Broken.size());
+		AssetImporter::SetSerializer(sc_BenchmarkAssetType, std::move(serializer));
+
+		for (const uint32_t threadCount : Benchmark::GetThreadCounts())
+		{
+			// Assets stay loaded while their results are alive, every run loads from scratch
+			std::vector<AssetLoaded> loaded;
+			uint32_t callbacks = 0;
+			AssetLoader loader(registry);
+			Stopwatch timer;
+			loader.Start(threadCount);
+			for (const AssetHandle& handle : handles)
+				loader.Load(registry.GetAsset(handle), [&](Ref<Asset>) { callbacks++; }, AssetLoadPriority::Normal);
+
+			while (loader.GetPendingCount() != 0)
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			const float ms = timer.Elapsed();
+
+			loader.TakeLoaded(loaded);
+			for (auto& result : loaded)
+			{
+				if (result.OnLoaded)
+					result.OnLoaded(result.Asset);
+			}
+			loader.Stop();
+			XYZ_BENCHMARK_CHECK(callbacks == assetCount - brokenCount);
+			XYZ_INFO("{} assets, {} us load, {} workers: {:.0f} assets/s", assetCount, loadCost.count(), threadCount, assetCount / (ms * 0.001f));
+		}
+		AssetImporter::SetSerializer(sc_BenchmarkAssetType, nullptr);
+	}
+
+	XYZ_BENCHMARK(AssetLoaderThroughput)
+	{
+		RunAssetLoader(20000, std::chrono::microseconds(0));
+		RunAssetLoader(256, std::chrono::microseconds(2000));
+	}
+}
@@ -0,0 +1,133 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Asset/AssetPack.h"
+
+#include <yaml-cpp/yaml.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_PackAssetCount = 3000;
+
+	struct PackStreamBuffer : public std::streambuf
+	{
+		PackStreamBuffer(std::string_view data)
+		{
+			char* begin = const_cast<char*>(data.data());
+			setg(begin, begin, begin + data.size());
+		}
+	};
+
+	static std::string ReadFile(const std::filesystem::path& path)
+	{
+		std::ifstream stream(path);
+		std::stringstream strStream;
+		strStream << stream.rdbuf();
+		return strStream.str();
+	}
+
+	// Material like files with their .meta files, same layout as Assets directory
+	static std::vector<AssetMetadata> WriteLooseAssets(const std::filesystem::path& directory)
+	{
+		std::vector<AssetMetadata> assets(sc_PackAssetCount);
+		for (uint32_t i = 0; i < sc_PackAssetCount; ++i)
+		{
+			AssetMetadata& metadata = assets[i];
+			metadata.Type = AssetType::Material;
+			metadata.FilePath = directory / ("Material" + std::to_string(i) + ".mat");
+
+			YAML::Emitter out;
+			out << YAML::BeginMap;
+			out << YAML::Key << "Shader" << YAML::Value << static_cast<std::string>(GUID());
+			out << YAML::Key << "Textures" << YAML::Value << YAML::BeginSeq;
+			for (uint32_t texture = 0; texture < 8; ++texture)
+			{
+				out << YAML::BeginMap;
+				out << YAML::Key << "Name" << YAML::Value << "u_Texture" + std::to_string(texture);
+				out << YAML::Key << "Handle" << YAML::Value << static_cast<std::string>(GUID());
+				out << YAML::EndMap;
+			}
+			out << YAML::EndSeq;
+			out << YAML::Key << "Values" << YAML::Value << YAML::BeginSeq;
+			for (uint32_t value = 0; value < 32; ++value)
+				out << YAML::Flow << std::vector<float>{ value * 0.5f, 1.0f, 0.25f, 0.0f };
+			out << YAML::EndSeq;
+			out << YAML::EndMap;
+			std::ofstream(metadata.FilePath) << out.c_str();
+
+			YAML::Emitter meta;
+			meta << YAML::BeginMap;
+			meta << YAML::Key << "Handle" << YAML::Value << static_cast<std::string>(metadata.Handle);
+			meta << YAML::Key << "FilePath" << YAML::Value << metadata.FilePath.string();
+			meta << YAML::Key << "Type" << YAML::Value << "Material";
+			meta << YAML::EndMap;
+			std::ofstream(metadata.FilePath.string() + ".meta") << meta.c_str();
+		}
+		return assets;
+	}
+
+	XYZ_BENCHMARK(AssetPackLoad)
+	{
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "XYZBenchmarkAssets";
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		const std::vector<AssetMetadata> assets = WriteLooseAssets(directory);
+
+		// Metadata and every asset parsed from loose files
+		uint32_t looseParsed = 0;
+		const float looseMs = Benchmark::Measure(1, [&]() {
+			for (const auto& entry : std::filesystem::directory_iterator(directory))
+			{
+				if (entry.path().extension() != ".meta")
+					continue;
+
+				const YAML::Node meta = YAML::Load(ReadFile(entry.path()));
+				const YAML::Node data = YAML::Load(ReadFile(meta["FilePath"].as<std::string>()));
+				looseParsed += data["Shader"].IsDefined();
+			}
+		});
+
+		for (const bool compress : { false, true })
+		{
+			const std::filesystem::path packPath = directory / (compress ? "Compressed.xyzpack" : "Assets.xyzpack");
+			const float cookMs = Benchmark::Measure(1, [&]() {
+				XYZ_BENCHMARK_CHECK(AssetPack::Cook(assets, packPath, compress));
+			});
+
+			uint32_t packParsed = 0;
+			AssetPack pack;
+			std::vector<uint8_t> scratch;
+			const float packMs = Benchmark::Measure(1, [&]() {
+				pack.Open(packPath);
+				for (const AssetMetadata& metadata : pack.GetMetadata())
+				{
+					std::string_view blob;
+					if (!pack.Read(metadata.Handle, blob, scratch))
+						continue;
+
+					PackStreamBuffer buffer(blob);
+					std::istream stream(&buffer);
+					const YAML::Node data = YAML::Load(stream);
+					packParsed += data["Shader"].IsDefined();
+				}
+			});
+
+			bool sameContent = pack.GetAssetCount() == sc_PackAssetCount;
+			for (const AssetMetadata& metadata : assets)
+			{
+				std::string_view blob;
+				sameContent &= pack.Read(metadata.Handle, blob, scratch) && blob == ReadFile(metadata.FilePath);
+			}
+			pack.Close();
+			XYZ_BENCHMARK_CHECK(sameContent);
+			XYZ_BENCHMARK_CHECK(looseParsed == sc_PackAssetCount && packParsed == sc_PackAssetCount);
+			XYZ_INFO("{} assets, compressed {}: loose files {:.3f} ms, pack {:.3f} ms, cook {:.3f} ms, pack size {} bytes",
+				sc_PackAssetCount, compress, looseMs, packMs, cookMs, std::filesystem::file_size(packPath));
+		}
+		std::filesystem::remove_all(directory);
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+#include "XYZ/Core/Logger.h"
+#include "XYZ/Debug/Timer.h"
+
+#include <vector>
+
+namespace XYZ {
+	namespace Benchmark {
+
+		using BenchmarkFunction = void(*)();
+
+		struct BenchmarkEntry
+		{
+			const char*		  Name;
+			BenchmarkFunction Function;
+		};
+
+		std::vector<BenchmarkEntry>& GetBenchmarks();
+
+		struct Registration
+		{
+			Registration(const char* name, BenchmarkFunction function)
+			{
+				GetBenchmarks().push_back({ name, function });
+			}
+		};
+
+		// Failed check is logged and the run returns non zero exit code
+		void Check(bool condition, const char* expression, const char* file, int line);
+
+		// 1, 2, 4 ... up to hardware threads
+		std::vector<uint32_t> GetThreadCounts();
+
+		// Average milliseconds of one call
+		template <typename F>
+		float Measure(uint32_t iterations, F&& func)
+		{
+			Stopwatch timer;
+			for (uint32_t i = 0; i < iterations; ++i)
+				func();
+			return timer.Elapsed() / iterations;
+		}
+	}
+}
+
+#define XYZ_BENCHMARK(name) \
+	static void name(); \
+	static ::XYZ::Benchmark::Registration s_##name##Registration(#name, &name); \
+	static void name()
+
+#define XYZ_BENCHMARK_CHECK(condition) ::XYZ::Benchmark::Check((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,60 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include <cstring>
+#include <thread>
+
+namespace XYZ {
+	namespace Benchmark {
+
+		static uint32_t s_FailedChecks = 0;
+
+		std::vector<BenchmarkEntry>& GetBenchmarks()
+		{
+			static std::vector<BenchmarkEntry> benchmarks;
+			return benchmarks;
+		}
+
+		void Check(bool condition, const char* expression, const char* file, int line)
+		{
+			if (!condition)
+			{
+				XYZ_ERROR("Check failed: {} {}:{}", expression, file, line);
+				s_FailedChecks++;
+			}
+		}
+
+		std::vector<uint32_t> GetThreadCounts()
+		{
+			const uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+			std::vector<uint32_t> result;
+			for (uint32_t count = 1; count < maxThreads; count *= 2)
+				result.push_back(count);
+			result.push_back(maxThreads);
+			return result;
+		}
+	}
+}
+
+// Runs benchmarks whose name contains the first argument, all of them without argument
+int main(int argc, char** argv)
+{
+	using namespace XYZ::Benchmark;
+	XYZ::CoreLogger::Init();
+
+	const char* filter = argc > 1 ? argv[1] : "";
+	for (const BenchmarkEntry& benchmark : GetBenchmarks())
+	{
+		if (strstr(benchmark.Name, filter) == nullptr)
+			continue;
+
+		XYZ_INFO("{}", benchmark.Name);
+		benchmark.Function();
+	}
+	if (s_FailedChecks != 0)
+	{
+		XYZ_ERROR("{} checks failed", s_FailedChecks);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Utils/DataStructures/DynamicTree.h"
+
+#include <random>
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_TreeBoxCount = 20000;
+	static constexpr uint32_t sc_TreeQueryCount = 2000;
+
+	static std::vector<AABB> CreateTreeBoxes(std::mt19937& random, uint32_t count, float size)
+	{
+		std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+		std::uniform_real_distribution<float> extent(0.5f, size);
+
+		std::vector<AABB> boxes(count);
+		for (auto& box : boxes)
+		{
+			const glm::vec3 min(position(random), position(random), position(random));
+			box = AABB(min, min + glm::vec3(extent(random), extent(random), extent(random)));
+		}
+		return boxes;
+	}
+
+	// Same slab test as the tree uses, brute force result has to match exactly
+	static bool RayBoxReference(const Ray& ray, const AABB& box, float& distance)
+	{
+		const glm::vec3 invDirection(1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z);
+		const glm::vec3 t1 = (box.Min - ray.Origin) * invDirection;
+		const glm::vec3 t2 = (box.Max - ray.Origin) * invDirection;
+		const glm::vec3 tMin = glm::min(t1, t2);
+		const glm::vec3 tMax = glm::max(t1, t2);
+
+		const float nearT = std::max(std::max(tMin.x, tMin.y), tMin.z);
+		const float farT = std::min(std::min(tMax.x, tMax.y), tMax.z);
+		if (farT < 0.0f || nearT > farT)
+			return false;
+
+		distance = std::max(nearT, 0.0f);
+		return true;
+	}
+
+	static bool QueriesMatch(const DynamicTree& tree, const std::vector<AABB>& boxes, const std::vector<AABB>& queries)
+	{
+		std::vector<uint32_t> treeResult;
+		std::vector<uint32_t> bruteForceResult;
+		for (const AABB& query : queries)
+		{
+			treeResult.clear();
+			tree.Query([&](int32_t leaf) {
+				treeResult.push_back(tree.GetDataIndex(leaf));
+				return false;
+			}, query);
+
+			bruteForceResult.clear();
+			for (uint32_t i = 0; i < static_cast<uint32_t>(boxes.size()); ++i)
+			{
+				if (boxes[i].Intersect(query))
+					bruteForceResult.push_back(i);
+			}
+			std::sort(treeResult.begin(), treeResult.end());
+			if (treeResult != bruteForceResult)
+				return false;
+		}
+		return true;
+	}
+
+	static bool RayCastsMatch(const DynamicTree& tree, const std::vector<AABB>& boxes, const std::vector<Ray>& rays)
+	{
+		std::vector<DynamicTree::RayHit> hits;
+		std::vector<uint32_t> treeResult;
+		std::vector<uint32_t> bruteForceResult;
+		for (const Ray& ray : rays)
+		{
+			tree.RayCastAll(ray, hits);
+			if (!std::is_sorted(hits.begin(), hits.end(), [](const auto& a, const auto& b) { return a.Distance < b.Distance; }))
+				return false;
+
+			treeResult.clear();
+			for (const auto& hit : hits)
+				treeResult.push_back(hit.DataIndex);
+
+			bruteForceResult.clear();
+			for (uint32_t i = 0; i < static_cast<uint32_t>(boxes.size()); ++i)
+			{
+				float distance;
+				if (RayBoxReference(ray, boxes[i], distance))
+					bruteForceResult.push_back(i);
+			}
+			std::sort(treeResult.begin(), treeResult.end());
+			if (treeResult != bruteForceResult)
+				return false;
+		}
+		return true;
+	}
+
+	XYZ_BENCHMARK(DynamicTreeRebuild)
+	{
+		std::mt19937 random(6);
+		std::vector<AABB> boxes = CreateTreeBoxes(random, sc_TreeBoxCount, 10.0f);
+		const std::vector<AABB> queries = CreateTreeBoxes(random, sc_TreeQueryCount, 40.0f);
+
+		std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+		std::vector<Ray> rays;
+		for (uint32_t i = 0; i < sc_TreeQueryCount; ++i)
+		{
+			const glm::vec3 origin = glm::vec3(coordinate(random), coordinate(random), coordinate(random)) * 600.0f;
+			const glm::vec3 target = glm::vec3(coordinate(random), coordinate(random), coordinate(random)) * 400.0f;
+			rays.emplace_back(origin, glm::normalize(target - origin));
+		}
+
+		DynamicTree tree;
+		std::vector<int32_t> leaves(sc_TreeBoxCount);
+		const float insertMs = Benchmark::Measure(1, [&]() {
+			for (uint32_t i = 0; i < sc_TreeBoxCount; ++i)
+				leaves[i] = tree.Insert(i, boxes[i]);
+		});
+
+		std::vector<DynamicTree::RayHit> hits;
+		auto castRays = [&]() {
+			for (const Ray& ray : rays)
+				tree.RayCastAll(ray, hits);
+		};
+		uint32_t queryHits = 0;
+		auto queryBoxes = [&]() {
+			queryHits = 0;
+			for (const AABB& query : queries)
+				tree.Query([&](int32_t leaf) { queryHits++; return false; }, query);
+		};
+		const float incrementalRayMs = Benchmark::Measure(5, castRays);
+		const float incrementalQueryMs = Benchmark::Measure(5, queryBoxes);
+		const int32_t incrementalHeight = tree.GetHeight();
+
+		const float rebuildMs = Benchmark::Measure(1, [&]() {
+			tree.Rebuild();
+		});
+		const float rebuiltRayMs = Benchmark::Measure(5, castRays);
+		const float rebuiltQueryMs = Benchmark::Measure(5, queryBoxes);
+		XYZ_BENCHMARK_CHECK(QueriesMatch(tree, boxes, queries));
+		XYZ_BENCHMARK_CHECK(RayCastsMatch(tree, boxes, rays));
+
+		// Leaves keep their indices through rebuild, incremental updates keep working on rebuilt tree
+		const glm::vec2 displacement(3.0f, -2.0f);
+		tree.CleanMovedNodes();
+		for (uint32_t i = 0; i < sc_TreeBoxCount; i += 10)
+		{
+			XYZ_BENCHMARK_CHECK(tree.GetDataIndex(leaves[i]) == i);
+			tree.Move(leaves[i], displacement);
+			boxes[i].Min += glm::vec3(displacement, 0.0f);
+			boxes[i].Max += glm::vec3(displacement, 0.0f);
+		}
+		const std::vector<uint8_t>& movedNodes = tree.GetMovedNodes();
+		bool movedMarked = true;
+		for (uint32_t i = 0; i < sc_TreeBoxCount; ++i)
+			movedMarked &= movedNodes[leaves[i]] == (i % 10 == 0);
+		XYZ_BENCHMARK_CHECK(movedMarked);
+		XYZ_BENCHMARK_CHECK(QueriesMatch(tree, boxes, queries));
+
+		XYZ_INFO("{} boxes, insert {:.3f} ms, rebuild {:.3f} ms, height {} -> {}", sc_TreeBoxCount, insertMs, rebuildMs, incrementalHeight, tree.GetHeight());
+		XYZ_INFO("{} rays: incremental tree {:.3f} ms, rebuilt tree {:.3f} ms", sc_TreeQueryCount, incrementalRayMs, rebuiltRayMs);
+		XYZ_INFO("{} box queries: incremental tree {:.3f} ms, rebuilt tree {:.3f} ms, {} hits", sc_TreeQueryCount, incrementalQueryMs, rebuiltQueryMs, queryHits);
+	}
+}
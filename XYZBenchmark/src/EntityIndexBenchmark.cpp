@@ -0,0 +1,98 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Scene/EntityHashIndex.h"
+#include "XYZ/Scene/Components.h"
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_IndexedEntityCount = 100000;
+	static constexpr uint32_t sc_LookupCount = 1000;
+
+	// Linear scan, lookup before the index was added
+	static entt::entity FindByGUIDLinear(entt::registry& registry, const GUID& guid)
+	{
+		auto view = registry.view<IDComponent>();
+		for (const entt::entity entity : view)
+		{
+			if (view.get<IDComponent>(entity).ID == guid)
+				return entity;
+		}
+		return entt::null;
+	}
+
+	static entt::entity FindByNameLinear(entt::registry& registry, const std::string& name)
+	{
+		auto view = registry.view<SceneTagComponent>();
+		for (const entt::entity entity : view)
+		{
+			if (view.get<SceneTagComponent>(entity).Name == name)
+				return entity;
+		}
+		return entt::null;
+	}
+
+	XYZ_BENCHMARK(EntityIndexLookup)
+	{
+		entt::registry registry;
+		std::vector<entt::entity> entities(sc_IndexedEntityCount);
+		for (uint32_t i = 0; i < sc_IndexedEntityCount; ++i)
+		{
+			entities[i] = registry.create();
+			registry.emplace<IDComponent>(entities[i], GUID());
+			registry.emplace<SceneTagComponent>(entities[i], "Entity " + std::to_string(i));
+		}
+
+		EntityHashIndex guidIndex;
+		EntityHashIndex nameIndex;
+		const float buildMs = Benchmark::Measure(1, [&]() {
+			guidIndex.Reserve(sc_IndexedEntityCount);
+			nameIndex.Reserve(sc_IndexedEntityCount);
+			for (const entt::entity entity : entities)
+			{
+				guidIndex.Insert(entity, registry.get<IDComponent>(entity).ID.Hash());
+				nameIndex.Insert(entity, std::hash<std::string_view>{}(registry.get<SceneTagComponent>(entity).Name));
+			}
+		});
+
+		std::vector<entt::entity> lookups(sc_LookupCount);
+		for (uint32_t i = 0; i < sc_LookupCount; ++i)
+			lookups[i] = entities[(i * 7919) % sc_IndexedEntityCount];
+
+		std::vector<entt::entity> linearResults(sc_LookupCount);
+		std::vector<entt::entity> indexResults(sc_LookupCount);
+		const float linearGUIDMs = Benchmark::Measure(1, [&]() {
+			for (uint32_t i = 0; i < sc_LookupCount; ++i)
+				linearResults[i] = FindByGUIDLinear(registry, registry.get<IDComponent>(lookups[i]).ID);
+		});
+		const float indexGUIDMs = Benchmark::Measure(1, [&]() {
+			for (uint32_t i = 0; i < sc_LookupCount; ++i)
+			{
+				const GUID& guid = registry.get<IDComponent>(lookups[i]).ID;
+				indexResults[i] = guidIndex.Find(guid.Hash(), [&](entt::entity entity) {
+					return registry.get<IDComponent>(entity).ID == guid;
+				});
+			}
+		});
+		XYZ_BENCHMARK_CHECK(linearResults == lookups && indexResults == lookups);
+
+		const float linearNameMs = Benchmark::Measure(1, [&]() {
+			for (uint32_t i = 0; i < sc_LookupCount; ++i)
+				linearResults[i] = FindByNameLinear(registry, registry.get<SceneTagComponent>(lookups[i]).Name);
+		});
+		const float indexNameMs = Benchmark::Measure(1, [&]() {
+			for (uint32_t i = 0; i < sc_LookupCount; ++i)
+			{
+				const std::string& name = registry.get<SceneTagComponent>(lookups[i]).Name;
+				indexResults[i] = nameIndex.Find(std::hash<std::string_view>{}(name), [&](entt::entity entity) {
+					return registry.get<SceneTagComponent>(entity).Name == name;
+				});
+			}
+		});
+		XYZ_BENCHMARK_CHECK(linearResults == lookups && indexResults == lookups);
+
+		XYZ_INFO("{} entities, index build {:.3f} ms", sc_IndexedEntityCount, buildMs);
+		XYZ_INFO("{} GUID lookups: linear {:.3f} ms, index {:.3f} ms", sc_LookupCount, linearGUIDMs, indexGUIDMs);
+		XYZ_INFO("{} name lookups: linear {:.3f} ms, index {:.3f} ms", sc_LookupCount, linearNameMs, indexNameMs);
+	}
+}
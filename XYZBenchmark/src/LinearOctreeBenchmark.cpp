@@ -0,0 +1,82 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Utils/DataStructures/LinearOctree.h"
+#include "XYZ/Utils/DataStructures/Octree.h"
+#include "XYZ/Core/ThreadPool.h"
+
+#include <random>
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_OctreeDepth = 4;
+	static const AABB sc_OctreeBounds(glm::vec3(-1000.0f), glm::vec3(1000.0f));
+
+	static std::vector<AABB> CreateBoxes(uint32_t count)
+	{
+		std::mt19937 random(3);
+		std::uniform_real_distribution<float> position(-990.0f, 990.0f);
+		std::uniform_real_distribution<float> size(0.5f, 10.0f);
+
+		std::vector<AABB> boxes(count);
+		for (auto& box : boxes)
+		{
+			const glm::vec3 min(position(random), position(random), position(random));
+			box = AABB(min, min + glm::vec3(size(random), size(random), size(random)));
+		}
+		return boxes;
+	}
+
+	// Every box is stored exactly once, in node that contains it. Node bounds get small tolerance for rounding of cell edges
+	static bool ValidOctree(const LinearOctree& octree, const std::vector<AABB>& boxes)
+	{
+		std::vector<uint32_t> stored(boxes.size(), 0);
+		for (const LinearOctreeNode& node : octree.GetNodes())
+		{
+			const AABB nodeBounds(glm::vec3(node.Min) - 0.01f, glm::vec3(node.Max) + 0.01f);
+			for (int32_t i = node.DataStart; i < node.DataEnd; ++i)
+			{
+				const int32_t index = octree.GetData()[i];
+				if (!nodeBounds.Contains(boxes[index]))
+					return false;
+				stored[index]++;
+			}
+		}
+		return std::all_of(stored.begin(), stored.end(), [](uint32_t count) { return count == 1; });
+	}
+
+	XYZ_BENCHMARK(LinearOctreeBuild)
+	{
+		for (const uint32_t count : { 1000u, 10000u, 100000u, 1000000u })
+		{
+			const std::vector<AABB> boxes = CreateBoxes(count);
+			const uint32_t iterations = count >= 100000 ? 2 : 20;
+
+			const float pointerMs = Benchmark::Measure(iterations, [&]() {
+				Octree octree(sc_OctreeBounds, sc_OctreeDepth);
+				for (uint32_t i = 0; i < count; ++i)
+					octree.InsertData(boxes[i], static_cast<int32_t>(i));
+			});
+
+			LinearOctree octree(sc_OctreeBounds, sc_OctreeDepth);
+			const float linearMs = Benchmark::Measure(iterations, [&]() {
+				octree.Build(boxes.data(), count);
+			});
+			XYZ_BENCHMARK_CHECK(ValidOctree(octree, boxes));
+			XYZ_INFO("{} boxes: Octree insert {:.3f} ms, LinearOctree build {:.3f} ms, {} nodes",
+				count, pointerMs, linearMs, octree.GetNodes().size());
+
+			for (const uint32_t threadCount : Benchmark::GetThreadCounts())
+			{
+				ThreadPool pool;
+				pool.Start(threadCount);
+				const float parallelMs = Benchmark::Measure(iterations, [&]() {
+					octree.Build(boxes.data(), count, pool);
+				});
+				XYZ_BENCHMARK_CHECK(ValidOctree(octree, boxes));
+				XYZ_INFO("{} threads: LinearOctree build {:.3f} ms", threadCount, parallelMs);
+				pool.Stop();
+			}
+		}
+	}
+}
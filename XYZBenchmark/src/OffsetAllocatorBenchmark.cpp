@@ -0,0 +1,214 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Utils/DataStructures/OffsetAllocator.h"
+
+#include <random>
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_AllocatorCapacity = 16 * 1024 * 1024;
+	static constexpr uint32_t sc_LiveAllocationCount = 4000;
+	static constexpr uint32_t sc_MaxAllocationSize = 4096;
+
+	// Free range scheme StorageBufferAllocator used before OffsetAllocator. Freed ranges are appended,
+	// allocation sorts them if needed, merges neighbours and scans from the back, otherwise bumps the end
+	class FreeRangeAllocator
+	{
+	public:
+		uint32_t Allocate(uint32_t size)
+		{
+			if (m_SortRequired)
+			{
+				std::sort(m_FreeRanges.begin(), m_FreeRanges.end(), [](const Range& a, const Range& b) {
+					return a.Offset < b.Offset;
+				});
+				m_SortRequired = false;
+			}
+			for (int64_t i = m_FreeRanges.size() - 1; i >= 1; --i)
+			{
+				Range& last = m_FreeRanges[i];
+				Range& prev = m_FreeRanges[i - 1];
+				if (last.Offset == prev.Offset + prev.Size)
+				{
+					prev.Size += last.Size;
+					m_FreeRanges.erase(m_FreeRanges.begin() + i);
+				}
+			}
+			for (int64_t i = m_FreeRanges.size() - 1; i >= 0; --i)
+			{
+				Range& last = m_FreeRanges[i];
+				if (last.Size > size)
+				{
+					last.Size -= size;
+					return last.Offset + last.Size;
+				}
+				else if (last.Size == size)
+				{
+					const uint32_t offset = last.Offset;
+					m_FreeRanges.erase(m_FreeRanges.begin() + i);
+					return offset;
+				}
+			}
+			const uint32_t offset = m_Next;
+			m_Next += size;
+			return offset;
+		}
+
+		void Free(uint32_t offset, uint32_t size)
+		{
+			m_FreeRanges.push_back({ offset, size });
+			m_SortRequired = true;
+		}
+
+		uint32_t GetEnd() const { return m_Next; }
+
+	private:
+		struct Range
+		{
+			uint32_t Offset;
+			uint32_t Size;
+		};
+		std::vector<Range> m_FreeRanges;
+		uint32_t		   m_Next = 0;
+		bool			   m_SortRequired = false;
+	};
+
+	struct StressAllocation
+	{
+		uint32_t Node;
+		uint8_t	 Tag;
+	};
+
+	static bool ValidContent(const OffsetAllocator& allocator, const std::vector<uint8_t>& memory, const StressAllocation& allocation)
+	{
+		const uint8_t* data = memory.data() + allocator.GetOffset(allocation.Node);
+		return std::all_of(data, data + allocator.GetSize(allocation.Node), [&](uint8_t value) { return value == allocation.Tag; });
+	}
+
+	// Every allocation fills its range with own tag, overlapping ranges or wrong relocations break the tags
+	XYZ_BENCHMARK(OffsetAllocatorStress)
+	{
+		std::mt19937 random(4);
+		OffsetAllocator allocator(sc_AllocatorCapacity);
+		std::vector<uint8_t> memory(sc_AllocatorCapacity, 0);
+		std::vector<StressAllocation> live;
+		std::vector<OffsetAllocator::Relocation> relocations;
+
+		bool validContent = true;
+		float fragmentationBefore = 0.0f;
+		float compactMs = 0.0f;
+		for (uint32_t operation = 0; operation < 200000; ++operation)
+		{
+			const uint32_t action = random() % 8;
+			if (action < 4 || live.empty())
+			{
+				const OffsetAllocator::Allocation allocation = allocator.Allocate(1 + random() % sc_MaxAllocationSize);
+				if (!allocation.Valid())
+					continue;
+
+				const StressAllocation stress{ allocation.Node, static_cast<uint8_t>(1 + random() % 255) };
+				memset(memory.data() + allocation.Offset, stress.Tag, allocator.GetSize(allocation.Node));
+				live.push_back(stress);
+			}
+			else if (action < 7)
+			{
+				const uint32_t index = random() % live.size();
+				validContent &= ValidContent(allocator, memory, live[index]);
+				allocator.Free(live[index].Node);
+				live[index] = live.back();
+				live.pop_back();
+			}
+			else
+			{
+				StressAllocation& stress = live[random() % live.size()];
+				const uint32_t oldSize = allocator.GetSize(stress.Node);
+				if (allocator.Grow(stress.Node, oldSize + 1 + random() % sc_MaxAllocationSize))
+					memset(memory.data() + allocator.GetOffset(stress.Node), stress.Tag, allocator.GetSize(stress.Node));
+			}
+
+			if (operation % 20000 == 19999)
+			{
+				fragmentationBefore = allocator.GetStatistics().Fragmentation;
+				relocations.clear();
+				compactMs += Benchmark::Measure(1, [&]() {
+					allocator.Compact(relocations);
+				});
+				// Sorted by destination, memmove handles source overlapping own destination
+				for (const OffsetAllocator::Relocation& relocation : relocations)
+					memmove(memory.data() + relocation.DstOffset, memory.data() + relocation.SrcOffset, relocation.Size);
+
+				for (const StressAllocation& stress : live)
+					validContent &= ValidContent(allocator, memory, stress);
+
+				const OffsetAllocator::Statistics stats = allocator.GetStatistics();
+				XYZ_BENCHMARK_CHECK(stats.FreeRegions <= 1 && stats.Fragmentation == 0.0f);
+			}
+		}
+		XYZ_BENCHMARK_CHECK(validContent);
+
+		uint32_t usedSize = 0;
+		for (const StressAllocation& stress : live)
+			usedSize += allocator.GetSize(stress.Node);
+		XYZ_BENCHMARK_CHECK(usedSize == allocator.GetUsedSize());
+		XYZ_INFO("{} live allocations, fragmentation {:.1f}% before compaction, compaction total {:.3f} ms",
+			live.size(), fragmentationBefore, compactMs);
+	}
+
+	XYZ_BENCHMARK(OffsetAllocatorFreeAllocate)
+	{
+		std::mt19937 random(5);
+		std::vector<uint32_t> sizes(sc_LiveAllocationCount);
+		for (auto& size : sizes)
+			size = 1 + random() % sc_MaxAllocationSize;
+
+		// Random slot is freed and allocated again with new size, both allocators get the same sequence
+		const uint32_t pairCount = 20000;
+		std::vector<uint32_t> slots(pairCount);
+		std::vector<uint32_t> newSizes(pairCount);
+		for (uint32_t i = 0; i < pairCount; ++i)
+		{
+			slots[i] = random() % sc_LiveAllocationCount;
+			newSizes[i] = 1 + random() % sc_MaxAllocationSize;
+		}
+
+		OffsetAllocator allocator(sc_AllocatorCapacity);
+		std::vector<uint32_t> nodes(sc_LiveAllocationCount);
+		for (uint32_t i = 0; i < sc_LiveAllocationCount; ++i)
+			nodes[i] = allocator.Allocate(sizes[i]).Node;
+
+		uint32_t failed = 0;
+		const float offsetMs = Benchmark::Measure(1, [&]() {
+			for (uint32_t i = 0; i < pairCount; ++i)
+			{
+				const uint32_t slot = slots[i];
+				allocator.Free(nodes[slot]);
+				const OffsetAllocator::Allocation allocation = allocator.Allocate(newSizes[i]);
+				failed += !allocation.Valid();
+				nodes[slot] = allocation.Node;
+			}
+		});
+		XYZ_BENCHMARK_CHECK(failed == 0);
+
+		FreeRangeAllocator freeRanges;
+		std::vector<uint32_t> offsets(sc_LiveAllocationCount);
+		for (uint32_t i = 0; i < sc_LiveAllocationCount; ++i)
+			offsets[i] = freeRanges.Allocate(sizes[i]);
+
+		const float freeRangesMs = Benchmark::Measure(1, [&]() {
+			for (uint32_t i = 0; i < pairCount; ++i)
+			{
+				const uint32_t slot = slots[i];
+				freeRanges.Free(offsets[slot], sizes[slot]);
+				offsets[slot] = freeRanges.Allocate(newSizes[i]);
+				sizes[slot] = newSizes[i];
+			}
+		});
+		XYZ_BENCHMARK_CHECK(freeRanges.GetEnd() <= sc_AllocatorCapacity);
+
+		const OffsetAllocator::Statistics stats = allocator.GetStatistics();
+		XYZ_INFO("{} free and allocate pairs: OffsetAllocator {:.1f} ns, free range list {:.1f} ns per pair",
+			pairCount, offsetMs * 1e6f / pairCount, freeRangesMs * 1e6f / pairCount);
+		XYZ_INFO("Largest free {} bytes, {} free regions, fragmentation {:.1f}%", stats.LargestFree, stats.FreeRegions, stats.Fragmentation);
+	}
+}
@@ -0,0 +1,95 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Utils/DataStructures/FreeList.h"
+#include "XYZ/Utils/DataStructures/PackedFreeList.h"
+
+#include <random>
+
+namespace XYZ {
+
+	static constexpr int32_t sc_FreeListElementCount = 1000000;
+
+	struct FreeListElement
+	{
+		float	 Value[6];
+		uint32_t Data;
+	};
+
+	// Same elements are erased from both lists, the rest is iterated
+	template <typename List>
+	static void FillAndErase(List& list, const std::vector<uint8_t>& erased)
+	{
+		for (int32_t i = 0; i < sc_FreeListElementCount; ++i)
+			list.Insert({ { static_cast<float>(i) }, static_cast<uint32_t>(i) });
+		for (int32_t i = 0; i < sc_FreeListElementCount; ++i)
+		{
+			if (erased[i])
+				list.Erase(i);
+		}
+	}
+
+	XYZ_BENCHMARK(PackedFreeListIteration)
+	{
+		for (const uint32_t erasedPercent : { 10u, 50u, 90u })
+		{
+			std::mt19937 random(1);
+			std::vector<uint8_t> erased(sc_FreeListElementCount);
+			for (auto& value : erased)
+				value = random() % 100 < erasedPercent;
+
+			FreeList<FreeListElement> freeList;
+			PackedFreeList<FreeListElement> packedList;
+			FillAndErase(freeList, erased);
+			FillAndErase(packedList, erased);
+
+			uint64_t freeListSum = 0;
+			const float freeListMs = Benchmark::Measure(10, [&]() {
+				freeListSum = 0;
+				for (int32_t i = 0; i < freeList.Range(); ++i)
+				{
+					if (freeList.Valid(i))
+						freeListSum += freeList[i].Data;
+				}
+			});
+
+			uint64_t packedSum = 0;
+			const float packedMs = Benchmark::Measure(10, [&]() {
+				packedSum = 0;
+				packedList.ForEach([&](int32_t index, const FreeListElement& elem) {
+					packedSum += elem.Data;
+				});
+			});
+			XYZ_BENCHMARK_CHECK(freeListSum == packedSum);
+
+			XYZ_INFO("{}% erased: FreeList {:.3f} ms, PackedFreeList {:.3f} ms, element {} bytes vs {} bytes",
+				erasedPercent, freeListMs, packedMs, sizeof(std::variant<int32_t, FreeListElement>), sizeof(FreeListElement));
+		}
+	}
+
+	XYZ_BENCHMARK(PackedFreeListChurn)
+	{
+		PackedFreeList<FreeListElement> packedList;
+		std::vector<PackedFreeList<FreeListElement>::Handle> handles;
+		for (int32_t i = 0; i < sc_FreeListElementCount; ++i)
+			handles.push_back(packedList.GetHandle(packedList.Insert({ {}, static_cast<uint32_t>(i) })));
+
+		// Every erased slot is reused, handles of erased elements must not resolve
+		std::mt19937 random(2);
+		uint32_t staleResolved = 0;
+		const float churnMs = Benchmark::Measure(1, [&]() {
+			for (int32_t i = 0; i < sc_FreeListElementCount; ++i)
+			{
+				const uint32_t slot = random() % sc_FreeListElementCount;
+				const auto stale = handles[slot];
+				packedList.Erase(stale);
+				handles[slot] = packedList.GetHandle(packedList.Insert({ {}, static_cast<uint32_t>(i) }));
+				if (packedList.TryGet(stale) != nullptr)
+					staleResolved++;
+			}
+		});
+		XYZ_BENCHMARK_CHECK(staleResolved == 0);
+		XYZ_BENCHMARK_CHECK(packedList.Size() == sc_FreeListElementCount);
+		XYZ_INFO("{} erase and insert pairs {:.3f} ms", sc_FreeListElementCount, churnMs);
+	}
+}
@@ -0,0 +1,82 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Utils/Math/Perlin.h"
+
+#include "PerlinNoise.hpp"
+
+#include <random>
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_PerlinSeed = 1234;
+	static constexpr uint32_t sc_PerlinTestRowCount = 20000;
+	static constexpr uint32_t sc_PerlinRowLength = 64;	 // Voxel chunk width
+	static constexpr uint32_t sc_PerlinTimingRowCount = 64 * 256; // 256 chunks
+	static constexpr uint32_t sc_PerlinTimingOctaves = 4;
+
+	// Row is evaluated in float, measured difference stays below 5e-5 with both AVX2 and SSE2
+	static constexpr double sc_PerlinRowTolerance = 1e-4;
+
+	// Old scalar noise is siv octave2D_01 evaluated per sample in double, row has to match it within tolerance
+	XYZ_BENCHMARK(PerlinOctave2DRow)
+	{
+		const siv::PerlinNoise noise(sc_PerlinSeed);
+		Perlin::SetSeed(sc_PerlinSeed);
+
+		std::mt19937 random(sc_PerlinSeed);
+		std::uniform_real_distribution<double> position(-1e5, 1e5);
+		std::uniform_real_distribution<double> step(0.001, 0.5);
+
+		bool scalarMatches = true;
+		double maxDifference = 0.0;
+		std::vector<float> row;
+		for (uint32_t i = 0; i < sc_PerlinTestRowCount; ++i)
+		{
+			const double x = position(random);
+			const double y = position(random);
+			const double stepX = step(random);
+			const uint32_t count = 1 + random() % 300;
+			const uint32_t octaves = 1 + random() % 8;
+
+			row.resize(count);
+			Perlin::Octave2DRow(row.data(), x, y, stepX, count, octaves);
+			for (uint32_t sample = 0; sample < count; ++sample)
+			{
+				const double sampleX = x + sample * stepX;
+				const double expected = noise.octave2D_01(sampleX, y, octaves);
+				scalarMatches &= Perlin::Octave2D(sampleX, y, octaves) == expected;
+				maxDifference = std::max(maxDifference, std::abs(static_cast<double>(row[sample]) - expected));
+			}
+		}
+		XYZ_BENCHMARK_CHECK(scalarMatches);
+		XYZ_BENCHMARK_CHECK(maxDifference < sc_PerlinRowTolerance);
+		XYZ_INFO("{} random rows, max difference from scalar noise {:.2e}", sc_PerlinTestRowCount, maxDifference);
+
+		// Same rows as terrain generation, frequency 1 over chunk width
+		const double stepX = 1.0 / sc_PerlinRowLength;
+		std::vector<float> scalarResult(sc_PerlinTimingRowCount * sc_PerlinRowLength);
+		std::vector<float> rowResult(scalarResult.size());
+		const float scalarMs = Benchmark::Measure(3, [&]() {
+			for (uint32_t z = 0; z < sc_PerlinTimingRowCount; ++z)
+			{
+				float* result = &scalarResult[z * sc_PerlinRowLength];
+				for (uint32_t x = 0; x < sc_PerlinRowLength; ++x)
+					result[x] = static_cast<float>(Perlin::Octave2D(x * stepX, z * stepX, sc_PerlinTimingOctaves));
+			}
+		});
+		const float rowMs = Benchmark::Measure(3, [&]() {
+			for (uint32_t z = 0; z < sc_PerlinTimingRowCount; ++z)
+				Perlin::Octave2DRow(&rowResult[z * sc_PerlinRowLength], 0.0, z * stepX, stepX, sc_PerlinRowLength, sc_PerlinTimingOctaves);
+		});
+
+		float timingDifference = 0.0f;
+		for (size_t i = 0; i < rowResult.size(); ++i)
+			timingDifference = std::max(timingDifference, std::abs(rowResult[i] - scalarResult[i]));
+		XYZ_BENCHMARK_CHECK(timingDifference < sc_PerlinRowTolerance);
+
+		const float sampleCount = static_cast<float>(rowResult.size());
+		XYZ_INFO("{} samples, {} octaves: scalar {:.1f} ns, row {:.1f} ns per sample, speedup {:.2f}x",
+			rowResult.size(), sc_PerlinTimingOctaves, scalarMs * 1e6f / sampleCount, rowMs * 1e6f / sampleCount, scalarMs / rowMs);
+	}
+}
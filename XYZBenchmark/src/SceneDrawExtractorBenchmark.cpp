@@ -0,0 +1,86 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Renderer/SceneDrawExtractor.h"
+#include "XYZ/Core/ThreadPool.h"
+
+#include <random>
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_DrawSpriteCount = 200000;
+	static constexpr uint32_t sc_DrawSubTextureCount = 64;
+
+	static bool SameSubmits(const GeometryRenderQueue& a, const GeometryRenderQueue& b)
+	{
+		if (a.Keys != b.Keys || a.Payloads != b.Payloads || a.SpriteSubmits.size() != b.SpriteSubmits.size())
+			return false;
+
+		for (size_t i = 0; i < a.SpriteSubmits.size(); ++i)
+		{
+			const auto& submitA = a.SpriteSubmits[i];
+			const auto& submitB = b.SpriteSubmits[i];
+			if (submitA.Texture != submitB.Texture || submitA.TexCoords != submitB.TexCoords
+				|| submitA.Color != submitB.Color || submitA.Transform != submitB.Transform)
+				return false;
+		}
+		return true;
+	}
+
+	// Materials and textures need the renderer, draws share null material and texture
+	// and differ by sub texture coordinates, color and transform. Mesh draws need mesh bounds from GPU mesh, so only sprites are recorded
+	XYZ_BENCHMARK(SceneDrawExtractorScaling)
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		const Ref<MaterialAsset> material;
+		std::vector<Ref<SubTexture>> subTextures;
+		for (uint32_t i = 0; i < sc_DrawSubTextureCount; ++i)
+			subTextures.push_back(Ref<SubTexture>::Create(Ref<Texture2D>(), glm::vec4(unit(random), unit(random), 1.0f, 1.0f)));
+
+		std::vector<glm::vec4> colors(sc_DrawSpriteCount);
+		std::vector<glm::mat4> transforms(sc_DrawSpriteCount);
+		std::vector<SceneDrawExtractor::SpriteDraw> sprites(sc_DrawSpriteCount);
+		for (uint32_t i = 0; i < sc_DrawSpriteCount; ++i)
+		{
+			colors[i] = glm::vec4(unit(random), unit(random), unit(random), 1.0f);
+			transforms[i] = glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random), position(random)));
+			sprites[i] = { &material, &subTextures[random() % sc_DrawSubTextureCount], &colors[i], &transforms[i] };
+		}
+		const std::vector<SceneDrawExtractor::MeshDraw> meshes;
+
+		SceneDrawExtractor serialExtractor;
+		GeometryRenderQueue serialQueue;
+		const float serialMs = Benchmark::Measure(5, [&]() {
+			serialQueue.Clear();
+			serialExtractor.Record(sprites, meshes, serialQueue);
+		});
+		XYZ_BENCHMARK_CHECK(serialQueue.SpriteSubmits.size() == sc_DrawSpriteCount);
+		XYZ_INFO("{} sprites, serial: record {:.3f} ms", sc_DrawSpriteCount, serialMs);
+
+		for (const uint32_t threadCount : Benchmark::GetThreadCounts())
+		{
+			ThreadPool pool;
+			pool.Start(threadCount);
+
+			SceneDrawExtractor extractor;
+			GeometryRenderQueue queue;
+			float recordMs = 0.0f;
+			float mergeMs = 0.0f;
+			const float totalMs = Benchmark::Measure(5, [&]() {
+				queue.Clear();
+				extractor.Record(sprites, meshes, queue, &pool);
+				recordMs += extractor.GetStats().ExtractTimeMs / 5.0f;
+				mergeMs += extractor.GetStats().MergeTimeMs / 5.0f;
+			});
+			pool.Stop();
+
+			// Segments are merged in order, result does not depend on thread count
+			XYZ_BENCHMARK_CHECK(SameSubmits(queue, serialQueue));
+			XYZ_INFO("{} threads, {} segments: record {:.3f} ms, merge {:.3f} ms, total {:.3f} ms, speedup {:.2f}x",
+				threadCount, extractor.GetStats().SegmentCount, recordMs, mergeMs, totalMs, serialMs / totalMs);
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/API/Vulkan/VulkanShaderCache.h"
+#include "XYZ/Renderer/ShaderParser.h"
+#include "XYZ/Renderer/ShaderIncluder.h"
+#include "XYZ/Core/ThreadPool.h"
+#include "XYZ/Utils/FileSystem.h"
+#include "XYZ/Utils/StringUtils.h"
+
+namespace XYZ {
+
+	// Include paths in shaders are relative to XYZEditor directory
+	static constexpr const char* sc_BenchmarkShaderDirectory = "Resources/Shaders";
+	static constexpr const char* sc_BenchmarkIncludeDirectory = "Resources/Shaders/Includes";
+
+	struct BenchmarkShaderStage
+	{
+		std::string			Path;
+		shaderc_shader_kind Kind;
+		std::string			Source;
+	};
+
+	// Same parsing as VulkanShader::Precompile, otherwise cache keys differ
+	static std::vector<BenchmarkShaderStage> ParseShaderStages()
+	{
+		ShaderParser parser;
+		parser.AddKeyword("XYZ_INSTANCED");
+
+		std::vector<BenchmarkShaderStage> stages;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(sc_BenchmarkShaderDirectory))
+		{
+			if (!entry.is_regular_file() || Utils::GetExtension(entry.path().string()) != "glsl")
+				continue;
+
+			const std::string path = entry.path().generic_string();
+			for (auto& [type, source] : parser.ParseStages(FileSystem::ReadFile(path)))
+			{
+				parser.RemoveKeywordsFromSourceCode(source);
+				const shaderc_shader_kind kind = type == "vertex" ? shaderc_vertex_shader
+					: type == "compute" ? shaderc_compute_shader : shaderc_fragment_shader;
+				stages.push_back({ path, kind, std::move(source) });
+			}
+		}
+		return stages;
+	}
+
+	XYZ_BENCHMARK(ShaderCacheCompile)
+	{
+		if (!std::filesystem::exists(sc_BenchmarkIncludeDirectory))
+		{
+			XYZ_WARN("{} not found, run from XYZEditor directory", sc_BenchmarkIncludeDirectory);
+			return;
+		}
+
+		ShaderIncluder includer;
+		includer.AddIncludes(sc_BenchmarkIncludeDirectory);
+		const std::vector<BenchmarkShaderStage> stages = ParseShaderStages();
+		const uint32_t stageCount = static_cast<uint32_t>(stages.size());
+
+		// Same source gives same key, any change in source gives new key
+		bool stableKeys = true;
+		for (const BenchmarkShaderStage& stage : stages)
+		{
+			const uint64_t key = VulkanShaderCache::ComputeKey(stage.Source, stage.Kind, includer);
+			stableKeys &= key == VulkanShaderCache::ComputeKey(stage.Source, stage.Kind, includer);
+			stableKeys &= key != VulkanShaderCache::ComputeKey(stage.Source + "\n", stage.Kind, includer);
+		}
+		XYZ_BENCHMARK_CHECK(stableKeys);
+
+		std::vector<std::vector<uint32_t>> compiled(stageCount);
+		for (const uint32_t threadCount : Benchmark::GetThreadCounts())
+		{
+			ThreadPool pool;
+			pool.Start(threadCount);
+			VulkanShaderCache::ResetStatistics();
+			const float compileMs = Benchmark::Measure(1, [&]() {
+				pool.ParallelFor(stageCount, 1, [&](uint32_t index) {
+					const BenchmarkShaderStage& stage = stages[index];
+					VulkanShaderCache::GetOrCompile(stage.Path, stage.Source, stage.Kind, includer, compiled[index], true);
+				});
+			});
+			const VulkanShaderCache::Statistics compileStats = VulkanShaderCache::GetStatistics();
+			XYZ_BENCHMARK_CHECK(compileStats.Failed == 0);
+
+			// Every stage was just stored, second pass reads only cached binaries
+			std::vector<std::vector<uint32_t>> cached(stageCount);
+			VulkanShaderCache::ResetStatistics();
+			const float cachedMs = Benchmark::Measure(1, [&]() {
+				pool.ParallelFor(stageCount, 1, [&](uint32_t index) {
+					const BenchmarkShaderStage& stage = stages[index];
+					VulkanShaderCache::GetOrCompile(stage.Path, stage.Source, stage.Kind, includer, cached[index]);
+				});
+			});
+			const VulkanShaderCache::Statistics cachedStats = VulkanShaderCache::GetStatistics();
+			XYZ_BENCHMARK_CHECK(cachedStats.Hits == stageCount && cachedStats.Misses == 0);
+			XYZ_BENCHMARK_CHECK(cached == compiled);
+			pool.Stop();
+
+			XYZ_INFO("{} stages, {} threads: compile {:.3f} ms, cached {:.3f} ms", stageCount, threadCount, compileMs, cachedMs);
+		}
+	}
+}
@@ -0,0 +1,129 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Utils/Algorithms/SpaceColonization.h"
+#include "XYZ/Core/ThreadPool.h"
+
+namespace XYZ {
+
+	// Voxel panel defaults with ranges x0.25, dense crown takes many steps
+	static SCInitializer CreateTreeInitializer(uint32_t attractorCount)
+	{
+		SCInitializer initializer;
+		initializer.AttractorsCount = attractorCount;
+		initializer.AttractorsCenter = glm::vec3(0.0f, 100.0f, 0.0f);
+		initializer.AttractorsRadius = 50.0f;
+		initializer.AttractionRange = 5.0f;
+		initializer.KillRange = 2.5f;
+		initializer.RootPosition = glm::vec3(0.0f);
+		initializer.BranchLength = 1.75f;
+		return initializer;
+	}
+
+	// Kill and assignment passes testing every attractor against every branch, as before the grid
+	static void BruteForceStep(const SCInitializer& initializer, const std::vector<glm::vec3>& attractors, const std::vector<SCBranch>& branches,
+		std::vector<glm::vec3>& remaining, std::vector<uint32_t>& attractorCounts)
+	{
+		remaining.clear();
+		for (const glm::vec3& attractor : attractors)
+		{
+			bool killed = false;
+			for (const SCBranch& branch : branches)
+			{
+				if (glm::distance(branch.End, attractor) < initializer.KillRange)
+				{
+					killed = true;
+					break;
+				}
+			}
+			if (!killed)
+				remaining.push_back(attractor);
+		}
+
+		attractorCounts.assign(branches.size(), 0);
+		for (const glm::vec3& attractor : remaining)
+		{
+			float min = std::numeric_limits<float>::max();
+			uint32_t closest = SCBranch::sc_NullIndex;
+			for (uint32_t i = 0; i < static_cast<uint32_t>(branches.size()); ++i)
+			{
+				const float distance = glm::distance(branches[i].End, attractor);
+				if (distance < initializer.AttractionRange && distance < min)
+				{
+					min = distance;
+					closest = i;
+				}
+			}
+			if (closest != SCBranch::sc_NullIndex)
+				attractorCounts[closest]++;
+		}
+	}
+
+	static bool MatchesBruteForce(const SpaceColonization& tree, const std::vector<glm::vec3>& remaining, const std::vector<uint32_t>& attractorCounts)
+	{
+		if (tree.GetAttractors() != remaining)
+			return false;
+
+		// Without attractors assignment is skipped
+		if (remaining.empty())
+			return true;
+
+		for (uint32_t i = 0; i < static_cast<uint32_t>(attractorCounts.size()); ++i)
+		{
+			if (tree.GetBranches()[i].AttractorCount != attractorCounts[i])
+				return false;
+		}
+		return true;
+	}
+
+	static void RunSpaceColonization(uint32_t attractorCount, uint32_t steps, uint32_t verifyEvery)
+	{
+		const SCInitializer initializer = CreateTreeInitializer(attractorCount);
+		for (const uint32_t threadCount : Benchmark::GetThreadCounts())
+		{
+			ThreadPool pool;
+			pool.Start(threadCount);
+
+			SpaceColonization tree(initializer);
+			std::vector<glm::vec3> attractors;
+			std::vector<SCBranch> branches;
+			std::vector<glm::vec3> remaining;
+			std::vector<uint32_t> attractorCounts;
+
+			bool matches = true;
+			float growMs = 0.0f;
+			float bruteForceMs = 0.0f;
+			uint32_t verifiedSteps = 0;
+			for (uint32_t step = 0; step < steps; ++step)
+			{
+				const bool verify = step % verifyEvery == 0;
+				if (verify)
+				{
+					attractors = tree.GetAttractors();
+					branches = tree.GetBranches();
+					bruteForceMs += Benchmark::Measure(1, [&]() {
+						BruteForceStep(initializer, attractors, branches, remaining, attractorCounts);
+					});
+					verifiedSteps++;
+				}
+
+				growMs += Benchmark::Measure(1, [&]() {
+					tree.Grow(&pool);
+				});
+				if (verify)
+					matches &= MatchesBruteForce(tree, remaining, attractorCounts);
+			}
+			pool.Stop();
+
+			XYZ_BENCHMARK_CHECK(matches);
+			XYZ_INFO("{} attractors, {} threads, {} steps: grow {:.3f} ms per step, brute force passes {:.3f} ms per step, {} branches, {} attractors left",
+				attractorCount, threadCount, steps, growMs / steps, bruteForceMs / verifiedSteps, tree.GetBranches().size(), tree.GetAttractors().size());
+		}
+	}
+
+	XYZ_BENCHMARK(SpaceColonizationGrow)
+	{
+		RunSpaceColonization(10000, 150, 1);
+		RunSpaceColonization(100000, 40, 10);
+	}
+}
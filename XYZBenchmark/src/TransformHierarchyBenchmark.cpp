@@ -0,0 +1,93 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "XYZ/Scene/TransformHierarchy.h"
+#include "XYZ/Scene/Components.h"
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_EntityCount = 100000;
+	static constexpr uint32_t sc_ChildrenPerEntity = 8;
+
+	static std::vector<entt::entity> CreateHierarchy(entt::registry& registry)
+	{
+		std::vector<entt::entity> entities(sc_EntityCount);
+		for (uint32_t i = 0; i < sc_EntityCount; ++i)
+		{
+			entities[i] = registry.create();
+			registry.emplace<Relationship>(entities[i]);
+			if (i == 0)
+			{
+				// Root is not updated by the hierarchy, same as scene entity
+				registry.emplace<TransformComponent>(entities[i]);
+				continue;
+			}
+			registry.emplace<TransformComponent>(entities[i], glm::vec3(static_cast<float>(i % 7), 1.0f, 0.0f));
+			Relationship::SetupRelation(entities[(i - 1) / sc_ChildrenPerEntity], entities[i], registry);
+		}
+		return entities;
+	}
+
+	// Recursive walk over the whole tree, hierarchy update before flattening
+	static void UpdateRecursive(entt::registry& registry, entt::entity entity, const glm::mat4& parentTransform, std::vector<glm::mat4>& result)
+	{
+		const glm::mat4 worldTransform = parentTransform * registry.get<TransformComponent>(entity).GetLocalTransform();
+		result[static_cast<size_t>(entt::to_entity(entity))] = worldTransform;
+
+		entt::entity child = registry.get<Relationship>(entity).GetFirstChild();
+		while (registry.valid(child))
+		{
+			UpdateRecursive(registry, child, worldTransform, result);
+			child = registry.get<Relationship>(child).GetNextSibling();
+		}
+	}
+
+	static bool MatchesRecursive(entt::registry& registry, const std::vector<entt::entity>& entities)
+	{
+		std::vector<glm::mat4> expected(sc_EntityCount);
+		UpdateRecursive(registry, entities[0], glm::mat4(1.0f), expected);
+		for (const entt::entity entity : entities)
+		{
+			if (registry.get<TransformComponent>(entity)->WorldTransform != expected[static_cast<size_t>(entt::to_entity(entity))])
+				return false;
+		}
+		return true;
+	}
+
+	XYZ_BENCHMARK(TransformHierarchyUpdate)
+	{
+		entt::registry registry;
+		const std::vector<entt::entity> entities = CreateHierarchy(registry);
+
+		std::vector<glm::mat4> recursiveResult(sc_EntityCount);
+		const float recursiveMs = Benchmark::Measure(10, [&]() {
+			UpdateRecursive(registry, entities[0], glm::mat4(1.0f), recursiveResult);
+		});
+		XYZ_INFO("{} entities, recursive walk {:.3f} ms", sc_EntityCount, recursiveMs);
+
+		for (const uint32_t threadCount : Benchmark::GetThreadCounts())
+		{
+			ThreadPool pool;
+			pool.Start(threadCount);
+
+			TransformHierarchy hierarchy;
+			const float fullMs = Benchmark::Measure(10, [&]() {
+				hierarchy.Invalidate();
+				hierarchy.Update(registry, entities[0], &pool);
+			});
+			XYZ_BENCHMARK_CHECK(MatchesRecursive(registry, entities));
+
+			// Every hundredth entity moves, its subtree is recomputed
+			const float partialMs = Benchmark::Measure(10, [&]() {
+				for (uint32_t i = 1; i < sc_EntityCount; i += 100)
+					registry.get<TransformComponent>(entities[i]).GetTransform().Translation.z += 1.0f;
+				hierarchy.Update(registry, entities[0], &pool);
+			});
+			XYZ_BENCHMARK_CHECK(MatchesRecursive(registry, entities));
+
+			XYZ_INFO("{} threads: rebuild and full update {:.3f} ms, 1% moved {:.3f} ms ({} updated), {:.0f} entities/ms",
+				threadCount, fullMs, partialMs, hierarchy.GetStats().UpdatedCount, sc_EntityCount / fullMs);
+			pool.Stop();
+		}
+	}
+}
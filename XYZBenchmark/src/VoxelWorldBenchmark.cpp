@@ -0,0 +1,263 @@
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "Voxel/VoxelWorld.h"
+#include "Voxel/VoxelTerrainGenerator.h"
+
+#include "XYZ/Utils/Math/Perlin.h"
+
+#include <random>
+#include <thread>
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_VoxelBenchmarkSeed = 1234;
+	static constexpr uint32_t sc_VoxelChunkCount = 256;
+	static constexpr uint32_t sc_WorldFlightFrames = 120;
+	static constexpr float	  sc_WorldFlightSpeed = 16.0f; // Units per frame, new chunk every fourth frame
+
+	static bool SameSubmesh(const VoxelSubmesh& a, const VoxelSubmesh& b)
+	{
+		if (a.Width != b.Width || a.Height != b.Height || a.Depth != b.Depth || a.CompressScale != b.CompressScale
+			|| a.ColorIndices != b.ColorIndices || a.CompressedCells.size() != b.CompressedCells.size())
+			return false;
+
+		for (size_t i = 0; i < a.CompressedCells.size(); ++i)
+		{
+			if (a.CompressedCells[i].VoxelCount != b.CompressedCells[i].VoxelCount
+				|| a.CompressedCells[i].VoxelOffset != b.CompressedCells[i].VoxelOffset)
+				return false;
+		}
+		return true;
+	}
+
+	static VoxelTerrainGenerator CreateChunkTerrain(uint32_t index)
+	{
+		const glm::ivec3 dimensions = VoxelWorld::sc_ChunkDimensions;
+		VoxelTerrainGenerator terrain(dimensions.x, dimensions.y, dimensions.z, VoxelWorld::sc_WaterLevel);
+		terrain.GenerateHeights(index % 16, index / 16, 1.0f, 3);
+		return terrain;
+	}
+
+	static const VoxelChunk* FindActiveChunk(const VoxelWorld& world, int64_t chunkX, int64_t chunkZ)
+	{
+		for (const auto& chunkRow : world.GetActiveChunks())
+		{
+			for (const auto& chunk : chunkRow)
+			{
+				if (chunk.Mesh.Raw() && chunk.X == chunkX && chunk.Z == chunkZ)
+					return &chunk;
+			}
+		}
+		return nullptr;
+	}
+
+	// Every chunk of window around center has to be active after WaitForChunks
+	static bool WindowComplete(const VoxelWorld& world, int64_t centerChunkX, int64_t centerChunkZ)
+	{
+		const int64_t viewDistance = world.GetViewDistance();
+		for (int64_t x = centerChunkX - viewDistance; x <= centerChunkX + viewDistance; ++x)
+		{
+			for (int64_t z = centerChunkZ - viewDistance; z <= centerChunkZ + viewDistance; ++z)
+			{
+				if (!FindActiveChunk(world, x, z))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// Columns compressed directly against grid compression, generation against loading stored grids
+	XYZ_BENCHMARK(VoxelTerrainGeneration)
+	{
+		const glm::ivec3 dimensions = VoxelWorld::sc_ChunkDimensions;
+		const uint32_t scale = VoxelWorld::sc_ChunkCompressScale;
+		const float voxelSize = VoxelWorld::sc_ChunkVoxelSize;
+		Perlin::SetSeed(sc_VoxelBenchmarkSeed);
+
+		bool sameSubmeshes = true;
+		std::vector<uint8_t> voxels;
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			const VoxelTerrainGenerator terrain = CreateChunkTerrain(i);
+			terrain.FillGrid(voxels);
+			sameSubmeshes &= SameSubmesh(terrain.BuildSubmesh(scale, voxelSize), VoxelSubmesh::Compress(scale, dimensions.x, dimensions.y, dimensions.z, voxelSize, voxels));
+		}
+		XYZ_BENCHMARK_CHECK(sameSubmeshes);
+
+		std::vector<VoxelSubmesh> submeshes(sc_VoxelChunkCount);
+		float serialMs = 0.0f;
+		for (const uint32_t threadCount : Benchmark::GetThreadCounts())
+		{
+			ThreadPool pool;
+			pool.Start(threadCount);
+			const float generateMs = Benchmark::Measure(1, [&]() {
+				pool.ParallelFor(sc_VoxelChunkCount, 1, [&](uint32_t index) {
+					submeshes[index] = CreateChunkTerrain(index).BuildSubmesh(scale, voxelSize);
+				});
+			});
+			pool.Stop();
+			if (threadCount == 1)
+				serialMs = generateMs;
+
+			XYZ_INFO("{} chunks, {} threads: generate {:.3f} ms, {:.1f} chunks per second, speedup {:.2f}x",
+				sc_VoxelChunkCount, threadCount, generateMs, sc_VoxelChunkCount * 1000.0f / generateMs, serialMs / generateMs);
+		}
+
+		// Stored chunk has to be decompressed and its grid compressed again
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "XYZBenchmarkVoxelStore";
+		std::filesystem::remove_all(directory);
+		{
+			VoxelChunkStore store(directory, VoxelWorld::sc_ChunkCacheSizeMB);
+			const float storeMs = Benchmark::Measure(1, [&]() {
+				for (uint32_t i = 0; i < sc_VoxelChunkCount; ++i)
+				{
+					CreateChunkTerrain(i).FillGrid(voxels);
+					store.Store(i % 16, i / 16, voxels);
+				}
+			});
+
+			bool sameLoaded = true;
+			const float loadMs = Benchmark::Measure(1, [&]() {
+				for (uint32_t i = 0; i < sc_VoxelChunkCount; ++i)
+				{
+					sameLoaded &= store.Load(i % 16, i / 16, voxels);
+					sameLoaded &= SameSubmesh(VoxelSubmesh::Compress(scale, dimensions.x, dimensions.y, dimensions.z, voxelSize, voxels), submeshes[i]);
+				}
+			});
+			XYZ_BENCHMARK_CHECK(sameLoaded);
+			XYZ_INFO("Per chunk: generate {:.3f} ms, generate and store {:.3f} ms, load {:.3f} ms",
+				serialMs / sc_VoxelChunkCount, storeMs / sc_VoxelChunkCount, loadMs / sc_VoxelChunkCount);
+		}
+		std::filesystem::remove_all(directory);
+	}
+
+	// Camera flies along x axis, window follows it and chunks that left it are cancelled
+	XYZ_BENCHMARK(VoxelWorldGeneration)
+	{
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "XYZBenchmarkVoxelWorld";
+		const glm::ivec3 dimensions = VoxelWorld::sc_ChunkDimensions;
+		for (const uint32_t threadCount : Benchmark::GetThreadCounts())
+		{
+			std::filesystem::remove_all(directory);
+			ThreadPool pool;
+			pool.Start(threadCount);
+			{
+				VoxelWorld world(directory, sc_VoxelBenchmarkSeed, &pool);
+				const float initialMs = Benchmark::Measure(1, [&]() {
+					world.WaitForChunks();
+				});
+				XYZ_BENCHMARK_CHECK(WindowComplete(world, 0, 0));
+
+				glm::vec3 position(0.0f);
+				const float flightMs = Benchmark::Measure(1, [&]() {
+					for (uint32_t frame = 0; frame < sc_WorldFlightFrames; ++frame)
+					{
+						position.x += sc_WorldFlightSpeed;
+						world.Update(position);
+						std::this_thread::sleep_for(std::chrono::milliseconds(16));
+					}
+					world.WaitForChunks();
+				});
+				const int64_t centerChunkX = static_cast<int64_t>(std::floor((position.x + dimensions.x / 2) / dimensions.x));
+				XYZ_BENCHMARK_CHECK(WindowComplete(world, centerChunkX, 0));
+
+				// Only edited chunk is stored, it is loaded instead of generated when it comes to view
+				const int64_t editedChunkX = centerChunkX + 100;
+				std::vector<uint8_t> edited;
+				VoxelTerrainGenerator terrain(dimensions.x, dimensions.y, dimensions.z, VoxelWorld::sc_WaterLevel);
+				terrain.GenerateHeights(editedChunkX, 0, 1.0f, 3);
+				terrain.FillGrid(edited);
+				std::fill(edited.begin(), edited.begin() + dimensions.x * dimensions.y, 3);
+				XYZ_BENCHMARK_CHECK(world.GetChunkStoreStatistics().Writes == 0);
+				world.StoreChunk(editedChunkX, 0, edited);
+
+				world.Update(glm::vec3(editedChunkX * dimensions.x, 0.0f, 0.0f));
+				world.WaitForChunks();
+				const VoxelChunk* editedChunk = FindActiveChunk(world, editedChunkX, 0);
+				const VoxelSubmesh expected = VoxelSubmesh::Compress(VoxelWorld::sc_ChunkCompressScale, dimensions.x, dimensions.y, dimensions.z, VoxelWorld::sc_ChunkVoxelSize, edited);
+				XYZ_BENCHMARK_CHECK(editedChunk && SameSubmesh(editedChunk->Mesh->GetSubmeshes()[0], expected));
+
+				const VoxelWorld::Statistics stats = world.GetStatistics();
+				XYZ_INFO("{} threads: initial window {:.3f} ms, flight {} frames {:.3f} ms, requested {}, ready {}, cancelled {}, latency avg {:.2f} ms, p99 {:.2f} ms",
+					threadCount, initialMs, sc_WorldFlightFrames, flightMs, stats.RequestedChunks, stats.ReadyChunks, stats.CancelledChunks, stats.AverageLatencyMs, stats.P99LatencyMs);
+			}
+			pool.Stop();
+		}
+		std::filesystem::remove_all(directory);
+	}
+
+	// Voxel DAGs of chunks against dense grids, rays cast down have to hit top voxel of generated column
+	XYZ_BENCHMARK(VoxelWorldQueries)
+	{
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "XYZBenchmarkVoxelQueries";
+		const glm::ivec3 dimensions = VoxelWorld::sc_ChunkDimensions;
+		std::filesystem::remove_all(directory);
+
+		ThreadPool pool;
+		pool.Start(Benchmark::GetThreadCounts().back());
+		{
+			VoxelWorld world(directory, sc_VoxelBenchmarkSeed, &pool);
+			const float denseMs = Benchmark::Measure(1, [&]() {
+				world.WaitForChunks();
+			});
+			const Ray downRay(glm::vec3(0.5f, 200.0f, 0.5f), glm::vec3(0.0f, -1.0f, 0.0f));
+			VoxelWorldHit hit;
+			XYZ_BENCHMARK_CHECK(!world.Raycast(downRay, hit));
+
+			const float queriesMs = Benchmark::Measure(1, [&]() {
+				world.SetVoxelQueries(true);
+				world.WaitForChunks();
+			});
+			XYZ_BENCHMARK_CHECK(WindowComplete(world, 0, 0));
+
+			std::mt19937 random(8);
+			const int64_t viewDistance = world.GetViewDistance();
+			std::uniform_int_distribution<int64_t> chunkCoord(-viewDistance, viewDistance);
+			std::uniform_int_distribution<uint32_t> column(0, dimensions.x - 1);
+
+			std::vector<Ray> rays;
+			bool correctHits = true;
+			for (uint32_t i = 0; i < 1000; ++i)
+			{
+				const int64_t chunkX = chunkCoord(random);
+				const int64_t chunkZ = chunkCoord(random);
+				const uint32_t x = column(random);
+				const uint32_t z = column(random);
+
+				VoxelTerrainGenerator terrain(dimensions.x, dimensions.y, dimensions.z, VoxelWorld::sc_WaterLevel);
+				terrain.GenerateHeights(chunkX, chunkZ, 1.0f, 3);
+				const uint32_t top = std::max(terrain.GetColumnHeight(x, z), VoxelWorld::sc_WaterLevel) - 1;
+
+				// Chunks are centered around their coordinates, same as chunk mesh instances
+				const glm::vec3 origin(
+					chunkX * dimensions.x - dimensions.x / 2.0f + x + 0.5f,
+					200.0f,
+					chunkZ * dimensions.z - dimensions.z / 2.0f + z + 0.5f
+				);
+				rays.emplace_back(origin, glm::vec3(0.0f, -1.0f, 0.0f));
+				const float expectedDistance = 200.0f - (top + 1.0f - dimensions.y / 2.0f);
+				correctHits &= world.Raycast(rays.back(), hit) && hit.ChunkX == chunkX && hit.ChunkZ == chunkZ
+					&& hit.Voxel == glm::uvec3(x, top, z) && std::abs(hit.Distance - expectedDistance) < 1e-3f;
+			}
+			XYZ_BENCHMARK_CHECK(correctHits);
+
+			uint32_t hits = 0;
+			const float raycastMs = Benchmark::Measure(10, [&]() {
+				for (const Ray& ray : rays)
+					hits += world.Raycast(ray, hit);
+			});
+
+			const VoxelWorld::Statistics stats = world.GetStatistics();
+			XYZ_BENCHMARK_CHECK(stats.QueryVoxelMemory < stats.DenseVoxelMemory);
+			XYZ_INFO("Window without voxels {:.3f} ms, with voxel DAGs {:.3f} ms", denseMs, queriesMs);
+			XYZ_INFO("Voxel DAGs {} bytes, dense grids {} bytes, ratio {:.1f}x, raycast {:.3f} us",
+				stats.QueryVoxelMemory, stats.DenseVoxelMemory, static_cast<float>(stats.DenseVoxelMemory) / stats.QueryVoxelMemory, raycastMs * 1000.0f / rays.size());
+
+			world.SetVoxelQueries(false);
+			XYZ_BENCHMARK_CHECK(world.GetStatistics().QueryVoxelMemory == 0 && !world.Raycast(downRay, hit));
+		}
+		pool.Stop();
+		std::filesystem::remove_all(directory);
+	}
+}
@@ -2,6 +2,7 @@
 #include "EditorManager.h"
 
 #include "XYZ/Core/Application.h"
+#include "XYZ/Asset/AssetManager.h"
 
 #include "XYZ/Scene/SceneSerializer.h"
 #include "XYZ/Project/ProjectSerializer.h"
@@ -116,6 +117,13 @@ namespace XYZ {
 							return false;
 						});
 					}
+					if (ImGui::MenuItem("Cook Asset Pack"))
+					{
+						if (AssetManager::CookAssetPack(AssetManager::GetAssetPackPath()))
+							XYZ_INFO("Asset pack cooked to {0}", AssetManager::GetAssetPackPath().string());
+						else
+							XYZ_ERROR("Failed to cook asset pack");
+					}
 					if (ImGui::MenuItem("Exit"))
 					{
 						Application::Get().Stop();
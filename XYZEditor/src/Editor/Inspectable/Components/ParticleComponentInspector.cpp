@@ -57,6 +57,13 @@ namespace XYZ {
 						[&]() {ImGui::Text("%u", component.GetSystem()->GetAliveParticles()); }
 					);
 
+					UI::TableRow("Skipped Frames",
+						[]() {ImGui::Text("Skipped Frames"); },
+						[&]() {
+						const auto& stats = component.GetSystem()->GetStats();
+						ImGui::Text("%u / %u", stats.SkippedFrames, stats.SkippedFrames + stats.SimulatedFrames);
+					});
+
 					ImGui::EndTable();
 				}
 	
@@ -17,13 +17,15 @@ namespace XYZ {
 		{
 			return EditorHelper::DrawComponent<SceneTagComponent>("Scene Tag", m_Context, [&](auto& component) {
 
-				std::string& tag = m_Context.GetComponent<SceneTagComponent>().Name;
+				const std::string& tag = m_Context.GetComponent<SceneTagComponent>().Name;
 				char buffer[256];
 				memset(buffer, 0, sizeof(buffer));
 				std::strncpy(buffer, tag.c_str(), sizeof(buffer));
 				if (ImGui::InputText("##Tag", buffer, sizeof(buffer)))
 				{
-					tag = std::string(buffer);
+					m_Context.PatchComponent<SceneTagComponent>([&](SceneTagComponent& tagComponent) {
+						tagComponent.Name = std::string(buffer);
+					});
 				}
 			});
 		}
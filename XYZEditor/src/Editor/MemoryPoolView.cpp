@@ -15,24 +15,32 @@ namespace XYZ {
 			XYZ_ASSERT(ImGui::GetCurrentWindow(), "ImGui must have active window");
 			if (ImGui::BeginTable("##MemoryStats", 2, ImGuiTableFlags_SizingFixedFit))
 			{
-				UI::TextTableRow("%s", "Block Size: ", "%u", m_Pool.GetBlockSize());
-				UI::TextTableRow("%s", "Block Count: ", "%u", m_Pool.GetNumBlocks());
+				if (m_Pool.GetMode() == MemoryPool::Mode::Blocks)
+				{
+					UI::TextTableRow("%s", "Block Size: ", "%u", m_Pool.GetBlockSize());
+					UI::TextTableRow("%s", "Block Count: ", "%u", m_Pool.GetNumBlocks());
+				}
 				UI::TextTableRow("%s", "Memory Used: ", "%u", m_Pool.GetMemoryUsed());
 				UI::TextTableRow("%s", "Allocation Count: ", "%u", m_Pool.GetNumAllocations());
 
 				ImGui::EndTable();
 			}
 			
+			if (m_Pool.GetMode() == MemoryPool::Mode::SizeClasses)
+				sizeClassesView();
+			else
+				blocksView();
+		}
+
+		void MemoryPoolView::blocksView()
+		{
 			if (UI::BeginTreeNode("Allocations"))
 			{
 				if (ImGui::BeginTable("##AllocNames", 2, ImGuiTableFlags_SizingFixedFit))
 				{
-					const auto& allocations = m_Pool.GetAllocations();
-					for (int32_t i = 0; i < allocations.Range(); ++i)
-					{
-						if (allocations.Valid(i))
-							UI::TextTableRow("%s", "Allocation:", "%s", allocations[i]);
-					}
+					m_Pool.GetAllocations().ForEach([](int32_t index, const std::string& name) {
+						UI::TextTableRow("%s", "Allocation:", "%s", name.c_str());
+					});
 					ImGui::EndTable();
 				}
 				UI::EndTreeNode();
@@ -52,5 +60,53 @@ namespace XYZ {
 				UI::EndTreeNode();
 			}		
 		}
+
+		void MemoryPoolView::sizeClassesView()
+		{
+			const SlabAllocator* allocator = m_Pool.GetSlabAllocator();
+			if (UI::BeginTreeNode("Size Classes"))
+			{
+				if (ImGui::BeginTable("##SizeClasses", 5, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg))
+				{
+					ImGui::TableSetupColumn("Slot Size");
+					ImGui::TableSetupColumn("Slabs");
+					ImGui::TableSetupColumn("Used Slots");
+					ImGui::TableSetupColumn("Occupancy");
+					ImGui::TableSetupColumn("Fragmentation");
+					ImGui::TableHeadersRow();
+
+					for (const auto& stats : allocator->GetClassStats())
+					{
+						if (stats.SlabCount == 0)
+							continue;
+
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						ImGui::Text("%u", stats.SlotSize);
+						ImGui::TableNextColumn();
+						ImGui::Text("%u", stats.SlabCount);
+						ImGui::TableNextColumn();
+						ImGui::Text("%u / %u", stats.UsedSlots, stats.SlotCount);
+						ImGui::TableNextColumn();
+						ImGui::ProgressBar(stats.Occupancy(), ImVec2(100.0f, 0.0f));
+						ImGui::TableNextColumn();
+						ImGui::Text("%.1f %%", stats.Fragmentation() * 100.0f);
+					}
+					ImGui::EndTable();
+				}
+				UI::EndTreeNode();
+			}
+			if (UI::BeginTreeNode("Allocations"))
+			{
+				if (ImGui::BeginTable("##AllocNames", 2, ImGuiTableFlags_SizingFixedFit))
+				{
+					for (const auto& name : allocator->GetDebugNames())
+						UI::TextTableRow("%s", "Allocation:", "%s", name.c_str());
+
+					ImGui::EndTable();
+				}
+				UI::EndTreeNode();
+			}
+		}
 	}
 }
\ No newline at end of file
@@ -10,6 +10,10 @@ namespace XYZ {
 
 			void OnImGuiRender();
 
+		private:
+			void blocksView();
+			void sizeClassesView();
+
 		private:
 			const MemoryPool& m_Pool;
 		};
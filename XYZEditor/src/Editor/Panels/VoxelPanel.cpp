@@ -13,6 +13,7 @@
 #include "XYZ/Utils/Math/Math.h"
 #include "XYZ/Utils/Math/Perlin.h"
 #include "XYZ/Utils/Random.h"
+#include "XYZ/Utils/StringUtils.h"
 #include "XYZ/Utils/Algorithms/Raymarch.h"
 
 
@@ -215,6 +216,27 @@ namespace XYZ {
 				}
 
 				ImGui::Checkbox("Update Water", &m_UpdateWater);
+
+				int viewDistance = static_cast<int>(m_World.GetViewDistance());
+				if (ImGui::SliderInt("Chunk View Distance", &viewDistance, 1, VoxelWorld::sc_MaxChunkViewDistance))
+					m_World.SetViewDistance(static_cast<uint32_t>(viewDistance));
+
+				bool voxelQueries = m_World.GetVoxelQueries();
+				if (ImGui::Checkbox("Voxel Queries", &voxelQueries))
+					m_World.SetVoxelQueries(voxelQueries);
+
+				const VoxelChunkStore::Statistics chunkStats = m_World.GetChunkStoreStatistics();
+				ImGui::NewLine();
+				ImGui::Text("Chunk Cache Hits: %u", chunkStats.CacheHits);
+				ImGui::Text("Chunk Disk Reads: %u", chunkStats.DiskReads);
+				ImGui::Text("Chunks Generated: %u", chunkStats.Misses);
+				ImGui::Text("Chunk Cache: %u chunks, %s", chunkStats.CachedChunks, Utils::BytesToString(chunkStats.CacheMemory).c_str());
+
+				const VoxelWorld::Statistics worldStats = m_World.GetStatistics();
+				ImGui::Text("Chunks Ready: %u / %u, Cancelled: %u, Pending: %u", worldStats.ReadyChunks, worldStats.RequestedChunks, worldStats.CancelledChunks, worldStats.PendingChunks);
+				ImGui::Text("Chunk Latency: avg %.2f ms, p99 %.2f ms", worldStats.AverageLatencyMs, worldStats.P99LatencyMs);
+				if (voxelQueries)
+					ImGui::Text("Query Voxels: %s, dense %s", Utils::BytesToString(worldStats.QueryVoxelMemory).c_str(), Utils::BytesToString(worldStats.DenseVoxelMemory).c_str());
 			}
 			ImGui::End();
 
@@ -272,7 +294,7 @@ namespace XYZ {
 				}
 				//m_World.Update(m_EditorCamera.GetPosition());
 				m_World.Update(glm::vec3(0));
-				for (const auto& chunkRow : *m_World.GetActiveChunks())
+				for (const auto& chunkRow : m_World.GetActiveChunks())
 				{
 					for (const auto& chunk : chunkRow)
 					{
@@ -366,7 +388,8 @@ namespace XYZ {
 							treeSubmesh.Height, 
 							treeSubmesh.Depth, 
 							treeSubmesh.VoxelSize,
-							radius
+							radius,
+							&Application::Get().GetThreadPool()
 						);		
 						if (radius > 1 && RandomNumber(0u, 1u) != 0)
 							radius--;
@@ -0,0 +1,211 @@
+#include "stdafx.h"
+#include "VoxelChunkStore.h"
+
+#include "XYZ/Utils/Compression.h"
+#include "XYZ/Debug/Profiler.h"
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_RegionMagic = 0x5247585a; // "ZXGR"
+	static constexpr uint32_t sc_RegionVersion = 1;
+
+	static int64_t FloorDiv(int64_t value, int64_t divisor)
+	{
+		return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+	}
+
+	VoxelRegionFile::VoxelRegionFile(const std::filesystem::path& path)
+		:
+		m_Path(path)
+	{
+		m_Stream.open(path, std::ios::binary | std::ios::in | std::ios::out);
+		if (!m_Stream.is_open())
+		{
+			create();
+			return;
+		}
+
+		Header header{};
+		m_Stream.read(reinterpret_cast<char*>(&header), sizeof(Header));
+		m_Stream.read(reinterpret_cast<char*>(m_Entries.data()), sizeof(m_Entries));
+		if (!m_Stream || header.Magic != sc_RegionMagic || header.Version != sc_RegionVersion || header.RegionSize != sc_RegionSize)
+		{
+			XYZ_CORE_WARN("Invalid region file {}, recreating", path.string());
+			m_Stream.close();
+			create();
+			return;
+		}
+		m_Mapping.Open(m_Path);
+	}
+
+	bool VoxelRegionFile::Read(uint32_t localX, uint32_t localZ, std::vector<uint8_t>& compressed, uint32_t& size)
+	{
+		std::lock_guard lock(m_Mutex);
+		const Entry& entry = m_Entries[localX * sc_RegionSize + localZ];
+		if (entry.Offset == 0)
+			return false;
+
+		// Chunks written after file was mapped require new mapping
+		const uint64_t end = entry.Offset + entry.CompressedSize;
+		if (end > m_Mapping.GetSize())
+		{
+			if (!m_Mapping.Open(m_Path) || end > m_Mapping.GetSize())
+				return false;
+		}
+		const uint8_t* data = m_Mapping.GetData() + entry.Offset;
+		compressed.assign(data, data + entry.CompressedSize);
+		size = entry.Size;
+		return true;
+	}
+
+	void VoxelRegionFile::Write(uint32_t localX, uint32_t localZ, const std::vector<uint8_t>& compressed, uint32_t size)
+	{
+		std::lock_guard lock(m_Mutex);
+		const uint32_t index = localX * sc_RegionSize + localZ;
+
+		// Old data are left in file, chunks are rarely rewritten
+		m_Stream.seekp(0, std::ios::end);
+		Entry& entry = m_Entries[index];
+		entry.Offset = static_cast<uint64_t>(m_Stream.tellp());
+		entry.CompressedSize = static_cast<uint32_t>(compressed.size());
+		entry.Size = size;
+		m_Stream.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+
+		m_Stream.seekp(sizeof(Header) + index * sizeof(Entry), std::ios::beg);
+		m_Stream.write(reinterpret_cast<const char*>(&entry), sizeof(Entry));
+		m_Stream.flush();
+	}
+
+	void VoxelRegionFile::create()
+	{
+		m_Entries.fill({});
+		const Header header{ sc_RegionMagic, sc_RegionVersion, sc_RegionSize, 0 };
+		{
+			std::ofstream output(m_Path, std::ios::binary | std::ios::trunc);
+			output.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			output.write(reinterpret_cast<const char*>(m_Entries.data()), sizeof(m_Entries));
+		}
+		m_Stream.open(m_Path, std::ios::binary | std::ios::in | std::ios::out);
+		m_Mapping.Open(m_Path);
+	}
+
+	VoxelChunkStore::VoxelChunkStore(const std::filesystem::path& directory, size_t cacheSizeMB)
+		:
+		m_Directory(directory),
+		m_CacheCapacity(cacheSizeMB * 1024 * 1024)
+	{
+		std::filesystem::create_directories(directory);
+	}
+
+	bool VoxelChunkStore::Load(int64_t chunkX, int64_t chunkZ, std::vector<uint8_t>& voxels)
+	{
+		XYZ_PROFILE_FUNC("VoxelChunkStore::Load");
+		const ChunkKey key{ chunkX, chunkZ };
+		std::vector<uint8_t> compressed;
+		uint32_t size = 0;
+		bool cached = false;
+		{
+			// Only copy of compressed bytes is done under lock, other threads do not wait for decompression
+			std::lock_guard lock(m_CacheMutex);
+			auto it = m_CacheLookup.find(key);
+			if (it != m_CacheLookup.end())
+			{
+				m_Cache.splice(m_Cache.begin(), m_Cache, it->second);
+				const CacheEntry& entry = *it->second;
+				compressed = entry.Compressed;
+				size = entry.Size;
+				cached = true;
+				m_Statistics.CacheHits++;
+			}
+		}
+		if (cached)
+		{
+			voxels.resize(size);
+			return Utils::RLEDecompress(compressed.data(), compressed.size(), voxels.data(), voxels.size());
+		}
+
+		const int64_t regionX = FloorDiv(chunkX, VoxelRegionFile::sc_RegionSize);
+		const int64_t regionZ = FloorDiv(chunkZ, VoxelRegionFile::sc_RegionSize);
+		const uint32_t localX = static_cast<uint32_t>(chunkX - regionX * VoxelRegionFile::sc_RegionSize);
+		const uint32_t localZ = static_cast<uint32_t>(chunkZ - regionZ * VoxelRegionFile::sc_RegionSize);
+
+		if (!getRegion(regionX, regionZ).Read(localX, localZ, compressed, size))
+		{
+			std::lock_guard lock(m_CacheMutex);
+			m_Statistics.Misses++;
+			return false;
+		}
+
+		voxels.resize(size);
+		if (!Utils::RLEDecompress(compressed.data(), compressed.size(), voxels.data(), voxels.size()))
+		{
+			XYZ_CORE_WARN("Corrupted chunk {} {}", chunkX, chunkZ);
+			return false;
+		}
+
+		std::lock_guard lock(m_CacheMutex);
+		m_Statistics.DiskReads++;
+		insertCache(key, std::move(compressed), size);
+		return true;
+	}
+
+	void VoxelChunkStore::Store(int64_t chunkX, int64_t chunkZ, const std::vector<uint8_t>& voxels)
+	{
+		XYZ_PROFILE_FUNC("VoxelChunkStore::Store");
+		std::vector<uint8_t> compressed;
+		Utils::RLECompress(voxels.data(), voxels.size(), compressed);
+
+		const int64_t regionX = FloorDiv(chunkX, VoxelRegionFile::sc_RegionSize);
+		const int64_t regionZ = FloorDiv(chunkZ, VoxelRegionFile::sc_RegionSize);
+		const uint32_t localX = static_cast<uint32_t>(chunkX - regionX * VoxelRegionFile::sc_RegionSize);
+		const uint32_t localZ = static_cast<uint32_t>(chunkZ - regionZ * VoxelRegionFile::sc_RegionSize);
+		getRegion(regionX, regionZ).Write(localX, localZ, compressed, static_cast<uint32_t>(voxels.size()));
+
+		std::lock_guard lock(m_CacheMutex);
+		m_Statistics.Writes++;
+		insertCache({ chunkX, chunkZ }, std::move(compressed), static_cast<uint32_t>(voxels.size()));
+	}
+
+	VoxelChunkStore::Statistics VoxelChunkStore::GetStatistics() const
+	{
+		std::lock_guard lock(m_CacheMutex);
+		Statistics result = m_Statistics;
+		result.CachedChunks = static_cast<uint32_t>(m_Cache.size());
+		return result;
+	}
+
+	VoxelRegionFile& VoxelChunkStore::getRegion(int64_t regionX, int64_t regionZ)
+	{
+		std::lock_guard lock(m_RegionsMutex);
+		auto& region = m_Regions[{ regionX, regionZ }];
+		if (!region)
+		{
+			const std::string fileName = "r." + std::to_string(regionX) + "." + std::to_string(regionZ) + ".xyzr";
+			region = std::make_unique<VoxelRegionFile>(m_Directory / fileName);
+		}
+		return *region;
+	}
+
+	void VoxelChunkStore::insertCache(const ChunkKey& key, std::vector<uint8_t>&& compressed, uint32_t size)
+	{
+		auto it = m_CacheLookup.find(key);
+		if (it != m_CacheLookup.end())
+		{
+			m_Statistics.CacheMemory -= it->second->Compressed.size();
+			m_Cache.erase(it->second);
+			m_CacheLookup.erase(it);
+		}
+
+		m_Statistics.CacheMemory += compressed.size();
+		m_Cache.push_front({ key, std::move(compressed), size });
+		m_CacheLookup[key] = m_Cache.begin();
+
+		while (m_Statistics.CacheMemory > m_CacheCapacity && m_Cache.size() > 1)
+		{
+			const CacheEntry& last = m_Cache.back();
+			m_Statistics.CacheMemory -= last.Compressed.size();
+			m_CacheLookup.erase(last.Key);
+			m_Cache.pop_back();
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "XYZ/Utils/MemoryMappedFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace XYZ {
+
+	// Compressed chunks of one region stored in single file.
+	// File starts with fixed size table of chunk offsets, chunk data are appended behind it and read through memory mapping
+	class VoxelRegionFile
+	{
+	public:
+		static constexpr uint32_t sc_RegionSize = 16; // Chunks per axis
+
+		VoxelRegionFile(const std::filesystem::path& path);
+
+		bool Read(uint32_t localX, uint32_t localZ, std::vector<uint8_t>& compressed, uint32_t& size);
+		void Write(uint32_t localX, uint32_t localZ, const std::vector<uint8_t>& compressed, uint32_t size);
+
+	private:
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t RegionSize;
+			uint32_t Padding;
+		};
+
+		struct Entry
+		{
+			uint64_t Offset = 0; // Zero if chunk is not stored
+			uint32_t CompressedSize = 0;
+			uint32_t Size = 0;
+		};
+
+		void create();
+
+	private:
+		std::filesystem::path m_Path;
+		std::fstream		  m_Stream;
+		MemoryMappedFile	  m_Mapping;
+		std::mutex			  m_Mutex;
+
+		std::array<Entry, sc_RegionSize * sc_RegionSize> m_Entries;
+	};
+
+	// Run length compressed chunk voxels stored in region files, recently used chunks are kept in LRU cache.
+	// All functions are thread safe
+	class VoxelChunkStore
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t CacheHits = 0;
+			uint32_t DiskReads = 0;
+			uint32_t Misses = 0;
+			uint32_t Writes = 0;
+			uint32_t CachedChunks = 0;
+			size_t	 CacheMemory = 0;
+		};
+
+	public:
+		VoxelChunkStore(const std::filesystem::path& directory, size_t cacheSizeMB);
+
+		// Tries cache first, then region file
+		bool Load(int64_t chunkX, int64_t chunkZ, std::vector<uint8_t>& voxels);
+		void Store(int64_t chunkX, int64_t chunkZ, const std::vector<uint8_t>& voxels);
+
+		Statistics GetStatistics() const;
+
+	private:
+		using ChunkKey = std::pair<int64_t, int64_t>;
+
+		struct CacheEntry
+		{
+			ChunkKey			 Key;
+			std::vector<uint8_t> Compressed;
+			uint32_t			 Size;
+		};
+
+		VoxelRegionFile& getRegion(int64_t regionX, int64_t regionZ);
+
+		void insertCache(const ChunkKey& key, std::vector<uint8_t>&& compressed, uint32_t size);
+
+	private:
+		std::filesystem::path m_Directory;
+
+		std::map<ChunkKey, std::unique_ptr<VoxelRegionFile>> m_Regions;
+		std::mutex											 m_RegionsMutex;
+
+		// Front is the most recently used chunk
+		std::list<CacheEntry>								m_Cache;
+		std::map<ChunkKey, std::list<CacheEntry>::iterator> m_CacheLookup;
+		size_t												m_CacheCapacity;
+		mutable std::mutex									m_CacheMutex;
+
+		Statistics m_Statistics;
+	};
+}
@@ -0,0 +1,162 @@
+#include "stdafx.h"
+#include "VoxelTerrainGenerator.h"
+
+#include "XYZ/Utils/Math/Perlin.h"
+#include "XYZ/Debug/Profiler.h"
+
+namespace XYZ {
+
+	static uint32_t Index3D(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint32_t height)
+	{
+		return x + width * (y + height * z);
+	}
+
+	VoxelTerrainGenerator::VoxelTerrainGenerator(uint32_t width, uint32_t height, uint32_t depth, uint32_t waterLevel)
+		:
+		m_Width(width),
+		m_Height(height),
+		m_Depth(depth),
+		m_WaterLevel(std::min(waterLevel, height)),
+		m_Heights(static_cast<size_t>(width) * depth, 0)
+	{
+	}
+
+	void VoxelTerrainGenerator::GenerateHeights(int64_t chunkX, int64_t chunkZ, float frequency, uint32_t octaves)
+	{
+		XYZ_PROFILE_FUNC("VoxelTerrainGenerator::GenerateHeights");
+		const double fx = static_cast<double>(frequency / m_Width);
+		const double fz = static_cast<double>(frequency / m_Depth);
+		const double startX = static_cast<double>(chunkX * m_Width);
+
+		std::vector<float> row(m_Width);
+		for (uint32_t z = 0; z < m_Depth; ++z)
+		{
+			const double zDouble = static_cast<double>(z) + chunkZ * m_Depth;
+			Perlin::Octave2DRow(row.data(), startX * fx, zDouble * fz, fx, m_Width, octaves);
+
+			uint32_t* heights = &m_Heights[z * m_Width];
+			for (uint32_t x = 0; x < m_Width; ++x)
+				heights[x] = std::min(static_cast<uint32_t>(row[x] * m_Height), m_Height);
+		}
+	}
+
+	void VoxelTerrainGenerator::FillGrid(std::vector<uint8_t>& voxels) const
+	{
+		XYZ_PROFILE_FUNC("VoxelTerrainGenerator::FillGrid");
+		voxels.resize(static_cast<size_t>(m_Width) * m_Height * m_Depth);
+		fillBox(voxels.data(), 0, 0, 0, m_Width, m_Height, m_Depth);
+	}
+
+	VoxelSubmesh VoxelTerrainGenerator::BuildSubmesh(uint32_t scale, float voxelSize) const
+	{
+		XYZ_PROFILE_FUNC("VoxelTerrainGenerator::BuildSubmesh");
+		XYZ_ASSERT(m_Width % scale == 0 && m_Height % scale == 0 && m_Depth % scale == 0, "Dimensions must be multiples of scale");
+
+		VoxelSubmesh result;
+		result.CompressScale = scale;
+		result.Width = m_Width / scale;
+		result.Height = m_Height / scale;
+		result.Depth = m_Depth / scale;
+		result.VoxelSize = voxelSize * scale;
+		result.Compressed = true;
+		result.CompressedCells.resize(result.Width * result.Height * result.Depth);
+
+		// Lowest and highest column of every cell footprint
+		std::vector<glm::uvec2> footprints(result.Width * result.Depth);
+		for (uint32_t cz = 0; cz < result.Depth; ++cz)
+		{
+			for (uint32_t cx = 0; cx < result.Width; ++cx)
+			{
+				glm::uvec2 range(m_Height, 0);
+				for (uint32_t z = cz * scale; z < (cz + 1) * scale; ++z)
+				{
+					const uint32_t* heights = &m_Heights[z * m_Width + cx * scale];
+					for (uint32_t x = 0; x < scale; ++x)
+					{
+						range.x = std::min(range.x, heights[x]);
+						range.y = std::max(range.y, heights[x]);
+					}
+				}
+				footprints[cz * result.Width + cx] = range;
+			}
+		}
+
+		const uint32_t cellVoxelCount = scale * scale * scale;
+		uint32_t voxelOffset = 0;
+		for (uint32_t cx = 0; cx < result.Width; ++cx)
+		{
+			for (uint32_t cy = 0; cy < result.Height; ++cy)
+			{
+				for (uint32_t cz = 0; cz < result.Depth; ++cz)
+				{
+					VoxelSubmesh::CompressedCell& cell = result.CompressedCells[Index3D(cx, cy, cz, result.Width, result.Height)];
+					const glm::uvec2 range = footprints[cz * result.Width + cx];
+					const uint32_t yStart = cy * scale;
+					const uint32_t yEnd = yStart + scale;
+
+					int32_t uniformColor = -1;
+					if (yEnd <= range.x)
+						uniformColor = sc_Grass;
+					else if (yStart >= range.y && yEnd <= m_WaterLevel)
+						uniformColor = sc_Water;
+					else if (yStart >= range.y && yStart >= m_WaterLevel)
+						uniformColor = sc_Air;
+
+					if (uniformColor != -1)
+					{
+						cell.VoxelCount = 1;
+						result.ColorIndices.push_back(static_cast<uint8_t>(uniformColor));
+					}
+					else
+					{
+						const size_t offset = result.ColorIndices.size();
+						cell.VoxelCount = cellVoxelCount;
+						result.ColorIndices.resize(offset + cellVoxelCount);
+						fillBox(&result.ColorIndices[offset], cx * scale, yStart, cz * scale, scale, scale, scale);
+					}
+					cell.VoxelOffset = voxelOffset;
+					voxelOffset += cell.VoxelCount;
+				}
+			}
+		}
+		return result;
+	}
+
+	void VoxelTerrainGenerator::fillBox(uint8_t* destination, uint32_t x, uint32_t y, uint32_t z, uint32_t sizeX, uint32_t sizeY, uint32_t sizeZ) const
+	{
+		const uint32_t yEnd = y + sizeY;
+		const uint32_t waterEnd = std::max(std::min(m_WaterLevel, yEnd), y);
+		for (uint32_t localZ = 0; localZ < sizeZ; ++localZ)
+		{
+			const uint32_t* heights = &m_Heights[(z + localZ) * m_Width + x];
+			uint8_t* slice = destination + static_cast<size_t>(localZ) * sizeX * sizeY;
+
+			uint32_t minHeight = m_Height;
+			uint32_t maxHeight = 0;
+			for (uint32_t localX = 0; localX < sizeX; ++localX)
+			{
+				minHeight = std::min(minHeight, heights[localX]);
+				maxHeight = std::max(maxHeight, heights[localX]);
+			}
+			const uint32_t grassEnd = std::max(std::min(minHeight, yEnd), y);
+			const uint32_t surfaceEnd = std::max(std::min(maxHeight, yEnd), grassEnd);
+
+			// Rows below lowest column are grass
+			memset(slice, sc_Grass, static_cast<size_t>(grassEnd - y) * sizeX);
+
+			// Rows crossing terrain surface are selected per voxel
+			for (uint32_t rowY = grassEnd; rowY < surfaceEnd; ++rowY)
+			{
+				uint8_t* row = slice + static_cast<size_t>(rowY - y) * sizeX;
+				const uint8_t above = rowY < m_WaterLevel ? sc_Water : sc_Air;
+				for (uint32_t localX = 0; localX < sizeX; ++localX)
+					row[localX] = rowY < heights[localX] ? sc_Grass : above;
+			}
+
+			// Rows above highest column are water up to water level, air above it
+			const uint32_t airStart = std::max(surfaceEnd, waterEnd);
+			memset(slice + static_cast<size_t>(surfaceEnd - y) * sizeX, sc_Water, static_cast<size_t>(airStart - surfaceEnd) * sizeX);
+			memset(slice + static_cast<size_t>(airStart - y) * sizeX, sc_Air, static_cast<size_t>(yEnd - airStart) * sizeX);
+		}
+	}
+}
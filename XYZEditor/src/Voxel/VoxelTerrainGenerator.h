@@ -0,0 +1,42 @@
+#pragma once
+#include "XYZ/Asset/Renderer/VoxelMeshSource.h"
+
+namespace XYZ {
+
+	// Terrain of one chunk described by height of every column. Voxels below column height are grass,
+	// empty voxels below water level are water. Grid and compressed submesh are filled from columns directly
+	class VoxelTerrainGenerator
+	{
+	public:
+		static constexpr uint8_t sc_Air = 0;
+		static constexpr uint8_t sc_Grass = 1;
+		static constexpr uint8_t sc_Water = 2;
+
+	public:
+		VoxelTerrainGenerator(uint32_t width, uint32_t height, uint32_t depth, uint32_t waterLevel);
+
+		// Noise is evaluated for whole rows along x axis
+		void GenerateHeights(int64_t chunkX, int64_t chunkZ, float frequency, uint32_t octaves);
+
+		void FillGrid(std::vector<uint8_t>& voxels) const;
+
+		// Same result as VoxelSubmesh::Compress of the grid, uniform cells are found from column heights
+		// and only non uniform cells are filled. Dimensions must be multiples of scale
+		VoxelSubmesh BuildSubmesh(uint32_t scale, float voxelSize) const;
+
+		uint32_t GetColumnHeight(uint32_t x, uint32_t z) const { return m_Heights[z * m_Width + x]; }
+
+	private:
+		// Fills box of size dimensions starting at x, y, z to dense destination with Index3D layout.
+		// Rows of every z slice below and above terrain are filled with single memset
+		void fillBox(uint8_t* destination, uint32_t x, uint32_t y, uint32_t z, uint32_t sizeX, uint32_t sizeY, uint32_t sizeZ) const;
+
+	private:
+		uint32_t m_Width;
+		uint32_t m_Height;
+		uint32_t m_Depth;
+		uint32_t m_WaterLevel;
+
+		std::vector<uint32_t> m_Heights; // Rows along x axis
+	};
+}
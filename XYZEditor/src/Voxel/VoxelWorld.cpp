@@ -1,8 +1,11 @@
 #include "stdafx.h"
 #include "VoxelWorld.h"
+#include "VoxelTerrainGenerator.h"
 
 #include "XYZ/Utils/Math/Perlin.h"
 
+#include <numeric>
+
 namespace XYZ {
 
 	static uint32_t Index3D(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint32_t height)
@@ -60,11 +63,13 @@ namespace XYZ {
 		return true;
 	}
 
-	ThreadQueue<std::vector<uint8_t>> VoxelWorld::DataPool;
+	ThreadQueue<std::vector<uint8_t>, ThreadQueueLockFreePolicy<64>> VoxelWorld::DataPool;
 
-	VoxelWorld::VoxelWorld(const std::filesystem::path& worldPath, uint32_t seed)
+	VoxelWorld::VoxelWorld(const std::filesystem::path& worldPath, uint32_t seed, ThreadPool* pool)
 		:
+		m_Pool(pool ? pool : &Application::Get().GetThreadPool()),
 		m_WorldPath(worldPath),
+		m_ChunkStore(worldPath / "Regions", sc_ChunkCacheSizeMB),
 		m_Seed(seed)
 	{
 		VoxelBiom& forestBiom = m_Bioms["Forest"];
@@ -73,180 +78,358 @@ namespace XYZ {
 		forestBiom.ColorPallete[2] = { 1, 30, 230, 50}; // Water
 		forestBiom.Octaves = 3;
 		forestBiom.Frequency = 1.0f;
-		m_ActiveChunks = std::make_unique<ActiveChunkStorage>();
+		m_ActiveChunks.assign(m_ChunksPerAxis, std::vector<VoxelChunk>(m_ChunksPerAxis));
+		m_Requests.assign(m_ChunksPerAxis, std::vector<std::shared_ptr<ChunkRequest>>(m_ChunksPerAxis));
 
 		Perlin::SetSeed(seed);
-		generateChunks(0, 0);
+		requestChunks(0, 0);
+	}
+	VoxelWorld::~VoxelWorld()
+	{
+		// Jobs reference world, queued requests are dropped and chunks being generated are finished
+		{
+			std::scoped_lock lock(m_QueueMutex);
+			for (auto& request : m_Queue)
+				cancelRequest(*request);
+			m_Queue.clear();
+		}
+		if (!m_JobGroup.IsDone())
+			m_Pool->Wait(m_JobGroup);
 	}
 	void VoxelWorld::Update(const glm::vec3& position)
 	{
 		constexpr uint32_t halfDimensionX = sc_ChunkDimensions.x / 2;
 		constexpr uint32_t halfDimensionZ = sc_ChunkDimensions.z / 2;
 
-
 		ProcessGenerated();
 
-
 		const int64_t centerChunkX = static_cast<int64_t>(std::floor((position.x + halfDimensionX) / sc_ChunkDimensions.x));
 		const int64_t centerChunkZ = static_cast<int64_t>(std::floor((position.z + halfDimensionZ) / sc_ChunkDimensions.z));
-		
-		const int64_t shiftDirX = m_LastCenterChunkX - centerChunkX;
-		const int64_t shiftDirZ = m_LastCenterChunkZ - centerChunkZ;
-		if (shiftDirX == 0 && shiftDirZ == 0)
+		if (centerChunkX == m_LastCenterChunkX && centerChunkZ == m_LastCenterChunkZ)
 			return;
 
-		
-		if (shiftDirX != 0 || shiftDirZ != 0)
-			m_ActiveChunks = std::move(shiftChunks(shiftDirX, shiftDirZ));
-
-		m_ChunksGenerated.clear();
-		generateChunks(centerChunkX, centerChunkZ);
+		requestChunks(centerChunkX, centerChunkZ);
 		m_LastCenterChunkX = centerChunkX;
 		m_LastCenterChunkZ = centerChunkZ;
 	}
 	void VoxelWorld::ProcessGenerated()
 	{
-		for (auto it = m_ChunksGenerated.begin(); it != m_ChunksGenerated.end(); )
+		for (int64_t slotX = 0; slotX < m_ChunksPerAxis; ++slotX)
 		{
-			std::shared_ptr<GeneratedChunk> chunk = (*it);
-			if (chunk->Finished)
+			for (int64_t slotZ = 0; slotZ < m_ChunksPerAxis; ++slotZ)
 			{
-				(*m_ActiveChunks)[chunk->IndexX][chunk->IndexZ] = std::move(chunk->Chunk);
-				it = m_ChunksGenerated.erase(it);
+				std::shared_ptr<ChunkRequest>& request = m_Requests[slotX][slotZ];
+				if (!request || request->Status.load(std::memory_order_acquire) != ChunkRequest::Ready)
+					continue;
+
+				m_LatencySamples[m_LatencySampleCount++ % sc_LatencySamples] = request->Latency.Elapsed();
+				m_Statistics.ReadyChunks++;
+
+				m_ActiveChunks[slotX][slotZ] = std::move(request->Chunk);
+				request.reset();
 			}
-			else
+		}
+	}
+	void VoxelWorld::WaitForChunks()
+	{
+		if (!m_JobGroup.IsDone())
+			m_Pool->Wait(m_JobGroup);
+		ProcessGenerated();
+	}
+	void VoxelWorld::SetVoxelQueries(bool enabled)
+	{
+		if (enabled == m_VoxelQueries.load(std::memory_order_relaxed))
+			return;
+
+		m_VoxelQueries.store(enabled, std::memory_order_relaxed);
+		if (!enabled)
+		{
+			for (auto& chunkRow : m_ActiveChunks)
 			{
-				it++;
+				for (auto& chunk : chunkRow)
+					chunk.Voxels = SparseVoxelDAG();
 			}
+			return;
+		}
+
+		// Active and pending chunks have no voxels, all of them are generated again
+		ProcessGenerated();
+		cancelRequests();
+		for (auto& chunkRow : m_ActiveChunks)
+		{
+			for (auto& chunk : chunkRow)
+				chunk = VoxelChunk();
 		}
+		requestChunks(m_LastCenterChunkX, m_LastCenterChunkZ);
 	}
-	void VoxelWorld::generateChunks(int64_t centerChunkX, int64_t centerChunkZ)
+	bool VoxelWorld::Raycast(const Ray& ray, VoxelWorldHit& hit, float maxDistance) const
 	{
-		const int64_t chunksWidth = sc_MaxVisibleChunksPerAxis;
+		bool result = false;
+		for (const auto& chunkRow : m_ActiveChunks)
+		{
+			for (const auto& chunk : chunkRow)
+			{
+				if (chunk.Voxels.GetWidth() == 0)
+					continue;
 
-		const int64_t chunkMinCoordX = centerChunkX - sc_ChunkViewDistance;
-		const int64_t chunkMaxCoordX = centerChunkX + sc_ChunkViewDistance;
+				// Chunk voxel space, closest hit so far limits the distance
+				const Ray chunkRay((ray.Origin - chunkOrigin(chunk.X, chunk.Z)) / sc_ChunkVoxelSize, ray.Direction);
+				SparseVoxelDAGHit chunkHit;
+				if (!chunk.Voxels.Raycast(chunkRay, chunkHit, maxDistance / sc_ChunkVoxelSize))
+					continue;
 
-		const int64_t chunkMinCoordZ = centerChunkZ - sc_ChunkViewDistance;
-		const int64_t chunkMaxCoordZ = centerChunkZ + sc_ChunkViewDistance;
-	
-		auto& pool = Application::Get().GetThreadPool();
-		VoxelBiom& forestBiom = m_Bioms["Forest"];
-		for (int64_t chunkX = 0; chunkX < chunksWidth; chunkX++)
+				const float distance = chunkHit.Distance * sc_ChunkVoxelSize;
+				if (distance > maxDistance)
+					continue;
+
+				hit = { chunk.X, chunk.Z, chunkHit.Voxel, chunkHit.ColorIndex, distance };
+				maxDistance = distance;
+				result = true;
+			}
+		}
+		return result;
+	}
+	void VoxelWorld::StoreChunk(int64_t chunkX, int64_t chunkZ, const std::vector<uint8_t>& voxels)
+	{
+		XYZ_ASSERT(voxels.size() == static_cast<size_t>(sc_ChunkDimensions.x) * sc_ChunkDimensions.y * sc_ChunkDimensions.z, "Invalid chunk voxels");
+		m_ChunkStore.Store(chunkX, chunkZ, voxels);
+	}
+	void VoxelWorld::SetViewDistance(uint32_t viewDistance)
+	{
+		viewDistance = std::clamp(viewDistance, 1u, sc_MaxChunkViewDistance);
+		if (viewDistance == m_ViewDistance)
+			return;
+
+		// Slots depend on chunks per axis, pending requests are requested again for new slots
+		ProcessGenerated();
+		cancelRequests();
+
+		ActiveChunkStorage oldChunks = std::move(m_ActiveChunks);
+		m_ViewDistance = viewDistance;
+		m_ChunksPerAxis = viewDistance * 2 + 1;
+		m_ActiveChunks.assign(m_ChunksPerAxis, std::vector<VoxelChunk>(m_ChunksPerAxis));
+		m_Requests.assign(m_ChunksPerAxis, std::vector<std::shared_ptr<ChunkRequest>>(m_ChunksPerAxis));
+		for (auto& chunkRow : oldChunks)
 		{
-			for (int64_t chunkZ = 0; chunkZ < chunksWidth; chunkZ++)
+			for (auto& chunk : chunkRow)
 			{
-				const int64_t worldChunkX = chunkX + centerChunkX - sc_ChunkViewDistance;
-				const int64_t worldChunkZ = chunkZ + centerChunkZ - sc_ChunkViewDistance;
+				const bool inWindow = std::abs(chunk.X - m_LastCenterChunkX) <= viewDistance
+								   && std::abs(chunk.Z - m_LastCenterChunkZ) <= viewDistance;
+				if (chunk.Mesh.Raw() && inWindow)
+					m_ActiveChunks[toSlot(chunk.X)][toSlot(chunk.Z)] = std::move(chunk);
+			}
+		}
+		requestChunks(m_LastCenterChunkX, m_LastCenterChunkZ);
+	}
+	VoxelWorld::Statistics VoxelWorld::GetStatistics() const
+	{
+		Statistics result = m_Statistics;
+		for (const auto& requestRow : m_Requests)
+		{
+			for (const auto& request : requestRow)
+				result.PendingChunks += request ? 1 : 0;
+		}
 
-				if (!(*m_ActiveChunks)[chunkX][chunkZ].Mesh.Raw()) // Chunk was shifted away
+		const uint32_t sampleCount = std::min(m_LatencySampleCount, sc_LatencySamples);
+		if (sampleCount != 0)
+		{
+			std::array<float, sc_LatencySamples> samples = m_LatencySamples;
+			const auto samplesEnd = samples.begin() + sampleCount;
+			const auto p99 = samples.begin() + (sampleCount * 99) / 100;
+			std::nth_element(samples.begin(), p99, samplesEnd);
+			result.P99LatencyMs = *p99;
+			result.AverageLatencyMs = std::accumulate(samples.begin(), samplesEnd, 0.0f) / sampleCount;
+		}
+		for (const auto& chunkRow : m_ActiveChunks)
+		{
+			for (const auto& chunk : chunkRow)
+			{
+				if (chunk.Voxels.GetWidth() == 0)
+					continue;
+				result.QueryVoxelMemory += chunk.Voxels.GetMemoryUsed();
+				result.DenseVoxelMemory += chunk.Voxels.GetGridMemory();
+			}
+		}
+		return result;
+	}
+	void VoxelWorld::requestChunks(int64_t centerChunkX, int64_t centerChunkZ)
+	{
+		const int64_t chunkMinCoordX = centerChunkX - m_ViewDistance;
+		const int64_t chunkMinCoordZ = centerChunkZ - m_ViewDistance;
+		const int64_t minSlotX = toSlot(chunkMinCoordX);
+		const int64_t minSlotZ = toSlot(chunkMinCoordZ);
+
+		std::vector<std::shared_ptr<ChunkRequest>> newRequests;
+		for (int64_t slotX = 0; slotX < m_ChunksPerAxis; ++slotX)
+		{
+			for (int64_t slotZ = 0; slotZ < m_ChunksPerAxis; ++slotZ)
+			{
+				// Only one chunk in window maps to the slot
+				const int64_t chunkX = chunkMinCoordX + (slotX - minSlotX + m_ChunksPerAxis) % m_ChunksPerAxis;
+				const int64_t chunkZ = chunkMinCoordZ + (slotZ - minSlotZ + m_ChunksPerAxis) % m_ChunksPerAxis;
+
+				VoxelChunk& chunk = m_ActiveChunks[slotX][slotZ];
+				if (chunk.Mesh.Raw())
 				{
-					m_ChunksGenerated.push_back(std::make_shared<GeneratedChunk>());
-					std::shared_ptr<GeneratedChunk> gen = m_ChunksGenerated.back();
-					gen->IndexX = chunkX;
-					gen->IndexZ = chunkZ;
-					pool.PushJob([this, gen, worldChunkX, worldChunkZ, &forestBiom]() {
-						gen->Chunk = generateChunk(worldChunkX, worldChunkZ, forestBiom);
-						gen->Finished = true;
-					});
+					if (chunk.X == chunkX && chunk.Z == chunkZ)
+						continue;
+					chunk = VoxelChunk(); // Chunk left the window
 				}
+
+				std::shared_ptr<ChunkRequest>& request = m_Requests[slotX][slotZ];
+				if (request && (request->X != chunkX || request->Z != chunkZ))
+				{
+					cancelRequest(*request);
+					request.reset();
+					m_Statistics.CancelledChunks++;
+				}
+				if (!request)
+				{
+					request = std::make_shared<ChunkRequest>();
+					request->X = chunkX;
+					request->Z = chunkZ;
+					newRequests.push_back(request);
+				}
+			}
+		}
+		m_Statistics.RequestedChunks += static_cast<uint32_t>(newRequests.size());
+
+		{
+			std::scoped_lock lock(m_QueueMutex);
+			m_Queue.erase(std::remove_if(m_Queue.begin(), m_Queue.end(), [](const auto& request) {
+				return request->Status.load(std::memory_order_relaxed) == ChunkRequest::Cancelled;
+			}), m_Queue.end());
+
+			m_Queue.insert(m_Queue.end(), newRequests.begin(), newRequests.end());
+			for (auto& request : m_Queue)
+			{
+				const int64_t distanceX = request->X - centerChunkX;
+				const int64_t distanceZ = request->Z - centerChunkZ;
+				request->Priority = distanceX * distanceX + distanceZ * distanceZ;
 			}
+			std::sort(m_Queue.begin(), m_Queue.end(), [](const auto& a, const auto& b) {
+				return a->Priority > b->Priority;
+			});
+		}
+
+		// Every job generates nearest queued chunk at the time it runs, not the one it was pushed for
+		const VoxelBiom& forestBiom = m_Bioms["Forest"];
+		for (size_t i = 0; i < newRequests.size(); ++i)
+		{
+			m_Pool->PushJob(m_JobGroup, [this, &forestBiom]() {
+				generateNextChunk(forestBiom);
+			});
 		}
 	}
-	std::unique_ptr<VoxelWorld::ActiveChunkStorage> VoxelWorld::shiftChunks(int64_t dirX, int64_t dirZ)
+	void VoxelWorld::generateNextChunk(const VoxelBiom& biom)
 	{
-		std::unique_ptr<ActiveChunkStorage> shiftedChunks = std::make_unique<ActiveChunkStorage>();
-		if (dirX > sc_ChunkViewDistance || dirZ > sc_ChunkViewDistance)
-			return shiftedChunks;
-
-		const int64_t chunksWidth = sc_MaxVisibleChunksPerAxis;
-		for (int64_t chunkX = 0; chunkX < chunksWidth; chunkX++)
+		std::shared_ptr<ChunkRequest> request;
 		{
-			const int64_t shiftedChunkX = chunkX + dirX;
-			if (shiftedChunkX >= sc_MaxVisibleChunksPerAxis || shiftedChunkX < 0)
-				continue;
+			std::scoped_lock lock(m_QueueMutex);
+			while (!m_Queue.empty() && !request)
+			{
+				request = std::move(m_Queue.back());
+				m_Queue.pop_back();
+
+				uint32_t expected = ChunkRequest::Queued;
+				if (!request->Status.compare_exchange_strong(expected, ChunkRequest::Generating))
+					request.reset();
+			}
+		}
+		if (!request)
+			return;
+
+		request->Chunk = generateChunk(request->X, request->Z, biom, *request);
 
-			for (int64_t chunkZ = 0; chunkZ < chunksWidth; chunkZ++)
+		// Result of cancelled request is released with the request
+		uint32_t expected = ChunkRequest::Generating;
+		request->Status.compare_exchange_strong(expected, ChunkRequest::Ready, std::memory_order_release);
+	}
+	void VoxelWorld::cancelRequests()
+	{
+		for (auto& requestRow : m_Requests)
+		{
+			for (auto& request : requestRow)
 			{
-				const int64_t shiftedChunkZ = chunkZ + dirZ;
-				if (shiftedChunkZ >= sc_MaxVisibleChunksPerAxis || shiftedChunkZ < 0)
+				if (!request)
 					continue;
 
-				(*shiftedChunks)[shiftedChunkX][shiftedChunkZ] = std::move((*m_ActiveChunks)[chunkX][chunkZ]);
+				cancelRequest(*request);
+				request.reset();
+				m_Statistics.CancelledChunks++;
 			}
 		}
-		return shiftedChunks;
 	}
-	VoxelChunk VoxelWorld::generateChunk(int64_t chunkX, int64_t chunkZ, const VoxelBiom& biom)
+	void VoxelWorld::cancelRequest(ChunkRequest& request)
+	{
+		// Ready requests are left as they are, their chunk is released with the request
+		uint32_t status = request.Status.load(std::memory_order_relaxed);
+		while (status == ChunkRequest::Queued || status == ChunkRequest::Generating)
+		{
+			if (request.Status.compare_exchange_weak(status, ChunkRequest::Cancelled))
+				return;
+		}
+	}
+	uint32_t VoxelWorld::toSlot(int64_t chunk) const
+	{
+		const int64_t slot = chunk % m_ChunksPerAxis;
+		return static_cast<uint32_t>(slot < 0 ? slot + m_ChunksPerAxis : slot);
+	}
+	glm::vec3 VoxelWorld::chunkOrigin(int64_t chunkX, int64_t chunkZ)
+	{
+		// Chunks are centered around their coordinates
+		return glm::vec3(
+			(chunkX * sc_ChunkDimensions.x - sc_ChunkDimensions.x / 2.0f) * sc_ChunkVoxelSize,
+			-sc_ChunkDimensions.y / 2.0f * sc_ChunkVoxelSize,
+			(chunkZ * sc_ChunkDimensions.z - sc_ChunkDimensions.z / 2.0f) * sc_ChunkVoxelSize
+		);
+	}
+	VoxelChunk VoxelWorld::generateChunk(int64_t chunkX, int64_t chunkZ, const VoxelBiom& biom, const ChunkRequest& request)
 	{
 		VoxelChunk chunk;		
 		chunk.X = chunkX;
 		chunk.Z = chunkZ;
 
-		chunk.Mesh = Ref<VoxelProceduralMesh>::Create();
-		chunk.Mesh->SetColorPallete(biom.ColorPallete);
-
-		VoxelSubmesh submesh;
-		submesh.Width = sc_ChunkDimensions.x;
-		submesh.Height = sc_ChunkDimensions.y;
-		submesh.Depth = sc_ChunkDimensions.z;
-		submesh.VoxelSize = sc_ChunkVoxelSize;
+		const uint32_t width = sc_ChunkDimensions.x;
+		const uint32_t height = sc_ChunkDimensions.y;
+		const uint32_t depth = sc_ChunkDimensions.z;
 		
-		const glm::vec3 centerTranslation = -glm::vec3(
-			submesh.Width / 2.0f * submesh.VoxelSize,
-			submesh.Height / 2.0f * submesh.VoxelSize,
-			submesh.Depth / 2.0f * submesh.VoxelSize
-		);
+		// Reuse grid storage of previously generated chunks
+		std::vector<uint8_t> voxels;
+		DataPool.TryPop(voxels);
 
-		const glm::vec3 translation = glm::vec3(
-			chunk.X * sc_ChunkDimensions.x * sc_ChunkVoxelSize, 
-			0.0f, 
-			chunk.Z * sc_ChunkDimensions.z * sc_ChunkVoxelSize
-		);
-
-		VoxelInstance instance;
-		instance.SubmeshIndex = 0;
-		instance.Transform = glm::translate(glm::mat4(1.0f), translation + centerTranslation);
+		// Edited chunks are loaded from cache or disk, others are generated again from seed
+		const size_t voxelCount = static_cast<size_t>(width) * height * depth;
+		const bool loaded = m_ChunkStore.Load(chunkX, chunkZ, voxels) && voxels.size() == voxelCount;
 
-		const double fx = static_cast<double>(biom.Frequency / submesh.Width);
-		const double fz = static_cast<double>(biom.Frequency / submesh.Depth);
-
-		
-		if (!DataPool.Empty())
-			submesh.ColorIndices = DataPool.PopBack();
+		VoxelTerrainGenerator terrain(width, height, depth, sc_WaterLevel);
+		if (!loaded)
+			terrain.GenerateHeights(chunkX, chunkZ, biom.Frequency, biom.Octaves);
 
-		submesh.ColorIndices.resize(submesh.Width * submesh.Height * submesh.Depth, 0);
-		for (uint32_t x = 0; x < submesh.Width; ++x)
+		if (request.Status.load(std::memory_order_relaxed) != ChunkRequest::Cancelled)
 		{
-			for (uint32_t z = 0; z < submesh.Depth; ++z)
-			{
-				const double xDouble = static_cast<double>(x) + chunk.X * sc_ChunkDimensions.x;
-				const double zDouble = static_cast<double>(z) + chunk.Z * sc_ChunkDimensions.z;
-				const double val = Perlin::Octave2D(xDouble * fx, zDouble * fz, biom.Octaves);
-				const uint32_t genHeight = val * submesh.Height;
-
-				for (uint32_t y = 0; y < genHeight; y++)
-				{
-					const uint32_t index = Index3D(x, y, z, submesh.Width, submesh.Height);
-					submesh.ColorIndices[index] = 1; // Grass
-				}
+			VoxelInstance instance;
+			instance.SubmeshIndex = 0;
+			instance.Transform = glm::translate(glm::mat4(1.0f), chunkOrigin(chunk.X, chunk.Z));
+
+			chunk.Mesh = Ref<VoxelProceduralMesh>::Create();
+			chunk.Mesh->SetColorPallete(biom.ColorPallete);
+			// Generated chunk is compressed from its columns, loaded chunk from the grid
+			if (loaded)
+				chunk.Mesh->SetSubmeshes({ VoxelSubmesh::Compress(sc_ChunkCompressScale, width, height, depth, sc_ChunkVoxelSize, voxels) });
+			else
+				chunk.Mesh->SetSubmeshes({ terrain.BuildSubmesh(sc_ChunkCompressScale, sc_ChunkVoxelSize) });
+			chunk.Mesh->SetInstances({ instance });
 
-				for (uint32_t y = genHeight; y < 70; y++)
-				{
-					const uint32_t index = Index3D(x, y, z, submesh.Width, submesh.Height);
-					submesh.ColorIndices[index] = 2; // Water
-				}
+			if (m_VoxelQueries.load(std::memory_order_relaxed))
+			{
+				if (!loaded)
+					terrain.FillGrid(voxels);
+				chunk.Voxels = SparseVoxelDAG::FromGrid(voxels, width, height, depth);
 			}
 		}
-		submesh.Compress(16);
-		chunk.Mesh->SetSubmeshes({ submesh });
-		chunk.Mesh->SetInstances({ instance });
 
+		DataPool.TryPush(std::move(voxels)); // Storage is released if pool is full
 		return chunk;
-	}	
-	VoxelChunk::~VoxelChunk()
-	{
-		if (!ColorIndices.empty())
-			VoxelWorld::DataPool.EmplaceBack(std::move(ColorIndices));
 	}
 }
@@ -1,8 +1,14 @@
 #pragma once
 #include "XYZ/Utils/Math/Ray.h"
 #include "XYZ/Utils/DataStructures/Octree.h"
+#include "XYZ/Utils/DataStructures/SparseVoxelDAG.h"
 #include "XYZ/Renderer/VoxelMesh.h"
 #include "XYZ/Utils/DataStructures/ThreadQueue.h"
+#include "XYZ/Core/Job.h"
+#include "XYZ/Core/ThreadPool.h"
+#include "XYZ/Debug/Timer.h"
+
+#include "VoxelChunkStore.h"
 
 #include <glm/glm.hpp>
 
@@ -11,13 +17,20 @@ namespace XYZ{
 
 	struct VoxelChunk
 	{
-		~VoxelChunk();
-
 		int64_t X = 0;
 		int64_t Z = 0;
 
 		Ref<VoxelProceduralMesh> Mesh;
-		std::vector<uint8_t>	 ColorIndices;
+		SparseVoxelDAG			 Voxels; // CPU copy for queries, built only with voxel queries enabled
+	};
+
+	struct VoxelWorldHit
+	{
+		int64_t	   ChunkX = 0;
+		int64_t	   ChunkZ = 0;
+		glm::uvec3 Voxel; // Voxel of chunk
+		uint8_t	   ColorIndex = 0;
+		float	   Distance = 0.0f;
 	};
 
 	struct VoxelBiom
@@ -27,57 +40,122 @@ namespace XYZ{
 		std::array<VoxelColor, 256> ColorPallete;
 	};
 
+	// Chunks in view window are kept in toroidal grid, chunk with world coordinates x, z lives in slot (x mod N, z mod N).
+	// Missing chunks are requested from worker jobs, nearest requests to the center are generated first.
+	// Requests of chunks that left the window are cancelled
 	class VoxelWorld
 	{
 	public:
 		static constexpr glm::ivec3 sc_ChunkDimensions = glm::ivec3(64, 128, 64);
-		static constexpr uint32_t	sc_ChunkViewDistance = 3; // View distance from center
-		static constexpr int64_t    sc_MaxVisibleChunksPerAxis = sc_ChunkViewDistance * 2 + 1;
+		static constexpr uint32_t	sc_DefaultChunkViewDistance = 3; // View distance from center
+		static constexpr uint32_t	sc_MaxChunkViewDistance = 16;
 		static constexpr float      sc_ChunkVoxelSize = 1.0f;
-		static ThreadQueue<std::vector<uint8_t>> DataPool;
+		static constexpr size_t		sc_ChunkCacheSizeMB = 64;
+		static constexpr uint32_t	sc_LatencySamples = 256;
+		static constexpr uint32_t	sc_ChunkCompressScale = 16;
+		static constexpr uint32_t	sc_WaterLevel = 70;
+
+		static_assert(sc_ChunkDimensions.x % sc_ChunkCompressScale == 0
+				   && sc_ChunkDimensions.y % sc_ChunkCompressScale == 0
+				   && sc_ChunkDimensions.z % sc_ChunkCompressScale == 0, "Chunk is compressed from columns to whole cells");
 
-		using ActiveChunkStorage = array_grid2D<sc_MaxVisibleChunksPerAxis, VoxelChunk>;
+		// Voxel grids used during generation, reused between chunks
+		static ThreadQueue<std::vector<uint8_t>, ThreadQueueLockFreePolicy<64>> DataPool;
+
+		// Indexed [slotX][slotZ], chunks per axis are ViewDistance * 2 + 1
+		using ActiveChunkStorage = std::vector<std::vector<VoxelChunk>>;
+
+		struct Statistics
+		{
+			uint32_t RequestedChunks = 0;
+			uint32_t ReadyChunks = 0;
+			uint32_t CancelledChunks = 0;
+			uint32_t PendingChunks = 0;
+			float	 AverageLatencyMs = 0.0f; // From request to chunk being ready, over last sc_LatencySamples chunks
+			float	 P99LatencyMs = 0.0f;
+			size_t	 QueryVoxelMemory = 0; // Voxel DAGs of active chunks
+			size_t	 DenseVoxelMemory = 0; // Same chunks stored as dense grids
+		};
 	public:
-		VoxelWorld(const std::filesystem::path& worldPath, uint32_t seed);
-		
+		// Chunks are generated on pool, application thread pool is used if it is not set
+		VoxelWorld(const std::filesystem::path& worldPath, uint32_t seed, ThreadPool* pool = nullptr);
+		~VoxelWorld();
+
 		void Update(const glm::vec3& position);
 		void ProcessGenerated();
 
-		const std::unique_ptr<ActiveChunkStorage>& GetActiveChunks() const { return m_ActiveChunks; }
-	private:
-		void generateChunks(int64_t centerChunkX, int64_t centerChunkZ);
+		// Waits until all requested chunks are generated and moves them to active chunks
+		void WaitForChunks();
 
-		std::unique_ptr<ActiveChunkStorage> shiftChunks(int64_t dirX, int64_t dirZ);
+		// Active chunks still in new window are kept, pending requests are cancelled and requested again
+		void SetViewDistance(uint32_t viewDistance);
 
-		VoxelChunk generateChunk(int64_t chunkX, int64_t chunkZ, const VoxelBiom& biom);
+		// Active chunks keep sparse voxel DAG for CPU queries. Changing it generates active chunks again
+		void SetVoxelQueries(bool enabled);
 
+		// Ray is in world space, only chunks with voxel queries are tested
+		bool Raycast(const Ray& ray, VoxelWorldHit& hit, float maxDistance = FLT_MAX) const;
 
+		// Stores edited voxels of chunk, they are loaded instead of generating the chunk again.
+		// Unedited chunks are not stored, generating them is faster than loading (VoxelWorldGeneration benchmark)
+		void StoreChunk(int64_t chunkX, int64_t chunkZ, const std::vector<uint8_t>& voxels);
+
+		uint32_t									GetViewDistance() const { return m_ViewDistance; }
+		bool										GetVoxelQueries() const { return m_VoxelQueries.load(std::memory_order_relaxed); }
+		const ActiveChunkStorage&					GetActiveChunks() const { return m_ActiveChunks; }
+		VoxelChunkStore::Statistics					GetChunkStoreStatistics() const { return m_ChunkStore.GetStatistics(); }
+		Statistics									GetStatistics() const;
 	private:
-		struct GeneratedChunk
+		struct ChunkRequest
 		{
-			int64_t IndexX;
-			int64_t IndexZ;
-			
-			VoxelChunk Chunk;
-			bool Finished = false;
+			enum State : uint32_t { Queued, Generating, Ready, Cancelled };
+
+			int64_t X;
+			int64_t Z;
+			int64_t Priority; // Squared distance to center in chunks, lower is generated first
+
+			std::atomic_uint32_t Status{ Queued };
+			VoxelChunk			 Chunk;
+			Stopwatch			 Latency;
 		};
 
+		void requestChunks(int64_t centerChunkX, int64_t centerChunkZ);
+		void generateNextChunk(const VoxelBiom& biom);
 
-	private:
-		std::unique_ptr<ActiveChunkStorage> m_ActiveChunks;
+		void			 cancelRequests();
+		static void		 cancelRequest(ChunkRequest& request);
+		uint32_t		 toSlot(int64_t chunk) const;
+		static glm::vec3 chunkOrigin(int64_t chunkX, int64_t chunkZ);
 
-		std::filesystem::path m_WorldPath;
+		VoxelChunk generateChunk(int64_t chunkX, int64_t chunkZ, const VoxelBiom& biom, const ChunkRequest& request);
 
-		std::unordered_map<std::string, VoxelBiom> m_Bioms;
+	private:
+		uint32_t		   m_ViewDistance = sc_DefaultChunkViewDistance;
+		int64_t			   m_ChunksPerAxis = sc_DefaultChunkViewDistance * 2 + 1;
+		ActiveChunkStorage m_ActiveChunks;
 
-		std::vector<std::shared_ptr<GeneratedChunk>> m_ChunksGenerated;
+		// Request of every slot which chunk is not ready yet, owned by main thread
+		std::vector<std::vector<std::shared_ptr<ChunkRequest>>> m_Requests;
 
+		// Queued requests sorted by priority, nearest at the back
+		std::mutex									 m_QueueMutex;
+		std::vector<std::shared_ptr<ChunkRequest>>	 m_Queue;
+		JobGroup									 m_JobGroup;
+		ThreadPool*									 m_Pool;
 
-		
+		std::filesystem::path m_WorldPath;
+		VoxelChunkStore		  m_ChunkStore;
+
+		std::unordered_map<std::string, VoxelBiom> m_Bioms;
 
 		uint32_t m_Seed;
+		std::atomic_bool m_VoxelQueries = false;
 		int64_t m_LastCenterChunkX = 0;
 		int64_t m_LastCenterChunkZ = 0;
+
+		Statistics m_Statistics;
+		std::array<float, sc_LatencySamples> m_LatencySamples;
+		uint32_t m_LatencySampleCount = 0;
 	};
 
 }
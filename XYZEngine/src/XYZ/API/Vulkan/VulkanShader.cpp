@@ -1,14 +1,16 @@
 #include "stdafx.h"
 #include "VulkanShader.h"
+#include "VulkanShaderCache.h"
 
 #include "XYZ/Renderer/Renderer.h"
 #include "XYZ/Renderer/Material.h"
 #include "XYZ/Renderer/Pipeline.h"
 #include "XYZ/Renderer/ShaderIncluder.h"
-#include "XYZ/Renderer/ShaderCIncluder.h"
 
 #include "XYZ/Utils/StringUtils.h"
 #include "XYZ/Utils/FileSystem.h"
+#include "XYZ/Core/Application.h"
+#include "XYZ/Debug/Profiler.h"
 
 
 #include "VulkanContext.h"
@@ -193,18 +195,6 @@ namespace XYZ {
 			return 0;
 		}
 
-		static const char* VkShaderStageCachedFileExtension(VkShaderStageFlagBits stage)
-		{
-			switch (stage)
-			{
-			case VK_SHADER_STAGE_VERTEX_BIT:    return ".cached_vulkan.vert";
-			case VK_SHADER_STAGE_FRAGMENT_BIT:  return ".cached_vulkan.frag";
-			case VK_SHADER_STAGE_COMPUTE_BIT:   return ".cached_vulkan.comp";
-			}
-			XYZ_ASSERT(false, "");
-			return "";
-		}
-
 		static shaderc_shader_kind VkShaderStageToShaderC(VkShaderStageFlagBits stage)
 		{
 			switch (stage)
@@ -290,25 +280,7 @@ namespace XYZ {
 			return result;
 		}
 
-		static const char* GetCacheDirectory()
-		{
-			// TODO: make sure the assets directory is valid
-			return "Resources/Cache/Shader/Vulkan";
-		}
-
-		static void CreateCacheDirectoryIfNeeded()
-		{
-			const std::string cacheDirectory = GetCacheDirectory();
-			if (!std::filesystem::exists(cacheDirectory))
-				std::filesystem::create_directories(cacheDirectory);
-		}	
-
-		static std::string GetCachePath(const std::string& name, VkShaderStageFlagBits stage)
-		{
-			std::string result = GetCacheDirectory();
-			result += "/" + name + VkShaderStageCachedFileExtension(stage);
-			return result;
-		}	
+		static constexpr const char* sc_InstancedKeyword = "XYZ_INSTANCED";
 	}
 
 
@@ -322,7 +294,7 @@ namespace XYZ {
 		m_SourceHash(sourceHash),
 		m_VertexBufferSize(0)
 	{
-		m_Parser.AddKeyword("XYZ_INSTANCED");
+		m_Parser.AddKeyword(Utils::sc_InstancedKeyword);
 		Reload(forceCompile);
 	}
 	VulkanShader::VulkanShader(const std::string& name, const std::string& path, size_t sourceHash, bool forceCompile)
@@ -333,7 +305,7 @@ namespace XYZ {
 		m_SourceHash(sourceHash),
 		m_VertexBufferSize(0)
 	{
-		m_Parser.AddKeyword("XYZ_INSTANCED");
+		m_Parser.AddKeyword(Utils::sc_InstancedKeyword);
 		Reload(forceCompile);
 	}
 	VulkanShader::VulkanShader(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath, size_t sourceHash, bool forceCompile)
@@ -352,7 +324,7 @@ namespace XYZ {
 
 		outfile.close();
 
-		m_Parser.AddKeyword("XYZ_INSTANCED");
+		m_Parser.AddKeyword(Utils::sc_InstancedKeyword);
 		Reload(forceCompile);
 	}
 	VulkanShader::~VulkanShader()
@@ -370,26 +342,11 @@ namespace XYZ {
 		m_Buffers.clear();
 		m_Specializations.clear();
 
-		Utils::CreateCacheDirectoryIfNeeded();
-
 		m_Source = FileSystem::ReadFile(m_FilePath);
 		PreprocessData preprocessData = preProcess(m_Source);
-					
-
-		const size_t newSourceHash = std::hash<std::string>{}(m_Source);
-		if (newSourceHash != m_SourceHash) // Source code has changed
-		{
-			forceCompile = true;
-			m_SourceHash = newSourceHash;
-		}
-		if (!forceCompile)
-		{
-			forceCompile = !binaryExists(preprocessData.Sources); // If binary does not exist recompile
-		}
-		if (forceCompile)
-		{
-			XYZ_CORE_INFO("Compiling shader {}", m_Name);
-		}
+		
+		// Cache is keyed by source content, changed source never uses old binary
+		m_SourceHash = std::hash<std::string>{}(m_Source);
 		m_ShaderData.clear();
 		if (compileOrGetVulkanBinaries(preprocessData.Sources, m_ShaderData, forceCompile))
 		{
@@ -432,6 +389,40 @@ namespace XYZ {
 		return m_Compiled;
 	}
 
+	void VulkanShader::Precompile(const std::vector<std::string>& paths)
+	{
+		XYZ_PROFILE_FUNC("VulkanShader::Precompile");
+		struct StageSource
+		{
+			const std::string*	  Path;
+			VkShaderStageFlagBits Stage;
+			std::string			  Source;
+		};
+
+		// Stage sources must match preProcess, otherwise cache keys differ
+		ShaderParser parser;
+		parser.AddKeyword(Utils::sc_InstancedKeyword);
+		std::vector<StageSource> stageSources;
+		for (const auto& path : paths)
+		{
+			for (auto& [type, source] : parser.ParseStages(FileSystem::ReadFile(path)))
+			{
+				parser.RemoveKeywordsFromSourceCode(source);
+				stageSources.push_back({ &path, Utils::ShaderStageFromString(type), std::move(source) });
+			}
+		}
+
+		const ShaderIncluder& includer = Renderer::GetDefaultResources().Includer;
+		Application::Get().GetThreadPool().ParallelFor(static_cast<uint32_t>(stageSources.size()), 1, [&](uint32_t index) {
+			const StageSource& stageSource = stageSources[index];
+			std::vector<uint32_t> binary;
+			VulkanShaderCache::GetOrCompile(*stageSource.Path, stageSource.Source, Utils::VkShaderStageToShaderC(stageSource.Stage), includer, binary);
+		});
+
+		const VulkanShaderCache::Statistics stats = VulkanShaderCache::GetStatistics();
+		XYZ_CORE_INFO("Shader cache: {} hits, {} misses, {} failed", stats.Hits, stats.Misses, stats.Failed);
+	}
+
 
 	void VulkanShader::reflectAllStages(const VulkanShader::StageMap<std::vector<uint32_t>>& shaderData, const PreprocessData& preprocessData)
 	{
@@ -753,66 +744,24 @@ namespace XYZ {
 
 	bool VulkanShader::compileOrGetVulkanBinaries(const StageMap<std::string>& sources, StageMap<std::vector<uint32_t>>& output, bool forceCompile)
 	{
-		std::filesystem::path cacheDirectory = Utils::GetCacheDirectory();
-		for (auto [stage, source] : sources)
-		{
-			std::filesystem::path shaderFilePath = m_FilePath;
-			std::filesystem::path cachedPath = cacheDirectory / (shaderFilePath.filename().string() + Utils::VkShaderStageCachedFileExtension(stage));
-
-			if (!forceCompile)
-			{
-				std::ifstream in(cachedPath, std::ios::in | std::ios::binary);
-				if (in.is_open())
-				{
-					in.seekg(0, std::ios::end);
-					auto size = in.tellg();
-					in.seekg(0, std::ios::beg);
-
-					auto& data = output[stage];
-					data.resize(size / sizeof(uint32_t));
-					in.read((char*)data.data(), size);
-					continue;
-				}
-			}
-			else
-			{
-				// Do we need to init a compiler for each stage?
-				shaderc::Compiler compiler;
-				shaderc::CompileOptions options;
+		XYZ_PROFILE_FUNC("VulkanShader::compileOrGetVulkanBinaries");
+		const ShaderIncluder& includer = Renderer::GetDefaultResources().Includer;
 
-				options.SetIncluder(ShaderCIncluder::Create(Renderer::GetDefaultResources().Includer));
-
-				options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
-				options.SetWarningsAsErrors();
-				options.SetGenerateDebugInfo();
-
-#ifdef XYZ_RELEASE
-				options.SetOptimizationLevel(shaderc_optimization_level_performance);
-#endif
-				// Compile shader
-				{
-					auto& shaderSource = sources.at(stage);
-					shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(shaderSource, Utils::VkShaderStageToShaderC(stage), m_FilePath.c_str(), options);
-
-					if (module.GetCompilationStatus() != shaderc_compilation_status_success)
-					{
-						XYZ_CORE_ERROR(module.GetErrorMessage());
-						return false;
-					}
-					output[stage] = std::vector<uint32_t>(module.cbegin(), module.cend());
-				}
-				// Cache compiled shader
-				std::ofstream out(cachedPath, std::ios::out | std::ios::binary);
-				if (out.is_open())
-				{
-					auto& data = output[stage];
-					out.write((char*)data.data(), data.size() * sizeof(uint32_t));
-					out.flush();
-					out.close();
-				}
-			}
+		// Output entries are created up front, stages only write to their own entry
+		std::vector<VkShaderStageFlagBits> stages;
+		for (const auto& [stage, source] : sources)
+		{
+			stages.push_back(stage);
+			output[stage];
 		}
-		return true;
+
+		std::atomic_bool success = true;
+		Application::Get().GetThreadPool().ParallelFor(static_cast<uint32_t>(stages.size()), 1, [&](uint32_t index) {
+			const VkShaderStageFlagBits stage = stages[index];
+			if (!VulkanShaderCache::GetOrCompile(m_FilePath, sources.at(stage), Utils::VkShaderStageToShaderC(stage), includer, output.at(stage), forceCompile))
+				success = false;
+		});
+		return success;
 	}
 
 	VulkanShader::PreprocessData VulkanShader::preProcess(const std::string& source) const
@@ -961,20 +910,6 @@ namespace XYZ {
 		});
 		m_Compiled = false;
 	}
-	bool VulkanShader::binaryExists(const StageMap<std::string>& sources) const
-	{
-		std::filesystem::path cacheDirectory = Utils::GetCacheDirectory();
-		std::filesystem::path shaderFilePath = m_FilePath;
-		
-		for (auto& [stage, source] : sources)
-		{
-			std::filesystem::path cachedPath = cacheDirectory / (shaderFilePath.filename().string() + Utils::VkShaderStageCachedFileExtension(stage));
-			if (!std::filesystem::exists(cachedPath))
-				return false;
-		}
-		return true;
-	}
-	
 	size_t VulkanShader::getBuffersSize() const
 	{
 		size_t size = 0;
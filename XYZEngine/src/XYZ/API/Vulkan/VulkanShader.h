@@ -113,6 +113,9 @@ namespace XYZ {
 		std::pair<const VkWriteDescriptorSet*, uint32_t>    TryGetDescriptorSet(const std::string& name) const;
 
 		std::vector<VkDescriptorSetLayout>				    GetAllDescriptorSetLayouts() const;
+
+		// Compiles all stages of all shaders in parallel into shader cache
+		static void Precompile(const std::vector<std::string>& paths);
 		
 	private:
 		
@@ -137,7 +140,6 @@ namespace XYZ {
 
 		void   createDescriptorSetLayout();
 		void   destroy();	
-		bool   binaryExists(const StageMap<std::string>& sources) const;
 		size_t getBuffersSize() const;
 	private:
 		bool					   m_Compiled;
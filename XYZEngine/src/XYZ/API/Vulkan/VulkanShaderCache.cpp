@@ -0,0 +1,212 @@
+#include "stdafx.h"
+#include "VulkanShaderCache.h"
+
+#include "XYZ/Renderer/ShaderCIncluder.h"
+#include "XYZ/Debug/Profiler.h"
+
+#include <fstream>
+#include <set>
+
+namespace XYZ {
+
+	// Increase when compilation changes in a way not described by compile options key
+	static constexpr uint32_t sc_CacheVersion = 1;
+	static constexpr uint32_t sc_SpirvMagic = 0x07230203;
+
+	std::atomic_uint32_t VulkanShaderCache::s_Hits = 0;
+	std::atomic_uint32_t VulkanShaderCache::s_Misses = 0;
+	std::atomic_uint32_t VulkanShaderCache::s_Failed = 0;
+
+	namespace Utils {
+
+		static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			for (size_t i = 0; i < size; ++i)
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			return hash;
+		}
+
+		static uint64_t HashString(uint64_t hash, const std::string& str)
+		{
+			const uint64_t size = str.size();
+			hash = HashBytes(hash, &size, sizeof(uint64_t));
+			return HashBytes(hash, str.data(), str.size());
+		}
+
+		// Every option set here must be described by CompileOptionsKey
+		static void SetCompileOptions(shaderc::CompileOptions& options)
+		{
+			options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+			options.SetWarningsAsErrors();
+			options.SetGenerateDebugInfo();
+#ifdef XYZ_RELEASE
+			options.SetOptimizationLevel(shaderc_optimization_level_performance);
+#endif
+		}
+
+		static const char* CompileOptionsKey()
+		{
+#ifdef XYZ_RELEASE
+			return "vulkan_1_2;werror;debug_info;optimize_performance";
+#else
+			return "vulkan_1_2;werror;debug_info";
+#endif
+		}
+
+		// Includes of includes are collected too, set keeps them in stable order for hashing
+		static void CollectIncludes(const std::string& source, const ShaderIncluder& includer, std::set<std::string>& result)
+		{
+			size_t pos = 0;
+			while ((pos = source.find("#include", pos)) != std::string::npos)
+			{
+				const size_t lineEnd = source.find('\n', pos);
+				const size_t open = source.find_first_of("\"<", pos);
+				if (open == std::string::npos || open > lineEnd)
+				{
+					pos++;
+					continue;
+				}
+				const char closing = source[open] == '"' ? '"' : '>';
+				const size_t close = source.find(closing, open + 1);
+				if (close == std::string::npos || close > lineEnd)
+				{
+					pos = open + 1;
+					continue;
+				}
+				pos = close + 1;
+
+				std::string name = source.substr(open + 1, close - open - 1);
+				if (!result.insert(name).second)
+					continue;
+
+				auto it = includer.GetIncludes().find(name);
+				if (it != includer.GetIncludes().end())
+					CollectIncludes(it->second, includer, result);
+			}
+		}
+	}
+
+	bool VulkanShaderCache::GetOrCompile(const std::string& filePath, const std::string& source, shaderc_shader_kind kind, const ShaderIncluder& includer, std::vector<uint32_t>& output, bool forceCompile)
+	{
+		XYZ_PROFILE_FUNC("VulkanShaderCache::GetOrCompile");
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "%016llx.spv", static_cast<unsigned long long>(ComputeKey(source, kind, includer)));
+		const std::filesystem::path cachedPath = GetDirectory() / fileName;
+
+		if (!forceCompile && readBinary(cachedPath, output))
+		{
+			s_Hits++;
+			return true;
+		}
+		s_Misses++;
+		if (!compile(filePath, source, kind, includer, output))
+		{
+			s_Failed++;
+			return false;
+		}
+		writeBinary(cachedPath, output);
+		return true;
+	}
+
+	uint64_t VulkanShaderCache::ComputeKey(const std::string& source, shaderc_shader_kind kind, const ShaderIncluder& includer)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		hash = Utils::HashBytes(hash, &sc_CacheVersion, sizeof(uint32_t));
+		hash = Utils::HashString(hash, Utils::CompileOptionsKey());
+		hash = Utils::HashBytes(hash, &kind, sizeof(shaderc_shader_kind));
+		hash = Utils::HashString(hash, source);
+
+		std::set<std::string> includes;
+		Utils::CollectIncludes(source, includer, includes);
+		for (const auto& name : includes)
+		{
+			hash = Utils::HashString(hash, name);
+			auto it = includer.GetIncludes().find(name);
+			if (it != includer.GetIncludes().end())
+				hash = Utils::HashString(hash, it->second);
+		}
+		return hash;
+	}
+
+	VulkanShaderCache::Statistics VulkanShaderCache::GetStatistics()
+	{
+		Statistics result;
+		result.Hits = s_Hits;
+		result.Misses = s_Misses;
+		result.Failed = s_Failed;
+		return result;
+	}
+
+	void VulkanShaderCache::ResetStatistics()
+	{
+		s_Hits = 0;
+		s_Misses = 0;
+		s_Failed = 0;
+	}
+
+	const std::filesystem::path& VulkanShaderCache::GetDirectory()
+	{
+		static const std::filesystem::path directory = []() {
+			// TODO: make sure the assets directory is valid
+			std::filesystem::path result = "Resources/Cache/Shader/Vulkan";
+			std::error_code error;
+			std::filesystem::create_directories(result, error);
+			return result;
+		}();
+		return directory;
+	}
+
+	bool VulkanShaderCache::compile(const std::string& filePath, const std::string& source, shaderc_shader_kind kind, const ShaderIncluder& includer, std::vector<uint32_t>& output)
+	{
+		XYZ_PROFILE_FUNC("VulkanShaderCache::compile");
+		// Compiler creation is expensive, every thread keeps its own
+		static thread_local shaderc::Compiler compiler;
+
+		shaderc::CompileOptions options;
+		options.SetIncluder(ShaderCIncluder::Create(includer));
+		Utils::SetCompileOptions(options);
+
+		shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(source, kind, filePath.c_str(), options);
+		if (module.GetCompilationStatus() != shaderc_compilation_status_success)
+		{
+			XYZ_CORE_ERROR(module.GetErrorMessage());
+			return false;
+		}
+		output.assign(module.cbegin(), module.cend());
+		return true;
+	}
+
+	bool VulkanShaderCache::readBinary(const std::filesystem::path& path, std::vector<uint32_t>& output)
+	{
+		std::ifstream in(path, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!in.is_open())
+			return false;
+
+		const size_t size = static_cast<size_t>(in.tellg());
+		if (size == 0 || size % sizeof(uint32_t) != 0)
+			return false;
+
+		in.seekg(0, std::ios::beg);
+		output.resize(size / sizeof(uint32_t));
+		in.read(reinterpret_cast<char*>(output.data()), size);
+		return static_cast<bool>(in) && output[0] == sc_SpirvMagic;
+	}
+
+	void VulkanShaderCache::writeBinary(const std::filesystem::path& path, const std::vector<uint32_t>& data)
+	{
+		// Another thread can compile the same source, binary is renamed into place once complete
+		std::filesystem::path tempPath = path;
+		tempPath += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+		{
+			std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!out.is_open())
+				return;
+			out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(uint32_t));
+		}
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error)
+			std::filesystem::remove(tempPath, error);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "XYZ/Renderer/ShaderIncluder.h"
+
+#include <shaderc/shaderc.hpp>
+
+#include <atomic>
+
+namespace XYZ {
+
+	// SPIR-V binaries stored under hash of stage source, resolved includes and compiler options.
+	// Changed source or include never reuses stale binary. All functions are thread safe
+	class VulkanShaderCache
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t Hits = 0;
+			uint32_t Misses = 0;
+			uint32_t Failed = 0;
+		};
+
+		// Force compile ignores cached binary, result is stored in cache anyway
+		static bool GetOrCompile(const std::string& filePath, const std::string& source, shaderc_shader_kind kind, const ShaderIncluder& includer, std::vector<uint32_t>& output, bool forceCompile = false);
+
+		static uint64_t ComputeKey(const std::string& source, shaderc_shader_kind kind, const ShaderIncluder& includer);
+
+		static Statistics GetStatistics();
+		static void		  ResetStatistics();
+
+		static const std::filesystem::path& GetDirectory();
+
+	private:
+		static bool compile(const std::string& filePath, const std::string& source, shaderc_shader_kind kind, const ShaderIncluder& includer, std::vector<uint32_t>& output);
+		static bool readBinary(const std::filesystem::path& path, std::vector<uint32_t>& output);
+		static void writeBinary(const std::filesystem::path& path, const std::vector<uint32_t>& data);
+
+	private:
+		static std::atomic_uint32_t s_Hits;
+		static std::atomic_uint32_t s_Misses;
+		static std::atomic_uint32_t s_Failed;
+	};
+}
@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "Asset.h"
+#include "AssetAllocator.h"
 
 
 namespace XYZ {
@@ -19,4 +20,14 @@ namespace XYZ {
 		else
 			m_Flags &= ~(uint16_t)flag;
 	}
-}
\ No newline at end of file
+
+	void* Asset::operator new(size_t size)
+	{
+		return AssetAllocator::Allocate(size);
+	}
+
+	void Asset::operator delete(void* ptr)
+	{
+		AssetAllocator::Deallocate(ptr);
+	}
+}
@@ -152,6 +152,12 @@ namespace XYZ {
 		
 		static AssetType GetStaticType() { return AssetType::None; }
 		static const char* GetExtension(AssetType type) { return Utils::AssetTypeToExtension(type); }
+
+		// Assets are allocated from size classes of AssetAllocator
+		static void* operator new(size_t size);
+		static void  operator delete(void* ptr);
+		static void* operator new(size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); }
+		static void  operator delete(void* ptr, std::align_val_t alignment) { ::operator delete(ptr, alignment); }
 	private:
 		AssetHandle m_Handle;
 		uint16_t    m_Flags = 0;
@@ -4,4 +4,21 @@
 
 namespace XYZ {
 
-}
\ No newline at end of file
+	void* AssetAllocator::Allocate(size_t size)
+	{
+		XYZ_ASSERT(size <= UINT32_MAX, "Asset is too big");
+		return getPool().Allocate(static_cast<uint32_t>(size), "Asset");
+	}
+
+	void AssetAllocator::Deallocate(void* ptr)
+	{
+		if (ptr)
+			getPool().Deallocate(ptr);
+	}
+
+	MemoryPool& AssetAllocator::getPool()
+	{
+		static MemoryPool* pool = new MemoryPool(1024 * 1024 * 10, MemoryPool::Mode::SizeClasses);
+		return *pool;
+	}
+}
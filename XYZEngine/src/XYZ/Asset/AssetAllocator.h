@@ -1,14 +1,19 @@
 #pragma once
 #include "XYZ/Utils/DataStructures/MemoryPool.h"
-#include "Asset.h"
 
 namespace XYZ {
 
-	class AssetAllocator
+	// Every Asset is allocated from size class pool, see Asset::operator new.
+	// Pool is never destroyed, assets held by static objects can be released after AssetManager
+	class XYZ_API AssetAllocator
 	{
 	public:
-		// TODO: allocations
+		static void* Allocate(size_t size);
+		static void  Deallocate(void* ptr);
 
+		static const MemoryPool& GetPool() { return getPool(); }
 
+	private:
+		static MemoryPool& getPool();
 	};
-}
\ No newline at end of file
+}
@@ -72,4 +72,17 @@ namespace XYZ {
 		return result;
 	}
 
+	std::vector<AssetHandle> AssetImporter::GetDependencies(const AssetMetadata& metadata)
+	{
+		if (!s_Serializers[ToUnderlying(metadata.Type)])
+			return {};
+
+		return s_Serializers[ToUnderlying(metadata.Type)]->GetDependencies(metadata);
+	}
+
+	void AssetImporter::SetSerializer(AssetType type, Scope<AssetSerializer> serializer)
+	{
+		s_Serializers[ToUnderlying(type)] = std::move(serializer);
+	}
+
 }
\ No newline at end of file
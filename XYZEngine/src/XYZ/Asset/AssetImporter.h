@@ -10,6 +10,10 @@ namespace XYZ {
 		static void Serialize(const AssetMetadata& metadata, WeakRef<Asset> asset);
 		static void Serialize(const Ref<Asset>& asset);
 		static bool TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset);
+		static std::vector<AssetHandle> GetDependencies(const AssetMetadata& metadata);
+
+		// Replaces serializer of the type, used by tools without renderer
+		static void SetSerializer(AssetType type, Scope<AssetSerializer> serializer);
 
 	private:
 		static std::array<Scope<AssetSerializer>, ToUnderlying(AssetType::NumTypes)> s_Serializers;
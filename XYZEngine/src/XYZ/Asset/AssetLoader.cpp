@@ -0,0 +1,251 @@
+#include "stdafx.h"
+#include "AssetLoader.h"
+#include "AssetImporter.h"
+
+#include "XYZ/Debug/Profiler.h"
+
+namespace XYZ {
+
+	bool AssetLoader::ReadyEntry::operator<(const ReadyEntry& other) const
+	{
+		// Top of the queue is the highest priority, requests with the same priority are loaded in order
+		if (Priority != other.Priority)
+			return Priority < other.Priority;
+		return Sequence > other.Sequence;
+	}
+
+	AssetLoader::AssetLoader(const AssetRegistry& registry)
+		:
+		m_Registry(registry),
+		m_NextID(sc_InvalidID),
+		m_NextSequence(0),
+		m_Running(false)
+	{
+	}
+
+	AssetLoader::~AssetLoader()
+	{
+		Stop();
+	}
+
+	void AssetLoader::Start(uint32_t numThreads)
+	{
+		XYZ_ASSERT(m_Threads.empty(), "Asset loader is already running");
+		m_Running = true;
+		for (uint32_t i = 0; i < numThreads; ++i)
+			m_Threads.emplace_back(&AssetLoader::workerThread, this);
+	}
+
+	void AssetLoader::Stop()
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Running = false;
+		}
+		m_Condition.notify_all();
+		for (auto& thread : m_Threads)
+			thread.join();
+
+		m_Threads.clear();
+		m_Requests.clear();
+		m_Ready = {};
+		m_Finished.clear();
+	}
+
+	AssetLoadID AssetLoader::Load(const Ref<AssetData>& assetData, const AssetLoadedFn& onLoaded, AssetLoadPriority priority)
+	{
+		std::lock_guard lock(m_Mutex);
+		const AssetLoadID id = createRequest(assetData, onLoaded, priority, sc_InvalidID);
+		pushReady(id, priority);
+		return id;
+	}
+
+	bool AssetLoader::Cancel(AssetLoadID id)
+	{
+		std::lock_guard lock(m_Mutex);
+		auto it = m_Requests.find(id);
+		if (it != m_Requests.end())
+		{
+			// Worker owning the request removes it, dependencies are dropped with it
+			it->second.Cancelled = true;
+			return true;
+		}
+		auto finished = std::find_if(m_Finished.begin(), m_Finished.end(), [id](const Finished& f) { return f.ID == id; });
+		if (finished != m_Finished.end())
+		{
+			m_Finished.erase(finished);
+			return true;
+		}
+		return false;
+	}
+
+	void AssetLoader::TakeLoaded(std::vector<AssetLoaded>& result)
+	{
+		std::lock_guard lock(m_Mutex);
+		for (auto& finished : m_Finished)
+			result.push_back(std::move(finished.Loaded));
+		m_Finished.clear();
+	}
+
+	uint32_t AssetLoader::GetPendingCount() const
+	{
+		std::lock_guard lock(m_Mutex);
+		return static_cast<uint32_t>(m_Requests.size());
+	}
+
+	void AssetLoader::workerThread()
+	{
+		std::unique_lock lock(m_Mutex);
+		while (true)
+		{
+			m_Condition.wait(lock, [this]() { return !m_Running || !m_Ready.empty(); });
+			if (!m_Running)
+				return;
+
+			const AssetLoadID id = m_Ready.top().ID;
+			m_Ready.pop();
+
+			// Only the worker that popped the request can erase it, so reference stays valid while unlocked
+			Request& request = m_Requests.at(id);
+			if (isCancelled(request))
+			{
+				finishRequest(id, nullptr);
+				continue;
+			}
+			if (!request.DependenciesResolved)
+			{
+				lock.unlock();
+				resolveDependencies(id, request);
+				lock.lock();
+				continue;
+			}
+
+			Ref<AssetData> assetData = request.AssetData;
+			lock.unlock();
+
+			XYZ_PROFILE_FUNC("AssetLoader::load");
+			assetData->SpinLock(); // Another worker might be loading the same asset
+			Ref<Asset> result = assetData->Asset.Lock(); // Probably loaded asset on main thread already
+			if (!result.Raw() && tryLoadData(assetData->Metadata, result))
+			{
+				assetData->Asset = result;
+			}
+			assetData->Unlock();
+
+			lock.lock();
+			finishRequest(id, result);
+		}
+	}
+
+	AssetLoadID AssetLoader::createRequest(const Ref<AssetData>& assetData, const AssetLoadedFn& onLoaded, AssetLoadPriority priority, AssetLoadID parent)
+	{
+		const AssetLoadID id = ++m_NextID;
+		Request& request = m_Requests[id];
+		request.AssetData = assetData;
+		request.OnLoaded = onLoaded;
+		request.Priority = priority;
+		request.Parent = parent;
+		return id;
+	}
+
+	void AssetLoader::pushReady(AssetLoadID id, AssetLoadPriority priority)
+	{
+		m_Ready.push({ priority, m_NextSequence++, id });
+		m_Condition.notify_one();
+	}
+
+	void AssetLoader::resolveDependencies(AssetLoadID id, Request& request)
+	{
+		// Called without lock, dependencies are read from asset file
+		std::vector<AssetHandle> handles;
+		try
+		{
+			handles = AssetImporter::GetDependencies(request.AssetData->Metadata);
+		}
+		catch (const std::exception& e)
+		{
+			// Asset is still loaded, its serializer reports the broken file
+			XYZ_CORE_ERROR("Failed to read dependencies of asset '{0}': {1}", request.AssetData->Metadata.FilePath.string(), e.what());
+		}
+
+		std::vector<Ref<AssetData>> pending;
+		std::vector<Ref<Asset>> loaded;
+		for (const AssetHandle& handle : handles)
+		{
+			auto it = m_Registry.find(handle);
+			if (it == m_Registry.cend())
+				continue; // Serializer handles missing assets
+
+			// Locked dependency is being loaded, its request waits for it
+			const Ref<AssetData>& dependency = it->second;
+			if (dependency->TryLock())
+			{
+				Ref<Asset> asset = dependency->Asset.Lock();
+				if (asset.Raw())
+					loaded.push_back(std::move(asset));
+				else
+					pending.push_back(dependency);
+				dependency->Unlock();
+			}
+			else
+			{
+				pending.push_back(dependency);
+			}
+		}
+
+		std::lock_guard lock(m_Mutex);
+		request.DependenciesResolved = true;
+		request.Dependencies = std::move(loaded);
+		for (const auto& dependency : pending)
+		{
+			const AssetLoadID dependencyID = createRequest(dependency, {}, request.Priority, id);
+			pushReady(dependencyID, request.Priority);
+			request.WaitingDependencies++;
+		}
+		if (request.WaitingDependencies == 0)
+			pushReady(id, request.Priority);
+	}
+
+	void AssetLoader::finishRequest(AssetLoadID id, Ref<Asset> asset)
+	{
+		auto it = m_Requests.find(id);
+		Request& request = it->second;
+		if (request.Parent != sc_InvalidID)
+		{
+			// Parent is loaded once all of its dependencies are finished, even if some of them failed
+			Request& parent = m_Requests.at(request.Parent);
+			if (asset.Raw())
+				parent.Dependencies.push_back(asset);
+			if (--parent.WaitingDependencies == 0)
+				pushReady(request.Parent, parent.Priority);
+		}
+		// Dependencies are reported too without callback, so main thread can keep them alive
+		if (asset.Raw() && !request.Cancelled)
+			m_Finished.push_back({ id, { asset, std::move(request.OnLoaded) } });
+
+		m_Requests.erase(it);
+	}
+
+	bool AssetLoader::tryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset)
+	{
+		// Serializers throw on malformed files, only this asset fails to load
+		try
+		{
+			return AssetImporter::TryLoadData(metadata, asset);
+		}
+		catch (const std::exception& e)
+		{
+			XYZ_CORE_ERROR("Failed to load asset '{0}': {1}", metadata.FilePath.string(), e.what());
+			asset = nullptr;
+			return false;
+		}
+	}
+
+	bool AssetLoader::isCancelled(const Request& request) const
+	{
+		const Request* current = &request;
+		while (!current->Cancelled && current->Parent != sc_InvalidID)
+			current = &m_Requests.at(current->Parent);
+		return current->Cancelled;
+	}
+}
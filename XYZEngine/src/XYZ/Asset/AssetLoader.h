@@ -0,0 +1,108 @@
+#pragma once
+#include "AssetRegistry.h"
+#include "Asset.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace XYZ {
+
+	using AssetLoadedFn = std::function<void(Ref<Asset>)>;
+	using AssetLoadID	= uint64_t;
+
+	enum class AssetLoadPriority : uint8_t
+	{
+		Low,
+		Normal,
+		High
+	};
+
+	struct AssetLoaded
+	{
+		Ref<Asset>	  Asset;
+		AssetLoadedFn OnLoaded;
+	};
+
+	// Loads assets on worker threads that sleep until there is a request.
+	// Before asset is loaded its dependencies are scheduled and loaded first,
+	// so the worker loading material does not block on its shader and textures
+	class XYZ_API AssetLoader
+	{
+	public:
+		static constexpr AssetLoadID sc_InvalidID = 0;
+
+		AssetLoader(const AssetRegistry& registry);
+		~AssetLoader();
+
+		void Start(uint32_t numThreads);
+		void Stop();
+
+		AssetLoadID Load(const Ref<AssetData>& assetData, const AssetLoadedFn& onLoaded, AssetLoadPriority priority);
+
+		// Returns true if callback of the request will not be called
+		bool Cancel(AssetLoadID id);
+
+		// Moves finished loads to result, dependencies have no callback
+		void TakeLoaded(std::vector<AssetLoaded>& result);
+
+		uint32_t GetPendingCount() const;
+		uint32_t GetNumThreads()   const { return static_cast<uint32_t>(m_Threads.size()); }
+
+	private:
+		struct Request
+		{
+			Ref<AssetData>			AssetData;
+			AssetLoadedFn			OnLoaded;
+			AssetLoadPriority		Priority;
+			AssetLoadID				Parent = sc_InvalidID;
+			uint32_t				WaitingDependencies = 0;
+			bool					DependenciesResolved = false;
+			bool					Cancelled = false;
+
+			// Keeps loaded dependencies alive until the request is loaded
+			std::vector<Ref<Asset>> Dependencies;
+		};
+
+		struct ReadyEntry
+		{
+			AssetLoadPriority Priority;
+			uint64_t		  Sequence;
+			AssetLoadID		  ID;
+
+			bool operator<(const ReadyEntry& other) const;
+		};
+
+		struct Finished
+		{
+			AssetLoadID ID;
+			AssetLoaded Loaded;
+		};
+
+		void workerThread();
+
+		AssetLoadID createRequest(const Ref<AssetData>& assetData, const AssetLoadedFn& onLoaded, AssetLoadPriority priority, AssetLoadID parent);
+		void		pushReady(AssetLoadID id, AssetLoadPriority priority);
+		void		resolveDependencies(AssetLoadID id, Request& request);
+		void		finishRequest(AssetLoadID id, Ref<Asset> asset);
+		bool		isCancelled(const Request& request) const;
+
+		static bool tryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset);
+
+	private:
+		const AssetRegistry& m_Registry;
+
+		std::unordered_map<AssetLoadID, Request> m_Requests;
+		std::priority_queue<ReadyEntry>			 m_Ready;
+		std::vector<Finished>					 m_Finished;
+
+		mutable std::mutex						 m_Mutex;
+		std::condition_variable					 m_Condition;
+		std::vector<std::thread>				 m_Threads;
+
+		AssetLoadID m_NextID;
+		uint64_t	m_NextSequence;
+		bool		m_Running;
+	};
+}
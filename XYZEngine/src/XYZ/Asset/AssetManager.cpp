@@ -10,13 +10,23 @@
 namespace XYZ
 {
 	static std::filesystem::path s_Directory = "Assets";
+	static std::filesystem::path s_PackPath = "Assets.xyzpack";
 	static AssetManager s_Instance;
 
 	void AssetManager::Init()
 	{
 		AssetImporter::Init();
-		processDirectory(s_Directory);
-		processDirectory("Resources");
+		// Loose files are used whenever they exist, so edited and new assets are never shadowed by a stale pack
+		if (!std::filesystem::exists(s_Directory) && s_Instance.m_Pack.Open(s_PackPath))
+		{
+			for (const auto& metadata : s_Instance.m_Pack.GetMetadata())
+				s_Instance.m_Registry.StoreMetadata(metadata);
+		}
+		else
+		{
+			processDirectory(s_Directory);
+			processDirectory("Resources");
+		}
 
 		std::wstring wdir = s_Directory.wstring();
 		s_Instance.m_FileWatcher = std::make_shared<FileWatcher>(wdir);
@@ -24,19 +34,16 @@ namespace XYZ
 		s_Instance.m_FileWatcher->AddOnFileChanged<&onFileChange>();
 		s_Instance.m_FileWatcher->Start();
 
-		s_Instance.m_LoadingAssetsAsync = true;
-		s_Instance.m_PendingAssetsLoadThread = std::make_unique<std::thread>(&AssetManager::assetLoadingWorker);
+		s_Instance.m_Loader.Start(std::max(2u, std::thread::hardware_concurrency() / 2));
 	}
 	void AssetManager::Shutdown()
 	{
-		s_Instance.m_LoadingAssetsAsync = false;
-		s_Instance.m_PendingAssetsLoadThread->join();
-		s_Instance.m_PendingAssetsLoadThread.reset();
-		s_Instance.m_LoadedAssetsQueue.Clear();
-		s_Instance.m_PendingAssetsQueue.Clear();
+		s_Instance.m_Loader.Stop();
+		s_Instance.m_LoadedAssets.clear();
 
 		s_Instance.m_MemoryAssets.clear();
 		s_Instance.m_Registry.Clear();
+		s_Instance.m_Pack.Close();
 
 		s_Instance.m_FileWatcher->Stop();
 		if (s_Instance.m_AssetLifeManager)
@@ -57,19 +64,38 @@ namespace XYZ
 	{
 		for (auto it : s_Instance.m_Registry)
 		{
-			if (it.second->Asset.IsValid())
+			Ref<Asset> asset = it.second->Asset.Lock();
+			if (asset.Raw())
 			{
 				const auto& metadata = it.second->Metadata;
-				AssetImporter::Serialize(metadata, it.second->Asset);
+				AssetImporter::Serialize(metadata, asset);
 			}
 		}
 	}
 
+	bool AssetManager::CookAssetPack(const std::filesystem::path& output, bool compress)
+	{
+		std::error_code error;
+		if (s_Instance.m_Pack.IsOpen() && std::filesystem::equivalent(output, s_PackPath, error))
+		{
+			XYZ_CORE_ERROR("Can not cook asset pack over the pack that is in use");
+			return false;
+		}
+		std::vector<AssetMetadata> assets;
+		for (const auto& [handle, assetData] : s_Instance.m_Registry)
+			assets.push_back(assetData->Metadata);
+
+		return AssetPack::Cook(assets, output, compress);
+	}
+
 	void AssetManager::Serialize(const AssetHandle& assetHandle)
 	{
-		WeakRef<Asset> asset;
+		Ref<Asset> asset;
 		auto it = s_Instance.m_Registry.find(assetHandle);
-		if (it != s_Instance.m_Registry.end() && it->second->Asset.IsValid())
+		if (it != s_Instance.m_Registry.end())
+			asset = it->second->Asset.Lock();
+
+		if (asset.Raw())
 		{
 			const auto metadata = s_Instance.m_Registry.GetMetadata(assetHandle);
 			AssetImporter::Serialize(*metadata, asset);
@@ -83,28 +109,39 @@ namespace XYZ
 	void AssetManager::Update(Timestep ts)
 	{
 		s_Instance.m_FileWatcher->ProcessChanges();
-		while (!s_Instance.m_LoadedAssetsQueue.Empty())
+
+		s_Instance.m_Loader.TakeLoaded(s_Instance.m_LoadedAssets);
+		for (auto& loaded : s_Instance.m_LoadedAssets)
 		{
-			AssetLoaded loaded = s_Instance.m_LoadedAssetsQueue.PopBack();
-			loaded.OnLoaded(loaded.Asset);
+			keepAliveAsset(loaded.Asset);
+			if (loaded.OnLoaded)
+				loaded.OnLoaded(loaded.Asset);
 		}
+		s_Instance.m_LoadedAssets.clear();
 	}
 
-	void AssetManager::LoadAssetAsync(const AssetHandle& assetHandle, const AssetLoadedFn& onLoaded)
+	AssetLoadID AssetManager::LoadAssetAsync(const AssetHandle& assetHandle, const AssetLoadedFn& onLoaded, AssetLoadPriority priority)
 	{
+		AssetLoadID result = AssetLoader::sc_InvalidID;
 		Ref<AssetData> assetData = s_Instance.m_Registry.GetAsset(assetHandle);
 		assetData->SpinLock(); // Wait to finish loading if it already started
 
-		if (assetData->Asset.IsValid()) // Asset is already loaded just call callback immediately
+		Ref<Asset> asset = assetData->Asset.Lock();
+		if (asset.Raw()) // Asset is already loaded just call callback immediately
 		{
-			Ref<Asset> asset = assetData->Asset.Raw();
 			onLoaded(asset);
 		}
 		else
 		{
-			s_Instance.m_PendingAssetsQueue.PushBack({ assetData, onLoaded });
+			result = s_Instance.m_Loader.Load(assetData, onLoaded, priority);
 		}
 		assetData->Unlock();
+		return result;
+	}
+
+	bool AssetManager::CancelAssetLoad(AssetLoadID loadID)
+	{
+		return s_Instance.m_Loader.Cancel(loadID);
 	}
 
 	std::vector<AssetHandle> AssetManager::FindAllLoadedAssets()
@@ -151,9 +188,10 @@ namespace XYZ
 			Ref<AssetData> assetData = s_Instance.m_Registry.GetAsset(metadata->Handle);
 			assetData->WaitUnlock();
 
-			if (assetData->Asset.IsValid())
+			Ref<Asset> oldAsset = assetData->Asset.Lock();
+			if (oldAsset.Raw())
 			{
-				assetData->Asset->SetFlag(AssetFlag::Reloaded);
+				oldAsset->SetFlag(AssetFlag::Reloaded);
 			}
 			assetData->Asset = asset;
 		}
@@ -177,6 +215,11 @@ namespace XYZ
 	{
 		return s_Directory;
 	}
+
+	const std::filesystem::path& AssetManager::GetAssetPackPath()
+	{
+		return s_PackPath;
+	}
 	
 	bool AssetManager::Exist(const AssetHandle& handle)
 	{
@@ -301,31 +344,4 @@ namespace XYZ
 		}
 	}
 
-	void AssetManager::assetLoadingWorker()
-	{
-		while (s_Instance.m_LoadingAssetsAsync)
-		{
-			while (!s_Instance.m_PendingAssetsQueue.Empty())
-			{
-				AssetPending pending = s_Instance.m_PendingAssetsQueue.PopBack();
-				pending.AssetData->SpinLock(); // Wait to be able to lock asset data again
-				
-				Ref<Asset> result;
-				if (pending.AssetData->Asset.IsValid()) // Probably loaded asset on main thread already
-				{
-					result = pending.AssetData->Asset.Raw();
-					s_Instance.m_LoadedAssetsQueue.PushBack({ result, std::move(pending.OnLoaded) });
-				}
-				else if (AssetImporter::TryLoadData(pending.AssetData->Metadata, result))
-				{
-					pending.AssetData->Asset = result;
-					s_Instance.m_LoadedAssetsQueue.PushBack({ result, std::move(pending.OnLoaded) });
-					keepAliveAsset(result);
-				}
-				pending.AssetData->Unlock();
-			
-			}
-		}
-	}
-
 }
\ No newline at end of file
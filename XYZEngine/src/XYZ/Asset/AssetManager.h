@@ -3,7 +3,6 @@
 #include "XYZ/Core/Timestep.h"
 #include "XYZ/Core/Application.h"
 
-#include "XYZ/Utils/DataStructures/MemoryPool.h"
 #include "XYZ/Utils/DataStructures/ThreadQueue.h"
 #include "XYZ/Utils/DataStructures/ThreadUnorderedMap.h"
 
@@ -18,6 +17,9 @@
 #include "AssetImporter.h"
 #include "AssetRegistry.h"
 #include "AssetLifeManager.h"
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "AssetAllocator.h"
 #include "Asset.h"
 
 
@@ -57,20 +59,6 @@ namespace XYZ {
 		class AssetBrowser;
 	}
 
-	using AssetLoadedFn = std::function<void(Ref<Asset>)>;
-	
-	struct AssetPending
-	{		
-		Ref<AssetData>	AssetData;
-		AssetLoadedFn	OnLoaded;
-	};
-
-	struct AssetLoaded
-	{
-		Ref<Asset> Asset;
-		AssetLoadedFn OnLoaded;
-	};
-
 	class XYZ_API AssetManager
 	{
 	public:
@@ -79,6 +67,9 @@ namespace XYZ {
 		static void KeepAlive(float seconds);
 
 		static void SerializeAll();
+
+		// Writes all registered assets to pack. Init uses the pack only if asset directory does not exist, as in shipped builds
+		static bool CookAssetPack(const std::filesystem::path& output, bool compress = true);
 		static void Serialize(const AssetHandle& assetHandle);
 
 		static void Update(Timestep ts);
@@ -92,7 +83,9 @@ namespace XYZ {
 		template<typename T, typename... Args>
 		static Ref<T> CreateAsset(const std::string& filename, const std::string& directoryPath, Args&&... args);
 			
-		static void LoadAssetAsync(const AssetHandle& assetHandle, const AssetLoadedFn& onLoaded);
+		// Callback is called from Update on main thread, or immediately if asset is already loaded
+		static AssetLoadID LoadAssetAsync(const AssetHandle& assetHandle, const AssetLoadedFn& onLoaded, AssetLoadPriority priority = AssetLoadPriority::Normal);
+		static bool		   CancelAssetLoad(AssetLoadID loadID);
 		
 		template<typename T>
 		static Ref<T> GetAsset(const AssetHandle& assetHandle);
@@ -129,7 +122,9 @@ namespace XYZ {
 		static const AssetMetadata GetMetadata(const Ref<Asset>& asset) { return GetMetadata(asset->m_Handle); }
 		
 		static const std::filesystem::path&	GetAssetDirectory();
-		static const MemoryPool&			GetMemoryPool() { return Get().m_Pool; }
+		static const MemoryPool&			GetMemoryPool() { return AssetAllocator::GetPool(); }
+		static const AssetPack&				GetAssetPack() { return Get().m_Pack; }
+		static const std::filesystem::path& GetAssetPackPath();
 
 		static bool Exist(const AssetHandle& handle);
 		static bool Exist(const std::filesystem::path& filepath);
@@ -149,23 +144,17 @@ namespace XYZ {
 
 
 		static void onFileChange(FileWatcher::ChangeType type, const std::filesystem::path& path);
-
-		static void assetLoadingWorker();
 	private:
-		MemoryPool										  m_Pool = MemoryPool(1024 * 1024 * 10);
 		AssetRegistry									  m_Registry;
+		AssetPack										  m_Pack;
 
 		std::unordered_map<AssetHandle, WeakRef<Asset>>   m_MemoryAssets;
 
-		ThreadQueue<AssetPending>						  m_PendingAssetsQueue;
-		ThreadQueue<AssetLoaded>						  m_LoadedAssetsQueue;
-
-		std::unique_ptr<std::thread>					  m_PendingAssetsLoadThread;
+		AssetLoader										  m_Loader{ m_Registry };
+		std::vector<AssetLoaded>						  m_LoadedAssets;
 
 		std::shared_ptr<FileWatcher>					  m_FileWatcher;
 		std::shared_ptr<AssetLifeManager>				  m_AssetLifeManager;
-
-		bool m_LoadingAssetsAsync;
 	private:
 		friend Editor::AssetBrowser;
 		friend Editor::AssetManagerViewPanel;
@@ -223,16 +212,13 @@ namespace XYZ {
 		Ref<AssetData> assetData = Get().m_Registry.GetAsset(assetHandle);
 		if (assetData->TryLock()) // If asset is locked it means it is not loaded yet
 		{	
-			if (!assetData->Asset.IsValid())
+			result = assetData->Asset.Lock();
+			if (!result.Raw())
 			{		
 				// If we did not request async load of asset, load it synchronously
 				result = loadAsset<T>(assetData->Metadata);
 				assetData->Asset = result.Raw();
 			}
-			else
-			{
-				result = assetData->Asset.Raw();
-			}
 			assetData->Unlock();
 		}
 		return result.As<T>();
@@ -244,17 +230,13 @@ namespace XYZ {
 		Ref<AssetData> assetData = Get().m_Registry.GetAsset(assetHandle);
 		assetData->SpinLock();
 
-		Ref<Asset> result;
-		if (!assetData->Asset.IsValid())
+		Ref<Asset> result = assetData->Asset.Lock();
+		if (!result.Raw())
 		{
 			// If we did not request async load of asset, load it synchronously
 			result = loadAsset<T>(assetData->Metadata);
 			assetData->Asset = result.Raw();
 		}
-		else
-		{
-			result = assetData->Asset.Raw();
-		}
 		assetData->Unlock();
 		return result.As<T>();
 	}
@@ -319,13 +301,11 @@ namespace XYZ {
 		
 		for (auto it : Get().m_Registry)
 		{
-			if (it.second->Asset.IsValid())
+			if (it.second->Metadata.Type == type)
 			{
-				if (it.second->Metadata.Type == type)
-				{
-					Ref<Asset> asset = it.second->Asset.Raw();
+				Ref<Asset> asset = it.second->Asset.Lock();
+				if (asset.Raw())
 					result.push_back(asset.As<T>());
-				}
 			}
 		}
 		return result;
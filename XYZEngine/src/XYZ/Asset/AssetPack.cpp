@@ -0,0 +1,187 @@
+#include "stdafx.h"
+#include "AssetPack.h"
+
+#include "XYZ/Utils/Compression.h"
+#include "XYZ/Debug/Profiler.h"
+
+#include <fstream>
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_PackMagic = 0x4b50585a; // "ZXPK"
+	static constexpr uint32_t sc_PackVersion = 1;
+
+	static_assert(sizeof(AssetHandle) == 16, "Pack entries store raw asset handles");
+
+	static uint64_t AlignOffset(uint64_t offset, uint64_t alignment)
+	{
+		return (offset + alignment - 1) & ~(alignment - 1);
+	}
+
+	static bool ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& result)
+	{
+		std::ifstream stream(path, std::ios::binary | std::ios::ate);
+		if (!stream.is_open())
+			return false;
+
+		result.resize(static_cast<size_t>(stream.tellg()));
+		stream.seekg(0, std::ios::beg);
+		stream.read(reinterpret_cast<char*>(result.data()), result.size());
+		return static_cast<bool>(stream);
+	}
+
+	bool AssetPack::Cook(const std::vector<AssetMetadata>& assets, const std::filesystem::path& output, bool compress)
+	{
+		XYZ_PROFILE_FUNC("AssetPack::Cook");
+		std::vector<AssetMetadata> sorted = assets;
+		std::sort(sorted.begin(), sorted.end(), [](const AssetMetadata& a, const AssetMetadata& b) {
+			return a.Handle < b.Handle;
+		});
+
+		std::vector<Entry> entries(sorted.size());
+		std::string paths;
+		for (size_t i = 0; i < sorted.size(); ++i)
+		{
+			const std::string path = sorted[i].FilePath.generic_string();
+			entries[i].Handle = sorted[i].Handle;
+			entries[i].Type = static_cast<uint32_t>(sorted[i].Type);
+			entries[i].PathOffset = static_cast<uint32_t>(paths.size());
+			entries[i].PathSize = static_cast<uint32_t>(path.size());
+			paths += path;
+		}
+
+		Header header{ sc_PackMagic, sc_PackVersion, static_cast<uint32_t>(entries.size()), 0 };
+		header.PathsOffset = sizeof(Header) + entries.size() * sizeof(Entry);
+		header.PathsSize = paths.size();
+
+		std::ofstream stream(output, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			XYZ_CORE_WARN("Could not create asset pack {}", output.string());
+			return false;
+		}
+
+		// Blobs are written first, table is written once their offsets are known
+		uint64_t offset = AlignOffset(header.PathsOffset + header.PathsSize, sc_BlobAlignment);
+		stream.seekp(offset, std::ios::beg);
+
+		std::vector<uint8_t> data;
+		std::vector<uint8_t> compressed;
+		const char zeros[sc_BlobAlignment] = {};
+		for (size_t i = 0; i < sorted.size(); ++i)
+		{
+			Entry& entry = entries[i];
+			if (!ReadFile(sorted[i].FilePath, data))
+			{
+				XYZ_CORE_WARN("Could not read asset {}", sorted[i].FilePath.string());
+				data.clear();
+			}
+			entry.UncompressedSize = data.size();
+			entry.Compressed = 0;
+			const std::vector<uint8_t>* blob = &data;
+			if (compress)
+			{
+				Utils::RLECompress(data.data(), data.size(), compressed);
+				if (compressed.size() < data.size())
+				{
+					entry.Compressed = 1;
+					blob = &compressed;
+				}
+			}
+			entry.Offset = offset;
+			entry.Size = blob->size();
+			stream.write(reinterpret_cast<const char*>(blob->data()), blob->size());
+
+			const uint64_t aligned = AlignOffset(offset + entry.Size, sc_BlobAlignment);
+			stream.write(zeros, aligned - offset - entry.Size);
+			offset = aligned;
+		}
+
+		stream.seekp(0, std::ios::beg);
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+		stream.write(paths.data(), paths.size());
+		return static_cast<bool>(stream);
+	}
+
+	bool AssetPack::Open(const std::filesystem::path& path)
+	{
+		Close();
+		if (!m_File.Open(path))
+			return false;
+
+		const uint8_t* data = m_File.GetData();
+		const size_t size = m_File.GetSize();
+
+		Header header;
+		if (size < sizeof(Header))
+		{
+			Close();
+			return false;
+		}
+		memcpy(&header, data, sizeof(Header));
+		const uint64_t tableEnd = sizeof(Header) + static_cast<uint64_t>(header.EntryCount) * sizeof(Entry);
+		if (header.Magic != sc_PackMagic || header.Version != sc_PackVersion
+		 || tableEnd > header.PathsOffset || header.PathsOffset + header.PathsSize > size)
+		{
+			XYZ_CORE_WARN("Invalid asset pack {}", path.string());
+			Close();
+			return false;
+		}
+		m_Entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+		m_Paths = reinterpret_cast<const char*>(data + header.PathsOffset);
+		m_EntryCount = header.EntryCount;
+		return true;
+	}
+
+	void AssetPack::Close()
+	{
+		m_File.Close();
+		m_Entries = nullptr;
+		m_Paths = nullptr;
+		m_EntryCount = 0;
+	}
+
+	bool AssetPack::Read(const AssetHandle& handle, std::string_view& result, std::vector<uint8_t>& scratch) const
+	{
+		const Entry* entry = find(handle);
+		if (!entry || entry->Offset + entry->Size > m_File.GetSize())
+			return false;
+
+		const uint8_t* blob = m_File.GetData() + entry->Offset;
+		if (!entry->Compressed)
+		{
+			result = std::string_view(reinterpret_cast<const char*>(blob), entry->Size);
+			return true;
+		}
+		scratch.resize(entry->UncompressedSize);
+		if (!Utils::RLEDecompress(blob, entry->Size, scratch.data(), scratch.size()))
+			return false;
+
+		result = std::string_view(reinterpret_cast<const char*>(scratch.data()), scratch.size());
+		return true;
+	}
+
+	std::vector<AssetMetadata> AssetPack::GetMetadata() const
+	{
+		std::vector<AssetMetadata> result(m_EntryCount);
+		for (uint32_t i = 0; i < m_EntryCount; ++i)
+		{
+			result[i].Handle = m_Entries[i].Handle;
+			result[i].Type = static_cast<AssetType>(m_Entries[i].Type);
+			result[i].FilePath = std::string_view(m_Paths + m_Entries[i].PathOffset, m_Entries[i].PathSize);
+		}
+		return result;
+	}
+
+	const AssetPack::Entry* AssetPack::find(const AssetHandle& handle) const
+	{
+		const Entry* end = m_Entries + m_EntryCount;
+		const Entry* it = std::lower_bound(m_Entries, end, handle, [](const Entry& entry, const AssetHandle& value) {
+			return entry.Handle < value;
+		});
+		if (it != end && it->Handle == handle)
+			return it;
+		return nullptr;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "Asset.h"
+
+#include "XYZ/Utils/MemoryMappedFile.h"
+
+#include <string_view>
+
+namespace XYZ {
+
+	// Single file containing asset files and their metadata.
+	// Table of entries sorted by handle is followed by file paths and aligned asset blobs,
+	// the pack is memory mapped and uncompressed blobs are used directly from the mapping
+	class XYZ_API AssetPack
+	{
+	public:
+		static constexpr uint32_t sc_BlobAlignment = 16;
+
+		// Blobs are run length compressed only if it makes them smaller
+		static bool Cook(const std::vector<AssetMetadata>& assets, const std::filesystem::path& output, bool compress);
+
+		bool Open(const std::filesystem::path& path);
+		void Close();
+
+		bool IsOpen() const { return m_File.IsOpen(); }
+		bool Contains(const AssetHandle& handle) const { return find(handle) != nullptr; }
+
+		// Result points to mapping, or to scratch if blob is compressed
+		bool Read(const AssetHandle& handle, std::string_view& result, std::vector<uint8_t>& scratch) const;
+
+		std::vector<AssetMetadata> GetMetadata() const;
+
+		uint32_t GetAssetCount() const { return m_EntryCount; }
+
+	private:
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t EntryCount;
+			uint32_t Padding;
+			uint64_t PathsOffset;
+			uint64_t PathsSize;
+		};
+
+		struct Entry
+		{
+			AssetHandle Handle;
+			uint32_t	Type;
+			uint32_t	Compressed;
+			uint64_t	Offset;
+			uint64_t	Size;
+			uint64_t	UncompressedSize;
+			uint32_t	PathOffset;
+			uint32_t	PathSize;
+		};
+
+		const Entry* find(const AssetHandle& handle) const;
+
+	private:
+		MemoryMappedFile m_File;
+		const Entry*	 m_Entries = nullptr;
+		const char*		 m_Paths = nullptr;
+		uint32_t		 m_EntryCount = 0;
+	};
+}
@@ -18,6 +18,42 @@
 
 
 namespace XYZ {
+
+	// Reads directly from memory of asset pack blob
+	struct MemoryStreamBuffer : public std::streambuf
+	{
+		MemoryStreamBuffer(std::string_view data)
+		{
+			char* begin = const_cast<char*>(data.data());
+			setg(begin, begin, begin + data.size());
+		}
+	};
+
+	// Cooked assets are read from asset pack, loose files are used otherwise
+	static YAML::Node LoadAssetFile(const AssetMetadata& metadata)
+	{
+		std::string_view packed;
+		std::vector<uint8_t> scratch;
+		if (AssetManager::GetAssetPack().Read(metadata.Handle, packed, scratch))
+		{
+			MemoryStreamBuffer buffer(packed);
+			std::istream stream(&buffer);
+			return YAML::Load(stream);
+		}
+
+		std::ifstream stream(metadata.FilePath);
+		std::stringstream strStream;
+		strStream << stream.rdbuf();
+		return YAML::Load(strStream.str());
+	}
+
+	// Missing or malformed dependency keys are skipped, loading of the asset reports them
+	static void AddDependency(std::vector<AssetHandle>& result, const YAML::Node& node)
+	{
+		if (node.IsDefined() && node.IsScalar())
+			result.push_back(AssetHandle(node.Scalar()));
+	}
+
 	namespace Utils {
 		static std::string ImageFormatToString(ImageFormat format)
 		{
@@ -115,10 +151,7 @@ namespace XYZ {
 	}
 	bool ShaderAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		std::string name = data["Name"].as<std::string>();
 		std::string filePath = data["FilePath"].as<std::string>();
@@ -210,10 +243,7 @@ namespace XYZ {
 	}
 	bool MaterialAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		AssetHandle shaderHandle = AssetHandle(data["Shader"].as<std::string>());
 		Ref<ShaderAsset> shaderAsset = AssetManager::GetAssetWait<ShaderAsset>(shaderHandle);
@@ -295,6 +325,29 @@ namespace XYZ {
 		return true;
 	}
 
+	std::vector<AssetHandle> MaterialAssetSerializer::GetDependencies(const AssetMetadata& metadata) const
+	{
+		YAML::Node data = LoadAssetFile(metadata);
+
+		std::vector<AssetHandle> result;
+		if (!data.IsMap())
+			return result;
+
+		AddDependency(result, data["Shader"]);
+		for (auto texture : data["Textures"])
+		{
+			if (texture.IsMap())
+				AddDependency(result, texture["Handle"]);
+		}
+		for (auto textureArr : data["TextureArrays"])
+		{
+			if (!textureArr.IsMap())
+				continue;
+			for (auto texture : textureArr["Textures"])
+				AddDependency(result, texture);
+		}
+		return result;
+	}
 	
 
 	void TextureAssetSerializer::Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const
@@ -323,10 +376,7 @@ namespace XYZ {
 	}
 	bool TextureAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		std::string imagePath = data["Image Path"].as<std::string>();
 		uint32_t width = data["Width"].as<uint32_t>();
@@ -399,10 +449,7 @@ namespace XYZ {
 
 	bool MeshSourceAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		auto sourceFilePath = data["SourceFilePath"];
 		if (sourceFilePath)
@@ -469,10 +516,7 @@ namespace XYZ {
 	}
 	bool SkeletonAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		auto sourceFilePath = data["SourceFilePath"];
 		asset = Ref<SkeletonAsset>::Create(sourceFilePath.as<std::string>());
@@ -497,10 +541,7 @@ namespace XYZ {
 	}
 	bool AnimationAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		auto sourceFilePath = data["SourceFilePath"].as<std::string>();
 		auto animationName = data["AnimationName"].as<std::string>();
@@ -532,16 +573,23 @@ namespace XYZ {
 
 	bool StaticMeshAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		AssetHandle meshSourceHandle(data["MeshSource"].as<std::string>());
 		asset = Ref<StaticMesh>::Create(AssetManager::GetAssetWait<MeshSource>(meshSourceHandle));
 		return true;
 	}
 
+	std::vector<AssetHandle> StaticMeshAssetSerializer::GetDependencies(const AssetMetadata& metadata) const
+	{
+		YAML::Node data = LoadAssetFile(metadata);
+
+		std::vector<AssetHandle> result;
+		if (data.IsMap())
+			AddDependency(result, data["MeshSource"]);
+		return result;
+	}
+
 	void AnimatedMeshAssetSerializer::Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const
 	{
 		WeakRef<AnimatedMesh> mesh = asset.As<AnimatedMesh>();
@@ -560,15 +608,22 @@ namespace XYZ {
 
 	bool AnimatedMeshAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		AssetHandle meshSourceHandle(data["MeshSource"].as<std::string>());
 		asset = Ref<AnimatedMesh>::Create(AssetManager::GetAssetWait<MeshSource>(meshSourceHandle));
 		return true;
 	}
+
+	std::vector<AssetHandle> AnimatedMeshAssetSerializer::GetDependencies(const AssetMetadata& metadata) const
+	{
+		YAML::Node data = LoadAssetFile(metadata);
+
+		std::vector<AssetHandle> result;
+		if (data.IsMap())
+			AddDependency(result, data["MeshSource"]);
+		return result;
+	}
 	void PrefabAssetSerializer::Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const
 	{
 		WeakRef<Prefab> prefab = asset.As<Prefab>();
@@ -578,10 +633,7 @@ namespace XYZ {
 	}
 	bool PrefabAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		Ref<Prefab> prefab = Ref<Prefab>::Create();
 
@@ -611,10 +663,7 @@ namespace XYZ {
 	}
 	bool SubTextureSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 
 
@@ -625,6 +674,16 @@ namespace XYZ {
 
 		return true;
 	}
+
+	std::vector<AssetHandle> SubTextureSerializer::GetDependencies(const AssetMetadata& metadata) const
+	{
+		YAML::Node data = LoadAssetFile(metadata);
+
+		std::vector<AssetHandle> result;
+		if (data.IsMap())
+			AddDependency(result, data["Texture"]);
+		return result;
+	}
 	void AnimationControllerAssetSerializer::Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const
 	{
 		WeakRef<AnimationController> controller = asset.As<AnimationController>();
@@ -656,10 +715,7 @@ namespace XYZ {
 	}
 	bool AnimationControllerAssetSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		Ref<AnimationController> controller = Ref<AnimationController>::Create();
 
@@ -737,10 +793,7 @@ namespace XYZ {
 	}
 	bool ParticleSystemSerializerGPU::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 		
 
 		const uint32_t maxParticles = data["MaxParticles"].as<uint32_t>();
@@ -796,10 +849,7 @@ namespace XYZ {
 	}
 	bool VoxelMeshSourceSerializer::TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const
 	{
-		std::ifstream stream(metadata.FilePath);
-		std::stringstream strStream;
-		strStream << stream.rdbuf();
-		YAML::Node data = YAML::Load(strStream.str());
+		YAML::Node data = LoadAssetFile(metadata);
 
 		return true;
 	}
@@ -8,6 +8,9 @@ namespace XYZ {
 	public:
 		virtual void Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const = 0;
 		virtual bool TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const = 0;
+
+		// Assets that must be loaded before this asset, used by asynchronous loading
+		virtual std::vector<AssetHandle> GetDependencies(const AssetMetadata& metadata) const { return {}; }
 	};
 
 
@@ -31,6 +34,7 @@ namespace XYZ {
 	public:
 		virtual void Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const override;
 		virtual bool TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const override;
+		virtual std::vector<AssetHandle> GetDependencies(const AssetMetadata& metadata) const override;
 	};
 
 
@@ -74,6 +78,7 @@ namespace XYZ {
 	public:
 		virtual void Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const override;
 		virtual bool TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const override;
+		virtual std::vector<AssetHandle> GetDependencies(const AssetMetadata& metadata) const override;
 	};
 
 	class XYZ_API AnimatedMeshAssetSerializer : public AssetSerializer
@@ -81,6 +86,7 @@ namespace XYZ {
 	public:
 		virtual void Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const override;
 		virtual bool TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const override;
+		virtual std::vector<AssetHandle> GetDependencies(const AssetMetadata& metadata) const override;
 	};
 
 	class XYZ_API PrefabAssetSerializer : public AssetSerializer
@@ -96,6 +102,7 @@ namespace XYZ {
 	public:
 		virtual void Serialize(const AssetMetadata& metadata, const WeakRef<Asset>& asset) const override;
 		virtual bool TryLoadData(const AssetMetadata& metadata, Ref<Asset>& asset) const override;
+		virtual std::vector<AssetHandle> GetDependencies(const AssetMetadata& metadata) const override;
 	};
 
 
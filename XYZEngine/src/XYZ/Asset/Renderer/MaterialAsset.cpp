@@ -60,12 +60,13 @@ namespace XYZ {
 
 		// We want weak ref so Material does not keep MaterialAsset alive
 		WeakRef<MaterialAsset> instance = this;
-		m_Material->m_OnInvalidate = [instance]() mutable {
-			if (instance->IsValid())
+		m_Material->m_OnInvalidate = [instance]() {
+			Ref<MaterialAsset> material = instance.Lock();
+			if (material.Raw() && material->IsValid())
 			{
-				instance->setupTextureBuffers();
-				instance->applyTexturesToMaterial();
-				instance->setupSpecialization();
+				material->setupTextureBuffers();
+				material->applyTexturesToMaterial();
+				material->setupSpecialization();
 			}
 		};
 
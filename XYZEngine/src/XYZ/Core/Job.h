@@ -0,0 +1,190 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+#include "XYZ/Core/Assert.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace XYZ {
+
+	// Type erased move only callable, small callables are stored inline without heap allocation
+	class XYZ_API Job
+	{
+	public:
+		static constexpr size_t sc_InlineSize = 56;
+
+	public:
+		Job() = default;
+		Job(const Job& other) = delete;
+		Job(Job&& other) noexcept;
+
+		template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Job>>>
+		Job(F&& func);
+
+		~Job();
+
+		Job& operator=(const Job& other) = delete;
+		Job& operator=(Job&& other) noexcept;
+
+		void operator()() { m_Operations->Invoke(m_Storage); }
+
+		explicit operator bool() const { return m_Operations != nullptr; }
+
+	private:
+		void reset();
+
+		struct Operations
+		{
+			void(*Invoke)(void* storage);
+			void(*Move)(void* destination, void* source);
+			void(*Destroy)(void* storage);
+		};
+
+		template <typename F>
+		struct InlineOperations
+		{
+			static void Invoke(void* storage) { (*std::launder(reinterpret_cast<F*>(storage)))(); }
+			static void Move(void* destination, void* source)
+			{
+				F* src = std::launder(reinterpret_cast<F*>(source));
+				new (destination) F(std::move(*src));
+				src->~F();
+			}
+			static void Destroy(void* storage) { std::launder(reinterpret_cast<F*>(storage))->~F(); }
+
+			static constexpr Operations Table = { Invoke, Move, Destroy };
+		};
+
+		template <typename F>
+		struct HeapOperations
+		{
+			static F*& Get(void* storage) { return *std::launder(reinterpret_cast<F**>(storage)); }
+
+			static void Invoke(void* storage) { (*Get(storage))(); }
+			static void Move(void* destination, void* source) { new (destination) F*(Get(source)); }
+			static void Destroy(void* storage) { delete Get(storage); }
+
+			static constexpr Operations Table = { Invoke, Move, Destroy };
+		};
+
+		template <typename F>
+		static constexpr bool storedInline()
+		{
+			return sizeof(F) <= sc_InlineSize
+				&& alignof(std::max_align_t) % alignof(F) == 0
+				&& std::is_nothrow_move_constructible_v<F>;
+		}
+
+	private:
+		alignas(std::max_align_t) std::byte m_Storage[sc_InlineSize];
+		const Operations* m_Operations = nullptr;
+	};
+
+
+	// Counter of unfinished jobs, ThreadPool::Wait blocks until all jobs pushed with the group are finished.
+	// Jobs pushed with ThreadPool::PushJobAfter are started once the dependency group reaches zero
+	class XYZ_API JobGroup
+	{
+	public:
+		JobGroup();
+		JobGroup(const JobGroup& other) = delete;
+		JobGroup(JobGroup&& other) = delete;
+		~JobGroup();
+
+		bool	 IsDone() const;
+		uint32_t GetPendingCount() const { return m_Counter.load(std::memory_order_acquire); }
+
+	private:
+		struct Continuation
+		{
+			Job		  Task;
+			JobGroup* Group;
+		};
+
+		std::atomic_uint32_t	  m_Counter;
+		std::atomic_uint32_t	  m_Finishing;
+		std::mutex				  m_ContinuationMutex;
+		std::vector<Continuation> m_Continuations;
+
+		friend class ThreadPool;
+	};
+
+
+	template <typename F, typename>
+	inline Job::Job(F&& func)
+	{
+		using Func = std::decay_t<F>;
+		if constexpr (storedInline<Func>())
+		{
+			new (m_Storage) Func(std::forward<F>(func));
+			m_Operations = &InlineOperations<Func>::Table;
+		}
+		else
+		{
+			new (m_Storage) Func*(new Func(std::forward<F>(func)));
+			m_Operations = &HeapOperations<Func>::Table;
+		}
+	}
+
+	inline Job::Job(Job&& other) noexcept
+		:
+		m_Operations(other.m_Operations)
+	{
+		if (m_Operations)
+		{
+			m_Operations->Move(m_Storage, other.m_Storage);
+			other.m_Operations = nullptr;
+		}
+	}
+
+	inline Job::~Job()
+	{
+		reset();
+	}
+
+	inline Job& Job::operator=(Job&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			m_Operations = other.m_Operations;
+			if (m_Operations)
+			{
+				m_Operations->Move(m_Storage, other.m_Storage);
+				other.m_Operations = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	inline void Job::reset()
+	{
+		if (m_Operations)
+		{
+			m_Operations->Destroy(m_Storage);
+			m_Operations = nullptr;
+		}
+	}
+
+
+	inline JobGroup::JobGroup()
+		:
+		m_Counter(0),
+		m_Finishing(0)
+	{
+	}
+
+	inline JobGroup::~JobGroup()
+	{
+		XYZ_ASSERT(IsDone(), "Destroying job group with unfinished jobs");
+	}
+
+	inline bool JobGroup::IsDone() const
+	{
+		return m_Counter.load() == 0 && m_Finishing.load() == 0;
+	}
+}
@@ -5,31 +5,69 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 
 
 namespace XYZ {
+	// Intrusive reference count. Weak block is allocated only when the first WeakRef is taken,
+	// it outlives the object while any WeakRef points to it. Block is expired under its mutex
+	// before the object is deleted, so WeakRef::Lock can not take a reference to a dying object
 	class XYZ_API RefCount
 	{
 	public:
-		RefCount()
-		{
-			m_RefCount = std::make_shared<std::atomic_uint32_t>(0);
-		}
+		RefCount() = default;
+
+		// Copy of the object has its own references
+		RefCount(const RefCount&) {}
+		RefCount& operator=(const RefCount&) { return *this; }
+
+		virtual ~RefCount();
 
-		virtual ~RefCount() = default;
+		uint32_t GetRefCount() const { return m_RefCount.load(std::memory_order_relaxed); }
 
 	private:
+		struct WeakBlock
+		{
+			std::atomic_uint32_t Count{ 1 }; // Held by the object
+			std::atomic_bool	 Alive{ true };
+			std::mutex			 Mutex;
+
+			void Acquire() { Count.fetch_add(1, std::memory_order_relaxed); }
+			void Release()
+			{
+				if (Count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					delete this;
+			}
+		};
+
 		void IncRefCount() const
 		{
-			(*m_RefCount)++;
+			m_RefCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		// Returns true if the last reference was released
+		bool DecRefCount() const
+		{
+			return m_RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1;
 		}
-		void DecRefCount() const
+		// Fails if no reference is held, object is not brought back to life
+		bool tryIncRefCount() const
 		{
-			(*m_RefCount)--;
+			uint32_t count = m_RefCount.load(std::memory_order_relaxed);
+			while (count != 0)
+			{
+				if (m_RefCount.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel))
+					return true;
+			}
+			return false;
 		}
 
+		void expireWeakBlock() const;
+
+		WeakBlock* acquireWeakBlock() const;
+
 	private:
-		mutable std::shared_ptr<std::atomic_uint32_t> m_RefCount;
+		mutable std::atomic_uint32_t	m_RefCount{ 0 };
+		mutable std::atomic<WeakBlock*> m_WeakBlock{ nullptr };
 
 		template<typename T>
 		friend class Ref;
@@ -37,6 +75,41 @@ namespace XYZ {
 		template <typename T>
 		friend class WeakRef;
 	};
+
+	inline RefCount::~RefCount()
+	{
+		// Objects not owned by Ref are expired here
+		expireWeakBlock();
+		WeakBlock* block = m_WeakBlock.load(std::memory_order_acquire);
+		if (block)
+			block->Release();
+	}
+
+	inline void RefCount::expireWeakBlock() const
+	{
+		WeakBlock* block = m_WeakBlock.load(std::memory_order_acquire);
+		if (block)
+		{
+			std::scoped_lock lock(block->Mutex);
+			block->Alive.store(false, std::memory_order_release);
+		}
+	}
+
+	inline RefCount::WeakBlock* RefCount::acquireWeakBlock() const
+	{
+		WeakBlock* block = m_WeakBlock.load(std::memory_order_acquire);
+		if (!block)
+		{
+			// Two threads can take the first WeakRef at once, only one block is kept
+			WeakBlock* created = new WeakBlock();
+			if (m_WeakBlock.compare_exchange_strong(block, created, std::memory_order_acq_rel))
+				block = created;
+			else
+				delete created;
+		}
+		block->Acquire();
+		return block;
+	}
 	
 	
 	template<typename T>
@@ -56,11 +129,13 @@ namespace XYZ {
 
 		
 		Ref(const Ref<T>& other);
+		Ref(Ref<T>&& other) noexcept;
 		
 		Ref& operator=(std::nullptr_t);
 
 		
 		Ref& operator=(const Ref<T>& other);
+		Ref& operator=(Ref<T>&& other) noexcept;
 
 		
 		template<typename T2>
@@ -95,6 +170,13 @@ namespace XYZ {
 		template<typename... Args>
 		static Ref<T> Create(Args&&... args);
 	private:
+		struct AdoptTag {};
+
+		// Takes over reference that was already counted
+		Ref(T* instance, AdoptTag)
+			: m_Instance(instance)
+		{}
+
 		void incRef() const;
 		
 		void decRef() const;
@@ -103,6 +185,9 @@ namespace XYZ {
 
 		template<class T22>
 		friend class Ref;
+
+		template <typename T22>
+		friend class WeakRef;
 	};
 	template<typename T>
 	inline Ref<T>::Ref()
@@ -151,6 +236,13 @@ namespace XYZ {
 		incRef();
 	}
 
+	template <typename T>
+	Ref<T>::Ref(Ref<T>&& other) noexcept
+	: m_Instance(other.m_Instance)
+	{
+		other.m_Instance = nullptr;
+	}
+
 	template <typename T>
 	Ref<T>& Ref<T>::operator=(std::nullptr_t)
 	{
@@ -169,6 +261,18 @@ namespace XYZ {
 		return *this;
 	}
 
+	template <typename T>
+	Ref<T>& Ref<T>::operator=(Ref<T>&& other) noexcept
+	{
+		// Reference is taken over, self move keeps it
+		T* instance = other.m_Instance;
+		other.m_Instance = nullptr;
+		decRef();
+
+		m_Instance = instance;
+		return *this;
+	}
+
 	template <typename T>
 	template <typename T2>
 	Ref<T>& Ref<T>::operator=(const Ref<T2>& other)
@@ -184,10 +288,11 @@ namespace XYZ {
 	template <typename T2>
 	Ref<T>& Ref<T>::operator=(Ref<T2>&& other)
 	{
+		T* instance = (T*)other.m_Instance;
+		other.m_Instance = nullptr;
 		decRef();
 
-		m_Instance = other.m_Instance;
-		other.m_Instance = nullptr;
+		m_Instance = instance;
 		return *this;
 	}
 
@@ -281,13 +386,10 @@ namespace XYZ {
 	template <typename T>
 	void Ref<T>::decRef() const
 	{
-		if (m_Instance)
+		if (m_Instance && m_Instance->DecRefCount())
 		{
-			m_Instance->DecRefCount();
-			if (*m_Instance->m_RefCount == 0)
-			{
-				delete m_Instance;
-			}
+			m_Instance->expireWeakBlock();
+			delete m_Instance;
 		}
 	}
 }
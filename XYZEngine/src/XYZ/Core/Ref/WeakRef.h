@@ -8,11 +8,9 @@ namespace XYZ {
 	public:
 		WeakRef() = default;
 
-		WeakRef(Ref<T> ref)
+		WeakRef(const Ref<T>& ref)
+			: WeakRef(const_cast<T*>(ref.Raw()))
 		{
-			m_Instance = ref.Raw();
-			if (m_Instance)
-				m_RefCount = m_Instance->m_RefCount;
 		}
 
 		WeakRef(T* instance)
@@ -20,7 +18,44 @@ namespace XYZ {
 			static_assert(std::is_base_of_v<RefCount, T>, "Type T must inherit from RefCount");
 			m_Instance = instance;
 			if (m_Instance)
-				m_RefCount = m_Instance->m_RefCount;
+				m_Block = m_Instance->acquireWeakBlock();
+		}
+
+		WeakRef(const WeakRef<T>& other)
+			: WeakRef(other.m_Instance, other.m_Block)
+		{
+		}
+
+		WeakRef(WeakRef<T>&& other) noexcept
+			: m_Instance(other.m_Instance), m_Block(other.m_Block)
+		{
+			other.m_Instance = nullptr;
+			other.m_Block = nullptr;
+		}
+
+		~WeakRef()
+		{
+			if (m_Block)
+				m_Block->Release();
+		}
+
+		WeakRef& operator=(const WeakRef<T>& other)
+		{
+			if (other.m_Block)
+				other.m_Block->Acquire();
+			if (m_Block)
+				m_Block->Release();
+
+			m_Instance = other.m_Instance;
+			m_Block = other.m_Block;
+			return *this;
+		}
+
+		WeakRef& operator=(WeakRef<T>&& other) noexcept
+		{
+			std::swap(m_Instance, other.m_Instance);
+			std::swap(m_Block, other.m_Block);
+			return *this;
 		}
 
 		T* operator->() { return m_Instance; }
@@ -29,21 +64,54 @@ namespace XYZ {
 		T& operator*() { return *m_Instance; }
 		const T& operator*() const { return *m_Instance; }
 
-		bool IsValid() const { return m_RefCount ? *m_RefCount != 0 : false; }
+		// True while the object is owned by at least one Ref. Result can change right after the call,
+		// use Lock to access the object from multiple threads
+		bool IsValid() const
+		{
+			if (!m_Block)
+				return false;
+
+			std::scoped_lock lock(m_Block->Mutex);
+			return m_Block->Alive.load(std::memory_order_acquire) && m_Instance->GetRefCount() != 0;
+		}
 		
 		operator bool() const { return IsValid(); }
+
+		// Returns strong reference or null if the object is destroyed or being destroyed
+		Ref<T> Lock() const
+		{
+			if (!m_Block)
+				return Ref<T>();
+
+			std::scoped_lock lock(m_Block->Mutex);
+			if (m_Block->Alive.load(std::memory_order_acquire) && m_Instance->tryIncRefCount())
+				return Ref<T>(m_Instance, typename Ref<T>::AdoptTag{});
+			return Ref<T>();
+		}
 	
 		T* Raw() { return m_Instance; }
 		const T* Raw() const { return m_Instance; }
 
+		// Shares weak block, does not touch the instance which might be destroyed
 		template <typename T2>
-		WeakRef<T2> As() { return WeakRef<T2>((T2*)m_Instance); }
+		WeakRef<T2> As() { return WeakRef<T2>((T2*)m_Instance, m_Block); }
 
 		template <typename T2>
-		const WeakRef<T2> As() const { return WeakRef<T2>((T2*)m_Instance); }
+		const WeakRef<T2> As() const { return WeakRef<T2>((T2*)m_Instance, m_Block); }
 
 	private:
-		T* m_Instance = nullptr;
-		std::shared_ptr<const std::atomic_uint32_t> m_RefCount;
+		WeakRef(T* instance, RefCount::WeakBlock* block)
+			: m_Instance(instance), m_Block(block)
+		{
+			if (m_Block)
+				m_Block->Acquire();
+		}
+
+	private:
+		T*					 m_Instance = nullptr;
+		RefCount::WeakBlock* m_Block = nullptr;
+
+		template <typename T2>
+		friend class WeakRef;
 	};
-}
\ No newline at end of file
+}
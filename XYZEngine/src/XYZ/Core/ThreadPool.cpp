@@ -5,10 +5,18 @@
 
 
 namespace XYZ {
+
+	static thread_local ThreadPool* s_WorkerPool = nullptr;
+	static thread_local uint32_t	s_WorkerIndex = 0;
+
 	ThreadPool::ThreadPool()
 		:
 		m_Running(false),
-		m_Waiting(false)
+		m_QueuedJobs(0),
+		m_ActiveJobs(0),
+		m_SleepingWorkers(0),
+		m_NextQueue(0),
+		m_BlockedWaiters(0)
 	{
 	}
 
@@ -22,14 +30,25 @@ namespace XYZ {
 	{
 		if (!m_Running)
 		{
-			m_Running = true;
 			if (numThreads > std::thread::hardware_concurrency())
 				XYZ_CORE_WARN("Creating more threads than the maximum number of threads");
+
+			numThreads = std::max(numThreads, 1u);
+			for (uint32_t i = 0; i < numThreads; ++i)
+				m_Queues.push_back(CreateScope<WorkerQueue>());
 			{
-				std::unique_lock<std::mutex> lock(m_JobMutex);
-				for (uint32_t i = 0; i < numThreads; ++i)
-					m_Threads.push_back(std::thread(&ThreadPool::worker, this));
+				// Jobs pushed before Start are distributed to worker queues
+				std::scoped_lock lock(m_PendingMutex);
+				for (auto& job : m_PendingJobs)
+				{
+					m_Queues[m_NextQueue.fetch_add(1) % numThreads]->Jobs.push_back(std::move(job));
+					m_QueuedJobs.fetch_add(1);
+				}
+				m_PendingJobs.clear();
+				m_Running = true;
 			}
+			for (uint32_t i = 0; i < numThreads; ++i)
+				m_Threads.push_back(std::thread(&ThreadPool::worker, this, i));
 		}
 	}
 
@@ -39,6 +58,9 @@ namespace XYZ {
 		{
 			WaitForJobs();
 			m_Running = false;
+			{
+				std::scoped_lock lock(m_SleepMutex);
+			}
 			m_JobAvailableCV.notify_all(); // wake up all threads.
 
 			for (size_t i = 0; i < m_Threads.size(); ++i)
@@ -46,33 +68,207 @@ namespace XYZ {
 				m_Threads[i].join();
 			}
 			m_Threads.clear();
+			m_Queues.clear();
 		}
 	}
 	void ThreadPool::WaitForJobs()
 	{
-		m_Waiting = true;
-		std::unique_lock<std::mutex> lock(m_JobMutex);
-		m_JobDoneCV.wait(lock, [this] { return m_JobQueue.empty(); });
-		m_Waiting = false;
+		std::unique_lock<std::mutex> lock(m_DoneMutex);
+		m_JobDoneCV.wait(lock, [this] { return m_ActiveJobs.load() == 0; });
+	}
+	void ThreadPool::Wait(JobGroup& group)
+	{
+		XYZ_PROFILE_FUNC("ThreadPool::Wait");
+		uint32_t failedPops = 0;
+		while (!group.IsDone())
+		{
+			QueuedJob job;
+			if (tryPopJob(job))
+			{
+				executeJob(job);
+				failedPops = 0;
+				continue;
+			}
+			if (++failedPops < sc_WaitSpinCount)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			// Remaining jobs of the group are running on other threads. Other jobs of the group
+			// can still be finishing when the counter reaches zero, the loop spins until they are done
+			std::unique_lock<std::mutex> lock(m_WaitMutex);
+			m_BlockedWaiters.fetch_add(1);
+			m_WaitCV.wait(lock, [&] { return group.GetPendingCount() == 0 || m_QueuedJobs.load() > 0; });
+			m_BlockedWaiters.fetch_sub(1);
+			failedPops = 0;
+		}
+	}
+	bool ThreadPool::IsWorkerThread() const
+	{
+		return s_WorkerPool == this;
 	}
-	void ThreadPool::worker()
+	void ThreadPool::pushJob(Job&& job, JobGroup* group)
+	{
+		if (group)
+			group->m_Counter.fetch_add(1);
+
+		enqueue({ std::move(job), group });
+	}
+	void ThreadPool::pushJobAfter(JobGroup& dependency, Job&& job, JobGroup* group)
+	{
+		if (group)
+			group->m_Counter.fetch_add(1);
+		{
+			std::scoped_lock lock(dependency.m_ContinuationMutex);
+			if (dependency.m_Counter.load() != 0)
+			{
+				dependency.m_Continuations.push_back({ std::move(job), group });
+				return;
+			}
+		}
+		enqueue({ std::move(job), group });
+	}
+	void ThreadPool::enqueue(QueuedJob&& job)
+	{
+		m_ActiveJobs.fetch_add(1);
+		if (!m_Running)
+		{
+			// Job waits until the pool is started
+			std::scoped_lock lock(m_PendingMutex);
+			if (!m_Running)
+			{
+				m_PendingJobs.push_back(std::move(job));
+				return;
+			}
+		}
+
+		m_QueuedJobs.fetch_add(1);
+		if (IsWorkerThread())
+		{
+			WorkerQueue& queue = *m_Queues[s_WorkerIndex];
+			std::scoped_lock lock(queue.Mutex);
+			queue.Jobs.push_front(std::move(job));
+		}
+		else
+		{
+			WorkerQueue& queue = *m_Queues[m_NextQueue.fetch_add(1) % m_Queues.size()];
+			std::scoped_lock lock(queue.Mutex);
+			queue.Jobs.push_back(std::move(job));
+		}
+
+		if (m_SleepingWorkers.load() != 0)
+		{
+			{
+				std::scoped_lock lock(m_SleepMutex);
+			}
+			m_JobAvailableCV.notify_one();
+		}
+		notifyWaiters(); // Blocked waiter can execute the job
+	}
+	bool ThreadPool::tryPopJob(QueuedJob& job)
+	{
+		const uint32_t numQueues = static_cast<uint32_t>(m_Queues.size());
+		if (numQueues == 0)
+			return false;
+
+		uint32_t start = 0;
+		if (IsWorkerThread())
+		{
+			WorkerQueue& queue = *m_Queues[s_WorkerIndex];
+			std::scoped_lock lock(queue.Mutex);
+			if (!queue.Jobs.empty())
+			{
+				job = std::move(queue.Jobs.front());
+				queue.Jobs.pop_front();
+				m_QueuedJobs.fetch_sub(1);
+				return true;
+			}
+			start = s_WorkerIndex + 1;
+		}
+
+		for (uint32_t i = 0; i < numQueues; ++i)
+		{
+			WorkerQueue& queue = *m_Queues[(start + i) % numQueues];
+			std::scoped_lock lock(queue.Mutex);
+			if (!queue.Jobs.empty())
+			{
+				job = std::move(queue.Jobs.back());
+				queue.Jobs.pop_back();
+				m_QueuedJobs.fetch_sub(1);
+				return true;
+			}
+		}
+		return false;
+	}
+	void ThreadPool::executeJob(QueuedJob& job)
+	{
+		job.Task();
+		job.Task = Job(); // Release captured resources before the job is reported as finished
+		if (job.Group)
+			finishGroup(*job.Group);
+
+		if (m_ActiveJobs.fetch_sub(1) == 1)
+		{
+			{
+				std::scoped_lock lock(m_DoneMutex);
+			}
+			m_JobDoneCV.notify_all();
+		}
+	}
+	void ThreadPool::finishGroup(JobGroup& group)
+	{
+		// m_Finishing keeps the group alive for waiters until continuations are flushed
+		group.m_Finishing.fetch_add(1);
+		const bool finished = group.m_Counter.fetch_sub(1) == 1;
+		if (finished)
+		{
+			std::vector<JobGroup::Continuation> continuations;
+			{
+				std::scoped_lock lock(group.m_ContinuationMutex);
+				continuations.swap(group.m_Continuations);
+			}
+			for (auto& continuation : continuations)
+				enqueue({ std::move(continuation.Task), continuation.Group });
+		}
+		group.m_Finishing.fetch_sub(1);
+
+		// Group can be destroyed by its waiter from now on
+		if (finished)
+			notifyWaiters();
+	}
+	void ThreadPool::notifyWaiters()
+	{
+		if (m_BlockedWaiters.load() != 0)
+		{
+			{
+				std::scoped_lock lock(m_WaitMutex);
+			}
+			m_WaitCV.notify_all();
+		}
+	}
+	void ThreadPool::worker(uint32_t index)
 	{
-		Job job;
 		XYZ_PROFILE_THREAD("WorkerThread");
+		s_WorkerPool = this;
+		s_WorkerIndex = index;
 
 		while (true)
 		{
+			QueuedJob job;
+			if (tryPopJob(job))
 			{
-				std::unique_lock<std::mutex> lock(m_JobMutex);
-				m_JobAvailableCV.wait(lock, [&] { return !m_JobQueue.empty() || !m_Running; });
-				if (!m_Running && m_JobQueue.empty())
-					return;
-
-				job = std::move(m_JobQueue.front());
-				m_JobQueue.pop();
+				executeJob(job);
+				continue;
 			}
-			job();		
+
+			std::unique_lock<std::mutex> lock(m_SleepMutex);
+			m_SleepingWorkers.fetch_add(1);
+			m_JobAvailableCV.wait(lock, [&] { return m_QueuedJobs.load() > 0 || !m_Running; });
+			m_SleepingWorkers.fetch_sub(1);
+			if (!m_Running && m_QueuedJobs.load() <= 0)
+				return;
 		}
 	}
-	
-}
\ No newline at end of file
+
+}
@@ -1,18 +1,24 @@
 #pragma once
-#include "XYZ/Utils/DataStructures/ThreadQueue.h"
-#include "XYZ/Utils/DataStructures/FreeList.h"
 #include "XYZ/Core/Core.h"
+#include "XYZ/Core/Job.h"
 
 #include <thread>
 #include <future>
 #include <mutex>
-#include <queue>
+#include <deque>
+#include <tuple>
 
 namespace XYZ {
 
+	// Work stealing thread pool, every worker owns a deque of jobs.
+	// Jobs pushed from outside of the pool are distributed round robin and keep FIFO order per worker,
+	// jobs pushed from inside of a job go to the front of the current worker's deque.
+	// Idle workers steal from the back of other deques
 	class XYZ_API ThreadPool
 	{
-		using Job = std::function<void()>;
+	public:
+		static constexpr uint32_t sc_WaitSpinCount = 16; // Failed pops before Wait blocks
+
 	public:
 		ThreadPool();
 		ThreadPool(const ThreadPool& other) = delete;
@@ -22,57 +28,175 @@ namespace XYZ {
 		void Stop();
 
 		void WaitForJobs();
+		// Executes queued jobs while the group is not done, blocks if there is nothing to execute
+		void Wait(JobGroup& group);
 
 		template <typename F, typename... A>
 		void PushJob(F&& task, A&&... args);
-		
+
+		template <typename F, typename... A>
+		void PushJob(JobGroup& group, F&& task, A&&... args);
+
+		// Starts the job after all jobs of dependency are finished, the job is counted in group
+		template <typename F, typename... A>
+		void PushJobAfter(JobGroup& dependency, JobGroup& group, F&& task, A&&... args);
+
 		template <typename F, typename... A, typename R = std::invoke_result_t<std::decay_t<F>, std::decay_t<A>...>>
-		std::future<R> SubmitJob(F&& task, A&&... args);	
+		std::future<R> SubmitJob(F&& task, A&&... args);
+
+		// Splits [0, count) to batches of batchSize, func is invoked either as func(begin, end) or func(index).
+		// Calling thread executes jobs while waiting
+		template <typename F>
+		void ParallelFor(uint32_t count, uint32_t batchSize, F&& func);
 
-	private:	
-		void worker();
+		uint32_t GetNumThreads() const { return static_cast<uint32_t>(m_Threads.size()); }
+		bool	 IsWorkerThread() const;
+
+	private:
+		struct QueuedJob
+		{
+			Job		  Task;
+			JobGroup* Group = nullptr;
+		};
+
+		struct WorkerQueue
+		{
+			std::mutex			  Mutex;
+			std::deque<QueuedJob> Jobs;
+		};
+
+		void pushJob(Job&& job, JobGroup* group);
+		void pushJobAfter(JobGroup& dependency, Job&& job, JobGroup* group);
+		void enqueue(QueuedJob&& job);
+		bool tryPopJob(QueuedJob& job);
+		void executeJob(QueuedJob& job);
+		void finishGroup(JobGroup& group);
+		void notifyWaiters();
+		void worker(uint32_t index);
+
+		template <typename F, typename... A>
+		static auto bindTask(F&& task, A&&... args);
+
+		template <typename F, typename... A>
+		static Job makeJob(F&& task, A&&... args) { return Job(bindTask(std::forward<F>(task), std::forward<A>(args)...)); }
+
+		template <typename F>
+		static void invokeRange(F& func, uint32_t begin, uint32_t end);
 
 	private:
 		std::atomic_bool		 m_Running;
-		std::atomic_bool		 m_Waiting;
 		std::vector<std::thread> m_Threads;
+		std::vector<Scope<WorkerQueue>> m_Queues;
 
-		std::mutex				m_JobMutex;
-		std::queue<Job>			m_JobQueue;
+		// Jobs pushed before Start
+		std::mutex				m_PendingMutex;
+		std::deque<QueuedJob>	m_PendingJobs;
+
+		std::atomic_int32_t		m_QueuedJobs;
+		std::atomic_uint32_t	m_ActiveJobs;
+		std::atomic_uint32_t	m_SleepingWorkers;
+		std::atomic_uint32_t	m_NextQueue;
+
+		std::mutex				m_SleepMutex;
 		std::condition_variable m_JobAvailableCV;
+		std::mutex				m_DoneMutex;
 		std::condition_variable m_JobDoneCV;
+
+		// Threads blocked in Wait, woken when a group finishes or a job is queued
+		std::atomic_uint32_t	m_BlockedWaiters;
+		std::mutex				m_WaitMutex;
+		std::condition_variable m_WaitCV;
 	};
 
 
 	template<typename F, typename ...A>
 	inline void ThreadPool::PushJob(F&& task, A && ...args)
 	{
-		Job taskFunction = std::bind(std::forward<F>(task), std::forward<A>(args)...);
-		{
-			const std::scoped_lock jobsLock(m_JobMutex);
-			m_JobQueue.push(taskFunction);
-		}
-		m_JobAvailableCV.notify_one();
+		pushJob(makeJob(std::forward<F>(task), std::forward<A>(args)...), nullptr);
+	}
+
+	template<typename F, typename ...A>
+	inline void ThreadPool::PushJob(JobGroup& group, F&& task, A && ...args)
+	{
+		pushJob(makeJob(std::forward<F>(task), std::forward<A>(args)...), &group);
+	}
+
+	template<typename F, typename ...A>
+	inline void ThreadPool::PushJobAfter(JobGroup& dependency, JobGroup& group, F&& task, A && ...args)
+	{
+		pushJobAfter(dependency, makeJob(std::forward<F>(task), std::forward<A>(args)...), &group);
 	}
 
 	template<typename F, typename ...A, typename R>
 	inline std::future<R> ThreadPool::SubmitJob(F&& task, A && ...args)
 	{
-		std::function<R()> taskFunction = std::bind(std::forward<F>(task), std::forward<A>(args)...);
-		std::shared_ptr<std::promise<R>> taskPromise = std::make_shared<std::promise<R>>();
-		
-		PushJob([taskFunction, taskPromise] {			
+		std::promise<R> taskPromise;
+		std::future<R> taskFuture = taskPromise.get_future();
+
+		pushJob(Job([taskFunction = bindTask(std::forward<F>(task), std::forward<A>(args)...),
+					 taskPromise = std::move(taskPromise)]() mutable {
 			if constexpr (std::is_void_v<R>)
 			{
-				std::invoke(task_function);
-				taskPromise->set_value();
+				std::invoke(taskFunction);
+				taskPromise.set_value();
 			}
 			else
 			{
-				taskPromise->set_value(std::invoke(taskFunction));
-			}			
-		});
-		return taskPromise->get_future();
+				taskPromise.set_value(std::invoke(taskFunction));
+			}
+		}), nullptr);
+		return taskFuture;
+	}
+
+	template<typename F>
+	inline void ThreadPool::ParallelFor(uint32_t count, uint32_t batchSize, F&& func)
+	{
+		if (count == 0)
+			return;
+
+		batchSize = std::max(batchSize, 1u);
+		if (m_Threads.empty() || count <= batchSize)
+		{
+			invokeRange(func, 0, count);
+			return;
+		}
+
+		JobGroup group;
+		for (uint32_t begin = batchSize; begin < count; begin += batchSize)
+		{
+			const uint32_t end = std::min(begin + batchSize, count);
+			pushJob(Job([&func, begin, end]() { invokeRange(func, begin, end); }), &group);
+		}
+		invokeRange(func, 0, batchSize);
+		Wait(group);
 	}
 
-}
\ No newline at end of file
+	template<typename F, typename ...A>
+	inline auto ThreadPool::bindTask(F&& task, A && ...args)
+	{
+		if constexpr (sizeof...(A) == 0)
+		{
+			return std::decay_t<F>(std::forward<F>(task));
+		}
+		else
+		{
+			return [func = std::forward<F>(task), arguments = std::make_tuple(std::forward<A>(args)...)]() mutable -> decltype(auto) {
+				return std::apply(func, arguments);
+			};
+		}
+	}
+
+	template<typename F>
+	inline void ThreadPool::invokeRange(F& func, uint32_t begin, uint32_t end)
+	{
+		if constexpr (std::is_invocable_v<F&, uint32_t, uint32_t>)
+		{
+			func(begin, end);
+		}
+		else
+		{
+			for (uint32_t i = begin; i < end; ++i)
+				func(i);
+		}
+	}
+}
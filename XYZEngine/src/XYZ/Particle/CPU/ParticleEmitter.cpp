@@ -86,17 +86,8 @@ namespace XYZ {
 	void ParticleEmitter::Kill(ParticlePool& data)
 	{
 		XYZ_PROFILE_FUNC("ParticleEmitter::Kill");
-		uint32_t aliveParticles = data.GetAliveParticles();
-		for (uint32_t i = 0; i < aliveParticles; ++i)
-		{
-			if (data.Particles[i].LifeRemaining <= 0.0f)
-			{
-				aliveParticles--;
-				data.Kill(i);
-				if (m_AliveLights != 0)
-					m_AliveLights--;
-			}
-		}
+		const uint32_t killed = data.KillExpired();
+		m_AliveLights -= std::min(killed, m_AliveLights);
 	}
 
 	uint32_t ParticleEmitter::burstEmit()
@@ -125,20 +116,18 @@ namespace XYZ {
 	void ParticleEmitter::generate(ParticlePool& data, uint32_t id) const
 	{
 		data.Wake(id);
-		data.Particles[id].Color = Color;
-		data.Particles[id].TexOffset = glm::vec2(0.0f, 0.0f);
-		data.Particles[id].Size = Size;
-		data.Particles[id].Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-		data.Particles[id].LifeRemaining = LifeTime;
-		data.Particles[id].Velocity = glm::linearRand(MinVelocity, MaxVelocity);
-		data.Particles[id].Position = glm::vec3(0.0f);
-		data.Particles[id].LightColor = LightColor;
-		data.Particles[id].LightIntensity = LightIntensity;
-		data.Particles[id].LightRadius = LightRadius;
+		data.SetColor(id, Color);
+		data.SetTexOffset(id, glm::vec2(0.0f, 0.0f));
+		data.SetSize(id, Size);
+		data.SetRotation(id, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		data.SetLifeRemaining(id, LifeTime);
+		data.SetVelocity(id, glm::linearRand(MinVelocity, MaxVelocity));
+		data.SetPosition(id, glm::vec3(0.0f));
+		data.SetLight(id, LightColor, LightRadius, LightIntensity);
 	}
 	void ParticleEmitter::generateBox(ParticlePool& data, uint32_t id) const
 	{
-		data.Particles[id].Position = glm::linearRand(BoxMin, BoxMax);
+		data.SetPosition(id, glm::linearRand(BoxMin, BoxMax));
 	}
 	void ParticleEmitter::generateCircle(ParticlePool& data, uint32_t id) const
 	{
@@ -152,6 +141,6 @@ namespace XYZ {
 			Radius * cos(theta),
 			Radius * sin(theta)
 		);
-		data.Particles[id].Position = glm::vec3(point.x, point.y, 0.0f);
+		data.SetPosition(id, glm::vec3(point.x, point.y, 0.0f));
 	}
 }
\ No newline at end of file
@@ -2,7 +2,6 @@
 
 #include "XYZ/Core/Timestep.h"
 #include "ParticlePool.h"
-#include "ParticleUpdater.h"
 
 namespace XYZ {
 
@@ -0,0 +1,213 @@
+#include "stdafx.h"
+#include "ParticleKernels.h"
+
+#include "XYZ/Debug/Profiler.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define XYZ_PARTICLES_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define XYZ_PARTICLES_SSE2
+#endif
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+namespace XYZ {
+	namespace ParticleKernels {
+
+		// Kernels are written once against lane type, remainder of range is processed by scalar lane
+		struct ScalarLane
+		{
+			using Type = float;
+			static constexpr uint32_t Width = 1;
+
+			static Type Load(const float* ptr)		  { return *ptr; }
+			static void Store(float* ptr, Type value) { *ptr = value; }
+			static Type Set(float value)			  { return value; }
+			static Type Add(Type a, Type b)			  { return a + b; }
+			static Type Sub(Type a, Type b)			  { return a - b; }
+			static Type Mul(Type a, Type b)			  { return a * b; }
+			static uint32_t LessEqualZero(Type value) { return value <= 0.0f ? 1 : 0; }
+		};
+
+	#if defined(XYZ_PARTICLES_AVX2)
+		struct SimdLane
+		{
+			using Type = __m256;
+			static constexpr uint32_t Width = 8;
+
+			static Type Load(const float* ptr)		  { return _mm256_loadu_ps(ptr); }
+			static void Store(float* ptr, Type value) { _mm256_storeu_ps(ptr, value); }
+			static Type Set(float value)			  { return _mm256_set1_ps(value); }
+			static Type Add(Type a, Type b)			  { return _mm256_add_ps(a, b); }
+			static Type Sub(Type a, Type b)			  { return _mm256_sub_ps(a, b); }
+			static Type Mul(Type a, Type b)			  { return _mm256_mul_ps(a, b); }
+			static uint32_t LessEqualZero(Type value) { return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_LE_OQ))); }
+		};
+	#elif defined(XYZ_PARTICLES_SSE2)
+		struct SimdLane
+		{
+			using Type = __m128;
+			static constexpr uint32_t Width = 4;
+
+			static Type Load(const float* ptr)		  { return _mm_loadu_ps(ptr); }
+			static void Store(float* ptr, Type value) { _mm_storeu_ps(ptr, value); }
+			static Type Set(float value)			  { return _mm_set1_ps(value); }
+			static Type Add(Type a, Type b)			  { return _mm_add_ps(a, b); }
+			static Type Sub(Type a, Type b)			  { return _mm_sub_ps(a, b); }
+			static Type Mul(Type a, Type b)			  { return _mm_mul_ps(a, b); }
+			static uint32_t LessEqualZero(Type value) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(value, _mm_setzero_ps()))); }
+		};
+	#else
+		using SimdLane = ScalarLane;
+	#endif
+
+		static uint32_t PopCount(uint64_t value)
+		{
+		#ifdef _MSC_VER
+			return static_cast<uint32_t>(__popcnt64(value));
+		#else
+			return static_cast<uint32_t>(__builtin_popcountll(value));
+		#endif
+		}
+
+		template <typename Lane>
+		static void Lerp(float* stream, uint32_t i, typename Lane::Type ratio, float start, float end)
+		{
+			Lane::Store(stream + i, Lane::Add(Lane::Set(start), Lane::Mul(Lane::Set(end - start), ratio)));
+		}
+
+		template <typename Lane>
+		static void LerpLights(const ParticleUpdateSettings& s, ParticlePool& pool, uint32_t i, typename Lane::Type ratio)
+		{
+			Lerp<Lane>(pool.GetStream(ParticlePool::LightColorR), i, ratio, s.StartLightColor.r, s.EndLightColor.r);
+			Lerp<Lane>(pool.GetStream(ParticlePool::LightColorG), i, ratio, s.StartLightColor.g, s.EndLightColor.g);
+			Lerp<Lane>(pool.GetStream(ParticlePool::LightColorB), i, ratio, s.StartLightColor.b, s.EndLightColor.b);
+			Lerp<Lane>(pool.GetStream(ParticlePool::LightRadius), i, ratio, s.StartLightRadius, s.EndLightRadius);
+			Lerp<Lane>(pool.GetStream(ParticlePool::LightIntensity), i, ratio, s.StartLightIntensity, s.EndLightIntensity);
+		}
+
+		// Over life modules that need floor or trigonometry run per particle while its data is in cache
+		static void UpdateScalarModules(const ParticleUpdateSettings& settings, ParticlePool& pool, uint32_t i)
+		{
+			const float life = pool.GetLifeRemaining(i);
+			if (settings.RotationOverLife)
+			{
+				const float ratio = (settings.LifeTime - life) / settings.LifeTime;
+				pool.SetRotation(i, glm::quat(glm::radians(settings.EndRotation) * ratio));
+			}
+			if (settings.TextureAnimation)
+			{
+				const glm::ivec2& tiles = settings.AnimationTiles;
+				const float ratio = (settings.AnimationCycleLength - life) / settings.AnimationCycleLength;
+				const float stageProgress = ratio * (tiles.x * tiles.y);
+
+				const uint32_t index = static_cast<uint32_t>(floor(stageProgress));
+				const float column = static_cast<float>(index % tiles.x);
+				const float row = static_cast<float>(index / tiles.y);
+				pool.SetTexOffset(i, glm::vec2(column / tiles.x, row / tiles.y));
+			}
+		}
+
+		// Returns end of processed range, last partial group of lanes is left for the caller
+		template <typename Lane>
+		static uint32_t UpdateLanes(const ParticleUpdateSettings& s, ParticlePool& pool, uint32_t begin, uint32_t end)
+		{
+			using Type = typename Lane::Type;
+			float* positionX = pool.GetStream(ParticlePool::PositionX);
+			float* positionY = pool.GetStream(ParticlePool::PositionY);
+			float* positionZ = pool.GetStream(ParticlePool::PositionZ);
+			const float* velocityX = pool.GetStream(ParticlePool::VelocityX);
+			const float* velocityY = pool.GetStream(ParticlePool::VelocityY);
+			const float* velocityZ = pool.GetStream(ParticlePool::VelocityZ);
+			float* lifeRemaining = pool.GetStream(ParticlePool::LifeRemaining);
+
+			const Type timestep = Lane::Set(s.Timestep);
+			const Type lifeTime = Lane::Set(s.LifeTime);
+			const Type invLifeTime = Lane::Set(1.0f / s.LifeTime);
+			const bool scalarModules = s.RotationOverLife || s.TextureAnimation;
+
+			uint32_t i = begin;
+			for (; i + Lane::Width <= end; i += Lane::Width)
+			{
+				const Type life = Lane::Sub(Lane::Load(lifeRemaining + i), timestep);
+				Lane::Store(lifeRemaining + i, life);
+				Lane::Store(positionX + i, Lane::Add(Lane::Load(positionX + i), Lane::Mul(Lane::Load(velocityX + i), timestep)));
+				Lane::Store(positionY + i, Lane::Add(Lane::Load(positionY + i), Lane::Mul(Lane::Load(velocityY + i), timestep)));
+				Lane::Store(positionZ + i, Lane::Add(Lane::Load(positionZ + i), Lane::Mul(Lane::Load(velocityZ + i), timestep)));
+
+				const Type ratio = Lane::Mul(Lane::Sub(lifeTime, life), invLifeTime);
+				if (s.ColorOverLife)
+				{
+					Lerp<Lane>(pool.GetStream(ParticlePool::ColorR), i, ratio, s.StartColor.r, s.EndColor.r);
+					Lerp<Lane>(pool.GetStream(ParticlePool::ColorG), i, ratio, s.StartColor.g, s.EndColor.g);
+					Lerp<Lane>(pool.GetStream(ParticlePool::ColorB), i, ratio, s.StartColor.b, s.EndColor.b);
+					Lerp<Lane>(pool.GetStream(ParticlePool::ColorA), i, ratio, s.StartColor.a, s.EndColor.a);
+				}
+				if (s.SizeOverLife)
+				{
+					Lerp<Lane>(pool.GetStream(ParticlePool::SizeX), i, ratio, s.StartSize.x, s.EndSize.x);
+					Lerp<Lane>(pool.GetStream(ParticlePool::SizeY), i, ratio, s.StartSize.y, s.EndSize.y);
+					Lerp<Lane>(pool.GetStream(ParticlePool::SizeZ), i, ratio, s.StartSize.z, s.EndSize.z);
+				}
+				if (s.LightOverLife && i < s.MaxLights)
+				{
+					if (i + Lane::Width <= s.MaxLights)
+					{
+						LerpLights<Lane>(s, pool, i, ratio);
+					}
+					else
+					{
+						// Lane crosses MaxLights, only particles below it are lights
+						for (uint32_t j = i; j < s.MaxLights; ++j)
+							LerpLights<ScalarLane>(s, pool, j, (s.LifeTime - lifeRemaining[j]) / s.LifeTime);
+					}
+				}
+				if (scalarModules)
+				{
+					for (uint32_t j = i; j < i + Lane::Width; ++j)
+						UpdateScalarModules(s, pool, j);
+				}
+			}
+			return i;
+		}
+
+		void Update(const ParticleUpdateSettings& settings, ParticlePool& pool, uint32_t begin, uint32_t end)
+		{
+			XYZ_PROFILE_FUNC("ParticleKernels::Update");
+			const uint32_t simdEnd = UpdateLanes<SimdLane>(settings, pool, begin, end);
+			UpdateLanes<ScalarLane>(settings, pool, simdEnd, end);
+		}
+
+		template <typename Lane>
+		static uint64_t ExpiredWord(const float* lifeRemaining, uint32_t begin, uint32_t end)
+		{
+			uint64_t mask = 0;
+			uint32_t i = begin;
+			for (; i + Lane::Width <= end; i += Lane::Width)
+				mask |= static_cast<uint64_t>(Lane::LessEqualZero(Lane::Load(lifeRemaining + i))) << (i - begin);
+
+			for (; i < end; ++i)
+				mask |= static_cast<uint64_t>(ScalarLane::LessEqualZero(lifeRemaining[i])) << (i - begin);
+			return mask;
+		}
+
+		uint32_t ExpiredMask(const float* lifeRemaining, uint32_t count, uint64_t* mask)
+		{
+			XYZ_PROFILE_FUNC("ParticleKernels::ExpiredMask");
+			uint32_t expired = 0;
+			for (uint32_t begin = 0; begin < count; begin += 64)
+			{
+				const uint64_t word = ExpiredWord<SimdLane>(lifeRemaining, begin, std::min(begin + 64, count));
+				mask[begin / 64] = word;
+				expired += PopCount(word);
+			}
+			return expired;
+		}
+	}
+}
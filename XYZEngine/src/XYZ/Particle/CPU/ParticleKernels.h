@@ -0,0 +1,52 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include "ParticlePool.h"
+
+#include <glm/glm.hpp>
+
+namespace XYZ {
+
+	// Everything one update pass needs, disabled modules are skipped
+	struct ParticleUpdateSettings
+	{
+		float		Timestep = 0.0f;
+		float		LifeTime = 1.0f;
+
+		bool		ColorOverLife = false;
+		glm::vec4	StartColor = glm::vec4(1.0f);
+		glm::vec4	EndColor = glm::vec4(1.0f);
+
+		bool		SizeOverLife = false;
+		glm::vec3	StartSize = glm::vec3(1.0f);
+		glm::vec3	EndSize = glm::vec3(1.0f);
+
+		// Only first MaxLights particles carry light
+		bool		LightOverLife = false;
+		uint32_t	MaxLights = 0;
+		glm::vec3	StartLightColor = glm::vec3(1.0f);
+		glm::vec3	EndLightColor = glm::vec3(1.0f);
+		float		StartLightRadius = 1.0f;
+		float		EndLightRadius = 1.0f;
+		float		StartLightIntensity = 1.0f;
+		float		EndLightIntensity = 1.0f;
+
+		bool		RotationOverLife = false;
+		glm::vec3	EndRotation = glm::vec3(0.0f); // Euler angles in degrees
+
+		bool		TextureAnimation = false;
+		glm::ivec2	AnimationTiles = glm::ivec2(1);
+		float		AnimationCycleLength = 1.0f;
+	};
+
+	namespace ParticleKernels {
+
+		// Integrates position and life and applies enabled over life modules in single pass over particles in range.
+		// Uses AVX2 / SSE2 if available at compile time, scalar code otherwise
+		XYZ_API void Update(const ParticleUpdateSettings& settings, ParticlePool& pool, uint32_t begin, uint32_t end);
+
+		// Writes one bit per particle with no life remaining, mask must hold (count + 63) / 64 words.
+		// Returns number of expired particles
+		XYZ_API uint32_t ExpiredMask(const float* lifeRemaining, uint32_t count, uint64_t* mask);
+	}
+}
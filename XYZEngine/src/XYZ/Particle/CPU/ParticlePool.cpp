@@ -1,32 +1,33 @@
 #include "stdafx.h"
 #include "ParticlePool.h"
+#include "ParticleKernels.h"
 
+#include "XYZ/Utils/DataStructures/PackedFreeList.h"
 
 namespace XYZ {
 
+	static constexpr uint32_t sc_FloatsPerAlignment = ParticlePool::sc_StreamAlignment / sizeof(float);
 
 	ParticlePool::ParticlePool(const uint32_t maxParticles)
 		:
+		m_Data(nullptr),
+		m_StreamCapacity(0),
 		m_MaxParticles(maxParticles),
 		m_AliveParticles(0)
 	{
-		if (maxParticles)
-		{
-			generateParticles(maxParticles);
-		}
-		else
-		{
-			Particles	= nullptr;
-		}
+		generateParticles(maxParticles);
 	}
 	ParticlePool::ParticlePool(ParticlePool&& other) noexcept
 	{
-		Particles = other.Particles;
-	
+		m_Data = other.m_Data;
+		memcpy(m_Streams, other.m_Streams, sizeof(m_Streams));
+		m_StreamCapacity = other.m_StreamCapacity;
 		m_MaxParticles = other.m_MaxParticles;
 		m_AliveParticles = other.m_AliveParticles;
+		m_ExpiredMask = std::move(other.m_ExpiredMask);
 
-		other.Particles = nullptr;
+		other.m_Data = nullptr;
+		other.m_StreamCapacity = 0;
 		other.m_MaxParticles = 0;
 		other.m_AliveParticles = 0;
 	}
@@ -37,47 +38,43 @@ namespace XYZ {
 
 	ParticlePool::ParticlePool(const ParticlePool& other)
 		:
+		m_Data(nullptr),
+		m_StreamCapacity(0),
 		m_MaxParticles(other.m_MaxParticles),
 		m_AliveParticles(other.m_AliveParticles)
 	{
-		if (m_MaxParticles)
-		{
-			generateParticles(m_MaxParticles);
-			copyData(other);
-		}
-		else
-		{
-			Particles = nullptr;
-		}
+		generateParticles(m_MaxParticles);
+		copyData(other);
 	}
-	
+
 	ParticlePool& ParticlePool::operator=(const ParticlePool& other)
 	{
+		if (this == &other)
+			return *this;
+
+		deleteParticles();
 		m_MaxParticles = other.m_MaxParticles;
 		m_AliveParticles = other.m_AliveParticles;
-		
-		deleteParticles();
-		if (m_MaxParticles)
-		{
-			generateParticles(m_MaxParticles);
-			copyData(other);
-		}
-		else
-		{
-			Particles = nullptr;
-		}	
+		generateParticles(m_MaxParticles);
+		copyData(other);
 		return *this;
 	}
 
 	ParticlePool& ParticlePool::operator=(ParticlePool&& other) noexcept
 	{
-		deleteParticles();
-		Particles = other.Particles;
+		if (this == &other)
+			return *this;
 
+		deleteParticles();
+		m_Data = other.m_Data;
+		memcpy(m_Streams, other.m_Streams, sizeof(m_Streams));
+		m_StreamCapacity = other.m_StreamCapacity;
 		m_MaxParticles = other.m_MaxParticles;
 		m_AliveParticles = other.m_AliveParticles;
+		m_ExpiredMask = std::move(other.m_ExpiredMask);
 
-		other.Particles = nullptr;
+		other.m_Data = nullptr;
+		other.m_StreamCapacity = 0;
 		other.m_MaxParticles = 0;
 		other.m_AliveParticles = 0;
 		return *this;
@@ -93,39 +90,160 @@ namespace XYZ {
 	void ParticlePool::Wake(uint32_t id)
 	{
 		XYZ_ASSERT(m_AliveParticles < m_MaxParticles, "");
-		Particles[id].Alive = true;
 		m_AliveParticles++;
 	}
 	void ParticlePool::Kill(uint32_t id)
 	{
-		swapData(id, m_AliveParticles - 1);
-		Particles[m_AliveParticles - 1].Alive = false;
+		const uint32_t last = m_AliveParticles - 1;
+		for (float* stream : m_Streams)
+			stream[id] = stream[last];
 		m_AliveParticles--;
 	}
-	void ParticlePool::generateParticles(uint32_t particleCount)
+
+	uint32_t ParticlePool::KillExpired()
+	{
+		const uint32_t count = m_AliveParticles;
+		const uint32_t expired = ParticleKernels::ExpiredMask(m_Streams[LifeRemaining], count, m_ExpiredMask.data());
+		if (expired == 0)
+			return 0;
+
+		// Expired particles before new end are holes, alive particles after it fill them
+		const uint32_t newCount = count - expired;
+		uint32_t sourceWord = newCount / 64;
+		uint64_t sourceBits = ~m_ExpiredMask[sourceWord] & (~0ull << (newCount % 64));
+		for (uint32_t word = 0; word * 64 < newCount; ++word)
+		{
+			uint64_t holes = m_ExpiredMask[word];
+			if (word == newCount / 64)
+				holes &= (1ull << (newCount % 64)) - 1;
+
+			while (holes != 0)
+			{
+				const uint32_t hole = word * 64 + Utils::CountTrailingZeros(holes);
+				holes &= holes - 1;
+				while (sourceBits == 0)
+					sourceBits = ~m_ExpiredMask[++sourceWord];
+
+				const uint32_t source = sourceWord * 64 + Utils::CountTrailingZeros(sourceBits);
+				sourceBits &= sourceBits - 1;
+				for (float* stream : m_Streams)
+					stream[hole] = stream[source];
+			}
+		}
+		m_AliveParticles = newCount;
+		return expired;
+	}
+
+	void ParticlePool::SetPosition(uint32_t id, const glm::vec3& position)
+	{
+		m_Streams[PositionX][id] = position.x;
+		m_Streams[PositionY][id] = position.y;
+		m_Streams[PositionZ][id] = position.z;
+	}
+
+	void ParticlePool::SetVelocity(uint32_t id, const glm::vec3& velocity)
+	{
+		m_Streams[VelocityX][id] = velocity.x;
+		m_Streams[VelocityY][id] = velocity.y;
+		m_Streams[VelocityZ][id] = velocity.z;
+	}
+
+	void ParticlePool::SetColor(uint32_t id, const glm::vec4& color)
 	{
-		Particles = new Particle[particleCount];
-		for (size_t i = 0; i < particleCount; ++i)
-			Particles[i].Alive = false;
+		m_Streams[ColorR][id] = color.r;
+		m_Streams[ColorG][id] = color.g;
+		m_Streams[ColorB][id] = color.b;
+		m_Streams[ColorA][id] = color.a;
 	}
-	void ParticlePool::swapData(uint32_t a, uint32_t b)
+
+	void ParticlePool::SetTexOffset(uint32_t id, const glm::vec2& offset)
+	{
+		m_Streams[TexOffsetX][id] = offset.x;
+		m_Streams[TexOffsetY][id] = offset.y;
+	}
+
+	void ParticlePool::SetSize(uint32_t id, const glm::vec3& size)
+	{
+		m_Streams[SizeX][id] = size.x;
+		m_Streams[SizeY][id] = size.y;
+		m_Streams[SizeZ][id] = size.z;
+	}
+
+	void ParticlePool::SetRotation(uint32_t id, const glm::quat& rotation)
+	{
+		m_Streams[RotationX][id] = rotation.x;
+		m_Streams[RotationY][id] = rotation.y;
+		m_Streams[RotationZ][id] = rotation.z;
+		m_Streams[RotationW][id] = rotation.w;
+	}
+
+	void ParticlePool::SetLight(uint32_t id, const glm::vec3& color, float radius, float intensity)
+	{
+		m_Streams[LightColorR][id] = color.r;
+		m_Streams[LightColorG][id] = color.g;
+		m_Streams[LightColorB][id] = color.b;
+		m_Streams[LightRadius][id] = radius;
+		m_Streams[LightIntensity][id] = intensity;
+	}
+
+	glm::vec3 ParticlePool::GetPosition(uint32_t id) const
+	{
+		return { m_Streams[PositionX][id], m_Streams[PositionY][id], m_Streams[PositionZ][id] };
+	}
+
+	glm::vec4 ParticlePool::GetColor(uint32_t id) const
 	{
-		Particles[a]	= Particles[b];
+		return { m_Streams[ColorR][id], m_Streams[ColorG][id], m_Streams[ColorB][id], m_Streams[ColorA][id] };
 	}
 
-	template <typename T>
-	static void copy(T* dest, T* source, uint32_t count)
+	glm::vec2 ParticlePool::GetTexOffset(uint32_t id) const
 	{
-		memcpy(dest, source, count * sizeof(T));
+		return { m_Streams[TexOffsetX][id], m_Streams[TexOffsetY][id] };
+	}
+
+	glm::vec3 ParticlePool::GetSize(uint32_t id) const
+	{
+		return { m_Streams[SizeX][id], m_Streams[SizeY][id], m_Streams[SizeZ][id] };
+	}
+
+	glm::quat ParticlePool::GetRotation(uint32_t id) const
+	{
+		return glm::quat(m_Streams[RotationW][id], m_Streams[RotationX][id], m_Streams[RotationY][id], m_Streams[RotationZ][id]);
+	}
+
+	glm::vec3 ParticlePool::GetLightColor(uint32_t id) const
+	{
+		return { m_Streams[LightColorR][id], m_Streams[LightColorG][id], m_Streams[LightColorB][id] };
+	}
+
+	void ParticlePool::generateParticles(uint32_t particleCount)
+	{
+		m_StreamCapacity = (particleCount + sc_FloatsPerAlignment - 1) / sc_FloatsPerAlignment * sc_FloatsPerAlignment;
+		m_ExpiredMask.assign((particleCount + 63) / 64, 0);
+		if (m_StreamCapacity == 0)
+		{
+			m_Data = nullptr;
+			std::fill(std::begin(m_Streams), std::end(m_Streams), nullptr);
+			return;
+		}
+
+		const size_t size = sizeof(float) * m_StreamCapacity * NumStreams;
+		m_Data = static_cast<float*>(::operator new[](size, std::align_val_t{ sc_StreamAlignment }));
+		memset(m_Data, 0, size);
+		for (uint32_t i = 0; i < NumStreams; ++i)
+			m_Streams[i] = m_Data + static_cast<size_t>(i) * m_StreamCapacity;
 	}
 
 	void ParticlePool::copyData(const ParticlePool& source)
 	{
-		copy(Particles,   source.Particles,	m_MaxParticles);	
+		if (m_Data)
+			memcpy(m_Data, source.m_Data, sizeof(float) * m_StreamCapacity * NumStreams);
 	}
 
 	void ParticlePool::deleteParticles()
 	{
-		delete[]Particles;
+		if (m_Data)
+			::operator delete[](m_Data, std::align_val_t{ sc_StreamAlignment });
+		m_Data = nullptr;
 	}
-}
\ No newline at end of file
+}
@@ -8,9 +8,28 @@
 
 namespace XYZ {
 
-    
+	// Particle data stored as separate aligned float streams, alive particles are kept
+	// tightly at the start of every stream, so kernels can process multiple particles per instruction
 	class XYZ_API ParticlePool
 	{
+	public:
+        enum Stream : uint32_t
+        {
+            PositionX, PositionY, PositionZ,
+            VelocityX, VelocityY, VelocityZ,
+            ColorR, ColorG, ColorB, ColorA,
+            TexOffsetX, TexOffsetY,
+            SizeX, SizeY, SizeZ,
+            RotationX, RotationY, RotationZ, RotationW,
+            LightColorR, LightColorG, LightColorB,
+            LightRadius,
+            LightIntensity,
+            LifeRemaining,
+            NumStreams
+        };
+
+        static constexpr uint32_t sc_StreamAlignment = 64;
+
 	public:
         ParticlePool(const uint32_t maxParticles);
         ParticlePool(const ParticlePool& other);
@@ -23,38 +42,47 @@ namespace XYZ {
         void SetMaxParticles(uint32_t maxParticles);
         void Wake(uint32_t id);
         void Kill(uint32_t id);
+        void KillAll() { m_AliveParticles = 0; }
 
-        // Default particle data
-        struct Particle
-        {
-            glm::vec3 Position;
-            glm::vec3 Velocity;
-            
-            glm::vec4 Color;
-            glm::vec2 TexOffset;
-            glm::vec3 Size;
-            glm::quat Rotation;
-
-            glm::vec3 LightColor;
-            float     LightRadius;
-            float     LightIntensity;
-
-            float     LifeRemaining;
-            bool      Alive;
-        };
+        // Kills every particle with no life remaining, returns number of killed particles.
+        // Holes are filled with alive particles from the end, order of particles is not kept
+        uint32_t KillExpired();
+
+        float*       GetStream(Stream stream)       { return m_Streams[stream]; }
+        const float* GetStream(Stream stream) const { return m_Streams[stream]; }
+
+        void SetPosition(uint32_t id, const glm::vec3& position);
+        void SetVelocity(uint32_t id, const glm::vec3& velocity);
+        void SetColor(uint32_t id, const glm::vec4& color);
+        void SetTexOffset(uint32_t id, const glm::vec2& offset);
+        void SetSize(uint32_t id, const glm::vec3& size);
+        void SetRotation(uint32_t id, const glm::quat& rotation);
+        void SetLight(uint32_t id, const glm::vec3& color, float radius, float intensity);
+        void SetLifeRemaining(uint32_t id, float life) { m_Streams[LifeRemaining][id] = life; }
 
-        Particle* Particles;
+        glm::vec3 GetPosition(uint32_t id) const;
+        glm::vec4 GetColor(uint32_t id) const;
+        glm::vec2 GetTexOffset(uint32_t id) const;
+        glm::vec3 GetSize(uint32_t id) const;
+        glm::quat GetRotation(uint32_t id) const;
+        glm::vec3 GetLightColor(uint32_t id) const;
+        float     GetLifeRemaining(uint32_t id) const { return m_Streams[LifeRemaining][id]; }
 
         uint32_t GetMaxParticles() const { return m_MaxParticles; }
         uint32_t GetAliveParticles() const { return m_AliveParticles; }
     private:
         void generateParticles(uint32_t particleCount);
         void deleteParticles();
-        void swapData(uint32_t a, uint32_t b);
         void copyData(const ParticlePool& source);
 
     private:
+        float*   m_Data;
+        float*   m_Streams[NumStreams];
+        uint32_t m_StreamCapacity; // Max particles rounded up to stream alignment
+
         uint32_t m_MaxParticles;
         uint32_t m_AliveParticles;
+
+        std::vector<uint64_t> m_ExpiredMask;
     };
-}
\ No newline at end of file
+}
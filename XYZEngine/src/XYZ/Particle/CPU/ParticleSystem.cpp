@@ -14,11 +14,6 @@
 #include <glm/gtx/compatibility.hpp>
 
 namespace XYZ {
-	static float CalcRatio(float length, float value)
-	{
-		return (length - value) / length;
-	}
-
 	void Mat4ToTransformData(glm::vec4* transformRows, const glm::mat4& transform)
 	{
 		transformRows[0] = { transform[0][0], transform[1][0], transform[2][0], transform[3][0] };
@@ -40,7 +35,7 @@ namespace XYZ {
 		Play(true),
 		Speed(1.0f),
 		m_Pool(maxParticles),
-		m_RenderData(maxParticles),
+		m_RenderData{ RenderData(maxParticles), RenderData(maxParticles) },
 		m_MaxParticles(maxParticles)
 	{
 		for (auto& enabled : ModuleEnabled)
@@ -49,57 +44,36 @@ namespace XYZ {
 
 	ParticleSystem::~ParticleSystem()
 	{
+		waitForJobs();
 	}
 
 	ParticleSystem::ParticleSystem(const ParticleSystem& other)
 		:
-		Emitter(other.Emitter),
-		AnimationTiles(other.AnimationTiles),
-		AnimationStartFrame(other.AnimationStartFrame),
-		AnimationCycleLength(other.AnimationCycleLength),
-		EndRotation(other.EndRotation),
-		EndSize(other.EndSize),
-		EndColor(other.EndColor),
-		LightEndColor(other.LightEndColor),
-		LightEndIntensity(other.LightEndIntensity),
-		LightEndRadius(other.LightEndRadius),
-		Play(other.Play),
-		Speed(other.Speed),
-		m_Pool(other.m_Pool),
-		m_RenderData(other.m_RenderData),
-		m_MaxParticles(other.m_MaxParticles)
+		ParticleSystem(0)
 	{
-		for (uint32_t i = 0; i < NumModules; ++i)
-			ModuleEnabled[i] = other.ModuleEnabled[i];
+		*this = other;
 	}
 
 	ParticleSystem::ParticleSystem(ParticleSystem&& other) noexcept
 		:
-		Emitter(other.Emitter),
-		AnimationTiles(other.AnimationTiles),
-		AnimationStartFrame(other.AnimationStartFrame),
-		AnimationCycleLength(other.AnimationCycleLength),
-		EndRotation(other.EndRotation),
-		EndSize(other.EndSize),
-		EndColor(other.EndColor),
-		LightEndColor(other.LightEndColor),
-		LightEndIntensity(other.LightEndIntensity),
-		LightEndRadius(other.LightEndRadius),
-		Play(other.Play),
-		Speed(other.Speed),
-		m_RenderData(std::move(other.m_RenderData)),
-		m_Pool(std::move(other.m_Pool)),
-		m_MaxParticles(other.m_MaxParticles)
+		ParticleSystem(0)
 	{
-		for (uint32_t i = 0; i < NumModules; ++i)
-			ModuleEnabled[i] = other.ModuleEnabled[i];
+		*this = std::move(other);
 	}
 
 	ParticleSystem& ParticleSystem::operator=(const ParticleSystem& other)
 	{	
+		if (this == &other)
+			return *this;
+
+		// Emitter and pool are modified by simulation jobs of both systems
+		waitForJobs();
+		other.waitForJobs();
+
 		Emitter = other.Emitter;
 		AnimationTiles = other.AnimationTiles;
 		AnimationStartFrame = other.AnimationStartFrame;
+		AnimationCycleLength = other.AnimationCycleLength;
 		EndRotation = other.EndRotation;
 		EndSize = other.EndSize;
 		EndColor = other.EndColor;
@@ -113,8 +87,9 @@ namespace XYZ {
 		for (uint32_t i = 0; i < NumModules; ++i)
 			ModuleEnabled[i] = other.ModuleEnabled[i];
 		
-		std::unique_lock lock(m_JobsMutex);
-		m_RenderData = other.m_RenderData;
+		m_RenderData[0] = other.m_RenderData[0];
+		m_RenderData[1] = other.m_RenderData[1];
+		m_ReadIndex = other.m_ReadIndex.load();
 		m_Pool = other.m_Pool;
 		m_MaxParticles = other.m_MaxParticles;
 
@@ -123,9 +98,16 @@ namespace XYZ {
 
 	ParticleSystem& ParticleSystem::operator=(ParticleSystem&& other) noexcept
 	{
+		if (this == &other)
+			return *this;
+
+		waitForJobs();
+		other.waitForJobs();
+
 		Emitter = other.Emitter;
 		AnimationTiles = other.AnimationTiles;
 		AnimationStartFrame = other.AnimationStartFrame;
+		AnimationCycleLength = other.AnimationCycleLength;
 		EndRotation = other.EndRotation;
 		EndSize = other.EndSize;
 		EndColor = other.EndColor;
@@ -137,8 +119,9 @@ namespace XYZ {
 		for (uint32_t i = 0; i < NumModules; ++i)
 			ModuleEnabled[i] = other.ModuleEnabled[i];
 
-		std::unique_lock lock(m_JobsMutex);
-		m_RenderData = std::move(other.m_RenderData);
+		m_RenderData[0] = std::move(other.m_RenderData[0]);
+		m_RenderData[1] = std::move(other.m_RenderData[1]);
+		m_ReadIndex = other.m_ReadIndex.load();
 		m_Pool = std::move(other.m_Pool);
 		m_MaxParticles = other.m_MaxParticles;
 		return *this;
@@ -156,16 +139,20 @@ namespace XYZ {
 
 	void ParticleSystem::Reset()
 	{
-		std::unique_lock lock(m_JobsMutex);
-		for (uint32_t i = 0; i < m_Pool.GetAliveParticles(); ++i)
-			m_Pool.Kill(i);
+		waitForJobs();
+		m_Pool.KillAll();
+		m_RenderData[0].ParticleCount = 0;
+		m_RenderData[1].ParticleCount = 0;
 	}
 
 	void ParticleSystem::SetMaxParticles(uint32_t maxParticles)
 	{
-		std::unique_lock lock(m_JobsMutex);
-
-		m_RenderData.ParticleData.resize(maxParticles);
+		waitForJobs();
+		for (auto& renderData : m_RenderData)
+		{
+			renderData.ParticleData.resize(maxParticles);
+			renderData.ParticleCount = std::min(renderData.ParticleCount, maxParticles);
+		}
 		m_Pool.SetMaxParticles(maxParticles);
 		m_MaxParticles = maxParticles;
 	}
@@ -181,281 +168,143 @@ namespace XYZ {
 	}
 	void ParticleSystem::pushJobs(const glm::mat4& transform, Timestep ts)
 	{
-		XYZ_PROFILE_FUNC("ParticleSystem::pushJobsManyThreads");
+		XYZ_PROFILE_FUNC("ParticleSystem::pushJobs");
 		if (m_MaxParticles == 0)
 			return;
 
-		if (m_JobsCount != 0) // If we did not finish previous jobs, skip one update frame
+		if (!jobsFinished()) // Previous frame is still simulated, timestep is kept for the next one
+		{
+			m_Stats.SkippedFrames++;
 			return;
+		}
+		m_Stats.SimulatedFrames++;
 
-		pushMainJob(ts);
-	
-		if (ModuleEnabled[RotationOverLife])
-			pushRotationJob();
-		if (ModuleEnabled[SizeOverLife])
-			pushSizeOverLifeJob();
-		if (ModuleEnabled[ColorOverLife])
-			pushColorOverLifeJob();
-		if (ModuleEnabled[TextureAnimation])
-			pushAnimationJob();	
-		if (ModuleEnabled[LightOverLife])
-			pushLightOverLifeJob();
-
-
-		pushBuildLightsDataJob(transform);
-		pushBuildRenderDataJobs(transform);
-
+		m_FrameSettings = createUpdateSettings(ts);
+		m_FrameTransform = transform;
 		m_Timestep = 0;
-	}
-
-	void ParticleSystem::pushMainJob(Timestep ts)
-	{
-		m_JobsCount++;
-		Ref<ParticleSystem> instance = this;
-		Application::Get().GetThreadPool().PushJob([instance, ts]() mutable {
-
-			XYZ_PROFILE_FUNC("ParticleSystem::pushMainJob");
-			std::unique_lock lock(instance->m_JobsMutex);
-			
 
+		// Jobs do not keep the system alive, it waits for them when destroyed
+		ParticleSystem* instance = this;
+		Application::Get().GetThreadPool().PushJob(m_EmitGroup, [instance]() {
+			XYZ_PROFILE_FUNC("ParticleSystem::emitJob");
 			instance->Emitter.Kill(instance->m_Pool);
-			instance->Emitter.Emit(ts, instance->m_Pool);
-
-			const uint32_t aliveParticles = instance->m_Pool.GetAliveParticles();
-			for (uint32_t i = 0; i < aliveParticles; ++i)
-			{
-				instance->m_Pool.Particles[i].Position += instance->m_Pool.Particles[i].Velocity * ts.GetSeconds();
-				instance->m_Pool.Particles[i].LifeRemaining -= ts.GetSeconds();
-			}
-			instance->m_JobsCount--;
+			instance->Emitter.Emit(instance->m_FrameSettings.Timestep, instance->m_Pool);
+			instance->pushChunkJobs();
 		});
 	}
 
-	void ParticleSystem::pushRotationJob()
+	void ParticleSystem::pushChunkJobs()
 	{
-		m_JobsCount++;
-		Ref<ParticleSystem> instance = this;
-		Application::Get().GetThreadPool().PushJob([instance]() mutable {
-
-			XYZ_PROFILE_FUNC("ParticleSystem::pushRotationJob");
-			std::shared_lock lock(instance->m_JobsMutex);
-
-			auto particles = instance->m_Pool.Particles;
-			const uint32_t aliveParticles = instance->m_Pool.GetAliveParticles();
+		ThreadPool& threadPool = Application::Get().GetThreadPool();
+		ParticleSystem* instance = this;
 
-			for (uint32_t i = 0; i < aliveParticles; ++i)
-			{
-				instance->updateRotation(particles[i]);
-			}
-			instance->m_JobsCount--;
-		});
-	}
+		const uint32_t aliveParticles = m_Pool.GetAliveParticles();
+		const uint32_t writeIndex = 1 - m_ReadIndex.load(std::memory_order_relaxed);
+		for (uint32_t startId = 0; startId < aliveParticles; startId += sc_ChunkSize)
+		{
+			const uint32_t endId = std::min(startId + sc_ChunkSize, aliveParticles);
+			threadPool.PushJob(m_ChunkGroup, [instance, startId, endId, writeIndex]() {
+				XYZ_PROFILE_FUNC("ParticleSystem::chunkJob");
+				ParticleKernels::Update(instance->m_FrameSettings, instance->m_Pool, startId, endId);
+				instance->buildRenderData(instance->m_RenderData[writeIndex], startId, endId);
+			});
+		}
 
-	void ParticleSystem::pushAnimationJob()
-	{
-		m_JobsCount++;
-		Ref<ParticleSystem> instance = this;
-		Application::Get().GetThreadPool().PushJob([instance]() mutable {
-
-			XYZ_PROFILE_FUNC("ParticleSystem::pushAnimationJob");
-			std::shared_lock lock(instance->m_JobsMutex);
-
-			auto particles = instance->m_Pool.Particles;
-			const uint32_t aliveParticles = instance->m_Pool.GetAliveParticles();
-
-			const uint32_t stageCount = instance->AnimationTiles.x * instance->AnimationTiles.y;
-			for (uint32_t i = 0; i < aliveParticles; ++i)
-			{
-				instance->updateAnimation(particles[i], stageCount);
-			}
-			instance->m_JobsCount--;
+		threadPool.PushJobAfter(m_ChunkGroup, m_PublishGroup, [instance, aliveParticles, writeIndex]() {
+			XYZ_PROFILE_FUNC("ParticleSystem::publishJob");
+			RenderData& renderData = instance->m_RenderData[writeIndex];
+			instance->buildLightsData(renderData);
+			renderData.ParticleCount = aliveParticles;
+			instance->m_ReadIndex.store(writeIndex, std::memory_order_release);
 		});
 	}
 
-	void ParticleSystem::pushColorOverLifeJob()
+	void ParticleSystem::waitForJobs() const
 	{
-		m_JobsCount++;
-		Ref<ParticleSystem> instance = this;
-		Application::Get().GetThreadPool().PushJob([instance]() mutable {
-
-			XYZ_PROFILE_FUNC("ParticleSystem::pushColorOverLifeJob");
-			std::shared_lock lock(instance->m_JobsMutex);
-
-			auto particles = instance->m_Pool.Particles;
-			const uint32_t aliveParticles = instance->m_Pool.GetAliveParticles();
+		if (jobsFinished())
+			return;
 
-			for (uint32_t i = 0; i < aliveParticles; ++i)
-			{
-				instance->updateColorOverLife(particles[i]);
-			}
-			instance->m_JobsCount--;
-		});
+		// Every stage counts the next one before it finishes, so waiting in order covers whole frame
+		ThreadPool& threadPool = Application::Get().GetThreadPool();
+		threadPool.Wait(m_EmitGroup);
+		threadPool.Wait(m_ChunkGroup);
+		threadPool.Wait(m_PublishGroup);
 	}
 
-	void ParticleSystem::pushSizeOverLifeJob()
+	bool ParticleSystem::jobsFinished() const
 	{
-		m_JobsCount++;
-		Ref<ParticleSystem> instance = this;
-		Application::Get().GetThreadPool().PushJob([instance]() mutable {
-
-			XYZ_PROFILE_FUNC("ParticleSystem::pushSizeOverLifeJob");
-			std::shared_lock lock(instance->m_JobsMutex);
-
-			auto particles = instance->m_Pool.Particles;
-			const uint32_t aliveParticles = instance->m_Pool.GetAliveParticles();
-
-			for (uint32_t i = 0; i < aliveParticles; ++i)
-			{
-				instance->updateSizeOverLife(particles[i]);
-			}
-			instance->m_JobsCount--;
-		});
+		return m_EmitGroup.IsDone() && m_ChunkGroup.IsDone() && m_PublishGroup.IsDone();
 	}
 
-	void ParticleSystem::pushLightOverLifeJob()
+	ParticleUpdateSettings ParticleSystem::createUpdateSettings(Timestep ts) const
 	{
-		m_JobsCount++;
-		Ref<ParticleSystem> instance = this;
-		Application::Get().GetThreadPool().PushJob([instance]() mutable {
-
-			XYZ_PROFILE_FUNC("ParticleSystem::pushLightOverLifeJob");
-			std::shared_lock lock(instance->m_JobsMutex);
-
-			auto particles = instance->m_Pool.Particles;
-			const uint32_t aliveParticles = instance->m_Pool.GetAliveParticles();
-
-			const uint32_t aliveLights = std::min(aliveParticles, instance->Emitter.MaxLights);
-
-			for (uint32_t i = 0; i < aliveLights; ++i)
-			{
-				instance->updateLightOverLife(particles[i]);
-			}
-			instance->m_JobsCount--;
-		});
+		ParticleUpdateSettings settings;
+		settings.Timestep = ts.GetSeconds();
+		settings.LifeTime = Emitter.LifeTime;
+
+		settings.ColorOverLife = ModuleEnabled[ColorOverLife];
+		settings.StartColor = Emitter.Color;
+		settings.EndColor = EndColor;
+
+		settings.SizeOverLife = ModuleEnabled[SizeOverLife];
+		settings.StartSize = Emitter.Size;
+		settings.EndSize = EndSize;
+
+		settings.LightOverLife = ModuleEnabled[LightOverLife];
+		settings.MaxLights = Emitter.MaxLights;
+		settings.StartLightColor = Emitter.LightColor;
+		settings.EndLightColor = LightEndColor;
+		settings.StartLightRadius = Emitter.LightRadius;
+		settings.EndLightRadius = LightEndRadius;
+		settings.StartLightIntensity = Emitter.LightIntensity;
+		settings.EndLightIntensity = LightEndIntensity;
+
+		settings.RotationOverLife = ModuleEnabled[RotationOverLife];
+		settings.EndRotation = EndRotation;
+
+		settings.TextureAnimation = ModuleEnabled[TextureAnimation];
+		settings.AnimationTiles = AnimationTiles;
+		settings.AnimationCycleLength = AnimationCycleLength;
+		return settings;
 	}
 
-	void ParticleSystem::pushBuildLightsDataJob(const glm::mat4& transform)
+	void ParticleSystem::buildRenderData(RenderData& renderData, uint32_t startId, uint32_t endId) const
 	{
-		m_JobsCount++;
-		Ref<ParticleSystem> instance = this;
-		Application::Get().GetThreadPool().PushJob([instance,tr = transform]() mutable {
-
-			XYZ_PROFILE_FUNC("ParticleSystem::pushBuildLightsDataJob");
-			std::shared_lock lock(instance->m_JobsMutex);
-			
-
-			const uint32_t aliveParticles = instance->m_Pool.GetAliveParticles();
-
-			const uint32_t maxLights = std::min(aliveParticles, instance->Emitter.MaxLights);
-			instance->m_RenderData.LightData.resize(maxLights);
-			for (uint32_t i = 0; i < maxLights; ++i)
-			{
-				const auto& particle = instance->m_Pool.Particles[i];
-
-				const glm::mat4 particleTransform =
-					glm::translate(particle.Position)
-				  * glm::toMat4(particle.Rotation)
-				  * glm::scale(particle.Size);
-
-				const glm::mat4 worldParticleTransform = tr * particleTransform;
-
-				auto& light = instance->m_RenderData.LightData[i];
-				light.Color = particle.LightColor;
-				light.Position = Math::TransformToTranslation(worldParticleTransform);
-				light.Radius = particle.LightRadius;
-				light.Intensity = particle.LightIntensity;
-			}
-			instance->m_JobsCount--;
-		});
-	}
-
-	void ParticleSystem::pushBuildRenderDataJobs(const glm::mat4& transform)
-	{	
-		Ref<ParticleSystem> instance = this;
-		
-		const uint32_t aliveParticles = instance->m_Pool.GetAliveParticles();
-		const uint32_t numJobs = aliveParticles / sc_PerJobCount;
-		for (uint32_t jobIndex = 0; jobIndex < numJobs + 1; ++jobIndex)
+		XYZ_PROFILE_FUNC("ParticleSystem::buildRenderData");
+		for (uint32_t i = startId; i < endId; ++i)
 		{
-			m_JobsCount++;
-			Application::Get().GetThreadPool().PushJob([instance, jobIndex, tr = transform]() mutable {
-
-				XYZ_PROFILE_FUNC("ParticleSystem::pushBuildRenderDataJob");
-				std::shared_lock lock(instance->m_JobsMutex);
-	
-				const uint32_t aliveParticles = instance->m_Pool.GetAliveParticles();
-
-				const uint32_t startId = jobIndex * instance->sc_PerJobCount;
-				const uint32_t endId = std::min(startId + instance->sc_PerJobCount, aliveParticles);
-
-				instance->buildRenderData(tr, startId, endId);
-				instance->m_RenderData.ParticleCount = aliveParticles;
+			const glm::mat4 particleTransform =
+				glm::translate(m_Pool.GetPosition(i))
+				* glm::toMat4(m_Pool.GetRotation(i))
+				* glm::scale(m_Pool.GetSize(i));
+			
+			const glm::mat4 worldParticleTransform = m_FrameTransform * particleTransform;
 
-				instance->m_JobsCount--;
-			});
+			renderData.ParticleData[i].Color = m_Pool.GetColor(i);
+			Mat4ToTransformData(renderData.ParticleData[i].Transform, worldParticleTransform);
+			renderData.ParticleData[i].TexOffset = m_Pool.GetTexOffset(i);
 		}
 	}
 
-
-
-	void ParticleSystem::updateAnimation(ParticlePool::Particle& particle, uint32_t stageCount) const
-	{
-		const float ratio = CalcRatio(AnimationCycleLength, particle.LifeRemaining);
-		const float stageProgress = ratio * stageCount;
-
-		const uint32_t index = (uint32_t)floor(stageProgress);
-		const float column = index % AnimationTiles.x;
-		const float row = index / AnimationTiles.y;
-
-		particle.TexOffset = glm::vec2(column / (float)AnimationTiles.x, row / (float)AnimationTiles.y);
-	}
-
-	void ParticleSystem::updateRotation(ParticlePool::Particle& particle) const
-	{
-		const glm::vec3 radians = glm::radians(EndRotation);
-		const float ratio = CalcRatio(Emitter.LifeTime, particle.LifeRemaining);
-		particle.Rotation = glm::quat(radians * ratio);
-	}
-
-	void ParticleSystem::updateColorOverLife(ParticlePool::Particle& particle) const
-	{
-		const float ratio = CalcRatio(Emitter.LifeTime, particle.LifeRemaining);
-		particle.Color = glm::lerp(Emitter.Color, EndColor, ratio);
-	}
-
-	void ParticleSystem::updateSizeOverLife(ParticlePool::Particle& particle) const
+	void ParticleSystem::buildLightsData(RenderData& renderData) const
 	{
-		const float ratio = CalcRatio(Emitter.LifeTime, particle.LifeRemaining);
-		particle.Size = glm::lerp(Emitter.Size, EndSize, ratio);
-	}
-
-	void ParticleSystem::updateLightOverLife(ParticlePool::Particle& particle) const
-	{
-		const float ratio = CalcRatio(Emitter.LifeTime, particle.LifeRemaining);
-		particle.LightColor = glm::lerp(Emitter.LightColor, LightEndColor, ratio);
-		particle.LightIntensity = glm::lerp(Emitter.LightIntensity, LightEndIntensity, ratio);
-		particle.LightRadius = glm::lerp(Emitter.LightRadius, LightEndRadius, ratio);
-	}
-
-	void ParticleSystem::buildRenderData(const glm::mat4& transform, uint32_t startId, uint32_t endId)
-	{
-		XYZ_PROFILE_FUNC("ParticleSystem::buildRenderData");
-		for (uint32_t i = startId; i < endId; ++i)
+		XYZ_PROFILE_FUNC("ParticleSystem::buildLightsData");
+		const uint32_t maxLights = std::min(m_Pool.GetAliveParticles(), m_FrameSettings.MaxLights);
+		renderData.LightData.resize(maxLights);
+		for (uint32_t i = 0; i < maxLights; ++i)
 		{
-			const auto& particle = m_Pool.Particles[i];
-
 			const glm::mat4 particleTransform =
-				glm::translate(particle.Position)
-				* glm::toMat4(particle.Rotation)
-				* glm::scale(particle.Size);
-			
-			
-			const glm::mat4 worldParticleTransform = transform * particleTransform;
+				glm::translate(m_Pool.GetPosition(i))
+			  * glm::toMat4(m_Pool.GetRotation(i))
+			  * glm::scale(m_Pool.GetSize(i));
 
+			const glm::mat4 worldParticleTransform = m_FrameTransform * particleTransform;
 
-			m_RenderData.ParticleData[i].Color = particle.Color;
-			Mat4ToTransformData(m_RenderData.ParticleData[i].Transform, worldParticleTransform);
-			m_RenderData.ParticleData[i].TexOffset = particle.TexOffset;
+			auto& light = renderData.LightData[i];
+			light.Color = m_Pool.GetLightColor(i);
+			light.Position = Math::TransformToTranslation(worldParticleTransform);
+			light.Radius = m_Pool.GetStream(ParticlePool::LightRadius)[i];
+			light.Intensity = m_Pool.GetStream(ParticlePool::LightIntensity)[i];
 		}
 	}
 
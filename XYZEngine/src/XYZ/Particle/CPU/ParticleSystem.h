@@ -3,14 +3,15 @@
 
 #include "XYZ/Core/Timestep.h"
 #include "XYZ/Core/Ref/Ref.h"
+#include "XYZ/Core/Job.h"
 
 #include "ParticlePool.h"
-#include "ParticleUpdater.h"
 #include "ParticleEmitter.h"
+#include "ParticleKernels.h"
 
 #include <glm/glm.hpp>
 
-#include <mutex>
+#include <atomic>
 
 namespace XYZ {
 
@@ -43,6 +44,12 @@ namespace XYZ {
 			std::vector<ParticleLightData>	LightData;
 		};
 
+		struct Stats
+		{
+			uint32_t SimulatedFrames = 0;
+			uint32_t SkippedFrames = 0; // Previous simulation was not finished, timestep is carried to next frame
+		};
+
 	public:
 		ParticleSystem(uint32_t maxParticles = 20);	
 		ParticleSystem(const ParticleSystem& other);
@@ -60,7 +67,11 @@ namespace XYZ {
 		uint32_t GetMaxParticles() const;
 		uint32_t GetAliveParticles() const;
 		
-		const RenderData& GetRenderData() const { return m_RenderData; }
+		// Last finished simulation, next one writes to the other buffer so rendering never waits
+		const RenderData& GetRenderData() const { return m_RenderData[m_ReadIndex.load(std::memory_order_acquire)]; }
+
+		const Stats& GetStats() const { return m_Stats; }
+		void		 ResetStats() { m_Stats = Stats(); }
 		
 
 		ParticleEmitter	Emitter;
@@ -101,34 +112,35 @@ namespace XYZ {
 
 	private:
 		void pushJobs(const glm::mat4& transform, Timestep ts);
+		void pushChunkJobs();
+		void waitForJobs() const;
+		bool jobsFinished() const;
 
-		void pushMainJob(Timestep ts);
-		void pushRotationJob();
-		void pushAnimationJob();
-		void pushColorOverLifeJob();
-		void pushSizeOverLifeJob();
-		void pushLightOverLifeJob();
-		void pushBuildLightsDataJob(const glm::mat4& transform);
-		void pushBuildRenderDataJobs(const glm::mat4& transform);
+		ParticleUpdateSettings createUpdateSettings(Timestep ts) const;
 
-		void updateAnimation(ParticlePool::Particle& particle, uint32_t stageCount) const;
-		void updateRotation(ParticlePool::Particle& particle) const;
-		void updateColorOverLife(ParticlePool::Particle& particle) const;
-		void updateSizeOverLife(ParticlePool::Particle& particle) const;
-		void updateLightOverLife(ParticlePool::Particle& particle) const;
-
-		void buildRenderData(const glm::mat4& transform, uint32_t startId, uint32_t endId);
+		void buildRenderData(RenderData& renderData, uint32_t startId, uint32_t endId) const;
+		void buildLightsData(RenderData& renderData) const;
 
 	private:
-		ParticlePool		m_Pool;
-		RenderData			m_RenderData;
-		uint32_t			m_MaxParticles;
-		std::shared_mutex	m_JobsMutex;
+		ParticlePool		 m_Pool;
+		RenderData			 m_RenderData[2];
+		std::atomic_uint32_t m_ReadIndex = 0;
+		uint32_t			 m_MaxParticles;
+
+		// Emit and kill -> update and build render data per chunk -> build lights and publish.
+		// Groups are counted before previous stage finishes, so all are done only when whole frame is
+		mutable JobGroup	 m_EmitGroup;
+		mutable JobGroup	 m_ChunkGroup;
+		mutable JobGroup	 m_PublishGroup;
+
+		// Written before frame jobs are pushed, read only while they run
+		ParticleUpdateSettings m_FrameSettings;
+		glm::mat4			   m_FrameTransform;
 
-		std::atomic_uint8_t m_JobsCount = 0;
-		Timestep			m_Timestep;
+		Timestep			 m_Timestep;
+		Stats				 m_Stats;
 
-		static constexpr uint32_t sc_PerJobCount = 500;
+		static constexpr uint32_t sc_ChunkSize = 2048;
 	};
 
 
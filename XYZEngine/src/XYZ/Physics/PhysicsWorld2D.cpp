@@ -3,11 +3,14 @@
 
 #include "XYZ/Core/Application.h"
 #include "XYZ/Debug/Profiler.h"
+#include "XYZ/Debug/Timer.h"
 
 namespace XYZ {
 	PhysicsWorld2D::PhysicsWorld2D(const glm::vec2& gravity)
 		:
-		m_World({ gravity.x, gravity.y })
+		m_World({ gravity.x, gravity.y }),
+		m_Accumulator(0.0f),
+		m_InterpolationAlpha(1.0f)
 	{
 		m_Layers[DefaultLayer] = { "Default", DefaultLayer, {} };
 		m_Layers[ParticleLayer] = { "Particle", ParticleLayer, {} };
@@ -18,13 +21,47 @@ namespace XYZ {
 		m_Layers[ParticleLayer].m_CollisionMask.set(DefaultLayer, true);
 		m_Layers[ParticleLayer].m_CollisionMask.set(ParticleLayer, false);
 	}
-	void PhysicsWorld2D::Step(Timestep ts)
+	uint32_t PhysicsWorld2D::Step(Timestep ts, const std::function<void()>& beforeLastSubStep)
 	{
 		XYZ_PROFILE_FUNC("PhysicsWorld2D::Step");
+		Stopwatch timer;
+		const StepSettings& settings = m_StepSettings;
 
-		const int32_t velocityIterations = 6;
-		const int32_t positionIterations = 2;
-		m_World.Step(ts.GetSeconds(), velocityIterations, positionIterations);
+		float timestep = ts.GetSeconds();
+		uint32_t subSteps = 1;
+		if (settings.FixedStep)
+		{
+			timestep = settings.FixedTimestep;
+			m_Accumulator += ts.GetSeconds();
+			subSteps = static_cast<uint32_t>(m_Accumulator / timestep);
+			m_Accumulator -= subSteps * timestep;
+			if (subSteps > settings.MaxSubSteps)
+			{
+				subSteps = settings.MaxSubSteps;
+				m_Stats.CappedFrames++;
+			}
+		}
+
+		for (uint32_t i = 0; i < subSteps; ++i)
+		{
+			if (i + 1 == subSteps && beforeLastSubStep)
+				beforeLastSubStep();
+			m_World.Step(timestep, settings.VelocityIterations, settings.PositionIterations);
+		}
+		m_InterpolationAlpha = settings.FixedStep ? m_Accumulator / timestep : 1.0f;
+
+		m_Stats.SubSteps = subSteps;
+		m_Stats.StepTimeMs = timer.Elapsed();
+		m_Stats.TotalSubSteps += subSteps;
+		m_Stats.TotalFrames++;
+		return subSteps;
+	}
+	void PhysicsWorld2D::SetStepSettings(const StepSettings& settings)
+	{
+		XYZ_ASSERT(settings.FixedTimestep > 0.0f, "Fixed timestep must be positive");
+		m_StepSettings = settings;
+		m_StepSettings.MaxSubSteps = std::max(settings.MaxSubSteps, 1u);
+		m_Accumulator = 0.0f;
 	}
 	void PhysicsWorld2D::SetLayer(const std::string& name, uint32_t index, const CollisionMask& mask)
 	{
@@ -7,6 +7,7 @@
 #include <glm/glm.hpp>
 
 #include <bitset>
+#include <functional>
 
 namespace XYZ {
 
@@ -26,11 +27,40 @@ namespace XYZ {
 			uint32_t	  m_ID;
 			CollisionMask m_CollisionMask;
 		};
+
+		struct StepSettings
+		{
+			bool	 FixedStep = true;
+			float	 FixedTimestep = 1.0f / 60.0f;
+			uint32_t MaxSubSteps = 4; // Time over the cap is dropped, simulation slows down instead of spiraling
+			int32_t	 VelocityIterations = 6;
+			int32_t	 PositionIterations = 2;
+		};
+
+		struct Stats
+		{
+			uint32_t SubSteps = 0;		// Last frame
+			float	 StepTimeMs = 0.0f; // Last frame, all sub steps
+			uint64_t TotalSubSteps = 0;
+			uint64_t TotalFrames = 0;
+			uint32_t CappedFrames = 0;	// Frames that hit MaxSubSteps
+		};
 	public:
 
 		PhysicsWorld2D(const glm::vec2& gravity);
 
-		void Step(Timestep ts);
+		// In fixed step mode world is stepped zero or more times with fixed timestep.
+		// beforeLastSubStep is called before the last sub step, so body states can be stored for interpolation
+		uint32_t Step(Timestep ts, const std::function<void()>& beforeLastSubStep = nullptr);
+
+		// Blend factor between body states before and after the last sub step
+		float GetInterpolationAlpha() const { return m_InterpolationAlpha; }
+
+		void SetStepSettings(const StepSettings& settings);
+		const StepSettings& GetStepSettings() const { return m_StepSettings; }
+
+		const Stats& GetStats() const { return m_Stats; }
+		void		 ResetStats() { m_Stats = Stats(); }
 
 		void SetLayer(const std::string& name, uint32_t index, const CollisionMask& mask = {});
 		
@@ -43,5 +73,10 @@ namespace XYZ {
 	private:		
 		b2World									 m_World;		
 		std::array<Layer, sc_NumCollisionLayers> m_Layers;
+
+		StepSettings							 m_StepSettings;
+		Stats									 m_Stats;
+		float									 m_Accumulator;
+		float									 m_InterpolationAlpha;
 	};
 }
\ No newline at end of file
@@ -1,20 +1,367 @@
 #include "stdafx.h"
 #include "GeometryRenderQueue.h"
 
+#include "XYZ/Core/ThreadPool.h"
+#include "XYZ/Debug/Profiler.h"
 
 namespace XYZ {
-	uint32_t GeometryRenderQueue::SpriteDrawCommand::SetTexture(const Ref<Texture2D>& texture)
+
+	static const AABB sc_InfiniteAABB(glm::vec3(-FLT_MAX), glm::vec3(FLT_MAX));
+
+	static GeometryRenderQueue::TransformData Mat4ToTransformData(const glm::mat4& transform)
+	{
+		GeometryRenderQueue::TransformData data;
+		data.TransformRow[0] = { transform[0][0], transform[1][0], transform[2][0], transform[3][0] };
+		data.TransformRow[1] = { transform[0][1], transform[1][1], transform[2][1], transform[3][1] };
+		data.TransformRow[2] = { transform[0][2], transform[1][2], transform[2][2], transform[3][2] };
+		return data;
+	}
+
+	static bool IsVisible(const uint64_t* visibleMask, uint32_t index)
+	{
+		return !visibleMask || ((visibleMask[index / 64] >> (index % 64)) & 1);
+	}
+
+	template <typename T>
+	static void InternAll(const RenderResourceTable<T>& source, RenderResourceTable<T>& target, std::vector<uint32_t>& remap)
+	{
+		remap.resize(source.Size());
+		for (uint32_t i = 0; i < source.Size(); ++i)
+			remap[i] = target.Intern(source[i]);
+	}
+
+	uint64_t GeometryRenderQueue::SortKey::Create(DrawPass pass, uint32_t material, uint32_t mesh, float depth)
+	{
+		// Bits of non negative float are ordered same as its value, highest bits keep exponent and part of mantissa
+		uint32_t depthBits;
+		depth = std::max(depth, 0.0f);
+		memcpy(&depthBits, &depth, sizeof(float));
+		depthBits >>= (32 - 1 - DepthBits);
+
+		// Blended passes are drawn back to front
+		if (pass == SpritePass || pass == BillboardPass)
+			depthBits = ((1u << DepthBits) - 1) - depthBits;
+
+		return Create(pass, material, mesh, depthBits);
+	}
+
+	uint64_t GeometryRenderQueue::SortKey::Create(DrawPass pass, uint32_t material, uint32_t mesh, uint32_t depthBits)
+	{
+		XYZ_ASSERT(material < (1u << MaterialBits) && mesh < (1u << MeshBits), "Too many unique resources in render queue");
+		return static_cast<uint64_t>(pass) << (DepthBits + MeshBits + MaterialBits)
+			 | static_cast<uint64_t>(material) << (DepthBits + MeshBits)
+			 | static_cast<uint64_t>(mesh) << DepthBits
+			 | depthBits;
+	}
+
+	bool GeometryRenderQueue::SpriteDrawCommand::SetTexture(const Ref<Texture2D>& texture, uint32_t& index)
 	{
 		for (uint32_t i = 0; i < TextureCount; i++)
 		{
-			if (Textures[i]->GetHandle() == texture->GetHandle())
+			if (Textures[i].Raw() == texture.Raw())
+			{
+				index = i;
+				return true;
+			}
+		}
+		if (TextureCount == Textures.size())
+			return false;
+
+		index = TextureCount;
+		Textures[TextureCount++] = texture;
+		return true;
+	}
+
+	void GeometryRenderQueue::SubmitMesh(const Ref<Mesh>& mesh, const Ref<MaterialAsset>& material, const glm::mat4& transform, const Ref<MaterialInstance>& overrideMaterial)
+	{
+		const uint32_t meshIndex = Meshes.Intern(mesh);
+		const uint32_t materialIndex = Materials.Intern(material);
+		const float depth = glm::distance(ViewPosition, glm::vec3(transform[3]));
+		const uint32_t payload = static_cast<uint32_t>(MeshSubmits.size());
+
+		MeshSubmit& submit = MeshSubmits.emplace_back();
+		submit.Transform = transform;
+		submit.OverrideMaterial = UINT32_MAX;
+		if (overrideMaterial.Raw())
+		{
+			// Override draws are not culled
+			submit.OverrideMaterial = MaterialInstances.Intern(overrideMaterial);
+			MeshBounds.Push(sc_InfiniteAABB);
+			Keys.push_back(SortKey::Create(StaticMeshOverridePass, materialIndex, meshIndex, depth));
+		}
+		else
+		{
+			const AABB* boundingBox = mesh->GetBoundingBox();
+			MeshBounds.Push(boundingBox ? boundingBox->TransformAABB(transform) : sc_InfiniteAABB);
+			Keys.push_back(SortKey::Create(StaticMeshPass, materialIndex, meshIndex, depth));
+		}
+		Payloads.push_back(payload);
+	}
+
+	void GeometryRenderQueue::SubmitSprite(const Ref<MaterialAsset>& material, const Ref<SubTexture>& subTexture, const glm::vec4& color, const glm::mat4& transform)
+	{
+		const uint32_t textureIndex = Textures.Intern(subTexture->GetTexture());
+		const uint32_t materialIndex = Materials.Intern(material);
+		const float depth = glm::distance(ViewPosition, glm::vec3(transform[3]));
+
+		Keys.push_back(SortKey::Create(SpritePass, materialIndex, textureIndex, depth));
+		Payloads.push_back(static_cast<uint32_t>(SpriteSubmits.size()));
+		SpriteSubmits.push_back({ textureIndex, subTexture->GetTexCoords(), color, transform });
+	}
+
+	void GeometryRenderQueue::SubmitBillboard(const Ref<MaterialAsset>& material, const Ref<SubTexture>& subTexture, const glm::vec4& color, const glm::vec3& position, const glm::vec2& size)
+	{
+		const uint32_t textureIndex = Textures.Intern(subTexture->GetTexture());
+		const uint32_t materialIndex = Materials.Intern(material);
+		const float depth = glm::distance(ViewPosition, position);
+
+		Keys.push_back(SortKey::Create(BillboardPass, materialIndex, textureIndex, depth));
+		Payloads.push_back(static_cast<uint32_t>(BillboardSubmits.size()));
+		BillboardSubmits.push_back({ textureIndex, subTexture->GetTexCoords(), color, position, size });
+	}
+
+	void GeometryRenderQueue::Merge(const GeometryRenderQueue* segments, uint32_t count, ThreadPool* pool)
+	{
+		XYZ_PROFILE_FUNC("GeometryRenderQueue::Merge");
+		if (m_SegmentRemaps.size() < count)
+			m_SegmentRemaps.resize(count);
+
+		// Resources are interned in segment order, so first use order is the same as with single queue
+		size_t keyCount = Keys.size();
+		size_t meshCount = MeshSubmits.size();
+		size_t spriteCount = SpriteSubmits.size();
+		size_t billboardCount = BillboardSubmits.size();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const GeometryRenderQueue& segment = segments[i];
+			XYZ_ASSERT(segment.AnimatedMeshDrawCommands.empty() && segment.InstanceMeshDrawCommands.empty()
+				&& segment.IndirectDrawCommands.empty() && segment.ComputeCommands.empty(), "Only mesh, sprite and billboard submits can be merged");
+
+			SegmentRemap& remap = m_SegmentRemaps[i];
+			InternAll(segment.Meshes, Meshes, remap.Meshes);
+			InternAll(segment.Materials, Materials, remap.Materials);
+			InternAll(segment.MaterialInstances, MaterialInstances, remap.MaterialInstances);
+			InternAll(segment.Textures, Textures, remap.Textures);
+
+			remap.KeyOffset = static_cast<uint32_t>(keyCount);
+			remap.MeshOffset = static_cast<uint32_t>(meshCount);
+			remap.SpriteOffset = static_cast<uint32_t>(spriteCount);
+			remap.BillboardOffset = static_cast<uint32_t>(billboardCount);
+			keyCount += segment.Keys.size();
+			meshCount += segment.MeshSubmits.size();
+			spriteCount += segment.SpriteSubmits.size();
+			billboardCount += segment.BillboardSubmits.size();
+		}
+
+		Keys.resize(keyCount);
+		Payloads.resize(keyCount);
+		MeshSubmits.resize(meshCount);
+		MeshBounds.Resize(meshCount);
+		SpriteSubmits.resize(spriteCount);
+		BillboardSubmits.resize(billboardCount);
+
+		// Segments write to disjoint ranges
+		if (pool)
+		{
+			pool->ParallelFor(count, 1, [&](uint32_t i) {
+				mergeSegment(segments[i], m_SegmentRemaps[i]);
+			});
+		}
+		else
+		{
+			for (uint32_t i = 0; i < count; ++i)
+				mergeSegment(segments[i], m_SegmentRemaps[i]);
+		}
+	}
+
+	void GeometryRenderQueue::Sort(const uint64_t* visibleMeshes)
+	{
+		XYZ_PROFILE_FUNC("GeometryRenderQueue::Sort");
+		const uint32_t count = static_cast<uint32_t>(Keys.size());
+		m_Sorter.Sort(Keys.data(), Payloads.data(), count, 64);
+
+		// Keys of every pass are continuous after sort
+		uint32_t begin = 0;
+		while (begin < count)
+		{
+			const DrawPass pass = SortKey::Pass(Keys[begin]);
+			uint32_t end = begin + 1;
+			while (end < count && SortKey::Pass(Keys[end]) == pass)
+				end++;
+
+			if (pass == StaticMeshPass || pass == StaticMeshOverridePass)
+			{
+				buildMeshCommands(visibleMeshes, begin, end);
+			}
+			else if (pass == SpritePass)
+			{
+				buildSpriteCommands(begin, end);
+			}
+			else if (pass == BillboardPass)
+			{
+				buildBillboardCommands(begin, end);
+			}
+			begin = end;
+		}
+	}
+
+	void GeometryRenderQueue::Clear()
+	{
+		Keys.clear();
+		Payloads.clear();
+		MeshSubmits.clear();
+		MeshBounds.Clear();
+		SpriteSubmits.clear();
+		BillboardSubmits.clear();
+
+		Meshes.Clear();
+		Materials.Clear();
+		MaterialInstances.Clear();
+		Textures.Clear();
+
+		SpriteDrawCommands.clear();
+		SpriteData.clear();
+		BillboardDrawCommands.clear();
+		BillboardData.clear();
+		MeshDrawCommands.clear();
+		MeshTransforms.clear();
+		MeshOverrides.clear();
+
+		AnimatedMeshDrawCommands.clear();
+		InstanceMeshDrawCommands.clear();
+		IndirectDrawCommands.clear();
+		ComputeCommands.clear();
+	}
+
+	void GeometryRenderQueue::mergeSegment(const GeometryRenderQueue& segment, const SegmentRemap& remap)
+	{
+		XYZ_PROFILE_FUNC("GeometryRenderQueue::mergeSegment");
+		for (size_t i = 0; i < segment.Keys.size(); ++i)
+		{
+			const uint64_t key = segment.Keys[i];
+			const DrawPass pass = SortKey::Pass(key);
+			const uint32_t material = remap.Materials[SortKey::Material(key)];
+			uint32_t resource, payloadOffset;
+			if (pass == StaticMeshPass || pass == StaticMeshOverridePass)
+			{
+				resource = remap.Meshes[SortKey::Mesh(key)];
+				payloadOffset = remap.MeshOffset;
+			}
+			else
+			{
+				resource = remap.Textures[SortKey::Mesh(key)];
+				payloadOffset = pass == SpritePass ? remap.SpriteOffset : remap.BillboardOffset;
+			}
+			Keys[remap.KeyOffset + i] = SortKey::Create(pass, material, resource, SortKey::Depth(key));
+			Payloads[remap.KeyOffset + i] = segment.Payloads[i] + payloadOffset;
+		}
+
+		for (size_t i = 0; i < segment.MeshSubmits.size(); ++i)
+		{
+			MeshSubmit& submit = MeshSubmits[remap.MeshOffset + i];
+			submit = segment.MeshSubmits[i];
+			if (submit.OverrideMaterial != UINT32_MAX)
+				submit.OverrideMaterial = remap.MaterialInstances[submit.OverrideMaterial];
+		}
+		MeshBounds.Copy(segment.MeshBounds, remap.MeshOffset);
+
+		for (size_t i = 0; i < segment.SpriteSubmits.size(); ++i)
+		{
+			SpriteSubmit& submit = SpriteSubmits[remap.SpriteOffset + i];
+			submit = segment.SpriteSubmits[i];
+			submit.Texture = remap.Textures[submit.Texture];
+		}
+		for (size_t i = 0; i < segment.BillboardSubmits.size(); ++i)
+		{
+			BillboardSubmit& submit = BillboardSubmits[remap.BillboardOffset + i];
+			submit = segment.BillboardSubmits[i];
+			submit.Texture = remap.Textures[submit.Texture];
+		}
+	}
+
+	void GeometryRenderQueue::buildMeshCommands(const uint64_t* visibleMeshes, uint32_t begin, uint32_t end)
+	{
+		MeshDrawCommand* command = nullptr;
+		uint64_t batch = UINT64_MAX;
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const uint64_t key = Keys[i];
+			const uint32_t payload = Payloads[i];
+			const bool isOverride = SortKey::Pass(key) == StaticMeshOverridePass;
+			if (!isOverride && !IsVisible(visibleMeshes, payload))
+				continue;
+
+			if (SortKey::Batch(key) != batch)
+			{
+				batch = SortKey::Batch(key);
+				command = &MeshDrawCommands.emplace_back();
+				command->Mesh = Meshes[SortKey::Mesh(key)];
+				command->MaterialAsset = Materials[SortKey::Material(key)];
+				command->OverrideMaterial = command->MaterialAsset->GetMaterialInstance();
+				command->FirstTransform = static_cast<uint32_t>(MeshTransforms.size());
+				command->FirstOverride = static_cast<uint32_t>(MeshOverrides.size());
+			}
+
+			const MeshSubmit& submit = MeshSubmits[payload];
+			if (isOverride)
+			{
+				MeshOverrides.push_back({ MaterialInstances[submit.OverrideMaterial], submit.Transform });
+				command->OverrideCount++;
+			}
+			else
+			{
+				MeshTransforms.push_back(Mat4ToTransformData(submit.Transform));
+				command->TransformInstanceCount++;
+				command->Count++;
+			}
+		}
+	}
+
+	void GeometryRenderQueue::buildSpriteCommands(uint32_t begin, uint32_t end)
+	{
+		SpriteDrawCommand* command = nullptr;
+		uint32_t material = UINT32_MAX;
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const SpriteSubmit& submit = SpriteSubmits[Payloads[i]];
+			const uint32_t keyMaterial = SortKey::Material(Keys[i]);
+
+			uint32_t textureIndex = 0;
+			if (keyMaterial != material || !command->SetTexture(Textures[submit.Texture], textureIndex))
+			{
+				material = keyMaterial;
+				command = &SpriteDrawCommands.emplace_back();
+				command->MaterialAsset = Materials[material];
+				command->MaterialInstance = command->MaterialAsset->GetMaterialInstance();
+				command->DataOffset = static_cast<uint32_t>(SpriteData.size());
+				command->SetTexture(Textures[submit.Texture], textureIndex);
+			}
+			SpriteData.push_back({ textureIndex, submit.TexCoords, submit.Color, submit.Transform });
+			command->DataCount++;
+		}
+	}
+
+	void GeometryRenderQueue::buildBillboardCommands(uint32_t begin, uint32_t end)
+	{
+		SpriteDrawCommand* command = nullptr;
+		uint32_t material = UINT32_MAX;
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const BillboardSubmit& submit = BillboardSubmits[Payloads[i]];
+			const uint32_t keyMaterial = SortKey::Material(Keys[i]);
+
+			uint32_t textureIndex = 0;
+			if (keyMaterial != material || !command->SetTexture(Textures[submit.Texture], textureIndex))
 			{
-				return i;
+				material = keyMaterial;
+				command = &BillboardDrawCommands.emplace_back();
+				command->MaterialAsset = Materials[material];
+				command->MaterialInstance = command->MaterialAsset->GetMaterialInstance();
+				command->DataOffset = static_cast<uint32_t>(BillboardData.size());
+				command->SetTexture(Textures[submit.Texture], textureIndex);
 			}
+			BillboardData.push_back({ textureIndex, submit.TexCoords, submit.Color, submit.Position, submit.Size });
+			command->DataCount++;
 		}
-		uint32_t result = TextureCount;
-		Textures[result] = texture;
-		TextureCount++;
-		return result;
 	}
-}
\ No newline at end of file
+}
@@ -9,27 +9,65 @@
 #include "MaterialInstance.h"
 
 #include "XYZ/Asset/Renderer/MaterialAsset.h"
+#include "XYZ/Utils/Math/FrustumCulling.h"
+#include "XYZ/Utils/Algorithms/RadixSort.h"
+#include "XYZ/Utils/DataStructures/HashIndex.h"
+#include "XYZ/Utils/DataStructures/FrameAllocator.h"
 
 #include "XYZ/Scene/Scene.h"
 #include "XYZ/Scene/Components.h"
 #include "XYZ/Scene/Prefab.h"
 
 namespace XYZ {
+
+	// Resources referenced by submits are stored once per frame, submits refer to them by index
+	template <typename T>
+	class RenderResourceTable
+	{
+	public:
+		uint32_t Intern(const Ref<T>& resource);
+		void	 Clear();
+
+		const Ref<T>& operator[](uint32_t index) const { return m_Resources[index]; }
+		uint32_t	  Size() const { return static_cast<uint32_t>(m_Resources.size()); }
+
+	private:
+		std::vector<Ref<T>> m_Resources;
+		HashIndex			m_Index;
+	};
+
+	// Mesh, sprite and billboard submits are recorded as 64 bit sort keys with payload indices,
+	// keys are radix sorted once per frame and consecutive keys with same batch bits form one draw command.
+	// Storage is cleared without releasing memory, so steady state frames do not allocate
 	struct XYZ_API GeometryRenderQueue
 	{
-		struct SpriteKey
+		enum DrawPass : uint32_t
 		{
-			SpriteKey(const AssetHandle& matHandle)
-				: MaterialHandle(matHandle)
-			{}
-
-			bool operator<(const SpriteKey& other) const
-			{
-				return (MaterialHandle < other.MaterialHandle);
-			}
+			StaticMeshPass,
+			StaticMeshOverridePass,
+			SpritePass,
+			BillboardPass
+		};
 
-			AssetHandle MaterialHandle;
+		// Key layout from most significant bit: | pass 4 | material 20 | mesh or texture 20 | depth 20 |
+		// Depth is inverted for sprite and billboard passes
+		struct SortKey
+		{
+			static constexpr uint32_t DepthBits = 20;
+			static constexpr uint32_t MeshBits = 20;
+			static constexpr uint32_t MaterialBits = 20;
+			static constexpr uint32_t PassBits = 4;
+
+			static uint64_t Create(DrawPass pass, uint32_t material, uint32_t mesh, float depth);
+			static uint64_t Create(DrawPass pass, uint32_t material, uint32_t mesh, uint32_t depthBits);
+
+			static uint64_t Batch(uint64_t key)	   { return key >> DepthBits; }
+			static DrawPass Pass(uint64_t key)	   { return static_cast<DrawPass>(key >> (DepthBits + MeshBits + MaterialBits)); }
+			static uint32_t Material(uint64_t key) { return static_cast<uint32_t>(key >> (DepthBits + MeshBits)) & ((1u << MaterialBits) - 1); }
+			static uint32_t Mesh(uint64_t key)	   { return static_cast<uint32_t>(key >> DepthBits) & ((1u << MeshBits) - 1); }
+			static uint32_t Depth(uint64_t key)	   { return static_cast<uint32_t>(key) & ((1u << DepthBits) - 1); }
 		};
+
 		struct BatchMeshKey
 		{
 			AssetHandle MeshHandle;
@@ -66,6 +104,7 @@ namespace XYZ {
 			glm::vec2 Size;
 		};
 
+		// Range of sorted SpriteData or BillboardData sharing material and texture slots
 		struct SpriteDrawCommand
 		{
 			Ref<MaterialAsset>	  MaterialAsset;
@@ -74,11 +113,11 @@ namespace XYZ {
 			std::array<Ref<Texture2D>, Renderer2D::GetMaxTextures()> Textures;
 
 			uint32_t       TextureCount = 0;
+			uint32_t	   DataOffset = 0;
+			uint32_t	   DataCount = 0;
 
-			uint32_t SetTexture(const Ref<Texture2D>& texture);
-
-			std::vector<SpriteDrawData>		SpriteData;
-			std::vector<BillboardDrawData>	BillboardData;
+			// Returns false if all texture slots are taken
+			bool SetTexture(const Ref<Texture2D>& texture, uint32_t& index);
 		};
 
 		struct TransformData
@@ -93,6 +132,7 @@ namespace XYZ {
 			glm::mat4			   Transform;
 		};
 
+		// Instanced draw of visible transforms in range of MeshTransforms, followed by override draws in range of MeshOverrides
 		struct MeshDrawCommand
 		{
 			Ref<Mesh>					 Mesh;
@@ -101,11 +141,12 @@ namespace XYZ {
 			Ref<Pipeline>				 Pipeline;
 			uint32_t					 TransformInstanceCount = 0;
 
-			std::vector<TransformData>	 TransformData;
+			uint32_t					 FirstTransform = 0;
 			uint32_t					 TransformOffset = 0;
 			uint32_t					 Count = 0;
 
-			std::vector<MeshDrawCommandOverride> OverrideCommands;
+			uint32_t					 FirstOverride = 0;
+			uint32_t					 OverrideCount = 0;
 		};
 
 		struct AnimatedMeshDrawCommandOverride
@@ -116,32 +157,41 @@ namespace XYZ {
 			uint32_t			   BoneTransformsIndex = 0;
 		};
 
+		// Per frame data of batched commands lives in frame memory when created with allocator
 		struct AnimatedMeshDrawCommand
 		{
+			AnimatedMeshDrawCommand(FrameAllocator* allocator = nullptr)
+				: TransformData(allocator), BoneData(allocator), OverrideCommands(allocator)
+			{}
+
 			Ref<AnimatedMesh>			 Mesh;
 			Ref<MaterialAsset>			 MaterialAsset;
 			Ref<MaterialInstance>		 OverrideMaterial;
 			Ref<Pipeline>				 Pipeline;
 			uint32_t					 TransformInstanceCount = 0;
 
-			std::vector<TransformData>	 TransformData;
+			FrameVector<TransformData>	 TransformData;
 			uint32_t					 TransformOffset = 0;
 
-			std::vector<BoneTransforms>	 BoneData;
+			FrameVector<BoneTransforms>	 BoneData;
 			uint32_t					 BoneTransformsIndex = 0;
 			uint32_t					 Count = 0;
-			std::vector<AnimatedMeshDrawCommandOverride> OverrideCommands;
+			FrameVector<AnimatedMeshDrawCommandOverride> OverrideCommands;
 		};
 
 		struct InstanceMeshDrawCommand
 		{
+			InstanceMeshDrawCommand(FrameAllocator* allocator = nullptr)
+				: InstanceData(allocator)
+			{}
+
 			Ref<Mesh>					 Mesh;
 			Ref<MaterialAsset>			 MaterialAsset;
 			Ref<MaterialInstance>		 OverrideMaterial;
 			Ref<Pipeline>				 Pipeline;
 			glm::mat4					 Transform;
 	
-			std::vector<std::byte>		 InstanceData;
+			FrameVector<std::byte>		 InstanceData;
 			uint32_t					 InstanceCount = 0;
 			uint32_t					 InstanceOffset = 0;
 		};
@@ -188,24 +238,118 @@ namespace XYZ {
 		};
 
 
-		std::map<SpriteKey, SpriteDrawCommand> SpriteDrawCommands;
-		std::map<SpriteKey, SpriteDrawCommand> BillboardDrawCommands;
+		struct MeshSubmit
+		{
+			glm::mat4 Transform;
+			uint32_t  OverrideMaterial; // Index to MaterialInstances, UINT32_MAX if not overridden
+		};
+
+		struct SpriteSubmit
+		{
+			uint32_t  Texture; // Index to Textures
+			glm::vec4 TexCoords;
+			glm::vec4 Color;
+			glm::mat4 Transform;
+		};
+
+		struct BillboardSubmit
+		{
+			uint32_t  Texture; // Index to Textures
+			glm::vec4 TexCoords;
+			glm::vec4 Color;
+			glm::vec3 Position;
+			glm::vec2 Size;
+		};
+
+		void SubmitMesh(const Ref<Mesh>& mesh, const Ref<MaterialAsset>& material, const glm::mat4& transform, const Ref<MaterialInstance>& overrideMaterial);
+		void SubmitSprite(const Ref<MaterialAsset>& material, const Ref<SubTexture>& subTexture, const glm::vec4& color, const glm::mat4& transform);
+		void SubmitBillboard(const Ref<MaterialAsset>& material, const Ref<SubTexture>& subTexture, const glm::vec4& color, const glm::vec3& position, const glm::vec2& size);
+
+		// Appends submits recorded in segments, their resource indices and payloads are remapped to this queue.
+		// Result is the same as submitting everything to this queue in segment order, copying runs on pool if set
+		void Merge(const GeometryRenderQueue* segments, uint32_t count, ThreadPool* pool = nullptr);
+
+		// Sorts submitted keys and builds draw commands. Mesh submits with cleared bit in visibleMeshes are skipped,
+		// mask has one bit per MeshBounds entry
+		void Sort(const uint64_t* visibleMeshes = nullptr);
+		void Clear();
+
+		// Depth in sort keys is distance from view position
+		glm::vec3 ViewPosition = glm::vec3(0.0f);
+
+		// Recorded submits
+		std::vector<uint64_t>		 Keys;
+		std::vector<uint32_t>		 Payloads;
+		std::vector<MeshSubmit>		 MeshSubmits;
+		AABBSoA						 MeshBounds; // World space bounds per mesh submit
+		std::vector<SpriteSubmit>	 SpriteSubmits;
+		std::vector<BillboardSubmit> BillboardSubmits;
+
+		RenderResourceTable<Mesh>			  Meshes;
+		RenderResourceTable<MaterialAsset>	  Materials;
+		RenderResourceTable<MaterialInstance> MaterialInstances;
+		RenderResourceTable<Texture2D>		  Textures;
+
+		// Built by Sort in key order
+		std::vector<SpriteDrawCommand>		 SpriteDrawCommands;
+		std::vector<SpriteDrawData>			 SpriteData;
+		std::vector<SpriteDrawCommand>		 BillboardDrawCommands;
+		std::vector<BillboardDrawData>		 BillboardData;
+		std::vector<MeshDrawCommand>		 MeshDrawCommands;
+		std::vector<TransformData>			 MeshTransforms;
+		std::vector<MeshDrawCommandOverride> MeshOverrides;
 
-		std::map<BatchMeshKey, MeshDrawCommand>			MeshDrawCommands;
 		std::map<BatchMeshKey, AnimatedMeshDrawCommand>	AnimatedMeshDrawCommands;
 		std::map<BatchMeshKey, InstanceMeshDrawCommand>	InstanceMeshDrawCommands;
 		std::map<AssetHandle,  IndirectMeshDrawCommand>	IndirectDrawCommands;
 		std::map<AssetHandle,  ComputeCommandBatch>	    ComputeCommands;
 
-		void Clear()
+	private:
+		void buildMeshCommands(const uint64_t* visibleMeshes, uint32_t begin, uint32_t end);
+		void buildSpriteCommands(uint32_t begin, uint32_t end);
+		void buildBillboardCommands(uint32_t begin, uint32_t end);
+
+		struct SegmentRemap
 		{
-			SpriteDrawCommands.clear();
-			BillboardDrawCommands.clear();
-			MeshDrawCommands.clear();
-			AnimatedMeshDrawCommands.clear();
-			InstanceMeshDrawCommands.clear();
-			IndirectDrawCommands.clear();
-			ComputeCommands.clear();
-		}
+			std::vector<uint32_t> Meshes;
+			std::vector<uint32_t> Materials;
+			std::vector<uint32_t> MaterialInstances;
+			std::vector<uint32_t> Textures;
+
+			uint32_t KeyOffset = 0;
+			uint32_t MeshOffset = 0;
+			uint32_t SpriteOffset = 0;
+			uint32_t BillboardOffset = 0;
+		};
+		void mergeSegment(const GeometryRenderQueue& segment, const SegmentRemap& remap);
+
+	private:
+		RadixSorter				  m_Sorter;
+		std::vector<SegmentRemap> m_SegmentRemaps;
 	};
+
+
+	template <typename T>
+	inline uint32_t RenderResourceTable<T>::Intern(const Ref<T>& resource)
+	{
+		// Pointers are aligned, low bits used for slot index have to be mixed
+		const T* raw = resource.Raw();
+		const uint64_t product = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(raw)) * 0x9E3779B97F4A7C15ull;
+		const size_t hash = static_cast<size_t>(product ^ (product >> 32));
+		const uint32_t existing = m_Index.Find(hash, [&](uint32_t index) { return m_Resources[index].Raw() == raw; });
+		if (existing != HashIndex::sc_InvalidValue)
+			return existing;
+
+		const uint32_t index = static_cast<uint32_t>(m_Resources.size());
+		m_Resources.push_back(resource);
+		m_Index.Insert(hash, index);
+		return index;
+	}
+
+	template <typename T>
+	inline void RenderResourceTable<T>::Clear()
+	{
+		m_Resources.clear();
+		m_Index.Clear();
+	}
 }
\ No newline at end of file
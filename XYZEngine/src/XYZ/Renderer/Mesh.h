@@ -20,6 +20,9 @@ namespace XYZ {
 		virtual Ref<VertexBuffer>   GetVertexBuffer() const = 0;
 		virtual Ref<IndexBuffer>    GetIndexBuffer()  const = 0;		
 		virtual const RenderID&		GetRenderID() const = 0;
+
+		// Local space bounds, nullptr if mesh has no bounds
+		virtual const AABB*			GetBoundingBox() const { return nullptr; }
 	};
 
 	
@@ -36,6 +39,7 @@ namespace XYZ {
 		virtual Ref<VertexBuffer>   GetVertexBuffer() const override { return m_MeshSource->GetVertexBuffer(); }
 		virtual Ref<IndexBuffer>    GetIndexBuffer()  const override { return m_MeshSource->GetIndexBuffer(); }
 		virtual const RenderID&		GetRenderID() const override { return GetHandle(); }
+		virtual const AABB*			GetBoundingBox() const override { return &m_MeshSource->GetSubmeshBoundingBox(); }
 
 
 		static AssetType	GetStaticType() { return AssetType::StaticMesh; }
@@ -61,6 +65,7 @@ namespace XYZ {
 		virtual Ref<VertexBuffer>   GetVertexBuffer() const override { return m_MeshSource->GetVertexBuffer(); }
 		virtual Ref<IndexBuffer>    GetIndexBuffer()  const override { return m_MeshSource->GetIndexBuffer(); }
 		virtual const RenderID&		GetRenderID() const override { return GetHandle(); }
+		virtual const AABB*			GetBoundingBox() const override { return &m_MeshSource->GetSubmeshBoundingBox(); }
 
 		static AssetType	GetStaticType() { return AssetType::AnimatedMesh; }
 
@@ -243,7 +243,7 @@ namespace XYZ {
 
 	void GeometryPass::submitStaticMeshes(GeometryRenderQueue& queue, const Ref<RenderCommandBuffer>& commandBuffer)
 	{
-		for (auto& [key, command] : queue.MeshDrawCommands)
+		for (auto& command : queue.MeshDrawCommands)
 		{
 			Renderer::BindPipeline(
 				commandBuffer,
@@ -266,8 +266,9 @@ namespace XYZ {
 					command.TransformInstanceCount
 				);
 			}
-			for (auto& dcOverride : command.OverrideCommands)
+			for (uint32_t i = 0; i < command.OverrideCount; ++i)
 			{
+				const auto& dcOverride = queue.MeshOverrides[command.FirstOverride + i];
 				Renderer::RenderMesh(
 					commandBuffer,
 					command.Pipeline,
@@ -351,21 +352,27 @@ namespace XYZ {
 
 		m_Renderer2D->BeginScene(viewMatrix);
 
-		for (auto& [key, command] : queue.SpriteDrawCommands)
+		for (auto& command : queue.SpriteDrawCommands)
 		{
 			Ref<Pipeline> pipeline = m_PipelineCache.PreparePipeline(command.MaterialAsset, m_SceneRenderer->m_GeometryRenderPass);
-			for (const auto& data : command.SpriteData)
+			for (uint32_t i = 0; i < command.DataCount; ++i)
+			{
+				const auto& data = queue.SpriteData[command.DataOffset + i];
 				m_Renderer2D->SubmitQuad(data.Transform, data.TexCoords, data.TextureIndex, data.Color);
+			}
 
 			Renderer::BindPipeline(commandBuffer, pipeline, m_SceneRenderer->m_UniformBufferSet, nullptr, command.MaterialAsset->GetMaterial());
 			m_Renderer2D->FlushQuads(pipeline, command.MaterialInstance, true);
 		}
 
-		for (auto& [key, command] : queue.BillboardDrawCommands)
+		for (auto& command : queue.BillboardDrawCommands)
 		{
 			Ref<Pipeline> pipeline = m_PipelineCache.PreparePipeline(command.MaterialAsset, m_SceneRenderer->m_GeometryRenderPass);
-			for (const auto& data : command.BillboardData)
+			for (uint32_t i = 0; i < command.DataCount; ++i)
+			{
+				const auto& data = queue.BillboardData[command.DataOffset + i];
 				m_Renderer2D->SubmitQuadBillboard(data.Position, data.Size, data.TexCoords, data.TextureIndex, data.Color);
+			}
 
 			Renderer::BindPipeline(commandBuffer, pipeline, m_SceneRenderer->m_UniformBufferSet, nullptr, command.MaterialAsset->GetMaterial());
 			m_Renderer2D->FlushQuads(pipeline, command.MaterialInstance, true);
@@ -383,7 +390,7 @@ namespace XYZ {
 			m_DepthPipeline3DStatic.Material
 		);
 
-		for (auto& [key, command] : queue.MeshDrawCommands)
+		for (auto& command : queue.MeshDrawCommands)
 		{
 			Renderer::RenderMesh(
 				commandBuffer,
@@ -396,8 +403,9 @@ namespace XYZ {
 				command.TransformOffset,
 				command.TransformInstanceCount
 			);
-			for (auto& dcOverride : command.OverrideCommands)
+			for (uint32_t i = 0; i < command.OverrideCount; ++i)
 			{
+				const auto& dcOverride = queue.MeshOverrides[command.FirstOverride + i];
 				Renderer::RenderMesh(
 					commandBuffer,
 					m_DepthPipeline3DStatic.Pipeline,
@@ -485,17 +493,23 @@ namespace XYZ {
 			nullptr, 
 			m_DepthPipeline2D.Material
 		);
-		for (auto& [key, command] : queue.SpriteDrawCommands)
+		for (auto& command : queue.SpriteDrawCommands)
 		{
-			for (const auto& data : command.SpriteData)
+			for (uint32_t i = 0; i < command.DataCount; ++i)
+			{
+				const auto& data = queue.SpriteData[command.DataOffset + i];
 				m_Renderer2D->SubmitQuad(data.Transform, data.TexCoords, data.TextureIndex, data.Color);
+			}
 
 			m_Renderer2D->FlushQuads(m_DepthPipeline2D.Pipeline, command.MaterialInstance, false);
 		}
-		for (auto& [key, command] : queue.BillboardDrawCommands)
+		for (auto& command : queue.BillboardDrawCommands)
 		{	
-			for (const auto& data : command.BillboardData)
+			for (uint32_t i = 0; i < command.DataCount; ++i)
+			{
+				const auto& data = queue.BillboardData[command.DataOffset + i];
 				m_Renderer2D->SubmitQuadBillboard(data.Position, data.Size, data.TexCoords, data.TextureIndex, data.Color);
+			}
 
 			m_Renderer2D->FlushQuads(m_DepthPipeline2D.Pipeline, command.MaterialInstance, false);
 		}
@@ -504,16 +518,17 @@ namespace XYZ {
 
 	void GeometryPass::prepareStaticDrawCommands(GeometryRenderQueue& queue, size_t& overrideCount, uint32_t& transformsCount)
 	{	
-		for (auto& [key, dc] : queue.MeshDrawCommands)
+		for (auto& dc : queue.MeshDrawCommands)
 		{
 			dc.Pipeline = m_PipelineCache.PreparePipeline(dc.MaterialAsset, m_SceneRenderer->m_GeometryRenderPass);
 			dc.TransformOffset = transformsCount * sizeof(GeometryRenderQueue::TransformData);
-			overrideCount += dc.OverrideCommands.size();
-			for (const auto& transform : dc.TransformData)
-			{
-				m_SceneRenderer->m_TransformData[transformsCount] = transform;
-				transformsCount++;
-			}
+			overrideCount += dc.OverrideCount;
+			memcpy(
+				&m_SceneRenderer->m_TransformData[transformsCount],
+				&queue.MeshTransforms[dc.FirstTransform],
+				dc.TransformInstanceCount * sizeof(GeometryRenderQueue::TransformData)
+			);
+			transformsCount += dc.TransformInstanceCount;
 		}
 	}
 	void GeometryPass::prepareComputeCommands(GeometryRenderQueue& queue)
@@ -619,14 +634,14 @@ namespace XYZ {
 
 	void GeometryPass::prepare2DDrawCommands(GeometryRenderQueue& queue)
 	{
-		for (auto& [key, command] : queue.SpriteDrawCommands)
+		for (auto& command : queue.SpriteDrawCommands)
 		{
 			for (uint32_t i = 0; i < command.TextureCount; ++i)
 				command.MaterialAsset->GetMaterial()->SetImageArray("u_Texture", command.Textures[i]->GetImage(), i);
 			for (uint32_t i = command.TextureCount; i < Renderer2D::GetMaxTextures(); ++i)
 				command.MaterialAsset->GetMaterial()->SetImageArray("u_Texture", m_WhiteTexture->GetImage(), i);
 		}
-		for (auto& [key, command] : queue.BillboardDrawCommands)
+		for (auto& command : queue.BillboardDrawCommands)
 		{
 			for (uint32_t i = 0; i < command.TextureCount; ++i)
 				command.MaterialAsset->GetMaterial()->SetImageArray("u_Texture", command.Textures[i]->GetImage(), i);
@@ -705,7 +720,7 @@ namespace XYZ {
 	{
 		std::vector<RaytracingGeometrySpecification> specifications;
 
-		for (auto& [key, command] : queue.MeshDrawCommands)
+		for (auto& command : queue.MeshDrawCommands)
 		{
 			auto& spec = specifications.emplace_back();
 
@@ -101,6 +101,7 @@ namespace XYZ {
 		RendererConfiguration		   Configuration;
 		RendererResources			   Resources;
 		ShaderDependencyMap			   ShaderDependencies;
+		FrameAllocator				   FrameMemory;
 	};
 
 	RendererAPI::Type RendererAPI::s_API = RendererAPI::Type::Vulkan;
@@ -158,6 +159,7 @@ namespace XYZ {
 		s_Data.APIContext = APIContext::Create();
 		s_RendererAPI = CreateRendererAPI();	
 		s_Data.QueueData.Init(s_Data.Configuration.FramesInFlight);	
+		s_Data.FrameMemory.Init(s_Data.Configuration.FramesInFlight);
 	}
 
 	void Renderer::InitAPI(bool initDefaultResources)
@@ -179,6 +181,7 @@ namespace XYZ {
 		s_Data.Resources.Shutdown();
 		s_RendererAPI->Shutdown();
 		s_Data.QueueData.Shutdown();
+		s_Data.FrameMemory.Shutdown();
 
 		delete s_RendererAPI;
 		s_RendererAPI = nullptr;
@@ -190,6 +193,7 @@ namespace XYZ {
 
 	void Renderer::BeginFrame()
 	{
+		s_Data.FrameMemory.BeginFrame();
 		s_RendererAPI->BeginFrame();
 	}
 
@@ -336,6 +340,11 @@ namespace XYZ {
 		return s_Data.QueueData.GetThreadPool();
 	}
 
+	FrameAllocator& Renderer::GetFrameAllocator()
+	{
+		return s_Data.FrameMemory;
+	}
+
 	const RendererStats& Renderer::GetStats()
 	{
 		return s_Data.Stats;
@@ -411,6 +420,7 @@ namespace XYZ {
 	void RendererResources::Init()
 	{
 		Includer.AddIncludes("Resources/Shaders/Includes");
+		Shader::PrecompileDirectory("Resources/Shaders");
 
 		auto whiteTexture = AssetManager::GetAsset<Texture2D>("Resources/Textures/WhiteTexture.tex");
 		whiteTexture->SetFlag(AssetFlag::ReadOnly);
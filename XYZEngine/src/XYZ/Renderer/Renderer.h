@@ -4,6 +4,7 @@
 #include "XYZ/Core/Application.h"
 #include "XYZ/Core/ThreadPool.h"
 #include "XYZ/Utils/DataStructures/ThreadPass.h"
+#include "XYZ/Utils/DataStructures/FrameAllocator.h"
 #include "XYZ/Debug/Profiler.h"
 
 #include "Shader.h"
@@ -146,6 +147,7 @@ namespace XYZ {
 		static void ExecuteResources(uint32_t index);
 
 		static ThreadPool&			GetPool();
+		static FrameAllocator&		GetFrameAllocator(); // Transient memory, valid for FramesInFlight frames
 		static RendererAPI::Type	GetAPI() { return RendererAPI::GetType(); }
 		static const RendererStats& GetStats();
 		static uint32_t			    GetCurrentFrame();
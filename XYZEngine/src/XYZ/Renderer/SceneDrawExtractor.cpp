@@ -0,0 +1,102 @@
+#include "stdafx.h"
+#include "SceneDrawExtractor.h"
+
+#include "XYZ/Scene/Components.h"
+
+#include "XYZ/Debug/Profiler.h"
+#include "XYZ/Debug/Timer.h"
+
+namespace XYZ {
+
+	void SceneDrawExtractor::Extract(entt::registry& registry, GeometryRenderQueue& queue, ThreadPool* pool)
+	{
+		XYZ_PROFILE_FUNC("SceneDrawExtractor::Extract");
+		gather(registry);
+		Record(m_Sprites, m_Meshes, queue, pool);
+	}
+
+	void SceneDrawExtractor::Record(const std::vector<SpriteDraw>& sprites, const std::vector<MeshDraw>& meshes, GeometryRenderQueue& queue, ThreadPool* pool)
+	{
+		XYZ_PROFILE_FUNC("SceneDrawExtractor::Record");
+		Stopwatch timer;
+		const uint32_t drawCount = static_cast<uint32_t>(sprites.size() + meshes.size());
+		uint32_t segmentCount = 1;
+		if (pool)
+			segmentCount = std::clamp(drawCount / sc_MinSegmentSize, 1u, pool->GetNumThreads() + 1);
+
+		if (segmentCount == 1)
+		{
+			recordSegment(sprites, meshes, queue, 0, 1);
+			m_Stats.ExtractTimeMs = timer.Elapsed();
+			m_Stats.MergeTimeMs = 0.0f;
+		}
+		else
+		{
+			if (m_Segments.size() < segmentCount)
+				m_Segments.resize(segmentCount);
+
+			pool->ParallelFor(segmentCount, 1, [&](uint32_t index) {
+				GeometryRenderQueue& segment = m_Segments[index];
+				segment.Clear();
+				segment.ViewPosition = queue.ViewPosition;
+				recordSegment(sprites, meshes, segment, index, segmentCount);
+			});
+			m_Stats.ExtractTimeMs = timer.Elapsed();
+
+			Stopwatch mergeTimer;
+			queue.Merge(m_Segments.data(), segmentCount, pool);
+			m_Stats.MergeTimeMs = mergeTimer.Elapsed();
+		}
+		m_Stats.SpriteCount = static_cast<uint32_t>(sprites.size());
+		m_Stats.MeshCount = static_cast<uint32_t>(meshes.size());
+		m_Stats.SegmentCount = segmentCount;
+	}
+
+	void SceneDrawExtractor::gather(entt::registry& registry)
+	{
+		XYZ_PROFILE_FUNC("SceneDrawExtractor::gather");
+		// Views are walked and asset references resolved on calling thread.
+		// Resolving can wait for asset load and writes cached ref of the component, so workers must not do it
+		m_Sprites.clear();
+		auto spriteView = registry.view<TransformComponent, SpriteRenderer>();
+		for (auto entity : spriteView)
+		{
+			auto& [transform, spriteRenderer] = spriteView.get<TransformComponent, SpriteRenderer>(entity);
+			if (!spriteRenderer.Material.Valid() || !spriteRenderer.SubTexture.Valid())
+				continue;
+
+			m_Sprites.push_back({ &spriteRenderer.Material.Value(), &spriteRenderer.SubTexture.Value(), &spriteRenderer.Color, &transform->WorldTransform });
+		}
+
+		m_Meshes.clear();
+		auto meshView = registry.view<TransformComponent, MeshComponent>();
+		for (auto entity : meshView)
+		{
+			auto& [transform, meshComponent] = meshView.get<TransformComponent, MeshComponent>(entity);
+			if (!meshComponent.MaterialAsset.Valid() || !meshComponent.Mesh.Valid())
+				continue;
+
+			m_Meshes.push_back({ &meshComponent.Mesh.Value(), &meshComponent.MaterialAsset.Value(), &meshComponent.OverrideMaterial, &transform->WorldTransform });
+		}
+	}
+
+	void SceneDrawExtractor::recordSegment(const std::vector<SpriteDraw>& sprites, const std::vector<MeshDraw>& meshes, GeometryRenderQueue& segment, uint32_t index, uint32_t count)
+	{
+		XYZ_PROFILE_FUNC("SceneDrawExtractor::recordSegment");
+		const size_t spriteBegin = sprites.size() * index / count;
+		const size_t spriteEnd = sprites.size() * (index + 1) / count;
+		for (size_t i = spriteBegin; i < spriteEnd; ++i)
+		{
+			const SpriteDraw& draw = sprites[i];
+			segment.SubmitSprite(*draw.Material, *draw.SubTexture, *draw.Color, *draw.Transform);
+		}
+
+		const size_t meshBegin = meshes.size() * index / count;
+		const size_t meshEnd = meshes.size() * (index + 1) / count;
+		for (size_t i = meshBegin; i < meshEnd; ++i)
+		{
+			const MeshDraw& draw = meshes[i];
+			segment.SubmitMesh(*draw.Mesh, *draw.Material, *draw.Transform, *draw.OverrideMaterial);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+#include "XYZ/Core/ThreadPool.h"
+#include "GeometryRenderQueue.h"
+
+#include <entt/entt.hpp>
+
+namespace XYZ {
+
+	// Records sprite and static mesh draws of registry to render queue.
+	// Entities are split to contiguous ranges, every range is recorded to its own queue segment on worker thread
+	// and segments are merged in range order, so result does not depend on number of threads
+	class XYZ_API SceneDrawExtractor
+	{
+	public:
+		struct Stats
+		{
+			uint32_t SpriteCount = 0;
+			uint32_t MeshCount = 0;
+			uint32_t SegmentCount = 0;
+			float	 ExtractTimeMs = 0.0f;
+			float	 MergeTimeMs = 0.0f;
+		};
+
+		// Draw with asset references already resolved, workers only read through the pointers
+		struct SpriteDraw
+		{
+			const Ref<MaterialAsset>* Material;
+			const Ref<SubTexture>*	  SubTexture;
+			const glm::vec4*		  Color;
+			const glm::mat4*		  Transform;
+		};
+
+		struct MeshDraw
+		{
+			const Ref<StaticMesh>*		 Mesh;
+			const Ref<MaterialAsset>*	 Material;
+			const Ref<MaterialInstance>* OverrideMaterial;
+			const glm::mat4*			 Transform;
+		};
+
+	public:
+		// Does not need renderer, queue only has to have ViewPosition set
+		void Extract(entt::registry& registry, GeometryRenderQueue& queue, ThreadPool* pool = nullptr);
+
+		// Records already resolved draws, part of Extract after gather
+		void Record(const std::vector<SpriteDraw>& sprites, const std::vector<MeshDraw>& meshes, GeometryRenderQueue& queue, ThreadPool* pool = nullptr);
+
+		const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		void gather(entt::registry& registry);
+		static void recordSegment(const std::vector<SpriteDraw>& sprites, const std::vector<MeshDraw>& meshes, GeometryRenderQueue& segment, uint32_t index, uint32_t count);
+
+	private:
+		static constexpr uint32_t sc_MinSegmentSize = 1024;
+
+		std::vector<SpriteDraw>			 m_Sprites;
+		std::vector<MeshDraw>			 m_Meshes;
+		std::vector<GeometryRenderQueue> m_Segments;
+
+		Stats m_Stats;
+	};
+}
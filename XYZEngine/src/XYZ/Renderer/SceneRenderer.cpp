@@ -15,6 +15,7 @@
 #include "XYZ/Asset/AssetManager.h"
 
 #include "XYZ/Utils/Math/Math.h"
+#include "XYZ/Core/Application.h"
 
 #include <glm/gtx/transform.hpp>
 
@@ -22,6 +23,8 @@
 
 namespace XYZ {
 
+	static constexpr uint32_t sc_ParallelCullingThreshold = 16384;
+
 	static GeometryRenderQueue::TransformData Mat4ToTransformData(const glm::mat4& transform)
 	{
 		GeometryRenderQueue::TransformData data;
@@ -131,6 +134,8 @@ namespace XYZ {
 		m_CameraDataUB.ProjectionMatrix = m_SceneCamera.Camera.GetProjectionMatrix();
 		m_CameraDataUB.ViewMatrix = m_SceneCamera.ViewMatrix;
 		m_CameraDataUB.CameraPosition = m_SceneCamera.ViewPosition;
+		m_Frustum = Math::ExtractFrustum(m_CameraDataUB.ViewProjectionMatrix);
+		m_Queue.ViewPosition = m_CameraDataUB.CameraPosition;
 
 		const auto& lightEnvironment = m_ActiveScene->m_LightEnvironment;
 		m_SceneDataUB.NumberDirectionalLights = static_cast<uint32_t>(lightEnvironment.DirectionalLights.size());
@@ -148,6 +153,8 @@ namespace XYZ {
 		m_CameraDataUB.ProjectionMatrix = projection;
 		m_CameraDataUB.ViewMatrix = viewMatrix;
 		m_CameraDataUB.CameraPosition = glm::inverse(viewMatrix)[3];
+		m_Frustum = Math::ExtractFrustum(m_CameraDataUB.ViewProjectionMatrix);
+		m_Queue.ViewPosition = m_CameraDataUB.CameraPosition;
 
 		const auto& lightEnvironment = m_ActiveScene->m_LightEnvironment;
 		m_SceneDataUB.NumberDirectionalLights = static_cast<uint32_t>(lightEnvironment.DirectionalLights.size());
@@ -200,58 +207,30 @@ namespace XYZ {
 
 	void SceneRenderer::SubmitBillboard(const Ref<MaterialAsset>& material, const Ref<SubTexture>& subTexture, uint32_t sortLayer, const glm::vec4& color, const glm::vec3& position, const glm::vec2& size)
 	{
-		GeometryRenderQueue::SpriteKey key{ material->GetHandle() };
-
-		auto& command = m_Queue.BillboardDrawCommands[key];
-
-		uint32_t textureIndex = command.SetTexture(subTexture->GetTexture());
-
-		command.MaterialAsset = material;
-		command.MaterialInstance = material->GetMaterialInstance();
-
-		command.BillboardData.push_back({ textureIndex, subTexture->GetTexCoords(), color, position, size });
+		m_Queue.SubmitBillboard(material, subTexture, color, position, size);
 	}
 
 	void SceneRenderer::SubmitSprite(const Ref<MaterialAsset>& material, const Ref<SubTexture>& subTexture, const glm::vec4& color, const glm::mat4& transform)
 	{
-		GeometryRenderQueue::SpriteKey key{ material->GetHandle() };
-		auto& command = m_Queue.SpriteDrawCommands[key];
-		
-		uint32_t textureIndex = command.SetTexture(subTexture->GetTexture());
-		
-		command.MaterialAsset = material;
-		command.MaterialInstance = material->GetMaterialInstance();
-		command.SpriteData.push_back({ textureIndex, subTexture->GetTexCoords(), color, transform });
+		m_Queue.SubmitSprite(material, subTexture, color, transform);
 	}
 
-	void SceneRenderer::SubmitMesh(const Ref<Mesh>& mesh, const Ref<MaterialAsset>& material, const glm::mat4& transform, const Ref<MaterialInstance>& overrideMaterial)
+	void SceneRenderer::SubmitDraws(entt::registry& registry)
 	{
-		GeometryRenderQueue::BatchMeshKey key{ mesh->GetRenderID(), material->GetHandle() };
-		
-		auto& dc = m_Queue.MeshDrawCommands[key];
-		dc.Mesh = mesh;
-		dc.MaterialAsset = material;
+		ThreadPool* pool = m_Options.ParallelDrawExtraction ? &Application::Get().GetThreadPool() : nullptr;
+		m_DrawExtractor.Extract(registry, m_Queue, pool);
+	}
 
-		if (overrideMaterial.Raw())
-		{
-			auto& dcOverride = dc.OverrideCommands.emplace_back();
-			dcOverride.OverrideMaterial = overrideMaterial;
-			dcOverride.Transform = transform;
-		}
-		else
-		{		
-			dc.Count++;
-			dc.OverrideMaterial = material->GetMaterialInstance();
-			dc.TransformInstanceCount++;
-			dc.TransformData.push_back(Mat4ToTransformData(transform));
-		}
+	void SceneRenderer::SubmitMesh(const Ref<Mesh>& mesh, const Ref<MaterialAsset>& material, const glm::mat4& transform, const Ref<MaterialInstance>& overrideMaterial)
+	{
+		m_Queue.SubmitMesh(mesh, material, transform, overrideMaterial);
 	}
 
 	void SceneRenderer::SubmitMesh(const Ref<Mesh>& mesh, const Ref<MaterialAsset>& material, const void* instanceData, uint32_t instanceCount, uint32_t instanceSize, const Ref<MaterialInstance>& overrideMaterial)
 	{
 		GeometryRenderQueue::BatchMeshKey key{ mesh->GetRenderID(), material->GetHandle() };
 
-		auto& dc = m_Queue.InstanceMeshDrawCommands[key];
+		auto& dc = m_Queue.InstanceMeshDrawCommands.try_emplace(key, &Renderer::GetFrameAllocator()).first->second;
 		dc.Mesh = mesh;
 		dc.MaterialAsset = material;
 		dc.Transform = glm::mat4(1.0f);
@@ -276,7 +255,7 @@ namespace XYZ {
 	{
 		GeometryRenderQueue::BatchMeshKey key{ mesh->GetHandle(), material->GetHandle() };
 
-		auto& dc = m_Queue.AnimatedMeshDrawCommands[key];
+		auto& dc = m_Queue.AnimatedMeshDrawCommands.try_emplace(key, &Renderer::GetFrameAllocator()).first->second;
 		dc.Mesh = mesh;
 		dc.MaterialAsset = material;
 
@@ -427,6 +406,14 @@ namespace XYZ {
 						[]() { ImGui::Text("Show Grid"); },
 						[&]() { ImGui::Checkbox("##ShowGrid", &m_Options.ShowGrid); }
 					);
+					UI::TableRow("FrustumCullingRow",
+						[]() { ImGui::Text("Frustum Culling"); },
+						[&]() { ImGui::Checkbox("##FrustumCulling", &m_Options.FrustumCulling); }
+					);
+					UI::TableRow("ParallelDrawExtractionRow",
+						[]() { ImGui::Text("Parallel Draw Extraction"); },
+						[&]() { ImGui::Checkbox("##ParallelDrawExtraction", &m_Options.ParallelDrawExtraction); }
+					);
 
 					UI::TableRow("GridScaleRow",
 						[]() { ImGui::Text("Grid Scale"); },
@@ -498,6 +485,7 @@ namespace XYZ {
 					
 					UI::TextTableRow("%s", "Mesh Draw Count:", "%u", m_RenderStatistics.MeshDrawCommandCount);
 					UI::TextTableRow("%s", "Mesh Override Draw Count:", "%u", m_RenderStatistics.MeshOverrideDrawCommandCount);
+					UI::TextTableRow("%s", "Culled Mesh Count:", "%u", m_RenderStatistics.CulledMeshCount);
 
 					
 					UI::TextTableRow("%s", "Animated Mesh Draw Count:", "%u", m_RenderStatistics.AnimatedMeshDrawCommandCount);
@@ -512,7 +500,17 @@ namespace XYZ {
 
 					UI::TextTableRow("%s", "Transform Instances:", "%u", m_RenderStatistics.TransformInstanceCount);
 					UI::TextTableRow("%s", "Instance Data Size:", "%u", m_RenderStatistics.InstanceDataSize);
-					
+
+					const auto& extractorStats = m_DrawExtractor.GetStats();
+					UI::TextTableRow("%s", "Draw Extraction Segments:", "%u", extractorStats.SegmentCount);
+					UI::TextTableRow("%s", "Draw Extraction:", "%.3fms", extractorStats.ExtractTimeMs);
+					UI::TextTableRow("%s", "Draw Extraction Merge:", "%.3fms", extractorStats.MergeTimeMs);
+
+					const auto& frameMemoryStats = Renderer::GetFrameAllocator().GetLastFrameStats();
+					UI::TextTableRow("%s", "Frame Memory Used:", "%llu", static_cast<uint64_t>(frameMemoryStats.Used));
+					UI::TextTableRow("%s", "Frame Memory High Water Mark:", "%llu", static_cast<uint64_t>(frameMemoryStats.HighWaterMark));
+					UI::TextTableRow("%s", "Frame Memory Block Allocations:", "%u", frameMemoryStats.BlockAllocations);
+
 					ImGui::EndTable();
 				}
 				UI::EndTreeNode();
@@ -707,6 +705,8 @@ namespace XYZ {
 	}
 	void SceneRenderer::preRender()
 	{
+		cullMeshes();
+		m_Queue.Sort(m_Options.FrustumCulling ? m_VisibleMeshes.data() : nullptr);
 		m_GeometryPassStatistics = m_GeometryPass.PreSubmit(m_Queue);
 		DeferredLightPassStatistics lightPassStats = m_DeferredLightPass.PreSubmit(m_ActiveScene);
 		
@@ -726,6 +726,28 @@ namespace XYZ {
 		m_RenderStatistics.SpotLight2DCount = lightPassStats.SpotLightCount;
 	}
 
+	void SceneRenderer::cullMeshes()
+	{
+		XYZ_PROFILE_FUNC("SceneRenderer::cullMeshes");
+		m_RenderStatistics.CulledMeshCount = 0;
+		if (!m_Options.FrustumCulling)
+			return;
+
+		// Bounds of all mesh submits are culled at once, invisible transforms are skipped when draw commands are built
+		const AABBSoA& bounds = m_Queue.MeshBounds;
+		const uint32_t count = bounds.Size();
+		m_VisibleMeshes.resize(Math::CullingMaskSize(count));
+		if (count > sc_ParallelCullingThreshold)
+			Math::CullAABBs(m_Frustum, bounds, m_VisibleMeshes.data(), Application::Get().GetThreadPool());
+		else
+			Math::CullAABBs(m_Frustum, bounds, m_VisibleMeshes.data());
+
+		uint32_t visibleCount = 0;
+		for (uint32_t i = 0; i < count; ++i)
+			visibleCount += static_cast<uint32_t>((m_VisibleMeshes[i / 64] >> (i % 64)) & 1);
+		m_RenderStatistics.CulledMeshCount = count - visibleCount;
+	}
+
 	void SceneRenderer::renderGrid()
 	{
 		const glm::mat4 transform = glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f)) * glm::scale(glm::mat4(1.0f), glm::vec3(8.0f));
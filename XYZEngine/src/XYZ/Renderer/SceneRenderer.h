@@ -10,6 +10,7 @@
 #include "PipelineCompute.h"
 #include "MaterialInstance.h"
 #include "GeometryRenderQueue.h"
+#include "SceneDrawExtractor.h"
 #include "SceneRendererBuffers.h"
 #include "PushConstBuffer.h"
 #include "StorageBufferAllocator.h"
@@ -41,6 +42,8 @@ namespace XYZ {
 	{
 		bool ShowGrid = true;
 		bool ShowBoundingBoxes = false;
+		bool FrustumCulling = true;
+		bool ParallelDrawExtraction = false; // Opt in, see SceneDrawExtractorScaling benchmark
 	};
 
 	struct SceneRendererCamera
@@ -83,6 +86,9 @@ namespace XYZ {
 		void SubmitMesh(const Ref<Mesh>& mesh, const Ref<MaterialAsset>& material, const glm::mat4& transform, const Ref<MaterialInstance>& overrideMaterial = nullptr);
 		void SubmitMesh(const Ref<Mesh>& mesh, const Ref<MaterialAsset>& material, const void* instanceData, uint32_t instanceCount, uint32_t instanceSize, const Ref<MaterialInstance>& overrideMaterial);
 		void SubmitMesh(const Ref<AnimatedMesh>& mesh, const Ref<MaterialAsset>& material, const glm::mat4& transform, const std::vector<ozz::math::Float4x4>& boneTransforms, const Ref<MaterialInstance>& overrideMaterial = nullptr);
+
+		// Submits sprites and static meshes of registry, recorded on worker threads if ParallelDrawExtraction is enabled
+		void SubmitDraws(entt::registry& registry);
 		
 		// Compute stuff
 		bool CreateComputeAllocation(uint32_t size, uint32_t index, StorageBufferAllocation& allocation);
@@ -127,6 +133,7 @@ namespace XYZ {
 
 		void updateViewportSize();
 		void preRender();
+		void cullMeshes();
 		void renderGrid();
 
 		void updateBufferSets();
@@ -171,6 +178,8 @@ namespace XYZ {
 		Ref<StorageBufferAllocator> m_IndirectCommandAllocator;
 
 		SceneRendererCamera		   m_SceneCamera;
+		Math::Frustum			   m_Frustum;
+		std::vector<uint64_t>	   m_VisibleMeshes;
 		SceneRendererOptions	   m_Options;
 		BloomSettings			   m_BloomSettings;
 		GridProperties			   m_GridProps;
@@ -178,6 +187,7 @@ namespace XYZ {
 		glm::ivec3				   m_LightCullingWorkGroups;
 
 		GeometryRenderQueue		   m_Queue;								   
+		SceneDrawExtractor		   m_DrawExtractor;
 		bool				       m_ViewportSizeChanged = false;
 	
 		Ref<ShaderAsset>		   m_CompositeShaderAsset;
@@ -202,6 +212,7 @@ namespace XYZ {
 			
 			uint32_t TransformInstanceCount = 0;
 			uint32_t InstanceDataSize = 0;
+			uint32_t CulledMeshCount = 0;
 		};
 		RenderStatistics m_RenderStatistics;
 		GeometryPassStatistics m_GeometryPassStatistics;
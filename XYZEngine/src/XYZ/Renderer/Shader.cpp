@@ -4,6 +4,7 @@
 #include "Renderer.h"
 
 #include "XYZ/API/Vulkan/VulkanShader.h"
+#include "XYZ/Utils/StringUtils.h"
 
 namespace XYZ {
 	
@@ -54,7 +55,26 @@ namespace XYZ {
 		XYZ_ASSERT(false, "Renderer::GetAPI() = RendererAPI::None");
 		return nullptr;
 	}
-	
+
+	void Shader::PrecompileDirectory(const std::string& directory)
+	{
+		std::vector<std::string> paths;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+		{
+			if (entry.is_regular_file() && Utils::GetExtension(entry.path().string()) == "glsl")
+				paths.push_back(entry.path().generic_string());
+		}
+
+		switch (Renderer::GetAPI())
+		{
+		case RendererAPI::Type::None:
+		{
+			XYZ_ASSERT(false, "Renderer::GetAPI() = RendererAPI::None");
+			return;
+		}
+		case RendererAPI::Type::Vulkan: VulkanShader::Precompile(paths); return;
+		}
+	}
 
 	ShaderUniform::ShaderUniform(std::string name, ShaderUniformDataType dataType, uint32_t size, uint32_t offset, uint32_t count)
 		:
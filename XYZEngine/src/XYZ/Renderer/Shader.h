@@ -155,9 +155,12 @@ namespace XYZ {
 		virtual bool IsCompute()  const = 0;
 		virtual bool IsCompiled() const = 0;
 
-		static Ref<Shader> Create(const std::string& path, size_t sourceHash = 0, bool forceCompile = true);
-		static Ref<Shader> Create(const std::string& name, const std::string& path, size_t sourceHash = 0, bool forceCompile = true);
-		static Ref<Shader> Create(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath, size_t sourceHash = 0, bool forceCompile = true);
+		static Ref<Shader> Create(const std::string& path, size_t sourceHash = 0, bool forceCompile = false);
+		static Ref<Shader> Create(const std::string& name, const std::string& path, size_t sourceHash = 0, bool forceCompile = false);
+		static Ref<Shader> Create(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath, size_t sourceHash = 0, bool forceCompile = false);
+
+		// Compiles all shaders in directory in parallel, later created shaders use cached binaries
+		static void PrecompileDirectory(const std::string& directory);
 	};
 
 }
\ No newline at end of file
@@ -124,11 +124,18 @@ namespace XYZ {
 		return subAllocation;
 	}
 
+	uint32_t StorageBufferAllocation::GetOffset() const
+	{
+		if (!m_Valid)
+			return m_Offset;
+		return m_Allocator->m_OffsetAllocator.GetOffset(m_ID) + m_Offset;
+	}
+
 	void StorageBufferAllocation::returnAllocation()
 	{
 		if (m_Valid && !m_IsSuballocation)
 		{
-			m_Allocator->returnAllocation(m_Size, m_Offset, m_ID);
+			m_Allocator->returnAllocation(m_ID);
 			m_Valid = false;
 		}
 	}
@@ -137,10 +144,7 @@ namespace XYZ {
 		m_Binding(binding),
 		m_Set(set),
 		m_Size(size),
-		m_Next(0),
-		m_AllocatedSize(0),
-		m_UnusedSpace(0),
-		m_SortRequired(false)
+		m_OffsetAllocator(size)
 	{
 	}
 
@@ -156,36 +160,31 @@ namespace XYZ {
 		// Allocation is not valid, create new
 		if (!allocation.m_Valid)
 		{
-			allocation = createNewAllocation(size);
-			m_AllocatedSize += size;
-			m_UnusedSpace = m_Next - m_AllocatedSize;
-			flags |= Reallocated;
+			if (updateAllocation(size, allocation))
+				flags |= Reallocated;
 		}
 		else if (reallocationRequired(size, allocation))
 		{		
 			if (extendAllocation(size, allocation))
-			{
 				flags |= Extended;
-			}
-			else
-			{
-				updateAllocation(size, allocation);
+			else if (updateAllocation(size, allocation))
 				flags |= Reallocated;
-			}
-			m_AllocatedSize += size;
-			m_UnusedSpace = m_Next - m_AllocatedSize;
 		}
-			
 		return flags;
 	}
 
+	void StorageBufferAllocator::Compact(std::vector<OffsetAllocator::Relocation>& relocations)
+	{
+		XYZ_PROFILE_FUNC("StorageBufferAllocator::Compact");
+		m_OffsetAllocator.Compact(relocations);
+	}
 
 	uint32_t StorageBufferAllocator::GetAllocatedSize() const
 	{
-		return m_AllocatedSize;
+		return m_OffsetAllocator.GetUsedSize();
 	}
 
-	bool StorageBufferAllocator::returnAllocation(uint32_t size, uint32_t offset, uint32_t id)
+	bool StorageBufferAllocator::returnAllocation(uint32_t id)
 	{
 		XYZ_ASSERT(m_AllocationRefCounter.size() > static_cast<size_t>(id), "");
 		XYZ_ASSERT(m_AllocationRefCounter[id] != 0, "");
@@ -193,65 +192,12 @@ namespace XYZ {
 		m_AllocationRefCounter[id]--;
 		if (m_AllocationRefCounter[id] == 0)
 		{
-			m_FreeAllocations.push_back({ size, offset });
-			m_FreeAllocationIDs.push(id);
-			m_AllocatedSize -= size;
-			m_UnusedSpace = m_Next - m_AllocatedSize;
-			m_SortRequired = true;
+			m_OffsetAllocator.Free(id);
 			return true;
 		}
 		return false;
 	}
 
-	bool StorageBufferAllocator::allocateFromFree(uint32_t size, uint32_t& offset)
-	{
-		XYZ_PROFILE_FUNC("StorageBufferAllocator::allocateFromFree");
-		
-		if (m_SortRequired)
-		{
-			std::sort(m_FreeAllocations.begin(), m_FreeAllocations.end(), [](const Allocation& a, const Allocation& b) {
-				return a.Offset < b.Offset;
-				});
-			m_SortRequired = false;
-		}
-
-		// Merge free allocations
-		for (int64_t i = m_FreeAllocations.size() - 1; i >= 1; --i)
-		{
-			auto& last = m_FreeAllocations[i];
-			auto& prev = m_FreeAllocations[i - 1];
-
-			
-			if (last.Offset == prev.Offset + prev.Size)
-			{
-				// Merge last allocation with previous allocation if possible
-				prev.Size += last.Size;
-				m_FreeAllocations.erase(m_FreeAllocations.begin() + i);
-			}			
-		}
-
-		// Try to find suitable free allocation
-		for (int64_t i = m_FreeAllocations.size() - 1; i >= 0; --i)
-		{
-			auto& last = m_FreeAllocations[i];
-			if (last.Size > size)
-			{
-				// Cut required size from free allocation
-				last.Size -= size;
-				offset = last.Offset + last.Size;
-				return true;
-			}
-			else if (last.Size == size)
-			{
-				// Take whole free allocation
-				offset = last.Offset;
-				m_FreeAllocations.erase(m_FreeAllocations.begin() + i);
-				return true;
-			}
-		}
-		return false;
-	}
-
 	bool StorageBufferAllocator::reallocationRequired(uint32_t size, const StorageBufferAllocation& allocation) const
 	{
 		return allocation.m_Size < size			 // Size is not sufficient
@@ -259,64 +205,41 @@ namespace XYZ {
 			|| allocation.GetSet() != m_Set;		 // Allocation is not owned by this allocator
 	}
 
-	StorageBufferAllocation StorageBufferAllocator::createNewAllocation(uint32_t size)
-	{
-		uint32_t offset = m_Next;
-		if (!allocateFromFree(size, offset))
-		{
-			XYZ_ASSERT(m_Next + size < m_Size, "");
-			m_Next += size;
-		}
-		return StorageBufferAllocation(this, size, offset, m_Binding, m_Set, nextAllocationID(), false);
-	}
-	void StorageBufferAllocator::updateAllocation(uint32_t size, StorageBufferAllocation& allocation)
+	bool StorageBufferAllocator::updateAllocation(uint32_t size, StorageBufferAllocation& allocation)
 	{
-		uint32_t offset = m_Next;
-		
-		if (!allocateFromFree(size, offset))
-		{
-			XYZ_ASSERT(m_Next + size < m_Size, "");
-			m_Next += size;
-		}
+		// Zero sized allocations still get unique node
+		const OffsetAllocator::Allocation result = m_OffsetAllocator.Allocate(std::max(size, 1u));
+		XYZ_ASSERT(result.Valid(), "Storage buffer allocator is full");
+		if (!result.Valid())
+			return false;
+
+		if (m_AllocationRefCounter.size() <= result.Node)
+			m_AllocationRefCounter.resize(result.Node + 1, 0);
+
 		allocation.returnAllocation();
 		allocation.m_Allocator = this;
 		allocation.m_Size = size;
-		allocation.m_Offset = offset;
+		allocation.m_Offset = 0;
 		allocation.m_StorageBufferBinding = m_Binding;
 		allocation.m_StorageBufferSet = m_Set;
 		allocation.m_Valid = true;
 		allocation.m_IsSuballocation = false;
-		allocation.m_ID = nextAllocationID();
+		allocation.m_ID = result.Node;
 		m_AllocationRefCounter[allocation.m_ID]++;
-		m_Next += size;
+		return true;
 	}
 
 	bool StorageBufferAllocator::extendAllocation(uint32_t size, StorageBufferAllocation& allocation)
 	{
-		if (allocation.m_Offset + allocation.m_Size == m_Next) // It is possible to just extend allocation
+		if (allocation.m_Allocator.Raw() != this || allocation.m_IsSuballocation)
+			return false;
+
+		// Possible only if the following range is free
+		if (m_OffsetAllocator.Grow(allocation.m_ID, size))
 		{
-			m_AllocatedSize -= allocation.m_Size;
-			allocation.m_Size = size; // Update size
-			m_Next = allocation.m_Offset + allocation.m_Size; // Calculate new m_Next
+			allocation.m_Size = size;
 			return true;
 		}
 		return false;
 	}
-
-	uint32_t StorageBufferAllocator::nextAllocationID()
-	{
-		uint32_t result;
-		if (!m_FreeAllocationIDs.empty())
-		{
-			result = m_FreeAllocationIDs.front();
-			m_FreeAllocationIDs.pop();
-		}
-		else
-		{
-			result = static_cast<uint32_t>(m_AllocationRefCounter.size());
-			m_AllocationRefCounter.push_back(0);
-		}
-		return result;
-	}
-
 }
\ No newline at end of file
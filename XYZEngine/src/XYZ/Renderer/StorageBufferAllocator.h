@@ -1,9 +1,10 @@
 #pragma once
 #include "Buffer.h"
 
+#include "XYZ/Utils/DataStructures/OffsetAllocator.h"
+
 #include <thread>
 #include <shared_mutex>
-#include <queue>
 
 namespace XYZ {
 	
@@ -24,7 +25,7 @@ namespace XYZ {
 		StorageBufferAllocation CreateSubAllocation(uint32_t offset, uint32_t size);
 
 		inline uint32_t   GetSize()			const { return m_Size; }
-		inline uint32_t   GetOffset()		const { return m_Offset; }
+		uint32_t		  GetOffset()		const;
 		inline uint32_t   GetBinding()		const { return m_StorageBufferBinding; }
 		inline uint32_t   GetSet()			const { return m_StorageBufferSet; }
 		inline bool		  Valid()			const { return m_Valid; }
@@ -45,7 +46,7 @@ namespace XYZ {
 		Ref<StorageBufferAllocator> m_Allocator;
 		
 		uint32_t m_Size;
-		uint32_t m_Offset;
+		uint32_t m_Offset; // Relative to allocator node, allocations can be moved by compaction
 		uint32_t m_StorageBufferBinding;
 		uint32_t m_StorageBufferSet;
 		uint32_t m_ID;
@@ -68,43 +69,32 @@ namespace XYZ {
 
 		uint32_t Allocate(uint32_t size, StorageBufferAllocation& allocation);
 
+		// Moves allocations to the start of the buffer, offsets of existing allocations are updated.
+		// Data of every relocation must be copied in the storage buffer before it is used again
+		void Compact(std::vector<OffsetAllocator::Relocation>& relocations);
+
+		OffsetAllocator::Statistics GetStatistics() const { return m_OffsetAllocator.GetStatistics(); }
 
 		uint32_t GetAllocatedSize() const;
 		uint32_t GetBinding()		const { return m_Binding; };
 		uint32_t GetSet()			const { return m_Set; }
 		uint32_t GetSize()			const { return m_Size; }
 	private:
-		bool returnAllocation(uint32_t size, uint32_t offset, uint32_t id);
-		bool allocateFromFree(uint32_t size, uint32_t& offset);
+		bool returnAllocation(uint32_t id);
 
 		bool reallocationRequired(uint32_t size, const StorageBufferAllocation& allocation) const;
 
-		StorageBufferAllocation createNewAllocation(uint32_t size);
-		void updateAllocation(uint32_t size, StorageBufferAllocation& allocation);
+		bool updateAllocation(uint32_t size, StorageBufferAllocation& allocation);
 		bool extendAllocation(uint32_t size, StorageBufferAllocation& allocation);
-		
-		uint32_t nextAllocationID();
 	private:
-		struct Allocation
-		{
-			uint32_t Size;
-			uint32_t Offset;
-		};
-
 		uint32_t m_Binding;
 		uint32_t m_Set;
 		uint32_t m_Size;
 
+		OffsetAllocator			m_OffsetAllocator;
 
-		std::vector<Allocation>	m_FreeAllocations;
+		// Indexed by allocator node
 		std::vector<uint32_t>	m_AllocationRefCounter;
-		std::queue<uint32_t>    m_FreeAllocationIDs;
-
-		std::uint32_t			m_Next;
-		uint32_t				m_AllocatedSize;
-		uint32_t				m_UnusedSpace;
-		bool					m_SortRequired;
-
 
 		friend StorageBufferAllocation;
 	};
@@ -9,6 +9,7 @@
 #include "XYZ/Utils/Math/Math.h"
 #include "XYZ/Utils/Math/AABB.h"
 #include "XYZ/Utils/Random.h"
+#include "XYZ/Core/Application.h"
 
 #include "XYZ/ImGui/ImGui.h"
 
@@ -22,6 +23,9 @@ namespace XYZ {
 
 #define TILE_SIZE 16
 
+	static constexpr uint32_t sc_ParallelCullingThreshold = 16384;
+	static constexpr float	  sc_CompactFragmentation = 50.0f; // Percentage of free space outside of the largest free region
+	static constexpr uint32_t sc_ParallelOctreeThreshold = 16384;
 	
 	static AABB VoxelModelToAABB(const glm::mat4& transform, uint32_t width, uint32_t height, uint32_t depth, float voxelSize)
 	{
@@ -83,17 +87,17 @@ namespace XYZ {
 		m_UBVoxelScene.ViewportSize.y = m_ViewportSize.y;
 		m_SSBOVoxelModels.NumModels = 0;
 		
+		m_Frustum = camera.Frustum;
 		m_RenderModelsSorted.clear();
 		m_RenderModels.clear();
-		m_VoxelMeshBuckets.clear();
+		m_RenderModelBounds.Clear();
 		m_EffectCommands.clear();
 
 		m_Statistics = {};
 
 		updateViewportSize();
 		updateUniformBufferSet();
-		m_ModelsOctree.Clear();
-
+		m_ModelsOctreeBounds.clear();
 	}
 	void VoxelRenderer::EndScene()
 	{
@@ -286,6 +290,7 @@ namespace XYZ {
 			ImGui::Checkbox("SSGI Noise", (bool*)&m_SSGIValues.Noise);
 			ImGui::NewLine();
 
+			ImGui::Checkbox("Frustum Culling", &m_UseFrustumCulling);
 			ImGui::Checkbox("Octree", &m_UseOctree);
 			ImGui::Checkbox("Show Octree", &m_ShowOctree);
 			ImGui::Checkbox("Show AABB", &m_ShowAABB);
@@ -303,10 +308,12 @@ namespace XYZ {
 
 				UI::TextTableRow("%s", "Mesh Allocations:", "%u", static_cast<uint32_t>(m_LastFrameMeshAllocations.size()));
 				UI::TextTableRow("%s", "Model Count:", "%u", m_Statistics.ModelCount);
+				UI::TextTableRow("%s", "Culled Model Count:", "%u", m_Statistics.CulledModelCount);
 
 				UI::TextTableRow("%s", "Voxel Buffer Usage:", "%u%%", voxelBufferUsage);
 				UI::TextTableRow("%s", "Color Buffer Usage:", "%u%%", colorBufferUsage);
 				UI::TextTableRow("%s", "Compress Buffer Usage:", "%u%%", compressBufferUsage);
+				UI::TextTableRow("%s", "Voxel Buffer Fragmentation:", "%.1f%%", m_VoxelStorageAllocator->GetStatistics().Fragmentation);
 
 
 				const uint32_t frameIndex = Renderer::GetCurrentFrame();
@@ -337,25 +344,21 @@ namespace XYZ {
 	void VoxelRenderer::updateOctreeSSBO()
 	{
 		XYZ_PROFILE_FUNC("VoxelRenderer::updateOctreeSSBO");
-		// Update octree
-		uint32_t nodeCount = 0;
-		uint32_t dataCount = 0;
-		const glm::vec3 cameraPosition(glm::vec3(m_UBVoxelScene.CameraPosition));
-		for (auto& octreeNode : m_ModelsOctree.GetNodes())
-		{
-			auto& node = m_SSBOOctree.Nodes[nodeCount];
-			memcpy(node.Children, octreeNode.Children, 8 * sizeof(uint32_t));
-			node.IsLeaf = octreeNode.IsLeaf;
-			node.Max = glm::vec4(octreeNode.BoundingBox.Max, 1.0f);
-			node.Min = glm::vec4(octreeNode.BoundingBox.Min, 1.0f);
-			node.DataStart = dataCount;
-			for (const auto& data : octreeNode.Data)
-			{
-				m_SSBOOctree.ModelIndices[dataCount++] = data.Data;
-			}
-			node.DataEnd = dataCount;
-			nodeCount++;
-		}
+		const uint32_t modelCount = static_cast<uint32_t>(m_ModelsOctreeBounds.size());
+		if (modelCount > sc_ParallelOctreeThreshold)
+			m_ModelsOctree.Build(m_ModelsOctreeBounds.data(), modelCount, Application::Get().GetThreadPool());
+		else
+			m_ModelsOctree.Build(m_ModelsOctreeBounds.data(), modelCount);
+
+		// Nodes are already in shader layout
+		const auto& nodes = m_ModelsOctree.GetNodes();
+		const auto& data = m_ModelsOctree.GetData();
+		XYZ_ASSERT(nodes.size() <= SSBOOCtree::MaxNodes, "Octree node count exceeds storage buffer capacity");
+
+		const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+		const uint32_t dataCount = static_cast<uint32_t>(data.size());
+		memcpy(m_SSBOOctree.Nodes, nodes.data(), sizeof(VoxelModelOctreeNode) * nodeCount);
+		memcpy(m_SSBOOctree.ModelIndices, data.data(), sizeof(uint32_t) * dataCount);
 		m_SSBOOctree.NodeCount = nodeCount;
 
 		const uint32_t firstUpdateSize =
@@ -383,6 +386,7 @@ namespace XYZ {
 		renderModel.SubmeshIndex = submeshIndex;
 		renderModel.Transform = transform;
 		renderModel.Mesh = mesh;
+		m_RenderModelBounds.Push(renderModel.BoundingBox);
 
 		m_Statistics.ModelCount++;
 	}
@@ -625,11 +629,26 @@ namespace XYZ {
 	{
 		XYZ_PROFILE_FUNC("VoxelRenderer::prepareModels");
 		const glm::vec3 cameraPosition(m_UBVoxelScene.CameraPosition);
+		if (m_UseFrustumCulling)
+		{
+			XYZ_PROFILE_FUNC("VoxelRenderer::prepareModelsCull");
+			m_VisibleRenderModels.resize(Math::CullingMaskSize(m_RenderModelBounds.Size()));
+			if (m_RenderModelBounds.Size() > sc_ParallelCullingThreshold)
+				Math::CullAABBs(m_Frustum, m_RenderModelBounds, m_VisibleRenderModels.data(), Application::Get().GetThreadPool());
+			else
+				Math::CullAABBs(m_Frustum, m_RenderModelBounds, m_VisibleRenderModels.data());
+		}
 		{
 			XYZ_PROFILE_FUNC("VoxelRenderer::prepareModelsCopy");
 
-			for (auto& renderModel : m_RenderModels)
+			for (size_t i = 0; i < m_RenderModels.size(); ++i)
 			{
+				if (m_UseFrustumCulling && !((m_VisibleRenderModels[i / 64] >> (i % 64)) & 1))
+				{
+					m_Statistics.CulledModelCount++;
+					continue;
+				}
+				auto& renderModel = m_RenderModels[i];
 				renderModel.DistanceFromCamera = renderModel.BoundingBox.Distance(cameraPosition);
 				m_RenderModelsSorted.push_back(&renderModel);
 			}
@@ -665,12 +684,16 @@ namespace XYZ {
 				}
 			});
 		}
+		// Buckets are rebuilt every frame, whole map lives in frame memory
+		FrameAllocator& frameAllocator = Renderer::GetFrameAllocator();
+		FrameUnorderedMap<AssetHandle, VoxelMeshBucket> meshBuckets(0, &frameAllocator);
+
 		int32_t modelIndex = 0;
 		for (auto model : m_RenderModelsSorted)
 		{
 			if (m_UseOctree)
-				m_ModelsOctree.InsertData(model->BoundingBox, modelIndex);
-			auto& allocation = m_VoxelMeshBuckets[model->Mesh->GetHandle()];
+				m_ModelsOctreeBounds.push_back(model->BoundingBox);
+			auto& allocation = meshBuckets.try_emplace(model->Mesh->GetHandle(), &frameAllocator).first->second;
 			model->ModelIndex = modelIndex;
 			allocation.Mesh = model->Mesh;
 			allocation.Models.push_back(model);
@@ -678,8 +701,10 @@ namespace XYZ {
 		}
 		
 
+		compactMeshStorage();
+
 		// Pass it to ssbo data
-		for (auto& [key, meshAllocation] : m_VoxelMeshBuckets)
+		for (auto& [key, meshAllocation] : meshBuckets)
 		{
 			if (meshAllocation.Models.empty())
 				continue;
@@ -795,6 +820,19 @@ namespace XYZ {
 		reallocateVoxels(mesh, meshAlloc);
 		return meshAlloc;
 	}
+	void VoxelRenderer::compactMeshStorage()
+	{
+		XYZ_PROFILE_FUNC("VoxelRenderer::compactMeshStorage");
+		auto compact = [](const Ref<StorageBufferAllocator>& allocator, std::vector<OffsetAllocator::Relocation>& relocations) {
+			const OffsetAllocator::Statistics stats = allocator->GetStatistics();
+			if (stats.FreeRegions > 1 && stats.Fragmentation > sc_CompactFragmentation)
+				allocator->Compact(relocations);
+		};
+		// Moved meshes are uploaded again in reallocateVoxels, relocations are not copied on GPU
+		std::vector<OffsetAllocator::Relocation> relocations;
+		compact(m_VoxelStorageAllocator, relocations);
+		compact(m_CompressedCellAllocator, relocations);
+	}
 	void VoxelRenderer::reallocateVoxels(const Ref<VoxelMesh>& mesh, MeshAllocation& allocation)
 	{
 		XYZ_PROFILE_FUNC("VoxelRenderer::reallocateVoxels");
@@ -812,6 +850,10 @@ namespace XYZ {
 		auto dirtySubmeshes = mesh->DirtySubmeshes();
 		auto dirtyCells = mesh->DirtyCompressedCells();
 
+		// Allocation was moved by compaction, whole mesh is uploaded again
+		const bool voxelsMoved = !allocation.Offsets.empty() && allocation.Offsets[0].Voxel != allocation.VoxelAllocation.GetOffset();
+		const bool cellsMoved = !allocation.Offsets.empty() && allocation.Offsets[0].CompressedCell != allocation.CompressAllocation.GetOffset() / sizeof(VoxelCompressedCell);
+
 		{	// Recreate offsets per submesh
 			uint32_t voxelOffset = allocation.VoxelAllocation.GetOffset();
 			uint32_t cellOffset = allocation.CompressAllocation.GetOffset() / sizeof(VoxelCompressedCell);
@@ -829,7 +871,7 @@ namespace XYZ {
 			m_StorageBufferSet->Update(mesh->GetColorPallete().data(), allocation.ColorAllocation.GetSize(), allocation.ColorAllocation.GetOffset(), SSBOColors::Binding, SSBOColors::Set);
 		}
 		// Update voxels
-		if (IS_SET(voxelAllocationFlags, StorageBufferAllocator::Reallocated))
+		if (IS_SET(voxelAllocationFlags, StorageBufferAllocator::Reallocated) || voxelsMoved)
 		{
 			for (uint32_t submeshIndex = 0; submeshIndex < submeshes.size(); ++submeshIndex)
 			{
@@ -852,7 +894,7 @@ namespace XYZ {
 			}
 		}
 		// Update compressed cells
-		if (IS_SET(cellAllocationFlags, StorageBufferAllocator::Reallocated))
+		if (IS_SET(cellAllocationFlags, StorageBufferAllocator::Reallocated) || cellsMoved)
 		{
 			for (uint32_t submeshIndex = 0; submeshIndex < submeshes.size(); ++submeshIndex)
 			{
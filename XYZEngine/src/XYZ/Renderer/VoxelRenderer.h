@@ -7,24 +7,14 @@
 #include "Material.h"
 
 #include "XYZ/Scene/Scene.h"
-#include "XYZ/Utils/DataStructures/Octree.h"
+#include "XYZ/Utils/DataStructures/LinearOctree.h"
+#include "XYZ/Utils/DataStructures/FrameAllocator.h"
+#include "XYZ/Utils/Math/FrustumCulling.h"
 #include "XYZ/Asset/Renderer/VoxelMeshSource.h"
 
 namespace XYZ {
 
-	struct VoxelModelOctreeNode
-	{
-		glm::vec4 Min;
-		glm::vec4 Max;
-
-		int32_t Children[8]{ -1 };
-
-		Bool32	IsLeaf;
-		int32_t DataStart;
-		int32_t DataEnd;
-
-		Padding<4> Padding;
-	};
+	using VoxelModelOctreeNode = LinearOctreeNode;
 
 
 	struct UBVoxelScene
@@ -181,8 +171,12 @@ namespace XYZ {
 
 		struct VoxelMeshBucket
 		{
+			VoxelMeshBucket(FrameAllocator* allocator = nullptr)
+				: Models(allocator)
+			{}
+
 			Ref<VoxelMesh> Mesh;
-			std::vector<VoxelRenderModel*> Models;
+			FrameVector<VoxelRenderModel*> Models;
 		};
 
 	
@@ -225,6 +219,7 @@ namespace XYZ {
 		struct Statistics
 		{
 			uint32_t ModelCount = 0;
+			uint32_t CulledModelCount = 0;
 		};
 
 	private:
@@ -252,6 +247,7 @@ namespace XYZ {
 
 		MeshAllocation& createMeshAllocation(const Ref<VoxelMesh>& mesh);	
 
+		void compactMeshStorage();
 		void reallocateVoxels(const Ref<VoxelMesh>& mesh, MeshAllocation& allocation);
 
 	private:
@@ -299,6 +295,7 @@ namespace XYZ {
 		Statistics				m_Statistics;
 	
 		bool					m_UseSSGI = false;
+		bool					m_UseFrustumCulling = true;
 		bool					m_UseOctree = false;
 		bool					m_ShowOctree = false;
 		bool					m_ShowAABB = false;
@@ -307,7 +304,9 @@ namespace XYZ {
 
 		std::vector<VoxelRenderModel*>					 m_RenderModelsSorted;
 		std::vector<VoxelRenderModel>					 m_RenderModels;
-		std::unordered_map<AssetHandle, VoxelMeshBucket> m_VoxelMeshBuckets;
+		AABBSoA											 m_RenderModelBounds;
+		std::vector<uint64_t>							 m_VisibleRenderModels;
+		Math::Frustum									 m_Frustum;
 		std::map<AssetHandle, VoxelEffectCommand>		 m_EffectCommands;
 
 		std::unordered_map<AssetHandle, MeshAllocation> m_MeshAllocations;
@@ -324,7 +323,8 @@ namespace XYZ {
 		};
 		GPUTimeQueries m_GPUTimeQueries;
 
-		Octree m_ModelsOctree;
+		LinearOctree	  m_ModelsOctree;
+		std::vector<AABB> m_ModelsOctreeBounds;
 	};
 
 }
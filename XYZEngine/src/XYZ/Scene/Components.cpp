@@ -168,11 +168,13 @@ namespace XYZ {
 		childRel.PreviousSibling = lastChild;
 		childRel.Parent = parent;
 		childRel.Depth = parentRel.Depth + 1;
+		reg.patch<Relationship>(child); // Notify listeners that hierarchy changed
 	}
 
 	void Relationship::RemoveRelation(entt::entity child, entt::registry& reg)
 	{
 		removeRelation(child, reg);
+		reg.patch<Relationship>(child);
 	}
 	void Relationship::removeRelation(entt::entity child, entt::registry& reg)
 	{
@@ -74,6 +74,7 @@ namespace XYZ {
 		bool	  m_Dirty = true;
 
 		friend class Scene;
+		friend class TransformHierarchy;
 	};
 	
 
@@ -348,6 +349,10 @@ namespace XYZ {
 		BodyType Type;
 
 		void* RuntimeBody = nullptr;
+
+		// Body state before the last physics sub step, used for interpolation
+		glm::vec2 PreviousPosition = glm::vec2(0.0f);
+		float	  PreviousAngle = 0.0f;
 	};
 
 
@@ -0,0 +1,52 @@
+#include "stdafx.h"
+#include "EntityHashIndex.h"
+
+namespace XYZ {
+
+	void EntityHashIndex::Insert(entt::entity entity, size_t hash)
+	{
+		const size_t index = static_cast<size_t>(entt::to_entity(entity));
+		if (index >= m_EntityHashes.size())
+		{
+			m_EntityHashes.resize(index + 1);
+			m_EntityValues.resize(index + 1, HashIndex::sc_InvalidValue);
+		}
+		else if (m_EntityValues[index] != HashIndex::sc_InvalidValue)
+		{
+			Erase(entity);
+		}
+
+		const uint32_t value = static_cast<uint32_t>(entt::to_integral(entity));
+		m_EntityHashes[index] = hash;
+		m_EntityValues[index] = value;
+		m_Index.Insert(hash, value);
+	}
+
+	void EntityHashIndex::Erase(entt::entity entity)
+	{
+		const size_t index = static_cast<size_t>(entt::to_entity(entity));
+		if (index < m_EntityValues.size() && m_EntityValues[index] != HashIndex::sc_InvalidValue)
+		{
+			m_Index.Erase(m_EntityHashes[index], m_EntityValues[index]);
+			m_EntityValues[index] = HashIndex::sc_InvalidValue;
+		}
+	}
+
+	void EntityHashIndex::Update(entt::entity entity, size_t hash)
+	{
+		Erase(entity);
+		Insert(entity, hash);
+	}
+
+	void EntityHashIndex::Reserve(uint32_t count)
+	{
+		m_Index.Reserve(count);
+	}
+
+	void EntityHashIndex::Clear()
+	{
+		m_Index.Clear();
+		m_EntityHashes.clear();
+		m_EntityValues.clear();
+	}
+}
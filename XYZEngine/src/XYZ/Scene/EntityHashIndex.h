@@ -0,0 +1,50 @@
+#pragma once
+#include "XYZ/Utils/DataStructures/HashIndex.h"
+
+#include <entt/entt.hpp>
+
+namespace XYZ {
+
+	// HashIndex from key hash to entity, remembers hash of every indexed entity so it can be erased after key changed
+	class XYZ_API EntityHashIndex
+	{
+	public:
+		void Insert(entt::entity entity, size_t hash);
+		void Erase(entt::entity entity);
+		void Update(entt::entity entity, size_t hash);
+		void Reserve(uint32_t count);
+		void Clear();
+
+		template <typename Pred>
+		entt::entity Find(size_t hash, Pred&& pred) const;
+
+		template <typename Func>
+		void ForEach(size_t hash, Func&& func) const;
+
+		uint32_t Size() const { return m_Index.Size(); }
+
+	private:
+		HashIndex			  m_Index;
+		std::vector<size_t>	  m_EntityHashes;
+		std::vector<uint32_t> m_EntityValues; // Indexed value per entity, HashIndex::sc_InvalidValue if not indexed
+	};
+
+	template<typename Pred>
+	inline entt::entity EntityHashIndex::Find(size_t hash, Pred&& pred) const
+	{
+		const uint32_t value = m_Index.Find(hash, [&](uint32_t value) {
+			return pred(static_cast<entt::entity>(value));
+		});
+		if (value == HashIndex::sc_InvalidValue)
+			return entt::null;
+		return static_cast<entt::entity>(value);
+	}
+
+	template<typename Func>
+	inline void EntityHashIndex::ForEach(size_t hash, Func&& func) const
+	{
+		m_Index.ForEach(hash, [&](uint32_t value) {
+			func(static_cast<entt::entity>(value));
+		});
+	}
+}
@@ -133,9 +133,17 @@ namespace XYZ {
 	
 	static entt::registry s_CopyRegistry;
 
+	static size_t HashName(std::string_view name)
+	{
+		return std::hash<std::string_view>{}(name);
+	}
+
 
 	static std::vector<ParticleEmitterGPU> s_ParticleEmitters;
 
+	static constexpr uint32_t sc_PhysicsBatchSize = 512;
+	static constexpr uint32_t sc_ParallelPhysicsThreshold = 16384; // Body state copy is cheaper than dispatching jobs below it
+
 	Scene::Scene(const std::string& name, const GUID& guid)
 		:
 		m_PhysicsWorld({ 0.0f, -9.8f }),
@@ -157,9 +165,8 @@ namespace XYZ {
 		b2World& physicsWorld = m_PhysicsWorld.GetWorld();
 		physicsWorld.SetContactListener(&m_ContactListener);
 
-		m_Registry.on_construct<ScriptComponent>().connect<&Scene::onScriptComponentConstruct>(this);
-		m_Registry.on_destroy<ScriptComponent>().connect<&Scene::onScriptComponentDestruct>(this);
-	
+		connectRegistrySignals();
+		rebuildEntityIndices();
 		
 
 		// Temporary
@@ -192,8 +199,7 @@ namespace XYZ {
 
 	Scene::~Scene()
 	{
-		m_Registry.on_construct<ScriptComponent>().disconnect<&Scene::onScriptComponentConstruct>(this);
-		m_Registry.on_destroy<ScriptComponent>().disconnect<&Scene::onScriptComponentDestruct>(this);
+		disconnectRegistrySignals();
 	}
 
 	SceneEntity Scene::CreateEntity(const std::string& name, const GUID& guid)
@@ -301,6 +307,10 @@ namespace XYZ {
 	{
 		Utils::CloneRegistry(s_CopyRegistry, m_Registry);
 		s_CopyRegistry = entt::registry();
+		// Registry was replaced, listeners must be connected again
+		connectRegistrySignals();
+		rebuildEntityIndices();
+		m_TransformHierarchy.Invalidate();
 		{
 			b2World& physicsWorld = m_PhysicsWorld.GetWorld();
 			auto rigidBodyView = m_Registry.view<RigidBody2DComponent>();
@@ -327,6 +337,7 @@ namespace XYZ {
 
 		delete[]m_PhysicsEntityBuffer;
 		m_PhysicsEntityBuffer = nullptr;
+		m_PhysicsBodies.clear();
 
 		m_SelectedEntity = entt::null;
 	}
@@ -334,9 +345,7 @@ namespace XYZ {
 	void Scene::OnUpdate(Timestep ts)
 	{
 		XYZ_PROFILE_FUNC("Scene::OnUpdate");
-		m_PhysicsWorld.Step(ts);
-
-		updateRigidBody2DView();
+		updatePhysics(ts);
 		
 		updateParticleView(ts);
 		updateGPUParticleView(ts);
@@ -371,19 +380,7 @@ namespace XYZ {
 		sceneRenderer->SetViewportSize(m_ViewportWidth, m_ViewportHeight);
 		sceneRenderer->BeginScene(renderCamera);
 
-
-		auto spriteView = m_Registry.view<TransformComponent, SpriteRenderer>();
-		for (auto entity : spriteView)
-		{
-			auto& [transform, spriteRenderer] = spriteView.get<TransformComponent, SpriteRenderer>(entity);
-			sceneRenderer->SubmitSprite(spriteRenderer.Material.Value(), spriteRenderer.SubTexture.Value(), spriteRenderer.Color, transform->WorldTransform);
-		}
-		auto meshView = m_Registry.view<TransformComponent, MeshComponent>();
-		for (auto entity : meshView)
-		{
-			auto& [transform, meshComponent] = meshView.get<TransformComponent, MeshComponent>(entity);
-			sceneRenderer->SubmitMesh(meshComponent.Mesh.Value(), meshComponent.MaterialAsset.Value(), transform->WorldTransform, meshComponent.OverrideMaterial);
-		}
+		sceneRenderer->SubmitDraws(m_Registry);
 
 		auto animMeshView = m_Registry.view<TransformComponent, AnimatedMeshComponent>();
 		for (auto entity : animMeshView)
@@ -423,10 +420,7 @@ namespace XYZ {
 		XYZ_PROFILE_FUNC("Scene::OnUpdateEditor");
 		m_PhysicsWorld.Step(ts);
 
-		if (m_UpdateHierarchyAsync)
-			updateHierarchyAsync();
-		else
-			updateHierarchy();
+		updateHierarchy();
 
 		if (m_UpdateAnimationAsync)
 			updateAnimationViewAsync(ts);
@@ -448,25 +442,7 @@ namespace XYZ {
 		setupLightEnvironment();
 		sceneRenderer->BeginScene(viewProjection, view, projection);
 	
-		auto spriteView = m_Registry.view<TransformComponent, SpriteRenderer>();
-		for (auto entity : spriteView)
-		{
-			auto& [transform, spriteRenderer] = spriteView.get<TransformComponent, SpriteRenderer>(entity);
-			
-			if (!spriteRenderer.Material.Valid() || !spriteRenderer.SubTexture.Valid())
-				continue;
-			sceneRenderer->SubmitSprite(spriteRenderer.Material.Value(), spriteRenderer.SubTexture.Value(), spriteRenderer.Color, transform->WorldTransform);
-		}
-		
-		auto meshView = m_Registry.view<TransformComponent, MeshComponent>();
-		for (auto entity : meshView)
-		{
-			auto& [transform, meshComponent] = meshView.get<TransformComponent, MeshComponent>(entity);
-			if (!meshComponent.MaterialAsset.Valid() || !meshComponent.Mesh.Valid())
-				continue;
-		
-			sceneRenderer->SubmitMesh(meshComponent.Mesh.Value(), meshComponent.MaterialAsset.Value(), transform->WorldTransform, meshComponent.OverrideMaterial);
-		}
+		sceneRenderer->SubmitDraws(m_Registry);
 		
 		
 		auto animMeshView = m_Registry.view<TransformComponent,AnimatedMeshComponent>();
@@ -518,6 +494,27 @@ namespace XYZ {
 		{
 			ImGui::Checkbox("Update Animation Async", &m_UpdateAnimationAsync);
 			ImGui::Checkbox("Update Hierarchy Async", &m_UpdateHierarchyAsync);
+
+			const auto& stats = m_TransformHierarchy.GetStats();
+			ImGui::Text("Hierarchy: %u entities, %u levels, %u updated, %u rebuilds", stats.NodeCount, stats.LevelCount, stats.UpdatedCount, stats.RebuildCount);
+			ImGui::Text("Hierarchy update: %.3f ms (%.0f entities / ms)", stats.UpdateTimeMs, stats.UpdateTimeMs > 0.0f ? stats.NodeCount / stats.UpdateTimeMs : 0.0f);
+
+			PhysicsWorld2D::StepSettings stepSettings = m_PhysicsWorld.GetStepSettings();
+			float stepRate = 1.0f / stepSettings.FixedTimestep;
+			int maxSubSteps = static_cast<int>(stepSettings.MaxSubSteps);
+			bool changed = ImGui::Checkbox("Physics Fixed Step", &stepSettings.FixedStep);
+			changed |= ImGui::DragFloat("Physics Step Rate", &stepRate, 1.0f, 10.0f, 240.0f, "%.0f Hz");
+			changed |= ImGui::DragInt("Physics Max Sub Steps", &maxSubSteps, 1.0f, 1, 16);
+			if (changed)
+			{
+				stepSettings.FixedTimestep = 1.0f / std::max(stepRate, 1.0f);
+				stepSettings.MaxSubSteps = static_cast<uint32_t>(std::max(maxSubSteps, 1));
+				m_PhysicsWorld.SetStepSettings(stepSettings);
+			}
+
+			const auto& physicsStats = m_PhysicsWorld.GetStats();
+			ImGui::Text("Physics: %u bodies, %u sub steps, %.3f ms", static_cast<uint32_t>(m_PhysicsBodies.size()), physicsStats.SubSteps, physicsStats.StepTimeMs);
+			ImGui::Text("Physics catch up cap hit: %u / %llu frames", physicsStats.CappedFrames, static_cast<unsigned long long>(physicsStats.TotalFrames));
 		}
 		ImGui::End();
 	}
@@ -530,24 +527,37 @@ namespace XYZ {
 
 	SceneEntity Scene::GetEntityByName(const std::string& name)
 	{
-		auto view = m_Registry.view<SceneTagComponent>();
-		for (auto entity : view)
-		{
-			if (view.get<SceneTagComponent>(entity).Name == name)
-				return SceneEntity(entity, this);
-		}
-		return SceneEntity();
+		const entt::entity entity = findByName(name);
+		if (entity == entt::null)
+			return SceneEntity();
+		return SceneEntity(entity, this);
 	}
 
 	SceneEntity Scene::GetEntityByGUID(const GUID& guid)
 	{
-		auto view = m_Registry.view<IDComponent>();
-		for (auto entity : view)
-		{
-			if (view.get<IDComponent>(entity).ID == guid)
-				return SceneEntity(entity, this);
-		}
-		return SceneEntity();
+		const entt::entity entity = findByGUID(guid);
+		if (entity == entt::null)
+			return SceneEntity();
+		return SceneEntity(entity, this);
+	}
+
+	std::vector<SceneEntity> Scene::GetEntitiesByName(const std::string& name)
+	{
+		std::vector<SceneEntity> result;
+		m_NameIndex.ForEach(HashName(name), [&](entt::entity entity) {
+			if (m_Registry.get<SceneTagComponent>(entity).Name == name)
+				result.emplace_back(entity, this);
+		});
+		return result;
+	}
+
+	std::vector<SceneEntity> Scene::GetEntitiesByGUID(const std::vector<GUID>& guids)
+	{
+		std::vector<SceneEntity> result;
+		result.reserve(guids.size());
+		for (const GUID& guid : guids)
+			result.push_back(GetEntityByGUID(guid));
+		return result;
 	}
 
 	SceneEntity Scene::GetSceneEntity()
@@ -572,127 +582,123 @@ namespace XYZ {
 		ScriptEngine::DestroyScriptEntityInstance({ ent, this });
 	}
 
-
-
-	void Scene::updateScripts(Timestep ts)
+	void Scene::onHierarchyChanged(entt::registry& reg, entt::entity ent)
 	{
-		XYZ_PROFILE_FUNC("Scene::updateScripts");
-		auto scriptView = m_Registry.view<ScriptComponent>();
-		std::shared_lock lock(m_ScriptMutex);
-		for (auto entity : scriptView)
-		{
-			ScriptComponent& scriptComponent = scriptView.get<ScriptComponent>(entity);
-			SceneEntity sceneEntity(entity, this);
-			if (!scriptComponent.ModuleName.empty())
-				ScriptEngine::OnUpdateEntity(sceneEntity, ts);
-		}
+		m_TransformHierarchy.Invalidate();
 	}
 
-	void Scene::updateHierarchy()
+	void Scene::onIDComponentChanged(entt::registry& reg, entt::entity ent)
 	{
-		XYZ_PROFILE_FUNC("Scene::updateHierarchy");
-		std::stack<entt::entity> entities;
-		{
-			const Relationship& relation = m_Registry.get<Relationship>(m_SceneEntity);
-			if (m_Registry.valid(relation.FirstChild))
-				entities.push(relation.FirstChild);
-		}
+		m_GUIDIndex.Insert(ent, reg.get<IDComponent>(ent).ID.Hash());
+	}
 
-		while (!entities.empty())
-		{
-			const entt::entity tmp = entities.top();
-			entities.pop();
-		
-			const Relationship& relation = m_Registry.get<Relationship>(tmp);
-			if (m_Registry.valid(relation.NextSibling))
-				entities.push(relation.NextSibling);
-			if (m_Registry.valid(relation.FirstChild))
-				entities.push(relation.FirstChild);
-			
-			TransformComponent& transform = m_Registry.get<TransformComponent>(tmp);		
-			// Every entity except m_SceneEntity must have parent
-			TransformComponent& parentTransform = m_Registry.get<TransformComponent>(relation.Parent);
-			
-			if (parentTransform.m_Dirty || transform.m_Dirty)
-				transform.GetTransform().WorldTransform = parentTransform->WorldTransform * transform.GetLocalTransform();
-		}
-		
-		// We updated all transforms, they are no longer dirty
-		auto& transformStorage = m_Registry.storage<TransformComponent>();
-		for (auto& transformComponent : transformStorage)
-			transformComponent.m_Dirty = false;
+	void Scene::onIDComponentDestruct(entt::registry& reg, entt::entity ent)
+	{
+		m_GUIDIndex.Erase(ent);
 	}
 
-	void Scene::updateHierarchyAsync()
+	void Scene::onSceneTagChanged(entt::registry& reg, entt::entity ent)
 	{
-		XYZ_PROFILE_FUNC("Scene::updateHierarchyAsync");
-		auto& threadPool = Application::Get().GetThreadPool();
-		Ref<Scene> instance = this;
+		m_NameIndex.Insert(ent, HashName(reg.get<SceneTagComponent>(ent).Name));
+	}
 
-		const Relationship& relation = m_Registry.get<Relationship>(m_SceneEntity);
-		TransformComponent& parentTransform = m_Registry.get<TransformComponent>(m_SceneEntity);
+	void Scene::onSceneTagDestruct(entt::registry& reg, entt::entity ent)
+	{
+		m_NameIndex.Erase(ent);
+	}
 
-		entt::entity parent = m_SceneEntity;
-		entt::entity child = relation.GetFirstChild();
+	void Scene::connectRegistrySignals()
+	{
+		m_Registry.on_construct<ScriptComponent>().connect<&Scene::onScriptComponentConstruct>(this);
+		m_Registry.on_destroy<ScriptComponent>().connect<&Scene::onScriptComponentDestruct>(this);
 
-		std::vector<std::future<bool>> futures;
-		while (m_Registry.valid(child))
-		{
-			const Relationship& childRelation = m_Registry.get<Relationship>(child);
+		m_Registry.on_construct<Relationship>().connect<&Scene::onHierarchyChanged>(this);
+		m_Registry.on_update<Relationship>().connect<&Scene::onHierarchyChanged>(this);
+		m_Registry.on_destroy<Relationship>().connect<&Scene::onHierarchyChanged>(this);
+		m_Registry.on_construct<TransformComponent>().connect<&Scene::onHierarchyChanged>(this);
+		m_Registry.on_destroy<TransformComponent>().connect<&Scene::onHierarchyChanged>(this);
+
+		m_Registry.on_construct<IDComponent>().connect<&Scene::onIDComponentChanged>(this);
+		m_Registry.on_update<IDComponent>().connect<&Scene::onIDComponentChanged>(this);
+		m_Registry.on_destroy<IDComponent>().connect<&Scene::onIDComponentDestruct>(this);
+		m_Registry.on_construct<SceneTagComponent>().connect<&Scene::onSceneTagChanged>(this);
+		m_Registry.on_update<SceneTagComponent>().connect<&Scene::onSceneTagChanged>(this);
+		m_Registry.on_destroy<SceneTagComponent>().connect<&Scene::onSceneTagDestruct>(this);
+	}
 
-			TransformComponent& transform = m_Registry.get<TransformComponent>(child);
-			if (parentTransform.m_Dirty || transform.m_Dirty)
-				transform.GetTransform().WorldTransform = parentTransform->WorldTransform * transform.GetLocalTransform();
+	void Scene::disconnectRegistrySignals()
+	{
+		m_Registry.on_construct<ScriptComponent>().disconnect<&Scene::onScriptComponentConstruct>(this);
+		m_Registry.on_destroy<ScriptComponent>().disconnect<&Scene::onScriptComponentDestruct>(this);
 
-			futures.emplace_back(threadPool.SubmitJob([instance, child]() mutable {
-				instance->updateSubHierarchy(child);
-				return true;
-			}));
-			child = childRelation.GetNextSibling();
-		}
+		m_Registry.on_construct<Relationship>().disconnect<&Scene::onHierarchyChanged>(this);
+		m_Registry.on_update<Relationship>().disconnect<&Scene::onHierarchyChanged>(this);
+		m_Registry.on_destroy<Relationship>().disconnect<&Scene::onHierarchyChanged>(this);
+		m_Registry.on_construct<TransformComponent>().disconnect<&Scene::onHierarchyChanged>(this);
+		m_Registry.on_destroy<TransformComponent>().disconnect<&Scene::onHierarchyChanged>(this);
+
+		m_Registry.on_construct<IDComponent>().disconnect<&Scene::onIDComponentChanged>(this);
+		m_Registry.on_update<IDComponent>().disconnect<&Scene::onIDComponentChanged>(this);
+		m_Registry.on_destroy<IDComponent>().disconnect<&Scene::onIDComponentDestruct>(this);
+		m_Registry.on_construct<SceneTagComponent>().disconnect<&Scene::onSceneTagChanged>(this);
+		m_Registry.on_update<SceneTagComponent>().disconnect<&Scene::onSceneTagChanged>(this);
+		m_Registry.on_destroy<SceneTagComponent>().disconnect<&Scene::onSceneTagDestruct>(this);
+	}
 
-		for (auto& future : futures)
-			future.wait();
+	void Scene::rebuildEntityIndices()
+	{
+		XYZ_PROFILE_FUNC("Scene::rebuildEntityIndices");
+		m_GUIDIndex.Clear();
+		m_NameIndex.Clear();
+
+		auto idView = m_Registry.view<IDComponent>();
+		m_GUIDIndex.Reserve(static_cast<uint32_t>(idView.size()));
+		for (auto entity : idView)
+			m_GUIDIndex.Insert(entity, idView.get<IDComponent>(entity).ID.Hash());
+
+		auto tagView = m_Registry.view<SceneTagComponent>();
+		m_NameIndex.Reserve(static_cast<uint32_t>(tagView.size()));
+		for (auto entity : tagView)
+			m_NameIndex.Insert(entity, HashName(tagView.get<SceneTagComponent>(entity).Name));
+	}
 
-		// We updated all transforms, they are no longer dirty
-		auto& transformStorage = m_Registry.storage<TransformComponent>();
-		for (auto& transformComponent : transformStorage)
-			transformComponent.m_Dirty = false;
+	entt::entity Scene::findByGUID(const GUID& guid) const
+	{
+		return m_GUIDIndex.Find(guid.Hash(), [&](entt::entity entity) {
+			return m_Registry.get<IDComponent>(entity).ID == guid;
+		});
 	}
 
-	void Scene::updateSubHierarchy(entt::entity parent)
+	entt::entity Scene::findByName(std::string_view name) const
 	{
-		XYZ_PROFILE_FUNC("Scene::updateSubHierarchy");
+		return m_NameIndex.Find(HashName(name), [&](entt::entity entity) {
+			return m_Registry.get<SceneTagComponent>(entity).Name == name;
+		});
+	}
 
-		const Relationship& relation = m_Registry.get<Relationship>(parent);
-		TransformComponent& parentTransform = m_Registry.get<TransformComponent>(parent);
 
-		std::stack<entt::entity> entities;
-		{
-			const Relationship& relation = m_Registry.get<Relationship>(parent);
-			if (m_Registry.valid(relation.FirstChild))
-				entities.push(relation.FirstChild);
-		}
 
-		while (!entities.empty())
+	void Scene::updateScripts(Timestep ts)
+	{
+		XYZ_PROFILE_FUNC("Scene::updateScripts");
+		auto scriptView = m_Registry.view<ScriptComponent>();
+		std::shared_lock lock(m_ScriptMutex);
+		for (auto entity : scriptView)
 		{
-			const entt::entity current = entities.top();
-			entities.pop();
-
-			const Relationship& relation = m_Registry.get<Relationship>(current);
-			if (m_Registry.valid(relation.NextSibling))
-				entities.push(relation.NextSibling);
-			if (m_Registry.valid(relation.FirstChild))
-				entities.push(relation.FirstChild);
-
-			TransformComponent& transform = m_Registry.get<TransformComponent>(current);
-			TransformComponent& parentTransform = m_Registry.get<TransformComponent>(relation.Parent);
-
-			if (parentTransform.m_Dirty || transform.m_Dirty)
-				transform.GetTransform().WorldTransform = parentTransform->WorldTransform * transform.GetLocalTransform();
+			ScriptComponent& scriptComponent = scriptView.get<ScriptComponent>(entity);
+			SceneEntity sceneEntity(entity, this);
+			if (!scriptComponent.ModuleName.empty())
+				ScriptEngine::OnUpdateEntity(sceneEntity, ts);
 		}
 	}
 
+	void Scene::updateHierarchy()
+	{
+		XYZ_PROFILE_FUNC("Scene::updateHierarchy");
+		ThreadPool* pool = m_UpdateHierarchyAsync ? &Application::Get().GetThreadPool() : nullptr;
+		m_TransformHierarchy.Update(m_Registry, m_SceneEntity, pool);
+	}
+
 	void Scene::updateAnimationView(Timestep ts)
 	{
 		XYZ_PROFILE_FUNC("Scene::updateAnimationView");
@@ -723,16 +729,14 @@ namespace XYZ {
 		auto& threadPool = Application::Get().GetThreadPool();
 		auto animView = m_Registry.view<AnimationComponent, AnimatedMeshComponent>();
 		
-		std::vector<std::future<bool>> futures;
-		futures.reserve(animView.size_hint());
-		
+		JobGroup animationGroup;
 		for (auto entity : animView)
 		{
 			auto [anim, animMesh] = animView.get(entity);
 			anim.Playing = true; // TODO: temporary
 			if (anim.Playing && anim.Controller.Valid())
 			{
-				futures.emplace_back(threadPool.SubmitJob([instance, ts, &animation = anim, &animatedMesh = animMesh]() mutable {
+				threadPool.PushJob(animationGroup, [instance, ts, &animation = anim, &animatedMesh = animMesh]() mutable {
 
 					animation.Controller->Update(animation.AnimationTime, animation.Context);
 					animation.AnimationTime += ts;
@@ -743,12 +747,10 @@ namespace XYZ {
 						transform.GetTransform().Rotation = glm::eulerAngles(animation.Context.LocalRotations[i]);
 						transform.GetTransform().Scale = animation.Context.LocalScales[i];
 					}
-					return true;
-				}));
+				});
 			}
 		}
-		for (auto& future : futures)
-			future.wait();
+		threadPool.Wait(animationGroup);
 	}
 
 	void Scene::updateParticleView(Timestep ts)
@@ -784,18 +786,64 @@ namespace XYZ {
 		}
 	}
 
-	void Scene::updateRigidBody2DView()
+	void Scene::updatePhysics(Timestep ts)
 	{
-		XYZ_PROFILE_FUNC("Scene::updateRigidBody2DView");
+		XYZ_PROFILE_FUNC("Scene::updatePhysics");
+		m_PhysicsBodies.clear();
 		auto rigidView = m_Registry.view<TransformComponent, RigidBody2DComponent>();
 		for (const auto entity : rigidView)
-		{
-			auto [transform, rigidBody] = rigidView.get<TransformComponent, RigidBody2DComponent>(entity);
-			const b2Body* body = static_cast<b2Body*>(rigidBody.RuntimeBody);
-			transform.GetTransform().Translation.x = body->GetPosition().x;
-			transform.GetTransform().Translation.y = body->GetPosition().y;
-			transform.GetTransform().Rotation.z = body->GetAngle();
-		}
+			m_PhysicsBodies.push_back(entity);
+
+		m_PhysicsWorld.Step(ts, [this]() { storePreviousBodyStates(); });
+		updateRigidBody2DView(m_PhysicsWorld.GetInterpolationAlpha());
+	}
+
+	void Scene::storePreviousBodyStates()
+	{
+		XYZ_PROFILE_FUNC("Scene::storePreviousBodyStates");
+		auto& rigidBodies = m_Registry.storage<RigidBody2DComponent>();
+		auto storeStates = [&](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				auto& rigidBody = rigidBodies.get(m_PhysicsBodies[i]);
+				const b2Body* body = static_cast<b2Body*>(rigidBody.RuntimeBody);
+				rigidBody.PreviousPosition = { body->GetPosition().x, body->GetPosition().y };
+				rigidBody.PreviousAngle = body->GetAngle();
+			}
+		};
+		const uint32_t count = static_cast<uint32_t>(m_PhysicsBodies.size());
+		if (count > sc_ParallelPhysicsThreshold)
+			Application::Get().GetThreadPool().ParallelFor(count, sc_PhysicsBatchSize, storeStates);
+		else
+			storeStates(0, count);
+	}
+
+	void Scene::updateRigidBody2DView(float alpha)
+	{
+		XYZ_PROFILE_FUNC("Scene::updateRigidBody2DView");
+		// Every entity writes only its own components, batches are independent.
+		// Storages are taken up front, registry lookup is not safe to call concurrently
+		auto& rigidBodies = m_Registry.storage<RigidBody2DComponent>();
+		auto& transforms = m_Registry.storage<TransformComponent>();
+		auto writeTransforms = [&](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const entt::entity entity = m_PhysicsBodies[i];
+				const auto& rigidBody = rigidBodies.get(entity);
+				const b2Body* body = static_cast<b2Body*>(rigidBody.RuntimeBody);
+				const glm::vec2 position = { body->GetPosition().x, body->GetPosition().y };
+
+				auto& transform = transforms.get(entity).GetTransform();
+				transform.Translation.x = glm::mix(rigidBody.PreviousPosition.x, position.x, alpha);
+				transform.Translation.y = glm::mix(rigidBody.PreviousPosition.y, position.y, alpha);
+				transform.Rotation.z = glm::mix(rigidBody.PreviousAngle, body->GetAngle(), alpha);
+			}
+		};
+		const uint32_t count = static_cast<uint32_t>(m_PhysicsBodies.size());
+		if (count > sc_ParallelPhysicsThreshold)
+			Application::Get().GetThreadPool().ParallelFor(count, sc_PhysicsBatchSize, writeTransforms);
+		else
+			writeTransforms(0, count);
 	}
 
 	void Scene::setupPhysics()
@@ -832,6 +880,8 @@ namespace XYZ {
 			
 			b2Body* body = physicsWorld.CreateBody(&bodyDef);
 			rigidBody.RuntimeBody = body;
+			rigidBody.PreviousPosition = { translation.x, translation.y };
+			rigidBody.PreviousAngle = bodyDef.angle;
 			
 			if (entity.HasComponent<BoxCollider2DComponent>())
 			{
@@ -13,6 +13,8 @@
 
 #include "SceneCamera.h"
 #include "GPUScene.h"
+#include "TransformHierarchy.h"
+#include "EntityHashIndex.h"
 
 #include <entt/entt.hpp>
 
@@ -114,6 +116,10 @@ namespace XYZ {
 
         SceneEntity GetEntityByName(const std::string& name);
         SceneEntity GetEntityByGUID(const GUID& guid);
+
+        std::vector<SceneEntity> GetEntitiesByName(const std::string& name);
+        // Result has the same order as guids, missing entities are returned invalid
+        std::vector<SceneEntity> GetEntitiesByGUID(const std::vector<GUID>& guids);
         SceneEntity GetSceneEntity();
         SceneEntity GetSelectedEntity();
 
@@ -132,12 +138,21 @@ namespace XYZ {
     private:
         void onScriptComponentConstruct(entt::registry& reg, entt::entity ent);
         void onScriptComponentDestruct(entt::registry& reg, entt::entity ent);
+        void onHierarchyChanged(entt::registry& reg, entt::entity ent);
+        void onIDComponentChanged(entt::registry& reg, entt::entity ent);
+        void onIDComponentDestruct(entt::registry& reg, entt::entity ent);
+        void onSceneTagChanged(entt::registry& reg, entt::entity ent);
+        void onSceneTagDestruct(entt::registry& reg, entt::entity ent);
   
+        void connectRegistrySignals();
+        void disconnectRegistrySignals();
+        void rebuildEntityIndices();
+
+        entt::entity findByGUID(const GUID& guid) const;
+        entt::entity findByName(std::string_view name) const;
 
         void updateScripts(Timestep ts);
-        void updateHierarchy();      
-        void updateHierarchyAsync();
-        void updateSubHierarchy(entt::entity parent);
+        void updateHierarchy();
 
 
         void updateAnimationView(Timestep ts);
@@ -145,7 +160,9 @@ namespace XYZ {
 
         void updateParticleView(Timestep ts);
         void updateGPUParticleView(Timestep ts);
-        void updateRigidBody2DView();
+        void updatePhysics(Timestep ts);
+        void storePreviousBodyStates();
+        void updateRigidBody2DView(float alpha);
 
        
         void setupPhysics();
@@ -155,8 +172,12 @@ namespace XYZ {
         PhysicsWorld2D      m_PhysicsWorld;
         ContactListener     m_ContactListener;
         SceneEntity*        m_PhysicsEntityBuffer;
+        std::vector<entt::entity> m_PhysicsBodies;
         LightEnvironment    m_LightEnvironment;
         GPUScene            m_GPUScene;
+        TransformHierarchy  m_TransformHierarchy;
+        EntityHashIndex     m_GUIDIndex;
+        EntityHashIndex     m_NameIndex;
 
         entt::registry      m_Registry;
         GUID                m_UUID;
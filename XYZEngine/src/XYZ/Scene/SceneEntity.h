@@ -26,6 +26,10 @@ namespace XYZ {
 		
 		template <typename T>
 		T& AddComponent(const T& component);
+
+		// Modifies component in place and notifies registry listeners
+		template <typename T, typename ...Func>
+		T& PatchComponent(Func&&... func);
 		
 		template <typename T>
 		void RemoveComponent();
@@ -82,6 +86,11 @@ namespace XYZ {
 		T& newComp = m_Scene->m_Registry.emplace<T>(m_ID, component);
 		return newComp;
 	}
+	template<typename T, typename ...Func>
+	inline T& SceneEntity::PatchComponent(Func && ...func)
+	{
+		return m_Scene->m_Registry.patch<T>(m_ID, std::forward<Func>(func)...);
+	}
 	template<typename T>
 	inline void SceneEntity::RemoveComponent()
 	{
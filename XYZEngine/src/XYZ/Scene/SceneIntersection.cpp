@@ -4,6 +4,8 @@
 
 #include "Components.h"
 
+#include "XYZ/Debug/Profiler.h"
+
 namespace XYZ {
 	namespace Utils {
 		
@@ -66,25 +68,22 @@ namespace XYZ {
 	}
 
 
-    std::deque<SceneIntersection::HitData> SceneIntersection::Intersect(const Ray& ray, Ref<Scene> scene)
-    {
-        std::deque<HitData> result;
+	std::deque<SceneIntersection::HitData> SceneIntersection::Intersect(const Ray& ray, Ref<Scene> scene)
+	{
+		XYZ_PROFILE_FUNC("SceneIntersection::Intersect");
+		std::deque<HitData> result;
 
-		// TODO: octree
+		// Building the tree costs more than testing every entity box once
 		scene->GetRegistry().each([&](const entt::entity entityID) {
 			SceneEntity entity(entityID, scene.Raw());
 			float distance = 0.0f;
-
 			if (Utils::RayEntityCollision(entity, ray, distance))
-			{
 				result.push_back({ entity, distance });
-			}
 		});
 
 		std::sort(result.begin(), result.end(), [&](const HitData& a, const HitData& b) {
 			return a.Distance < b.Distance;
 		});
-
-        return result;
-    }
+		return result;
+	}
 }
\ No newline at end of file
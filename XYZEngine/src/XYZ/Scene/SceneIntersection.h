@@ -17,6 +17,7 @@ namespace XYZ {
 			float		Distance;
 		};
 
+		// Tests every entity, used for single picking ray
 		static std::deque<HitData> Intersect(const Ray& ray, Ref<Scene> scene);
 	};
 }
\ No newline at end of file
@@ -848,17 +848,6 @@ namespace XYZ {
 		fout.flush();
 	}
 
-	entt::entity FindByID(const entt::registry& reg, const GUID& guid)
-	{
-		auto view = reg.view<const IDComponent>();
-		for (auto entity : view)
-		{
-			if (view.get<const IDComponent>(entity).ID == guid)
-				return entity;
-		}
-		return entt::null;
-	}
-
 	void PreloadAssets(const YAML::Node& assets)
 	{
 		std::vector<AssetHandle> assetHandles;	
@@ -885,7 +874,6 @@ namespace XYZ {
 
 
 		Ref<Scene> scene = Ref<Scene>::Create(sceneName, sceneEntityGuid);
-		entt::registry& reg = scene->m_Registry;
 		SceneEntity sceneEntity = scene->GetSceneEntity();
 
 		auto entities = data["Entities"];
@@ -906,12 +894,12 @@ namespace XYZ {
 			if (data["FirstChild"])
 			{
 				GUID firstChildID = data["FirstChild"].as<std::string>();
-				sceneEntity.GetComponent<Relationship>().FirstChild = FindByID(reg, firstChildID);
+				sceneEntity.GetComponent<Relationship>().FirstChild = scene->findByGUID(firstChildID);
 			}
 			for (auto entityData : entities)
 			{
 				GUID guid = entityData["Entity"].as<std::string>();
-				entt::entity entity = FindByID(reg, guid);
+				entt::entity entity = scene->findByGUID(guid);
 				SceneEntity setupEntity{ entity, scene.Raw() };
 
 				setupRelationship(entityData, setupEntity);
@@ -938,7 +926,7 @@ namespace XYZ {
 
 	void SceneSerializer::setupRelationship(YAML::Node& data, SceneEntity entity)
 	{
-		const entt::registry& reg = *entity.GetRegistry();
+		const Scene& scene = *entity.GetScene();
 		Relationship& relationship = entity.GetComponent<Relationship>();
 		// Remove relations created by scene
 		relationship.Parent = entt::null;
@@ -949,22 +937,22 @@ namespace XYZ {
 		auto relComponent = data["Relationship"];
 
 		GUID parent = relComponent["Parent"].as<std::string>();
-		relationship.Parent = FindByID(reg, parent);
+		relationship.Parent = scene.findByGUID(parent);
 
 		if (relComponent["NextSibling"])
 		{
 			GUID nextSibling = relComponent["NextSibling"].as<std::string>();
-			relationship.NextSibling = FindByID(reg, nextSibling);
+			relationship.NextSibling = scene.findByGUID(nextSibling);
 		}
 		if (relComponent["PreviousSibling"])
 		{
 			GUID previousSibling = relComponent["PreviousSibling"].as<std::string>();
-			relationship.PreviousSibling = FindByID(reg, previousSibling);
+			relationship.PreviousSibling = scene.findByGUID(previousSibling);
 		}
 		if (relComponent["FirstChild"])
 		{
 			GUID firstChild = relComponent["FirstChild"].as<std::string>();
-			relationship.FirstChild = FindByID(reg, firstChild);
+			relationship.FirstChild = scene.findByGUID(firstChild);
 		}
 		relationship.Depth = relComponent["Depth"].as<uint32_t>();
 	}
@@ -973,7 +961,7 @@ namespace XYZ {
 		AnimatedMeshComponent& component = entity.GetComponent<AnimatedMeshComponent>();
 		for (auto boneEntity : data["BoneEntities"])
 		{
-			entt::entity bone = FindByID(*entity.GetRegistry(), boneEntity.as<std::string>());
+			entt::entity bone = entity.GetScene()->findByGUID(boneEntity.as<std::string>());
 			component.BoneEntities.push_back(bone);
 		}
 	}
@@ -0,0 +1,107 @@
+#include "stdafx.h"
+#include "TransformHierarchy.h"
+
+#include "Components.h"
+
+#include "XYZ/Debug/Profiler.h"
+#include "XYZ/Debug/Timer.h"
+
+namespace XYZ {
+
+	void TransformHierarchy::Update(entt::registry& registry, entt::entity root, ThreadPool* pool)
+	{
+		XYZ_PROFILE_FUNC("TransformHierarchy::Update");
+		Stopwatch timer;
+		if (m_Invalid)
+			rebuild(registry, root);
+
+		TransformComponent& rootTransform = *m_Nodes[0].Transform;
+		m_DirtyFlags[0] = rootTransform.m_Dirty;
+		rootTransform.m_Dirty = false;
+
+		std::atomic_uint32_t updatedCount = 0;
+		const uint32_t levelCount = static_cast<uint32_t>(m_LevelOffsets.size()) - 1;
+		for (uint32_t level = 1; level < levelCount; ++level)
+		{
+			const uint32_t levelBegin = m_LevelOffsets[level];
+			const uint32_t levelEnd = m_LevelOffsets[level + 1];
+			const uint32_t levelSize = levelEnd - levelBegin;
+
+			if (pool && levelSize > sc_BatchSize)
+			{
+				pool->ParallelFor(levelSize, sc_BatchSize, [&](uint32_t begin, uint32_t end) {
+					updatedCount += updateRange(levelBegin + begin, levelBegin + end);
+				});
+			}
+			else
+			{
+				updatedCount += updateRange(levelBegin, levelEnd);
+			}
+		}
+
+		m_Stats.NodeCount = static_cast<uint32_t>(m_Nodes.size());
+		m_Stats.LevelCount = levelCount;
+		m_Stats.UpdatedCount = updatedCount;
+		m_Stats.UpdateTimeMs = timer.Elapsed();
+	}
+
+	void TransformHierarchy::rebuild(entt::registry& registry, entt::entity root)
+	{
+		XYZ_PROFILE_FUNC("TransformHierarchy::rebuild");
+		m_Nodes.clear();
+		m_LevelOffsets.clear();
+
+		m_Nodes.push_back({ &registry.get<TransformComponent>(root), UINT32_MAX });
+		m_LevelOffsets.push_back(0);
+
+		std::vector<entt::entity> currentLevel{ root };
+		std::vector<entt::entity> nextLevel;
+		uint32_t parentIndex = 0;
+		while (!currentLevel.empty())
+		{
+			m_LevelOffsets.push_back(static_cast<uint32_t>(m_Nodes.size()));
+			for (const entt::entity parent : currentLevel)
+			{
+				entt::entity child = registry.get<Relationship>(parent).GetFirstChild();
+				while (registry.valid(child))
+				{
+					m_Nodes.push_back({ &registry.get<TransformComponent>(child), parentIndex });
+					nextLevel.push_back(child);
+					child = registry.get<Relationship>(child).GetNextSibling();
+				}
+				parentIndex++;
+			}
+			std::swap(currentLevel, nextLevel);
+			nextLevel.clear();
+		}
+
+		// Structure changed, recompute everything once
+		for (auto& node : m_Nodes)
+			node.Transform->m_Dirty = true;
+
+		m_DirtyFlags.resize(m_Nodes.size());
+		m_Stats.RebuildCount++;
+		m_Invalid = false;
+	}
+
+	uint32_t TransformHierarchy::updateRange(uint32_t begin, uint32_t end)
+	{
+		uint32_t updated = 0;
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const Node& node = m_Nodes[i];
+			TransformComponent& transform = *node.Transform;
+
+			const bool dirty = m_DirtyFlags[node.Parent] || transform.m_Dirty;
+			m_DirtyFlags[i] = dirty;
+			if (dirty)
+			{
+				const TransformComponent& parentTransform = *m_Nodes[node.Parent].Transform;
+				transform.m_Transform.WorldTransform = parentTransform->WorldTransform * transform.GetLocalTransform();
+				transform.m_Dirty = false;
+				updated++;
+			}
+		}
+		return updated;
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+#include "XYZ/Core/ThreadPool.h"
+
+#include <entt/entt.hpp>
+
+namespace XYZ {
+
+	class TransformComponent;
+
+	// Flat, depth sorted view of the Relationship hierarchy.
+	// World transforms are recomputed level by level, nodes of one level are independent and updated in parallel
+	class XYZ_API TransformHierarchy
+	{
+	public:
+		struct Stats
+		{
+			uint32_t NodeCount = 0;
+			uint32_t LevelCount = 0;
+			uint32_t UpdatedCount = 0;
+			uint32_t RebuildCount = 0;
+			float	 UpdateTimeMs = 0.0f;
+		};
+
+		void Update(entt::registry& registry, entt::entity root, ThreadPool* pool = nullptr);
+
+		// Must be called when Relationship or TransformComponent storage changes
+		void Invalidate() { m_Invalid = true; }
+
+		const Stats& GetStats() const { return m_Stats; }
+
+	private:
+		void rebuild(entt::registry& registry, entt::entity root);
+		uint32_t updateRange(uint32_t begin, uint32_t end);
+
+	private:
+		struct Node
+		{
+			TransformComponent* Transform;
+			uint32_t			Parent;
+		};
+
+		static constexpr uint32_t sc_BatchSize = 1024;
+
+		std::vector<Node>	  m_Nodes;		  // Breadth first order, m_Nodes[0] is root
+		std::vector<uint32_t> m_LevelOffsets; // Level i occupies [m_LevelOffsets[i], m_LevelOffsets[i + 1])
+		std::vector<uint8_t>  m_DirtyFlags;
+
+		Stats m_Stats;
+		bool  m_Invalid = true;
+	};
+}
@@ -0,0 +1,109 @@
+#include "stdafx.h"
+#include "RadixSort.h"
+
+#include "XYZ/Core/ThreadPool.h"
+#include "XYZ/Debug/Profiler.h"
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_RadixBits = 8;
+	static constexpr uint32_t sc_RadixSize = 1 << sc_RadixBits;
+	static constexpr uint32_t sc_MinBlockSize = 16384;
+
+	void RadixSorter::Sort(uint64_t* keys, uint32_t* values, uint32_t count, uint32_t keyBits)
+	{
+		XYZ_PROFILE_FUNC("RadixSorter::Sort");
+		sort(keys, values, count, keyBits, 1, nullptr);
+	}
+
+	void RadixSorter::Sort(uint64_t* keys, uint32_t* values, uint32_t count, uint32_t keyBits, ThreadPool& pool)
+	{
+		XYZ_PROFILE_FUNC("RadixSorter::Sort");
+		const uint32_t maxBlocks = pool.GetNumThreads() + 1;
+		const uint32_t numBlocks = std::clamp(count / sc_MinBlockSize, 1u, maxBlocks);
+		sort(keys, values, count, keyBits, numBlocks, &pool);
+	}
+
+	void RadixSorter::sort(uint64_t* keys, uint32_t* values, uint32_t count, uint32_t keyBits, uint32_t numBlocks, ThreadPool* pool)
+	{
+		if (count < 2 || keyBits == 0)
+			return;
+
+		m_Keys.resize(count);
+		m_Values.resize(count);
+		m_Histograms.resize(static_cast<size_t>(numBlocks) * sc_RadixSize);
+
+		const uint32_t blockSize = (count + numBlocks - 1) / numBlocks;
+		const uint32_t numPasses = (keyBits + sc_RadixBits - 1) / sc_RadixBits;
+
+		uint64_t* srcKeys = keys;
+		uint32_t* srcValues = values;
+		uint64_t* dstKeys = m_Keys.data();
+		uint32_t* dstValues = m_Values.data();
+
+		auto forEachBlock = [&](auto&& func) {
+			if (pool)
+				pool->ParallelFor(numBlocks, 1, func);
+			else
+				func(0u);
+		};
+
+		for (uint32_t pass = 0; pass < numPasses; ++pass)
+		{
+			const uint32_t shift = pass * sc_RadixBits;
+			forEachBlock([&](uint32_t block) {
+				uint32_t* histogram = &m_Histograms[block * sc_RadixSize];
+				std::fill(histogram, histogram + sc_RadixSize, 0);
+
+				const uint32_t end = std::min((block + 1) * blockSize, count);
+				for (uint32_t i = block * blockSize; i < end; ++i)
+					histogram[(srcKeys[i] >> shift) & (sc_RadixSize - 1)]++;
+			});
+
+			// Pass is skipped if all keys have same digit, common for high bits of sort keys
+			bool uniformDigit = false;
+			for (uint32_t digit = 0; digit < sc_RadixSize && !uniformDigit; ++digit)
+			{
+				uint32_t digitCount = 0;
+				for (uint32_t block = 0; block < numBlocks; ++block)
+					digitCount += m_Histograms[block * sc_RadixSize + digit];
+				uniformDigit = digitCount == count;
+			}
+			if (uniformDigit)
+				continue;
+
+			// Exclusive prefix sum digit major, block minor keeps sort stable
+			uint32_t offset = 0;
+			for (uint32_t digit = 0; digit < sc_RadixSize; ++digit)
+			{
+				for (uint32_t block = 0; block < numBlocks; ++block)
+				{
+					uint32_t& bucket = m_Histograms[block * sc_RadixSize + digit];
+					const uint32_t bucketCount = bucket;
+					bucket = offset;
+					offset += bucketCount;
+				}
+			}
+
+			forEachBlock([&](uint32_t block) {
+				uint32_t* offsets = &m_Histograms[block * sc_RadixSize];
+				const uint32_t end = std::min((block + 1) * blockSize, count);
+				for (uint32_t i = block * blockSize; i < end; ++i)
+				{
+					const uint32_t dst = offsets[(srcKeys[i] >> shift) & (sc_RadixSize - 1)]++;
+					dstKeys[dst] = srcKeys[i];
+					dstValues[dst] = srcValues[i];
+				}
+			});
+
+			std::swap(srcKeys, dstKeys);
+			std::swap(srcValues, dstValues);
+		}
+
+		if (srcKeys != keys)
+		{
+			memcpy(keys, srcKeys, sizeof(uint64_t) * count);
+			memcpy(values, srcValues, sizeof(uint32_t) * count);
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include <vector>
+
+namespace XYZ {
+
+	class ThreadPool;
+
+	// Stable LSD radix sort of 64 bit keys with 32 bit values, 8 bits per pass.
+	// Scratch buffers are kept between calls, so sorting every frame does not allocate
+	class XYZ_API RadixSorter
+	{
+	public:
+		// Sorts only lower keyBits bits of keys, higher bits must be zero
+		void Sort(uint64_t* keys, uint32_t* values, uint32_t count, uint32_t keyBits);
+
+		// Every pass histograms and scatters blocks of keys in parallel
+		void Sort(uint64_t* keys, uint32_t* values, uint32_t count, uint32_t keyBits, ThreadPool& pool);
+
+	private:
+		void sort(uint64_t* keys, uint32_t* values, uint32_t count, uint32_t keyBits, uint32_t numBlocks, ThreadPool* pool);
+
+	private:
+		std::vector<uint64_t> m_Keys;
+		std::vector<uint32_t> m_Values;
+		std::vector<uint32_t> m_Histograms;
+	};
+}
@@ -3,11 +3,16 @@
 
 #include "XYZ/Utils/Random.h"
 #include "XYZ/Utils/Algorithms/Raymarch.h"
+#include "XYZ/Core/ThreadPool.h"
+#include "XYZ/Debug/Profiler.h"
 
 #include <glm/ext/scalar_constants.hpp>
 
 namespace XYZ {
 
+	static constexpr uint32_t sc_AttractorBatchSize = 256;
+	static constexpr float	  sc_MaxGridResolution = 64.0f; // Cells per axis
+
 	static uint32_t Index3D(const glm::ivec3& index, uint32_t width, uint32_t height)
 	{
 		return index.x + width * (index.y + height * index.z);
@@ -31,158 +36,111 @@ namespace XYZ {
 			m_Attractors[i].y = initializer.AttractorsCenter.y + RandomNumber(0.0f, initializer.AttractorsRadius) * sin(phi) * sin(theta);
 			m_Attractors[i].z = initializer.AttractorsCenter.z + RandomNumber(0.0f, initializer.AttractorsRadius) * cos(phi);
 		}
-		m_RootBranch = new SCBranch();
-		m_RootBranch->Start = initializer.RootPosition;
-		m_RootBranch->End = initializer.RootPosition + glm::vec3(0.0f, initializer.BranchLength, 0.0f);
-		m_RootBranch->Direction = glm::normalize(glm::vec3(0.0f, 1.0f, 0.0f) + randomGrowVector(m_GrowSize));
-		m_RootBranch->Parent = nullptr;
-		m_Branches.push_back(m_RootBranch);
-		m_Extremities.push_back(m_RootBranch);
+		createGrid(std::max(m_AttractionRange, m_KillRange));
+
+		SCBranch root;
+		root.Start = initializer.RootPosition;
+		root.End = initializer.RootPosition + glm::vec3(0.0f, initializer.BranchLength, 0.0f);
+		root.Direction = glm::normalize(glm::vec3(0.0f, 1.0f, 0.0f) + randomGrowVector(m_GrowSize));
+		addBranch(root);
+		m_Extremities.push_back(0);
 	}
-	void SpaceColonization::Grow()
+	void SpaceColonization::Grow(ThreadPool* pool)
 	{
+		XYZ_PROFILE_FUNC("SpaceColonization::Grow");
 		// we remove the attractors in kill range
-		for (int32_t i = m_Attractors.size() - 1; i >= 0; i--) 
-		{
-			for (SCBranch* branch : m_Branches)
-			{
-				if (glm::distance(branch->End, m_Attractors[i]) < m_KillRange) 
-				{
-					m_Attractors.erase(m_Attractors.begin() + i);
-					break;
-				}
-			}
-		}
+		killAttractors(pool);
 
 		if (!m_Attractors.empty())
 		{
-			// we clear the active attractors
-			m_ActiveAttractors.clear();
-			for (SCBranch* branch : m_Branches)
-			{
-				branch->Attractors.clear();
-			}
-
 			// each attractor is associated to its closest branch, if in attraction range
-			uint32_t attractorIndex = 0;
-			for (const glm::vec3& attractor : m_Attractors) 
-			{
-				float min = std::numeric_limits<float>::max();
-				SCBranch* closest = nullptr; // will store the closest branch
-				for (SCBranch* branch : m_Branches) 
-				{
-					float distance = glm::distance(branch->End, attractor);
-					if (distance < m_AttractionRange && distance < min)
-					{
-						min = distance;
-						closest = branch;
-					}
-				}
-
-				// if a branch has been found, we add the attractor to the branch
-				if (closest != nullptr) 
-				{
-					closest->Attractors.push_back(attractor);
-					m_ActiveAttractors.push_back(attractorIndex);
-				}
-				attractorIndex++;
-			}
-
+			const uint32_t activeAttractors = assignAttractors(pool);
 
 			// if at least an attraction point has been found, we want our tree to grow towards it
-			if (!m_ActiveAttractors.empty()) 
+			if (activeAttractors != 0)
 			{
 				// because new extremities will be set here, we clear the current ones
 				m_Extremities.clear();
 
 				// new branches will be added here
-				std::vector<SCBranch*> newBranches;
-				for (SCBranch* branch : m_Branches) 
+				std::vector<SCBranch> newBranches;
+				const uint32_t branchCount = static_cast<uint32_t>(m_Branches.size());
+				for (uint32_t i = 0; i < branchCount; ++i)
 				{
+					SCBranch& branch = m_Branches[i];
 					// if the branch has attraction points, we grow towards them
-					if (!branch->Attractors.empty())
+					if (branch.AttractorCount != 0)
 					{
 						// we compute the direction of the new branch
-						glm::vec3 dir(0, 0, 0);
-						for (const glm::vec3& attr : branch->Attractors) 
-						{
-							dir += glm::normalize(attr - branch->End);
-						}
-						dir /= branch->Attractors.size();
+						glm::vec3 dir = branch.AttractorDirection / static_cast<float>(branch.AttractorCount);
 						// random growth
 						dir += randomGrowVector(m_GrowSize);
 						dir = glm::normalize(dir);
 
 						// our new branch grows in the correct direction
-						SCBranch* newBranch = new SCBranch();
-						newBranch->Start = branch->End;
-						newBranch->End = branch->End + dir * m_BranchLength;
-						newBranch->Direction = dir;
-						newBranch->Parent = branch;
-
+						SCBranch& newBranch = newBranches.emplace_back();
+						newBranch.Start = branch.End;
+						newBranch.End = branch.End + dir * m_BranchLength;
+						newBranch.Direction = dir;
+						newBranch.Parent = i;
+						newBranch.DistanceFromRoot = branch.DistanceFromRoot + 1;
 
-						newBranch->DistanceFromRoot = branch->DistanceFromRoot + 1;
-						branch->Children.push_back(newBranch);
-						newBranches.push_back(newBranch);
-						m_Extremities.push_back(newBranch);
+						branch.ChildCount++;
+						m_Extremities.push_back(branchCount + static_cast<uint32_t>(newBranches.size()) - 1);
 					}
-					else 
+					else if (branch.ChildCount == 0)
 					{
 						// if no attraction points, we only check if the branch is an extremity
-						if (branch->Children.empty()) 
-						{
-							m_Extremities.push_back(branch);
-						}
+						m_Extremities.push_back(i);
 					}
 				}
 
 				// we merge the new branches with the previous ones
-				for (auto newBranch : newBranches)
-					m_Branches.push_back(newBranch);
+				for (const SCBranch& newBranch : newBranches)
+					addBranch(newBranch);
 			}
 			else 
 			{
 				// we grow the extremities of the tree
 				for (uint32_t i = 0; i < m_Extremities.size(); ++i) 
 				{
-					SCBranch* extremity = m_Extremities[i];
-					// the new branch starts where the extremity ends
-					glm::vec3 start = extremity->End;
+					const uint32_t extremityIndex = m_Extremities[i];
+					SCBranch& extremity = m_Branches[extremityIndex];
 					// we add randomness to the direction
-					glm::vec3 dir = extremity->Direction + randomGrowVector(m_GrowSize);
-					// we add the direction multiplied by the branch length to get the end point
-					glm::vec3 end = extremity->End + dir * m_BranchLength;
-					// a new branch can be created with the same direction as its parent
-					SCBranch* newBranch = new SCBranch();
-					newBranch->Start = start;
-					newBranch->End = end;
-					newBranch->Direction = dir;
-					newBranch->Parent = extremity;
+					const glm::vec3 dir = extremity.Direction + randomGrowVector(m_GrowSize);
+
+					// a new branch starts where the extremity ends, with the same direction as its parent
+					SCBranch newBranch;
+					newBranch.Start = extremity.End;
+					newBranch.End = extremity.End + dir * m_BranchLength;
+					newBranch.Direction = dir;
+					newBranch.Parent = extremityIndex;
 
 					// the current extrimity has a new child
-					extremity->Children.push_back(newBranch);
+					extremity.ChildCount++;
 
 					// let's add the new branch to the list and set it as the new extremity 
-					m_Branches.push_back(newBranch);
-					
-					m_Extremities[i] = newBranch;
+					m_Extremities[i] = static_cast<uint32_t>(m_Branches.size());
+					addBranch(newBranch);
 				}
 			}
 		}
 	}
-	void SpaceColonization::Grow(std::vector<uint8_t>& voxels, uint32_t width, uint32_t height, uint32_t depth, float voxelSize, int32_t radius)
+	void SpaceColonization::Grow(std::vector<uint8_t>& voxels, uint32_t width, uint32_t height, uint32_t depth, float voxelSize, int32_t radius, ThreadPool* pool)
 	{
 		if (m_Finished)
 			return;
 
-		Grow();
+		Grow(pool);
 
 		const uint8_t Grass = 3;
 		const uint32_t Wood = 4;
 
-		for (const SCBranch * branch : m_Branches)
+		// Voxels of older branches are already in the buffer, only branches added since last call are voxelized
+		for (uint32_t i = m_VoxelizedBranches; i < m_Branches.size(); ++i)
 		{
-			Ray ray(branch->Start, branch->Direction);
+			const SCBranch& branch = m_Branches[i];
+			Ray ray(branch.Start, branch.Direction);
 			Raymarch raymarch(ray, width, height, depth, voxelSize);
 			
 			glm::ivec3 currentVoxel = raymarch.GetCurrentVoxel();
@@ -210,14 +168,16 @@ namespace XYZ {
 				currentVoxelPosition = glm::vec3(currentVoxel) * voxelSize;
 			}
 		}
+		m_VoxelizedBranches = static_cast<uint32_t>(m_Branches.size());
+
 		if (m_Attractors.empty())
 		{
 			m_Finished = true;
-			for (const SCBranch* branch : m_Branches)
+			for (const SCBranch& branch : m_Branches)
 			{
-				if (branch->Children.empty())
+				if (branch.ChildCount == 0)
 				{
-					glm::ivec3 voxel = branch->End / voxelSize;
+					glm::ivec3 voxel = branch.End / voxelSize;
 					glm::ivec3 elipsoid(RandomNumber(6u, 15u), RandomNumber(3u, 7u), RandomNumber(6u, 15u));
 					int32_t max = std::max(elipsoid.x, std::max(elipsoid.y, elipsoid.z));
 					for (int32_t x = -max * 2; x < max * 2; x++)
@@ -255,6 +215,158 @@ namespace XYZ {
 				voxels[index] = 10;
 		}
 	}
+	template <typename Pred>
+	bool SpaceColonization::queryNearBranches(const glm::vec3& position, Pred&& pred) const
+	{
+		const glm::ivec3 cell(glm::floor((position - m_GridMin) / m_CellSize));
+		const int32_t minX = std::max(cell.x - 1, 0), maxX = std::min(cell.x + 1, m_GridSize.x - 1);
+		const int32_t minY = std::max(cell.y - 1, 0), maxY = std::min(cell.y + 1, m_GridSize.y - 1);
+		const int32_t minZ = std::max(cell.z - 1, 0), maxZ = std::min(cell.z + 1, m_GridSize.z - 1);
+		for (int32_t z = minZ; z <= maxZ; ++z)
+		{
+			for (int32_t y = minY; y <= maxY; ++y)
+			{
+				for (int32_t x = minX; x <= maxX; ++x)
+				{
+					const uint32_t cellIndex = Index3D(glm::ivec3(x, y, z), m_GridSize.x, m_GridSize.y);
+					for (uint32_t branch = m_CellHeads[cellIndex]; branch != SCBranch::sc_NullIndex; branch = m_GridEntries[branch].Next)
+					{
+						if (pred(branch, m_GridEntries[branch].End))
+							return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	void SpaceColonization::killAttractors(ThreadPool* pool)
+	{
+		XYZ_PROFILE_FUNC("SpaceColonization::killAttractors");
+		const uint32_t count = static_cast<uint32_t>(m_Attractors.size());
+		m_KilledAttractors.resize(count);
+
+		auto kill = [&](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const glm::vec3& attractor = m_Attractors[i];
+				m_KilledAttractors[i] = queryNearBranches(attractor, [&](uint32_t branchIndex, const glm::vec3& end) {
+					return glm::distance(end, attractor) < m_KillRange;
+				});
+			}
+		};
+		if (pool)
+			pool->ParallelFor(count, sc_AttractorBatchSize, kill);
+		else
+			kill(0, count);
+
+		// Keeps order of remaining attractors
+		uint32_t remaining = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (!m_KilledAttractors[i])
+				m_Attractors[remaining++] = m_Attractors[i];
+		}
+		m_Attractors.resize(remaining);
+	}
+
+	uint32_t SpaceColonization::assignAttractors(ThreadPool* pool)
+	{
+		XYZ_PROFILE_FUNC("SpaceColonization::assignAttractors");
+		const uint32_t count = static_cast<uint32_t>(m_Attractors.size());
+		m_ClosestBranches.resize(count);
+
+		auto assign = [&](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const glm::vec3& attractor = m_Attractors[i];
+				float min = std::numeric_limits<float>::max();
+				uint32_t closest = SCBranch::sc_NullIndex;
+				queryNearBranches(attractor, [&](uint32_t branchIndex, const glm::vec3& end) {
+					// Ties go to lower index, same as testing branches in order
+					const float distance = glm::distance(end, attractor);
+					if (distance < m_AttractionRange && (distance < min || (distance == min && branchIndex < closest)))
+					{
+						min = distance;
+						closest = branchIndex;
+					}
+					return false;
+				});
+				m_ClosestBranches[i] = closest;
+			}
+		};
+		if (pool)
+			pool->ParallelFor(count, sc_AttractorBatchSize, assign);
+		else
+			assign(0, count);
+
+		for (SCBranch& branch : m_Branches)
+		{
+			branch.AttractorDirection = glm::vec3(0.0f);
+			branch.AttractorCount = 0;
+		}
+
+		// Directions are summed in attractor order, result does not depend on number of threads
+		uint32_t activeAttractors = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (m_ClosestBranches[i] == SCBranch::sc_NullIndex)
+				continue;
+
+			SCBranch& branch = m_Branches[m_ClosestBranches[i]];
+			branch.AttractorDirection += glm::normalize(m_Attractors[i] - branch.End);
+			branch.AttractorCount++;
+			activeAttractors++;
+		}
+		return activeAttractors;
+	}
+
+	void SpaceColonization::addBranch(const SCBranch& branch)
+	{
+		const uint32_t index = static_cast<uint32_t>(m_Branches.size());
+		m_Branches.push_back(branch);
+
+		GridEntry& entry = m_GridEntries.emplace_back();
+		entry.End = branch.End;
+		entry.Next = SCBranch::sc_NullIndex;
+
+		// Branches outside of the grid are out of range of every attractor
+		const glm::ivec3 cell(glm::floor((branch.End - m_GridMin) / m_CellSize));
+		if (cell.x >= 0 && cell.y >= 0 && cell.z >= 0
+		 && cell.x < m_GridSize.x && cell.y < m_GridSize.y && cell.z < m_GridSize.z)
+		{
+			uint32_t& head = m_CellHeads[Index3D(cell, m_GridSize.x, m_GridSize.y)];
+			entry.Next = head;
+			head = index;
+		}
+	}
+
+	void SpaceColonization::createGrid(float range)
+	{
+		glm::vec3 min(0.0f);
+		glm::vec3 max(0.0f);
+		if (!m_Attractors.empty())
+		{
+			min = max = m_Attractors[0];
+			for (const glm::vec3& attractor : m_Attractors)
+			{
+				min = glm::min(min, attractor);
+				max = glm::max(max, attractor);
+			}
+		}
+		// Every branch in range of an attractor is inside of attractor bounds extended by range
+		const glm::vec3 extent = max - min + glm::vec3(2.0f * range);
+		const float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+
+		m_CellSize = std::max(range, maxExtent / sc_MaxGridResolution);
+		if (m_CellSize <= 0.0f)
+			m_CellSize = 1.0f;
+
+		m_GridMin = min - glm::vec3(range);
+		m_GridSize = glm::ivec3(glm::floor(extent / m_CellSize)) + glm::ivec3(1);
+		m_CellHeads.assign(static_cast<size_t>(m_GridSize.x) * m_GridSize.y * m_GridSize.z, SCBranch::sc_NullIndex);
+	}
+
 	glm::vec3 SpaceColonization::randomGrowVector(float growSize)
 	{
 		float alpha = RandomNumber(0.0f, glm::pi<float>());
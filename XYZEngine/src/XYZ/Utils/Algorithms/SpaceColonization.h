@@ -1,18 +1,26 @@
 #pragma once
+#include "XYZ/Core/Core.h"
 
 #include <glm/glm.hpp>
 
 namespace XYZ {
+
+	class ThreadPool;
+
 	struct SCBranch
 	{
+		static constexpr uint32_t sc_NullIndex = UINT32_MAX;
+
 		glm::vec3	Start;
 		glm::vec3   End;
 		glm::vec3	Direction;
-		SCBranch*   Parent;				// Pointer to parent of the branch
+		uint32_t	Parent = sc_NullIndex;	// Index of parent of the branch
 		uint32_t	DistanceFromRoot = 0;
+		uint32_t	ChildCount = 0;
 
-		std::vector<SCBranch*> Children;
-		std::vector<glm::vec3> Attractors;
+		// Sum of directions to attractors assigned in current iteration
+		glm::vec3	AttractorDirection = glm::vec3(0.0f);
+		uint32_t	AttractorCount = 0;
 	};
 
 	struct SCInitializer
@@ -27,26 +35,53 @@ namespace XYZ {
 		float		BranchLength;
 	};
 
+	// Branch ends are kept in uniform grid over attractors with cells of at least max(AttractionRange, KillRange) size,
+	// so every attractor tests only branches in neighbouring cells. Branches are never removed, grid is updated with new branches only
 	class XYZ_API SpaceColonization
 	{
 	public:
 		SpaceColonization(const SCInitializer& initializer);
 
-		void Grow();
-		void Grow(std::vector<uint8_t>& voxels, uint32_t width, uint32_t height, uint32_t depth, float voxelSize, int32_t radius);
+		void Grow(ThreadPool* pool = nullptr);
+		void Grow(std::vector<uint8_t>& voxels, uint32_t width, uint32_t height, uint32_t depth, float voxelSize, int32_t radius, ThreadPool* pool = nullptr);
 		void VoxelizeAttractors(std::vector<uint8_t>& voxels, uint32_t width, uint32_t height, uint32_t depth, float voxelSize);
 
+		const std::vector<SCBranch>&  GetBranches()   const { return m_Branches; }
+		const std::vector<glm::vec3>& GetAttractors() const { return m_Attractors; }
+
 	private:
-		static glm::vec3 randomGrowVector(float growSize);
+		void	 killAttractors(ThreadPool* pool);
+		uint32_t assignAttractors(ThreadPool* pool);
+		void	 addBranch(const SCBranch& branch);
 
+		// Calls pred for branches in neighbouring cells until it returns true
+		template <typename Pred>
+		bool	 queryNearBranches(const glm::vec3& position, Pred&& pred) const;
+
+		void	 createGrid(float range);
+
+		static glm::vec3 randomGrowVector(float growSize);
 
 	private:
 		std::vector<glm::vec3> m_Attractors;
-		std::vector<uint32_t>  m_ActiveAttractors;
-		std::vector<SCBranch*> m_Extremities;
-		std::vector<SCBranch*> m_Branches;
+		std::vector<uint32_t>  m_ClosestBranches; // Per attractor, result of assignment
+		std::vector<uint8_t>   m_KilledAttractors;
+		std::vector<uint32_t>  m_Extremities;
+		std::vector<SCBranch>  m_Branches;
+
+		struct GridEntry
+		{
+			glm::vec3 End;
+			uint32_t  Next; // Next branch in the same cell
+		};
+
+		std::vector<uint32_t>  m_CellHeads;
+		std::vector<GridEntry> m_GridEntries; // Per branch
+		glm::vec3			   m_GridMin;
+		glm::ivec3			   m_GridSize;
+		float				   m_CellSize;
+		uint32_t			   m_VoxelizedBranches = 0;
 
-		SCBranch* m_RootBranch;
 		float     m_BranchLength;
 		float	  m_KillRange;
 		float	  m_AttractionRange;
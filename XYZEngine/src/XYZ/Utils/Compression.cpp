@@ -0,0 +1,57 @@
+#include "stdafx.h"
+#include "Compression.h"
+
+namespace XYZ::Utils {
+
+	void RLECompress(const uint8_t* data, size_t size, std::vector<uint8_t>& result)
+	{
+		result.clear();
+		size_t i = 0;
+		while (i < size)
+		{
+			const uint8_t value = data[i];
+			size_t run = 1;
+			while (i + run < size && data[i + run] == value)
+				run++;
+
+			result.push_back(value);
+			size_t length = run;
+			while (length >= 0x80)
+			{
+				result.push_back(static_cast<uint8_t>(length | 0x80));
+				length >>= 7;
+			}
+			result.push_back(static_cast<uint8_t>(length));
+			i += run;
+		}
+	}
+
+	bool RLEDecompress(const uint8_t* data, size_t size, uint8_t* result, size_t resultSize)
+	{
+		size_t read = 0;
+		size_t written = 0;
+		while (read < size)
+		{
+			const uint8_t value = data[read++];
+			size_t length = 0;
+			uint32_t shift = 0;
+			while (true)
+			{
+				if (read >= size || shift > 56)
+					return false;
+
+				const uint8_t byte = data[read++];
+				length |= static_cast<size_t>(byte & 0x7f) << shift;
+				shift += 7;
+				if (!(byte & 0x80))
+					break;
+			}
+			if (length > resultSize - written)
+				return false;
+
+			memset(result + written, value, length);
+			written += length;
+		}
+		return written == resultSize;
+	}
+}
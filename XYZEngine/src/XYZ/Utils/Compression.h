@@ -0,0 +1,14 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include <vector>
+
+namespace XYZ::Utils {
+
+	// Run length encoding, every run is stored as value byte followed by run length in 7 bit variable length encoding.
+	// Suited for voxel data with long uniform runs
+	XYZ_API void RLECompress(const uint8_t* data, size_t size, std::vector<uint8_t>& result);
+
+	// Returns false if data are corrupted or do not decompress to exactly resultSize bytes
+	XYZ_API bool RLEDecompress(const uint8_t* data, size_t size, uint8_t* result, size_t resultSize);
+}
@@ -2,6 +2,7 @@
 #include "DynamicTree.h"
 
 #include "XYZ/Renderer/Renderer2D.h"
+#include "XYZ/Debug/Profiler.h"
 
 
 
@@ -10,70 +11,127 @@
 
 
 namespace XYZ {
+
+	static constexpr uint32_t sc_NumSAHBins = 16;
+
+	static glm::vec3 InverseDirection(const glm::vec3& direction)
+	{
+		return { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+	}
+
+	static bool RayBoxDistance(const glm::vec3& origin, const glm::vec3& invDirection, const AABB& box, float& distance)
+	{
+		const glm::vec3 t1 = (box.Min - origin) * invDirection;
+		const glm::vec3 t2 = (box.Max - origin) * invDirection;
+		const glm::vec3 tMin = glm::min(t1, t2);
+		const glm::vec3 tMax = glm::max(t1, t2);
+
+		const float nearT = std::max(std::max(tMin.x, tMin.y), tMin.z);
+		const float farT = std::min(std::min(tMax.x, tMax.y), tMax.z);
+		if (farT < 0.0f || nearT > farT)
+			return false;
+
+		distance = std::max(nearT, 0.0f);
+		return true;
+	}
+
+	static float HalfSurfaceArea(const AABB& box)
+	{
+		const glm::vec3 size = box.Max - box.Min;
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
 	bool DynamicTree::RayCast(const Ray& ray, uint32_t& result)
 	{
-		std::stack<int32_t> stack;
-		stack.push(m_RootIndex);
-		while (!stack.empty())
+		if (m_RootIndex == NULL_NODE)
+			return false;
+
+		int32_t stack[sc_StackSize];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = m_RootIndex;
+		while (stackSize != 0)
 		{
-			const int32_t index = stack.top();
-			stack.pop();
+			const Node& node = m_Nodes[stack[--stackSize]];
 			float distance = 0.0f;
-			if (!ray.IntersectsAABB(m_Nodes[index].Box, distance))
-			{
+			if (!ray.IntersectsAABB(node.Box, distance))
 				continue;
-			}
-			if (m_Nodes[index].IsLeaf())
-			{
-				const uint32_t objectIndex = m_Nodes[index].DataIndex;
-				if (ray.IntersectsAABB(m_Nodes[index].Box, distance))
-				{
-					result = objectIndex;
-					return true;
-				}
-			}
-			else
+
+			if (node.IsLeaf())
 			{
-				stack.push(m_Nodes[index].FirstChild);
-				stack.push(m_Nodes[index].SecondChild);
+				result = node.DataIndex;
+				return true;
 			}
+			XYZ_ASSERT(stackSize + 2 <= sc_StackSize, "DynamicTree is too deep");
+			stack[stackSize++] = node.FirstChild;
+			stack[stackSize++] = node.SecondChild;
 		}
 		return false;
 	}
-	void DynamicTree::Query(const CollisionCallback& callback,const AABB& aabb)
+
+	void DynamicTree::RayCastAll(const Ray& ray, std::vector<RayHit>& hits) const
 	{
-		std::stack<int32_t> stack;
-		stack.push(m_RootIndex);
-		while (!stack.empty())
+		hits.clear();
+		if (m_RootIndex == NULL_NODE)
+			return;
+
+		const glm::vec3 invDirection = InverseDirection(ray.Direction);
+		int32_t stack[sc_StackSize];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = m_RootIndex;
+		while (stackSize != 0)
 		{
-			const int32_t index = stack.top();
-			stack.pop();
-			if (index == NULL_NODE)
+			const Node& node = m_Nodes[stack[--stackSize]];
+			float distance;
+			if (!RayBoxDistance(ray.Origin, invDirection, node.Box, distance))
 				continue;
 
-			const Node& node = m_Nodes[index];
-			if (node.Box.Intersect(aabb))
+			if (node.IsLeaf())
 			{
-				if (node.IsLeaf())
-				{
-					const bool proceed = callback(index);
-					if (proceed)
-						return;
-				}
-				else
-				{
-					stack.push(node.FirstChild);
-					stack.push(node.SecondChild);
-				}
+				hits.push_back({ node.DataIndex, distance });
+				continue;
 			}
+			XYZ_ASSERT(stackSize + 2 <= sc_StackSize, "DynamicTree is too deep");
+			stack[stackSize++] = node.FirstChild;
+			stack[stackSize++] = node.SecondChild;
 		}
+		std::sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b) {
+			return a.Distance < b.Distance;
+		});
+	}
+
+	void DynamicTree::Rebuild()
+	{
+		XYZ_PROFILE_FUNC("DynamicTree::Rebuild");
+		std::vector<int32_t> leaves;
+		std::vector<int32_t> internalNodes;
+		m_Nodes.ForEach([&](int32_t index, const Node& node) {
+			if (node.IsLeaf())
+				leaves.push_back(index);
+			else
+				internalNodes.push_back(index);
+		});
+		for (const int32_t index : internalNodes)
+			m_Nodes.Erase(index);
+
+		if (leaves.empty())
+		{
+			m_RootIndex = NULL_NODE;
+			return;
+		}
+		m_RootIndex = buildRange(leaves.data(), static_cast<uint32_t>(leaves.size()), 0);
+		m_Nodes[m_RootIndex].ParentIndex = NULL_NODE;
+
+		// Internal nodes can get indices past the range of moved nodes
+		if (m_MovedNodes.size() < m_Nodes.Range())
+			m_MovedNodes.resize(m_Nodes.Range(), 0);
 	}
+
 	int32_t DynamicTree::Insert(uint32_t objectIndex, const AABB& box)
 	{
 		const int32_t leaf = m_Nodes.Insert({ box , objectIndex });
 		
 		if (m_MovedNodes.size() < m_Nodes.Range())
-			m_MovedNodes.resize(m_Nodes.Range());
+			m_MovedNodes.resize(m_Nodes.Range(), 0);
 		insertLeaf(leaf);
 		return leaf;
 	}
@@ -86,7 +144,7 @@ namespace XYZ {
 		m_Nodes[index].Box.Max.x += displacement.x;
 		m_Nodes[index].Box.Max.y += displacement.y;
 
-		m_MovedNodes[index] = true;
+		m_MovedNodes[index] = 1;
 		insertLeaf(index);
 	}
 	void DynamicTree::Remove(int32_t index)
@@ -97,37 +155,19 @@ namespace XYZ {
 
 	void DynamicTree::SubmitToRenderer(Ref<Renderer2D> renderer2D)
 	{
-		std::stack<int32_t> stack;
-		if (m_RootIndex != NULL_NODE)
-			stack.push(m_RootIndex);
-		while (!stack.empty())
-		{
-			const int32_t index = stack.top();
-			stack.pop();
-
-			const AABB box = m_Nodes[index].Box;
+		m_Nodes.ForEach([&](int32_t index, const Node& node) {
+			const AABB& box = node.Box;
 
 			renderer2D->SubmitLine(glm::vec3(box.Min.x, box.Min.y, box.Max.z), glm::vec3(box.Max.x, box.Min.y, box.Max.z));
 			renderer2D->SubmitLine(glm::vec3(box.Max.x, box.Min.y, box.Max.z), glm::vec3(box.Max.x, box.Max.y, box.Max.z));
 			renderer2D->SubmitLine(glm::vec3(box.Max.x, box.Max.y, box.Max.z), glm::vec3(box.Min.x, box.Max.y, box.Max.z));
 			renderer2D->SubmitLine(glm::vec3(box.Min.x, box.Max.y, box.Max.z), glm::vec3(box.Min.x, box.Min.y, box.Max.z));
-
-			if (m_Nodes[index].IsLeaf())
-			{
-				
-			}
-			else
-			{
-				stack.push(m_Nodes[index].FirstChild);
-				stack.push(m_Nodes[index].SecondChild);
-			}
-		}
+		});
 	}
 
 	void DynamicTree::CleanMovedNodes()
 	{
-		for (auto& node : m_MovedNodes)
-			node = false;
+		std::fill(m_MovedNodes.begin(), m_MovedNodes.end(), 0);
 	}
 
 	void DynamicTree::insertLeaf(int32_t leaf)
@@ -301,6 +341,105 @@ namespace XYZ {
 		}
 	}
 
+	int32_t DynamicTree::buildRange(int32_t* leaves, uint32_t count, uint32_t depth)
+	{
+		if (count == 1)
+			return leaves[0];
+
+		AABB centerBounds(m_Nodes[leaves[0]].Box.GetCenter(), m_Nodes[leaves[0]].Box.GetCenter());
+		for (uint32_t i = 1; i < count; ++i)
+		{
+			const glm::vec3 center = m_Nodes[leaves[i]].Box.GetCenter();
+			centerBounds.Min = glm::min(centerBounds.Min, center);
+			centerBounds.Max = glm::max(centerBounds.Max, center);
+		}
+		const glm::vec3 extent = centerBounds.Max - centerBounds.Min;
+		const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+		uint32_t split = 0;
+		if (extent[axis] > 0.0f && depth < sc_MaxSAHDepth)
+		{
+			struct Bin
+			{
+				AABB	 Box;
+				uint32_t Count = 0;
+			};
+			Bin bins[sc_NumSAHBins];
+			const float scale = sc_NumSAHBins / extent[axis];
+			auto binIndex = [&](int32_t leaf) {
+				const float offset = m_Nodes[leaf].Box.GetCenter()[axis] - centerBounds.Min[axis];
+				return std::min(static_cast<uint32_t>(offset * scale), sc_NumSAHBins - 1);
+			};
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Bin& bin = bins[binIndex(leaves[i])];
+				bin.Box = bin.Count == 0 ? m_Nodes[leaves[i]].Box : AABB::Union(bin.Box, m_Nodes[leaves[i]].Box);
+				bin.Count++;
+			}
+
+			// Sweep from the right to get cost of every right side, then from the left
+			float rightCost[sc_NumSAHBins];
+			AABB rightBox;
+			uint32_t rightCount = 0;
+			for (uint32_t i = sc_NumSAHBins - 1; i > 0; --i)
+			{
+				if (bins[i].Count != 0)
+				{
+					rightBox = rightCount == 0 ? bins[i].Box : AABB::Union(rightBox, bins[i].Box);
+					rightCount += bins[i].Count;
+				}
+				rightCost[i] = rightCount == 0 ? 0.0f : rightCount * HalfSurfaceArea(rightBox);
+			}
+
+			float bestCost = FLT_MAX;
+			uint32_t bestBin = 0;
+			AABB leftBox;
+			uint32_t leftCount = 0;
+			for (uint32_t i = 0; i < sc_NumSAHBins - 1; ++i)
+			{
+				if (bins[i].Count != 0)
+				{
+					leftBox = leftCount == 0 ? bins[i].Box : AABB::Union(leftBox, bins[i].Box);
+					leftCount += bins[i].Count;
+				}
+				if (leftCount == 0 || leftCount == count)
+					continue;
+
+				const float cost = leftCount * HalfSurfaceArea(leftBox) + rightCost[i + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestBin = i;
+				}
+			}
+			if (bestCost != FLT_MAX)
+			{
+				int32_t* middle = std::partition(leaves, leaves + count, [&](int32_t leaf) {
+					return binIndex(leaf) <= bestBin;
+				});
+				split = static_cast<uint32_t>(middle - leaves);
+			}
+		}
+
+		if (split == 0 || split == count)
+		{
+			split = count / 2;
+			std::nth_element(leaves, leaves + split, leaves + count, [&](int32_t a, int32_t b) {
+				return m_Nodes[a].Box.GetCenter()[axis] < m_Nodes[b].Box.GetCenter()[axis];
+			});
+		}
+
+		const int32_t first = buildRange(leaves, split, depth + 1);
+		const int32_t second = buildRange(leaves + split, count - split, depth + 1);
+		const int32_t parent = m_Nodes.Insert({ AABB::Union(m_Nodes[first].Box, m_Nodes[second].Box), 0 });
+		m_Nodes[parent].FirstChild = first;
+		m_Nodes[parent].SecondChild = second;
+		m_Nodes[parent].Height = 1 + std::max(m_Nodes[first].Height, m_Nodes[second].Height);
+		m_Nodes[first].ParentIndex = parent;
+		m_Nodes[second].ParentIndex = parent;
+		return parent;
+	}
+
 	int32_t DynamicTree::balance(int32_t iA)
 	{
 		Node* A = &m_Nodes[iA];
@@ -1,12 +1,10 @@
 #pragma once
 #include "XYZ/Utils/Math/AABB.h"
 #include "XYZ/Utils/Math/Ray.h"
-#include "XYZ/Utils/DataStructures/FreeList.h"
+#include "XYZ/Utils/DataStructures/PackedFreeList.h"
 
 #include "XYZ/Renderer/Renderer2D.h"
 
-#include <stack>
-
 namespace XYZ {
 
 #define NULL_NODE (-1)
@@ -27,9 +25,28 @@ namespace XYZ {
 
 	class XYZ_API DynamicTree
 	{
+	public:
+		static constexpr uint32_t sc_NoHit = UINT32_MAX;
+
+		struct RayHit
+		{
+			uint32_t DataIndex = sc_NoHit;
+			float	 Distance = FLT_MAX;
+		};
+
 	public:
 		bool RayCast(const Ray& ray, uint32_t& result);
-		void Query(const CollisionCallback& callback, const AABB& aabb);
+
+		// Callback returns true to stop the query
+		template <typename F>
+		void Query(F&& callback, const AABB& aabb) const;
+
+		// Every leaf box hit by the ray, sorted by distance
+		void RayCastAll(const Ray& ray, std::vector<RayHit>& hits) const;
+
+		// Rebuilds internal nodes top down with binned SAH, leaf indices stay valid.
+		// Gives better tree than incremental insertion for large static sets
+		void Rebuild();
 
 		int32_t Insert(uint32_t objectIndex, const AABB& box);
 		void Move(int32_t index, const glm::vec2& displacement);
@@ -37,21 +54,57 @@ namespace XYZ {
 
 		uint32_t GetDataIndex(int32_t index) const { return m_Nodes[index].DataIndex; }
 		const AABB& GetAABB(int32_t index) const { return m_Nodes[index].Box; }
+		int32_t GetHeight() const { return m_RootIndex == NULL_NODE ? 0 : m_Nodes[m_RootIndex].Height; }
 		// Debug
 		void SubmitToRenderer(Ref<Renderer2D> renderer2D);
 
 		void CleanMovedNodes();
-		const std::vector<bool>& GetMovedNodes() const { return m_MovedNodes; }
+		const std::vector<uint8_t>& GetMovedNodes() const { return m_MovedNodes; }
 
 	private:
 		void insertLeaf(int32_t index);
 		void removeLeaf(int32_t leaf);
 		int32_t balance(int32_t index);
 
+		int32_t buildRange(int32_t* leaves, uint32_t count, uint32_t depth);
+
 	private:
-		FreeList<Node> m_Nodes;
+		// Rebuild switches to median split at this depth, so traversal stack can not overflow
+		static constexpr uint32_t sc_MaxSAHDepth = 48;
+		static constexpr uint32_t sc_StackSize = 128;
+
+		PackedFreeList<Node> m_Nodes;
 
-		std::vector<bool> m_MovedNodes;
+		std::vector<uint8_t> m_MovedNodes;
 		int32_t m_RootIndex = NULL_NODE;
 	};
+
+	template <typename F>
+	inline void DynamicTree::Query(F&& callback, const AABB& aabb) const
+	{
+		if (m_RootIndex == NULL_NODE)
+			return;
+
+		int32_t stack[sc_StackSize];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = m_RootIndex;
+		while (stackSize != 0)
+		{
+			const Node& node = m_Nodes[stack[--stackSize]];
+			if (!node.Box.Intersect(aabb))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				if (callback(stack[stackSize]))
+					return;
+			}
+			else
+			{
+				XYZ_ASSERT(stackSize + 2 <= sc_StackSize, "DynamicTree is too deep");
+				stack[stackSize++] = node.FirstChild;
+				stack[stackSize++] = node.SecondChild;
+			}
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "stdafx.h"
+#include "FrameAllocator.h"
+
+#include "XYZ/Debug/Profiler.h"
+
+#include <mutex>
+
+namespace XYZ {
+
+	static uint8_t* AlignUp(uint8_t* ptr, size_t alignment)
+	{
+		const uintptr_t value = reinterpret_cast<uintptr_t>(ptr);
+		return reinterpret_cast<uint8_t*>((value + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+	}
+
+	LinearArena::LinearArena(size_t blockSize)
+		:
+		m_Blocks(nullptr),
+		m_Current(nullptr),
+		m_End(nullptr),
+		m_BlockSize(blockSize),
+		m_Used(0),
+		m_Capacity(0),
+		m_HighWaterMark(0),
+		m_BlockAllocations(0)
+	{
+	}
+
+	LinearArena::~LinearArena()
+	{
+		releaseBlocks();
+	}
+
+	void* LinearArena::Allocate(size_t size, size_t alignment)
+	{
+		uint8_t* result = AlignUp(m_Current, alignment);
+		if (m_Current == nullptr || result + size > m_End)
+		{
+			addBlock(size + alignment);
+			result = AlignUp(m_Current, alignment);
+		}
+		m_Used += static_cast<size_t>(result + size - m_Current);
+		m_Current = result + size;
+		m_HighWaterMark = std::max(m_HighWaterMark, m_Used);
+		return result;
+	}
+
+	void LinearArena::Free(void* ptr, size_t size)
+	{
+		uint8_t* data = static_cast<uint8_t*>(ptr);
+		if (data + size == m_Current)
+		{
+			m_Used -= size;
+			m_Current = data;
+		}
+	}
+
+	void LinearArena::Reset()
+	{
+		m_BlockAllocations = 0;
+		if (m_Blocks && m_Blocks->Next)
+		{
+			const size_t size = std::max(m_HighWaterMark, m_BlockSize);
+			releaseBlocks();
+			addBlock(size);
+		}
+		else if (m_Blocks)
+		{
+			m_Current = blockData(m_Blocks);
+		}
+		m_Used = 0;
+		m_HighWaterMark = 0;
+	}
+
+	void LinearArena::addBlock(size_t minSize)
+	{
+		const size_t size = std::max(m_BlockSize, minSize);
+		Block* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+		block->Next = m_Blocks;
+		block->Size = size;
+		m_Blocks = block;
+		m_Current = blockData(block);
+		m_End = m_Current + size;
+		m_Capacity += size;
+		m_BlockAllocations++;
+	}
+
+	void LinearArena::releaseBlocks()
+	{
+		while (m_Blocks)
+		{
+			Block* next = m_Blocks->Next;
+			::operator delete(m_Blocks);
+			m_Blocks = next;
+		}
+		m_Current = nullptr;
+		m_End = nullptr;
+		m_Capacity = 0;
+	}
+
+
+	static std::mutex			s_ThreadSlotMutex;
+	static std::vector<uint32_t> s_FreeThreadSlots;
+	static uint32_t				s_NextThreadSlot = 0;
+
+	// Arena slot of a thread, returned when the thread exits so short lived threads do not use up slots.
+	// Memory allocated by the exited thread stays valid until its frame is reset
+	struct ThreadSlot
+	{
+		ThreadSlot()
+		{
+			std::scoped_lock lock(s_ThreadSlotMutex);
+			if (!s_FreeThreadSlots.empty())
+			{
+				Index = s_FreeThreadSlots.back();
+				s_FreeThreadSlots.pop_back();
+			}
+			else
+			{
+				Index = s_NextThreadSlot++;
+			}
+		}
+		~ThreadSlot()
+		{
+			std::scoped_lock lock(s_ThreadSlotMutex);
+			s_FreeThreadSlots.push_back(Index);
+		}
+
+		uint32_t Index;
+	};
+
+	static uint32_t GetThreadIndex()
+	{
+		thread_local const ThreadSlot slot;
+		XYZ_ASSERT(slot.Index < FrameAllocator::sc_MaxThreads, "Too many threads allocate frame memory at once");
+		return slot.Index;
+	}
+
+	FrameAllocator::FrameAllocator()
+		:
+		m_FramesInFlight(0),
+		m_CurrentFrame(0),
+		m_PeakHighWaterMark(0)
+	{
+	}
+
+	FrameAllocator::~FrameAllocator()
+	{
+		Shutdown();
+	}
+
+	void FrameAllocator::Init(uint32_t framesInFlight, size_t blockSize)
+	{
+		m_FramesInFlight = std::max(framesInFlight, 1u);
+		m_CurrentFrame = 0;
+		m_Arenas = std::make_unique<LinearArena[]>(static_cast<size_t>(m_FramesInFlight) * sc_MaxThreads);
+		for (size_t i = 0; i < static_cast<size_t>(m_FramesInFlight) * sc_MaxThreads; ++i)
+			m_Arenas[i].SetBlockSize(blockSize);
+
+		m_LastFrameStats = {};
+		m_PeakHighWaterMark = 0;
+	}
+
+	void FrameAllocator::Shutdown()
+	{
+		m_Arenas.reset();
+		m_FramesInFlight = 0;
+		m_CurrentFrame = 0;
+	}
+
+	void FrameAllocator::BeginFrame()
+	{
+		XYZ_PROFILE_FUNC("FrameAllocator::BeginFrame");
+		if (m_FramesInFlight == 0)
+			return;
+
+		m_LastFrameStats = collectStats(m_CurrentFrame);
+		m_PeakHighWaterMark = std::max(m_PeakHighWaterMark, m_LastFrameStats.HighWaterMark);
+
+		m_CurrentFrame = (m_CurrentFrame + 1) % m_FramesInFlight;
+		LinearArena* arenas = &m_Arenas[static_cast<size_t>(m_CurrentFrame) * sc_MaxThreads];
+		for (uint32_t i = 0; i < sc_MaxThreads; ++i)
+			arenas[i].Reset();
+	}
+
+	void* FrameAllocator::Allocate(size_t size, size_t alignment)
+	{
+		XYZ_ASSERT(m_FramesInFlight != 0, "Frame allocator is not initialized");
+		return getThreadArena().Allocate(size, alignment);
+	}
+
+	void FrameAllocator::Free(void* ptr, size_t size)
+	{
+		// Only the last allocation of the calling thread in current frame is given back
+		if (m_FramesInFlight != 0)
+			getThreadArena().Free(ptr, size);
+	}
+
+	LinearArena& FrameAllocator::getThreadArena()
+	{
+		return m_Arenas[static_cast<size_t>(m_CurrentFrame) * sc_MaxThreads + GetThreadIndex()];
+	}
+
+	FrameAllocator::Stats FrameAllocator::collectStats(uint32_t frame) const
+	{
+		Stats stats;
+		const LinearArena* arenas = &m_Arenas[static_cast<size_t>(frame) * sc_MaxThreads];
+		for (uint32_t i = 0; i < sc_MaxThreads; ++i)
+		{
+			const LinearArena& arena = arenas[i];
+			stats.Used += arena.GetUsed();
+			stats.HighWaterMark += arena.GetHighWaterMark();
+			stats.Capacity += arena.GetCapacity();
+			stats.BlockAllocations += arena.GetBlockAllocations();
+			if (arena.GetHighWaterMark() != 0)
+				stats.ThreadCount++;
+		}
+		return stats;
+	}
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+namespace XYZ {
+
+	// Bump allocator over chained blocks. Free only rolls back the last allocation,
+	// Reset releases everything and merges blocks into single one sized to the high water mark
+	class XYZ_API LinearArena
+	{
+	public:
+		static constexpr size_t sc_DefaultBlockSize = 64 * 1024;
+
+	public:
+		LinearArena(size_t blockSize = sc_DefaultBlockSize);
+		LinearArena(const LinearArena& other) = delete;
+		~LinearArena();
+
+		LinearArena& operator=(const LinearArena& other) = delete;
+
+		void* Allocate(size_t size, size_t alignment);
+		void  Free(void* ptr, size_t size);
+		void  Reset();
+
+		void SetBlockSize(size_t blockSize) { m_BlockSize = blockSize; }
+
+		size_t	 GetUsed()			  const { return m_Used; }
+		size_t	 GetCapacity()		  const { return m_Capacity; }
+		size_t	 GetHighWaterMark()	  const { return m_HighWaterMark; }
+		uint32_t GetBlockAllocations() const { return m_BlockAllocations; } // Since last reset
+
+	private:
+		struct Block
+		{
+			Block* Next;
+			size_t Size;
+		};
+
+		void  addBlock(size_t minSize);
+		void  releaseBlocks();
+
+		static uint8_t* blockData(Block* block) { return reinterpret_cast<uint8_t*>(block + 1); }
+
+	private:
+		Block*	 m_Blocks;
+		uint8_t* m_Current;
+		uint8_t* m_End;
+
+		size_t	 m_BlockSize;
+		size_t	 m_Used;
+		size_t	 m_Capacity;
+		size_t	 m_HighWaterMark;
+		uint32_t m_BlockAllocations;
+	};
+
+	// Ring of linear arenas, one per frame in flight. Every thread allocates from its own arena of current frame,
+	// so allocations are pointer bumps without locking. Memory stays valid until the frame slot is reused,
+	// BeginFrame must not run concurrently with allocations
+	class XYZ_API FrameAllocator
+	{
+	public:
+		static constexpr uint32_t sc_MaxThreads = 128;
+
+		struct Stats
+		{
+			size_t	 Used = 0;
+			size_t	 HighWaterMark = 0; // Sum of per thread peaks
+			size_t	 Capacity = 0;
+			uint32_t BlockAllocations = 0;
+			uint32_t ThreadCount = 0;
+		};
+
+	public:
+		FrameAllocator();
+		FrameAllocator(const FrameAllocator& other) = delete;
+		~FrameAllocator();
+
+		FrameAllocator& operator=(const FrameAllocator& other) = delete;
+
+		void Init(uint32_t framesInFlight, size_t blockSize = LinearArena::sc_DefaultBlockSize);
+		void Shutdown();
+
+		void BeginFrame();
+
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+		void  Free(void* ptr, size_t size);
+
+		template <typename T>
+		T* Allocate(size_t count) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+		// Stats of the frame finished by the last BeginFrame
+		const Stats& GetLastFrameStats() const { return m_LastFrameStats; }
+		size_t		 GetPeakHighWaterMark() const { return m_PeakHighWaterMark; }
+		uint32_t	 GetFramesInFlight() const { return m_FramesInFlight; }
+
+	private:
+		LinearArena& getThreadArena();
+		Stats		 collectStats(uint32_t frame) const;
+
+	private:
+		std::unique_ptr<LinearArena[]> m_Arenas; // FramesInFlight * sc_MaxThreads
+		uint32_t m_FramesInFlight;
+		uint32_t m_CurrentFrame;
+
+		Stats	 m_LastFrameStats;
+		size_t	 m_PeakHighWaterMark;
+	};
+
+	// STL allocator over FrameAllocator, default constructed adapter falls back to the heap
+	template <typename T>
+	class FrameAllocatorAdapter
+	{
+	public:
+		using value_type = T;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+		using is_always_equal = std::false_type;
+
+		FrameAllocatorAdapter() noexcept = default;
+		FrameAllocatorAdapter(FrameAllocator* allocator) noexcept
+			: m_Allocator(allocator)
+		{}
+		template <typename U>
+		FrameAllocatorAdapter(const FrameAllocatorAdapter<U>& other) noexcept
+			: m_Allocator(other.m_Allocator)
+		{}
+
+		T* allocate(size_t count)
+		{
+			if (m_Allocator)
+				return m_Allocator->Allocate<T>(count);
+			return std::allocator<T>().allocate(count);
+		}
+
+		void deallocate(T* ptr, size_t count)
+		{
+			if (m_Allocator)
+				m_Allocator->Free(ptr, count * sizeof(T));
+			else
+				std::allocator<T>().deallocate(ptr, count);
+		}
+
+		FrameAllocator* GetAllocator() const { return m_Allocator; }
+
+		template <typename U>
+		bool operator==(const FrameAllocatorAdapter<U>& other) const { return m_Allocator == other.m_Allocator; }
+		template <typename U>
+		bool operator!=(const FrameAllocatorAdapter<U>& other) const { return m_Allocator != other.m_Allocator; }
+
+	private:
+		FrameAllocator* m_Allocator = nullptr;
+
+		template <typename U>
+		friend class FrameAllocatorAdapter;
+	};
+
+	template <typename T>
+	using FrameVector = std::vector<T, FrameAllocatorAdapter<T>>;
+
+	template <typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>>
+	using FrameUnorderedMap = std::unordered_map<K, V, Hash, Equal, FrameAllocatorAdapter<std::pair<const K, V>>>;
+}
@@ -25,7 +25,7 @@ namespace XYZ {
 		FreeListIterator<T>& operator=(const FreeListIterator<T>&rawIterator) = default;
 		FreeListIterator<T>& operator=(T * ptr) { m_ptr = ptr; return (*this); }
 
-		operator bool() const {return m_ptr != null; }
+		operator bool() const {return m_ptr != nullptr; }
 
 		bool                 operator==(const FreeListIterator<T>&rawIterator) const { return (m_ptr == rawIterator.getConstPtr()); }
 		bool                 operator!=(const FreeListIterator<T>&rawIterator) const { return (m_ptr != rawIterator.getConstPtr()); }
@@ -0,0 +1,110 @@
+#include "stdafx.h"
+#include "HashIndex.h"
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_MinCapacity = 16;
+
+	static uint32_t NextPowerOfTwo(uint32_t value)
+	{
+		uint32_t result = sc_MinCapacity;
+		while (result < value)
+			result <<= 1;
+		return result;
+	}
+
+	HashIndex::HashIndex(uint32_t capacity)
+		:
+		m_Size(0)
+	{
+		if (capacity != 0)
+			Reserve(capacity);
+	}
+
+	void HashIndex::Insert(size_t hash, uint32_t value)
+	{
+		XYZ_ASSERT(value != sc_InvalidValue, "Invalid value can not be inserted");
+		// Keep load factor under 0.75
+		if ((m_Size + 1) * 4 > Capacity() * 3)
+			rehash(NextPowerOfTwo((m_Size + 1) * 2));
+
+		const size_t mask = m_Slots.size() - 1;
+		size_t i = slotIndex(hash);
+		while (m_Slots[i].Value != sc_InvalidValue)
+			i = (i + 1) & mask;
+
+		m_Slots[i].Hash = hash;
+		m_Slots[i].Value = value;
+		m_Size++;
+	}
+
+	bool HashIndex::Erase(size_t hash, uint32_t value)
+	{
+		if (m_Size == 0)
+			return false;
+
+		const size_t mask = m_Slots.size() - 1;
+		size_t hole = slotIndex(hash);
+		while (m_Slots[hole].Value != sc_InvalidValue)
+		{
+			if (m_Slots[hole].Hash == hash && m_Slots[hole].Value == value)
+				break;
+			hole = (hole + 1) & mask;
+		}
+		if (m_Slots[hole].Value == sc_InvalidValue)
+			return false;
+
+		// Backward shift deletion, no tombstones are needed
+		size_t next = (hole + 1) & mask;
+		while (m_Slots[next].Value != sc_InvalidValue)
+		{
+			const size_t ideal = slotIndex(m_Slots[next].Hash);
+			// Move the slot to the hole if its ideal position is not in cyclic range (hole, next]
+			const bool inRange = hole <= next
+				? (ideal > hole && ideal <= next)
+				: (ideal > hole || ideal <= next);
+			if (!inRange)
+			{
+				m_Slots[hole] = m_Slots[next];
+				hole = next;
+			}
+			next = (next + 1) & mask;
+		}
+		m_Slots[hole] = Slot();
+		m_Size--;
+		return true;
+	}
+
+	void HashIndex::Reserve(uint32_t count)
+	{
+		const uint32_t capacity = NextPowerOfTwo(count + count / 3 + 1);
+		if (capacity > Capacity())
+			rehash(capacity);
+	}
+
+	void HashIndex::Clear()
+	{
+		// Capacity is kept, index can be refilled every frame without allocations
+		std::fill(m_Slots.begin(), m_Slots.end(), Slot());
+		m_Size = 0;
+	}
+
+	void HashIndex::rehash(uint32_t capacity)
+	{
+		std::vector<Slot> oldSlots = std::move(m_Slots);
+		m_Slots.clear();
+		m_Slots.resize(capacity);
+
+		const size_t mask = m_Slots.size() - 1;
+		for (const Slot& slot : oldSlots)
+		{
+			if (slot.Value == sc_InvalidValue)
+				continue;
+
+			size_t i = slotIndex(slot.Hash);
+			while (m_Slots[i].Value != sc_InvalidValue)
+				i = (i + 1) & mask;
+			m_Slots[i] = slot;
+		}
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include <vector>
+
+namespace XYZ {
+
+	// Open addressing (linear probing) multi index from hash to uint32_t value.
+	// Keys are not stored, callers resolve hash collisions by comparing their own data in the predicate
+	class XYZ_API HashIndex
+	{
+	public:
+		static constexpr uint32_t sc_InvalidValue = UINT32_MAX;
+
+	public:
+		HashIndex(uint32_t capacity = 0);
+
+		void Insert(size_t hash, uint32_t value);
+		bool Erase(size_t hash, uint32_t value);
+		void Reserve(uint32_t count);
+		void Clear();
+
+		// Returns first value with matching hash for which pred(value) returns true
+		template <typename Pred>
+		uint32_t Find(size_t hash, Pred&& pred) const;
+
+		// Calls func(value) for every value with matching hash
+		template <typename Func>
+		void ForEach(size_t hash, Func&& func) const;
+
+		uint32_t Size()		const { return m_Size; }
+		uint32_t Capacity() const { return static_cast<uint32_t>(m_Slots.size()); }
+
+	private:
+		void rehash(uint32_t capacity);
+
+		size_t slotIndex(size_t hash) const { return hash & (m_Slots.size() - 1); }
+
+	private:
+		struct Slot
+		{
+			size_t	 Hash  = 0;
+			uint32_t Value = sc_InvalidValue;
+		};
+
+		std::vector<Slot> m_Slots;
+		uint32_t		  m_Size;
+	};
+
+	template<typename Pred>
+	inline uint32_t HashIndex::Find(size_t hash, Pred&& pred) const
+	{
+		if (m_Size == 0)
+			return sc_InvalidValue;
+
+		const size_t mask = m_Slots.size() - 1;
+		for (size_t i = slotIndex(hash); m_Slots[i].Value != sc_InvalidValue; i = (i + 1) & mask)
+		{
+			const Slot& slot = m_Slots[i];
+			if (slot.Hash == hash && pred(slot.Value))
+				return slot.Value;
+		}
+		return sc_InvalidValue;
+	}
+
+	template<typename Func>
+	inline void HashIndex::ForEach(size_t hash, Func&& func) const
+	{
+		if (m_Size == 0)
+			return;
+
+		const size_t mask = m_Slots.size() - 1;
+		for (size_t i = slotIndex(hash); m_Slots[i].Value != sc_InvalidValue; i = (i + 1) & mask)
+		{
+			const Slot& slot = m_Slots[i];
+			if (slot.Hash == hash)
+				func(slot.Value);
+		}
+	}
+}
@@ -0,0 +1,184 @@
+#include "stdafx.h"
+#include "LinearOctree.h"
+
+#include "XYZ/Core/ThreadPool.h"
+#include "XYZ/Debug/Profiler.h"
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_DepthBits = 4;
+	static constexpr uint32_t sc_KeyBatchSize = 4096;
+
+	// Spreads lower 10 bits so there are two zero bits between each bit
+	static uint32_t ExpandBits(uint32_t value)
+	{
+		value &= 0x000003ff;
+		value = (value ^ (value << 16)) & 0xff0000ff;
+		value = (value ^ (value << 8))  & 0x0300f00f;
+		value = (value ^ (value << 4))  & 0x030c30c3;
+		value = (value ^ (value << 2))  & 0x09249249;
+		return value;
+	}
+
+	// X is the lowest bit, so lowest three bits of code match child order x + 2y + 4z
+	static uint32_t MortonCode(const glm::uvec3& cell)
+	{
+		return ExpandBits(cell.x) | (ExpandBits(cell.y) << 1) | (ExpandBits(cell.z) << 2);
+	}
+
+	LinearOctree::LinearOctree(const AABB& bounds, uint32_t maxDepth)
+		:
+		m_InitialBounds(bounds),
+		m_Bounds(bounds),
+		m_CellScale(0.0f),
+		m_MaxDepth(std::min(maxDepth, MaxDepth))
+	{
+	}
+
+	void LinearOctree::Build(const AABB* boxes, uint32_t count)
+	{
+		XYZ_PROFILE_FUNC("LinearOctree::Build");
+		prepareBuild(boxes, count);
+		computeKeys(boxes, 0, count);
+		m_Sorter.Sort(m_Keys.data(), m_Indices.data(), count, 3 * m_MaxDepth + sc_DepthBits);
+		emitNodes();
+	}
+
+	void LinearOctree::Build(const AABB* boxes, uint32_t count, ThreadPool& pool)
+	{
+		XYZ_PROFILE_FUNC("LinearOctree::Build");
+		prepareBuild(boxes, count);
+		pool.ParallelFor(count, sc_KeyBatchSize, [&](uint32_t begin, uint32_t end) {
+			computeKeys(boxes, begin, end);
+		});
+		m_Sorter.Sort(m_Keys.data(), m_Indices.data(), count, 3 * m_MaxDepth + sc_DepthBits, pool);
+		emitNodes();
+	}
+
+	void LinearOctree::Clear()
+	{
+		m_Nodes.clear();
+		m_Data.clear();
+		m_Keys.clear();
+		m_Indices.clear();
+		m_Bounds = m_InitialBounds;
+	}
+
+	void LinearOctree::prepareBuild(const AABB* boxes, uint32_t count)
+	{
+		m_Bounds = m_InitialBounds;
+		for (uint32_t i = 0; i < count; ++i)
+			m_Bounds = AABB::Union(m_Bounds, boxes[i]);
+
+		const glm::vec3 size = m_Bounds.Max - m_Bounds.Min;
+		const float resolution = static_cast<float>(1u << m_MaxDepth);
+		m_CellScale = glm::vec3(
+			size.x > 0.0f ? resolution / size.x : 0.0f,
+			size.y > 0.0f ? resolution / size.y : 0.0f,
+			size.z > 0.0f ? resolution / size.z : 0.0f
+		);
+		m_Keys.resize(count);
+		m_Indices.resize(count);
+	}
+
+	void LinearOctree::computeKeys(const AABB* boxes, uint32_t begin, uint32_t end)
+	{
+		const glm::vec3 maxCell(static_cast<float>((1u << m_MaxDepth) - 1));
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const glm::uvec3 minCell(glm::clamp((boxes[i].Min - m_Bounds.Min) * m_CellScale, glm::vec3(0.0f), maxCell));
+			const glm::uvec3 maxCellBox(glm::clamp((boxes[i].Max - m_Bounds.Min) * m_CellScale, glm::vec3(0.0f), maxCell));
+
+			// Box belongs to deepest level at which min and max cells are the same
+			uint32_t difference = (minCell.x ^ maxCellBox.x) | (minCell.y ^ maxCellBox.y) | (minCell.z ^ maxCellBox.z);
+			uint32_t shift = 0;
+			while (difference)
+			{
+				difference >>= 1;
+				shift++;
+			}
+			const uint32_t depth = m_MaxDepth - shift;
+			const glm::uvec3 nodeCell = (minCell >> shift) << shift;
+
+			// Parent has the same code as its first child and lower depth, so it is sorted before its descendants
+			m_Keys[i] = (static_cast<uint64_t>(MortonCode(nodeCell)) << sc_DepthBits) | depth;
+			m_Indices[i] = i;
+		}
+	}
+
+	void LinearOctree::emitNodes()
+	{
+		XYZ_PROFILE_FUNC("LinearOctree::emitNodes");
+		m_Nodes.clear();
+		m_Data.resize(m_Indices.size());
+
+		glm::vec3 levelSize[MaxDepth + 1];
+		levelSize[0] = m_Bounds.Max - m_Bounds.Min;
+		for (uint32_t level = 1; level <= m_MaxDepth; ++level)
+			levelSize[level] = levelSize[level - 1] * 0.5f;
+
+		int32_t  path[MaxDepth + 1];
+		uint32_t pathCode[MaxDepth + 1];
+		uint32_t pathDepth = 0;
+
+		auto& root = m_Nodes.emplace_back();
+		root.Min = glm::vec4(m_Bounds.Min, 1.0f);
+		root.Max = glm::vec4(m_Bounds.Max, 1.0f);
+		std::fill(std::begin(root.Children), std::end(root.Children), -1);
+		path[0] = 0;
+		pathCode[0] = 0;
+
+		int32_t dataCount = 0;
+		for (size_t i = 0; i < m_Keys.size(); ++i)
+		{
+			const uint32_t depth = static_cast<uint32_t>(m_Keys[i] & ((1 << sc_DepthBits) - 1));
+			const uint32_t code = static_cast<uint32_t>(m_Keys[i] >> sc_DepthBits);
+
+			// Keep the part of current path shared with this node
+			uint32_t level = 1;
+			while (level <= pathDepth && level <= depth && (code >> (3 * (m_MaxDepth - level))) == pathCode[level])
+				level++;
+
+			for (; level <= depth; ++level)
+			{
+				const uint32_t levelCode = code >> (3 * (m_MaxDepth - level));
+				const uint32_t childSlot = levelCode & 7;
+				const int32_t  nodeIndex = static_cast<int32_t>(m_Nodes.size());
+
+				LinearOctreeNode& node = m_Nodes.emplace_back();
+				LinearOctreeNode& parent = m_Nodes[path[level - 1]];
+				const glm::vec3 offset(childSlot & 1, (childSlot >> 1) & 1, (childSlot >> 2) & 1);
+				node.Min = glm::vec4(glm::vec3(parent.Min) + offset * levelSize[level], 1.0f);
+				node.Max = glm::vec4(glm::vec3(node.Min) + levelSize[level], 1.0f);
+				std::fill(std::begin(node.Children), std::end(node.Children), -1);
+
+				parent.IsLeaf = false;
+				parent.Children[childSlot] = nodeIndex;
+				path[level] = nodeIndex;
+				pathCode[level] = levelCode;
+			}
+			pathDepth = depth;
+
+			// Boxes with the same key are adjacent, radix sort is stable so they keep increasing order
+			LinearOctreeNode& node = m_Nodes[path[depth]];
+			if (node.DataStart == node.DataEnd)
+				node.DataStart = dataCount;
+			m_Data[dataCount++] = static_cast<int32_t>(m_Indices[i]);
+			node.DataEnd = dataCount;
+		}
+
+		const int32_t emptyLeaf = static_cast<int32_t>(m_Nodes.size());
+		for (auto& node : m_Nodes)
+		{
+			for (int32_t& child : node.Children)
+			{
+				if (child == -1)
+					child = emptyLeaf;
+			}
+		}
+		auto& leaf = m_Nodes.emplace_back();
+		leaf.Min = m_Nodes[0].Min;
+		leaf.Max = leaf.Min;
+		std::fill(std::begin(leaf.Children), std::end(leaf.Children), emptyLeaf);
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "XYZ/Utils/Math/AABB.h"
+#include "XYZ/Utils/Algorithms/RadixSort.h"
+
+#include <glm/glm.hpp>
+
+namespace XYZ {
+
+	class ThreadPool;
+
+	// Layout matches octree node in shaders, nodes can be copied directly to storage buffer
+	struct LinearOctreeNode
+	{
+		glm::vec4 Min;
+		glm::vec4 Max;
+
+		int32_t Children[8];
+
+		Bool32	IsLeaf = true;
+		int32_t DataStart = 0;
+		int32_t DataEnd = 0;
+
+		Padding<4> Padding;
+	};
+
+	// Octree rebuilt from scratch from list of boxes.
+	// Every box is stored in deepest node that fully contains it, boxes are sorted by morton code of their node,
+	// so nodes are emitted in depth first order into one contiguous array with root at index 0.
+	// Children of internal nodes that are not occupied point to shared empty leaf node at the end of the array
+	class XYZ_API LinearOctree
+	{
+	public:
+		static constexpr uint32_t MaxDepth = 10;
+
+		LinearOctree(const AABB& bounds, uint32_t maxDepth);
+
+		// Node data are indices to boxes, in increasing order within node
+		void Build(const AABB* boxes, uint32_t count);
+		void Build(const AABB* boxes, uint32_t count, ThreadPool& pool);
+
+		void Clear();
+
+		const std::vector<LinearOctreeNode>& GetNodes()  const { return m_Nodes; }
+		const std::vector<int32_t>&			 GetData()	 const { return m_Data; }
+		const AABB&							 GetBounds() const { return m_Bounds; }
+		uint32_t							 GetMaxDepth() const { return m_MaxDepth; }
+
+	private:
+		void prepareBuild(const AABB* boxes, uint32_t count);
+		void computeKeys(const AABB* boxes, uint32_t begin, uint32_t end);
+		void emitNodes();
+
+	private:
+		std::vector<LinearOctreeNode> m_Nodes;
+		std::vector<int32_t>		  m_Data;
+
+		std::vector<uint64_t> m_Keys;
+		std::vector<uint32_t> m_Indices;
+		RadixSorter			  m_Sorter;
+
+		AABB	  m_InitialBounds;
+		AABB	  m_Bounds;
+		glm::vec3 m_CellScale;
+		uint32_t  m_MaxDepth;
+	};
+}
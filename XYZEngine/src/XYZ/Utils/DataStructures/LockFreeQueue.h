@@ -0,0 +1,319 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace XYZ {
+
+	static constexpr size_t sc_CacheLineSize = 64;
+
+	namespace Utils {
+		inline size_t RoundUpPowerOfTwo(size_t value)
+		{
+			size_t result = 2;
+			while (result < value)
+				result <<= 1;
+			return result;
+		}
+	}
+
+	// Bounded lock free multi producer / multi consumer ring queue (Dmitry Vyukov).
+	// Every cell carries a sequence number, producers and consumers only contend on their own position counter
+	template <typename T>
+	class MPMCQueue
+	{
+	public:
+		MPMCQueue(size_t capacity = 1024);
+		MPMCQueue(const MPMCQueue<T>& other) = delete;
+		~MPMCQueue();
+
+		MPMCQueue<T>& operator=(const MPMCQueue<T>& other) = delete;
+
+		bool TryPush(const T& elem) { return TryEmplace(elem); }
+		bool TryPush(T&& elem)		{ return TryEmplace(std::move(elem)); }
+
+		template <typename ...Args>
+		bool TryEmplace(Args&&... args);
+
+		bool TryPop(T& elem);
+
+		// Pops up to maxCount elements, returns number of popped elements
+		size_t TryPopBatch(T* elems, size_t maxCount);
+
+		void Clear();
+
+		// Approximations, other threads might modify queue at the same time
+		size_t Size() const;
+		bool   Empty() const { return Size() == 0; }
+
+		size_t Capacity() const { return m_Mask + 1; }
+
+	private:
+		template <typename Func>
+		bool tryDequeue(Func&& consume);
+
+	private:
+		struct Cell
+		{
+			std::atomic_size_t Sequence;
+			alignas(T) std::byte Data[sizeof(T)];
+
+			T* Get() { return std::launder(reinterpret_cast<T*>(Data)); }
+		};
+
+		Cell*		 m_Cells;
+		const size_t m_Mask;
+
+		alignas(sc_CacheLineSize) std::atomic_size_t m_EnqueuePosition;
+		alignas(sc_CacheLineSize) std::atomic_size_t m_DequeuePosition;
+	};
+
+
+	// Bounded lock free single producer / single consumer ring queue
+	template <typename T>
+	class SPSCQueue
+	{
+	public:
+		SPSCQueue(size_t capacity = 1024);
+		SPSCQueue(const SPSCQueue<T>& other) = delete;
+		~SPSCQueue();
+
+		SPSCQueue<T>& operator=(const SPSCQueue<T>& other) = delete;
+
+		// Producer thread only
+		bool TryPush(const T& elem) { return TryEmplace(elem); }
+		bool TryPush(T&& elem)		{ return TryEmplace(std::move(elem)); }
+
+		template <typename ...Args>
+		bool TryEmplace(Args&&... args);
+
+		// Consumer thread only
+		bool   TryPop(T& elem);
+		size_t TryPopBatch(T* elems, size_t maxCount);
+		void   Clear();
+
+		size_t Size() const;
+		bool   Empty() const { return Size() == 0; }
+
+		size_t Capacity() const { return m_Mask + 1; }
+
+	private:
+		T* get(size_t position) { return std::launder(reinterpret_cast<T*>(m_Data + (position & m_Mask) * sizeof(T))); }
+
+	private:
+		std::byte*	 m_Data;
+		const size_t m_Mask;
+
+		alignas(sc_CacheLineSize) std::atomic_size_t m_Head;
+		size_t m_TailCache = 0; // Consumer side copy of m_Tail
+
+		alignas(sc_CacheLineSize) std::atomic_size_t m_Tail;
+		size_t m_HeadCache = 0; // Producer side copy of m_Head
+	};
+
+
+	template<typename T>
+	inline MPMCQueue<T>::MPMCQueue(size_t capacity)
+		:
+		m_Cells(nullptr),
+		m_Mask(Utils::RoundUpPowerOfTwo(capacity) - 1),
+		m_EnqueuePosition(0),
+		m_DequeuePosition(0)
+	{
+		m_Cells = static_cast<Cell*>(::operator new[](sizeof(Cell) * (m_Mask + 1), std::align_val_t{ alignof(Cell) }));
+		for (size_t i = 0; i <= m_Mask; ++i)
+			new (&m_Cells[i].Sequence) std::atomic_size_t(i);
+	}
+
+	template<typename T>
+	inline MPMCQueue<T>::~MPMCQueue()
+	{
+		Clear();
+		for (size_t i = 0; i <= m_Mask; ++i)
+			m_Cells[i].Sequence.~atomic();
+		::operator delete[](m_Cells, std::align_val_t{ alignof(Cell) });
+	}
+
+	template<typename T>
+	template<typename ...Args>
+	inline bool MPMCQueue<T>::TryEmplace(Args && ...args)
+	{
+		Cell* cell = nullptr;
+		size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &m_Cells[position & m_Mask];
+			const size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+			const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (diff == 0)
+			{
+				if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				return false; // Full
+			}
+			else
+			{
+				position = m_EnqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+		new (cell->Data) T(std::forward<Args>(args)...);
+		cell->Sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline bool MPMCQueue<T>::TryPop(T& elem)
+	{
+		return tryDequeue([&](T& data) { elem = std::move(data); });
+	}
+
+	template<typename T>
+	template<typename Func>
+	inline bool MPMCQueue<T>::tryDequeue(Func&& consume)
+	{
+		Cell* cell = nullptr;
+		size_t position = m_DequeuePosition.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &m_Cells[position & m_Mask];
+			const size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+			const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+			if (diff == 0)
+			{
+				if (m_DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				return false; // Empty
+			}
+			else
+			{
+				position = m_DequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+		T* data = cell->Get();
+		consume(*data);
+		data->~T();
+		cell->Sequence.store(position + m_Mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline size_t MPMCQueue<T>::TryPopBatch(T* elems, size_t maxCount)
+	{
+		size_t count = 0;
+		while (count < maxCount && TryPop(elems[count]))
+			count++;
+		return count;
+	}
+
+	template<typename T>
+	inline void MPMCQueue<T>::Clear()
+	{
+		while (tryDequeue([](T&) {})) {}
+	}
+
+	template<typename T>
+	inline size_t MPMCQueue<T>::Size() const
+	{
+		const size_t enqueue = m_EnqueuePosition.load(std::memory_order_relaxed);
+		const size_t dequeue = m_DequeuePosition.load(std::memory_order_relaxed);
+		return enqueue > dequeue ? enqueue - dequeue : 0;
+	}
+
+
+	template<typename T>
+	inline SPSCQueue<T>::SPSCQueue(size_t capacity)
+		:
+		m_Data(nullptr),
+		m_Mask(Utils::RoundUpPowerOfTwo(capacity) - 1),
+		m_Head(0),
+		m_Tail(0)
+	{
+		m_Data = static_cast<std::byte*>(::operator new[](sizeof(T) * (m_Mask + 1), std::align_val_t{ alignof(T) }));
+	}
+
+	template<typename T>
+	inline SPSCQueue<T>::~SPSCQueue()
+	{
+		Clear();
+		::operator delete[](m_Data, std::align_val_t{ alignof(T) });
+	}
+
+	template<typename T>
+	template<typename ...Args>
+	inline bool SPSCQueue<T>::TryEmplace(Args && ...args)
+	{
+		const size_t tail = m_Tail.load(std::memory_order_relaxed);
+		if (tail - m_HeadCache > m_Mask)
+		{
+			m_HeadCache = m_Head.load(std::memory_order_acquire);
+			if (tail - m_HeadCache > m_Mask)
+				return false; // Full
+		}
+		new (m_Data + (tail & m_Mask) * sizeof(T)) T(std::forward<Args>(args)...);
+		m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline bool SPSCQueue<T>::TryPop(T& elem)
+	{
+		const size_t head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_TailCache)
+		{
+			m_TailCache = m_Tail.load(std::memory_order_acquire);
+			if (head == m_TailCache)
+				return false; // Empty
+		}
+		T* data = get(head);
+		elem = std::move(*data);
+		data->~T();
+		m_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline size_t SPSCQueue<T>::TryPopBatch(T* elems, size_t maxCount)
+	{
+		const size_t head = m_Head.load(std::memory_order_relaxed);
+		m_TailCache = m_Tail.load(std::memory_order_acquire);
+
+		const size_t count = std::min(m_TailCache - head, maxCount);
+		for (size_t i = 0; i < count; ++i)
+		{
+			T* data = get(head + i);
+			elems[i] = std::move(*data);
+			data->~T();
+		}
+		m_Head.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+	template<typename T>
+	inline void SPSCQueue<T>::Clear()
+	{
+		const size_t tail = m_Tail.load(std::memory_order_acquire);
+		size_t head = m_Head.load(std::memory_order_relaxed);
+		for (; head != tail; ++head)
+			get(head)->~T();
+		m_Head.store(head, std::memory_order_release);
+	}
+
+	template<typename T>
+	inline size_t SPSCQueue<T>::Size() const
+	{
+		// Head is loaded first, tail loaded later can only be further
+		const size_t head = m_Head.load(std::memory_order_acquire);
+		const size_t tail = m_Tail.load(std::memory_order_acquire);
+		return tail > head ? tail - head : 0;
+	}
+}
@@ -10,23 +10,28 @@ namespace XYZ {
 	{}
 
 
-	MemoryPool::MemoryPool(const uint32_t blockSize)
+	MemoryPool::MemoryPool(const uint32_t blockSize, Mode mode)
 		:
 		m_BlockInUse(0),
 		m_BlockSize(blockSize),
 		m_NumAllocations(0),
-		m_MemoryUsed(0)
+		m_MemoryUsed(0),
+		m_Mode(mode)
 	{
+		if (m_Mode == Mode::SizeClasses)
+			m_SlabAllocator = CreateScope<SlabAllocator>();
 	}
 	MemoryPool::MemoryPool(MemoryPool&& other) noexcept
 		:
 		m_Blocks(std::move(other.m_Blocks)),
 		m_FreeChunks(std::move(other.m_FreeChunks)),
 		m_Allocations(std::move(other.m_Allocations)),
+		m_SlabAllocator(std::move(other.m_SlabAllocator)),
 		m_BlockInUse(other.m_BlockInUse),
 		m_BlockSize(other.m_BlockSize),
 		m_NumAllocations(other.m_NumAllocations),
 		m_MemoryUsed(other.m_MemoryUsed),
+		m_Mode(other.m_Mode),
 		m_Dirty(other.m_Dirty)
 	{
 		other.m_NumAllocations = 0;
@@ -39,11 +44,9 @@ namespace XYZ {
 			XYZ_CORE_WARN("Memory not released, number of elements: {} not released memory: {}", m_NumAllocations, m_MemoryUsed);
 
 		#ifdef XYZ_DEBUG
-		for (int32_t i = 0; i < m_Allocations.Range(); ++i)
-		{
-			if (m_Allocations.Valid(i))
-				XYZ_CORE_WARN("Allocation with name {} not released", m_Allocations[i]);
-		}
+		m_Allocations.ForEach([](int32_t index, const std::string& name) {
+			XYZ_CORE_WARN("Allocation with name {} not released", name);
+		});
 		#endif //  XYZ_DEBUG
 
 		for (auto& block : m_Blocks)
@@ -57,10 +60,12 @@ namespace XYZ {
 		m_Blocks = std::move(other.m_Blocks);
 		m_FreeChunks = std::move(other.m_FreeChunks);
 		m_Allocations = std::move(other.m_Allocations);
+		m_SlabAllocator = std::move(other.m_SlabAllocator);
 		m_BlockInUse = other.m_BlockInUse;
 		m_BlockSize = other.m_BlockSize;
 		m_NumAllocations = other.m_NumAllocations;
 		m_MemoryUsed = other.m_MemoryUsed;
+		m_Mode = other.m_Mode;
 		m_Dirty = other.m_Dirty;
 
 		other.m_NumAllocations = 0;
@@ -72,6 +77,9 @@ namespace XYZ {
 	void* MemoryPool::Allocate(uint32_t size, const char* debugName)
 	{
 		XYZ_PROFILE_FUNC("MemoryPool::Allocate");
+		if (m_SlabAllocator)
+			return m_SlabAllocator->Allocate(size, debugName);
+
 		const uint32_t sizeReq = size + Metadata::SizeTight();
 		m_NumAllocations++;
 		m_MemoryUsed += sizeReq;
@@ -92,6 +100,12 @@ namespace XYZ {
 	void MemoryPool::Deallocate(const void* val)
 	{
 		XYZ_PROFILE_FUNC("MemoryPool::Deallocate");
+		if (m_SlabAllocator)
+		{
+			m_SlabAllocator->Deallocate(val);
+			return;
+		}
+
 		Metadata metadata = readMetadata(val);
 		m_NumAllocations--;
 		m_Dirty = true;
@@ -105,6 +119,20 @@ namespace XYZ {
 		#endif
 	}
 
+	uint32_t MemoryPool::GetMemoryUsed() const
+	{
+		if (m_SlabAllocator)
+			return m_SlabAllocator->GetMemoryUsed();
+		return m_MemoryUsed;
+	}
+
+	uint32_t MemoryPool::GetNumAllocations() const
+	{
+		if (m_SlabAllocator)
+			return m_SlabAllocator->GetNumAllocations();
+		return m_NumAllocations;
+	}
+
 	void MemoryPool::cleanUp()
 	{
 		XYZ_PROFILE_FUNC("MemoryPool::cleanUp");
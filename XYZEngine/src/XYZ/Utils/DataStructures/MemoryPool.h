@@ -1,11 +1,18 @@
 #pragma once
-#include "XYZ/Utils/DataStructures/FreeList.h"
+#include "XYZ/Utils/DataStructures/PackedFreeList.h"
+#include "XYZ/Utils/DataStructures/SlabAllocator.h"
 
 namespace XYZ {
 
 	class XYZ_API MemoryPool
 	{
 	public:
+		enum class Mode
+		{
+			Blocks,		// Variable sized chunks in big blocks, free chunks are merged
+			SizeClasses // Segregated size classes, O(1) allocate / deallocate, thread safe
+		};
+
 		struct Block
 		{
 			uint8_t* Data = nullptr;
@@ -33,7 +40,7 @@ namespace XYZ {
 		};
 
 
-		MemoryPool(const uint32_t blockSize = 1024);
+		MemoryPool(const uint32_t blockSize = 1024, Mode mode = Mode::Blocks);
 		MemoryPool(const MemoryPool& other) = delete;
 		MemoryPool(MemoryPool&& other) noexcept;
 		~MemoryPool();
@@ -46,12 +53,16 @@ namespace XYZ {
 
 
 
-		const FreeList<std::string>& GetAllocations()    const { return m_Allocations; }
-		const std::vector<Chunk>&	 GetFreeChunks()     const { return m_FreeChunks; }
-		uint32_t					 GetMemoryUsed()     const { return m_MemoryUsed; }
-		uint32_t					 GetNumAllocations() const { return m_NumAllocations; }
-		uint32_t					 GetBlockSize()      const { return m_BlockSize; }
-		uint32_t					 GetNumBlocks()      const { return static_cast<uint32_t>(m_Blocks.size()); }
+		const PackedFreeList<std::string>& GetAllocations()    const { return m_Allocations; }
+		const std::vector<Chunk>&		   GetFreeChunks()     const { return m_FreeChunks; }
+		uint32_t						   GetMemoryUsed()     const;
+		uint32_t						   GetNumAllocations() const;
+		uint32_t						   GetBlockSize()      const { return m_BlockSize; }
+		uint32_t						   GetNumBlocks()      const { return static_cast<uint32_t>(m_Blocks.size()); }
+		Mode							   GetMode()			 const { return m_Mode; }
+
+		// Valid only in Mode::SizeClasses
+		const SlabAllocator*			   GetSlabAllocator()  const { return m_SlabAllocator.get(); }
 	
 	private:
 		void   cleanUp();
@@ -65,14 +76,16 @@ namespace XYZ {
 		static void	    writeMetadata(void* data, const Metadata& metadata);
 
 	private:
-		std::vector<Block>    m_Blocks;
-		std::vector<Chunk>    m_FreeChunks;
-		FreeList<std::string> m_Allocations;
+		std::vector<Block>			m_Blocks;
+		std::vector<Chunk>			m_FreeChunks;
+		PackedFreeList<std::string> m_Allocations;
+		Scope<SlabAllocator>		m_SlabAllocator;
 
 		uint8_t			   m_BlockInUse;
 		uint32_t		   m_BlockSize;
 		uint32_t		   m_NumAllocations;
 		uint32_t		   m_MemoryUsed;
+		Mode			   m_Mode;
 
 		bool m_Dirty = false;
 		static constexpr size_t sc_MaxNumberOfBlocks = 255;
@@ -0,0 +1,324 @@
+#include "stdafx.h"
+#include "OffsetAllocator.h"
+
+#include "PackedFreeList.h"
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_MantissaBits  = 3;
+	static constexpr uint32_t sc_MantissaValue = 1 << sc_MantissaBits;
+	static constexpr uint32_t sc_MantissaMask  = sc_MantissaValue - 1;
+
+	static uint32_t HighestBit(uint32_t value)
+	{
+	#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, value);
+		return static_cast<uint32_t>(index);
+	#else
+		return 31 - static_cast<uint32_t>(__builtin_clz(value));
+	#endif
+	}
+
+	// Size is stored as small float, exponent selects top bin and mantissa leaf bin.
+	// Allocations look up bin rounded up so any range in it is large enough,
+	// free ranges are stored in bin rounded down
+	static uint32_t SizeToBin(uint32_t size, bool roundUp)
+	{
+		if (size < sc_MantissaValue)
+			return size;
+
+		const uint32_t mantissaStart = HighestBit(size) - sc_MantissaBits;
+		const uint32_t exponent = mantissaStart + 1;
+		uint32_t mantissa = (size >> mantissaStart) & sc_MantissaMask;
+		if (roundUp && (size & ((1u << mantissaStart) - 1)) != 0)
+			mantissa++; // Overflow carries into exponent
+
+		return (exponent << sc_MantissaBits) + mantissa;
+	}
+
+	OffsetAllocator::OffsetAllocator(uint32_t size)
+		:
+		m_Size(size)
+	{
+		Reset();
+	}
+
+	OffsetAllocator::Allocation OffsetAllocator::Allocate(uint32_t size)
+	{
+		XYZ_ASSERT(size != 0, "Zero sized allocation");
+		const uint32_t bin = findFreeBin(SizeToBin(size, true));
+		if (bin == sc_InvalidNode)
+			return {};
+
+		const uint32_t nodeIndex = m_BinHeads[bin];
+		removeFree(nodeIndex);
+
+		Node& node = m_Nodes[nodeIndex];
+		const uint32_t remainder = node.Size - size;
+		node.Size = size;
+		node.Used = true;
+		if (remainder != 0)
+		{
+			const uint32_t next = node.NeighborNext;
+			const uint32_t offset = node.Offset + size;
+			const uint32_t remainderIndex = createNode(offset, remainder); // Invalidates node reference
+
+			m_Nodes[remainderIndex].NeighborPrev = nodeIndex;
+			m_Nodes[remainderIndex].NeighborNext = next;
+			if (next != sc_InvalidNode)
+				m_Nodes[next].NeighborPrev = remainderIndex;
+			m_Nodes[nodeIndex].NeighborNext = remainderIndex;
+			insertFree(remainderIndex);
+		}
+		return { m_Nodes[nodeIndex].Offset, nodeIndex };
+	}
+
+	void OffsetAllocator::Free(uint32_t nodeIndex)
+	{
+		XYZ_ASSERT(m_Nodes[nodeIndex].Used, "Node is not allocated");
+		Node& node = m_Nodes[nodeIndex];
+		node.Used = false;
+
+		const uint32_t prev = node.NeighborPrev;
+		if (prev != sc_InvalidNode && !m_Nodes[prev].Used)
+		{
+			removeFree(prev);
+			node.Offset = m_Nodes[prev].Offset;
+			node.Size += m_Nodes[prev].Size;
+			node.NeighborPrev = m_Nodes[prev].NeighborPrev;
+			if (node.NeighborPrev != sc_InvalidNode)
+				m_Nodes[node.NeighborPrev].NeighborNext = nodeIndex;
+			releaseNode(prev);
+		}
+
+		const uint32_t next = node.NeighborNext;
+		if (next != sc_InvalidNode && !m_Nodes[next].Used)
+		{
+			removeFree(next);
+			node.Size += m_Nodes[next].Size;
+			node.NeighborNext = m_Nodes[next].NeighborNext;
+			if (node.NeighborNext != sc_InvalidNode)
+				m_Nodes[node.NeighborNext].NeighborPrev = nodeIndex;
+			releaseNode(next);
+		}
+		insertFree(nodeIndex);
+	}
+
+	bool OffsetAllocator::Grow(uint32_t nodeIndex, uint32_t size)
+	{
+		Node& node = m_Nodes[nodeIndex];
+		XYZ_ASSERT(node.Used, "Node is not allocated");
+		if (size <= node.Size)
+			return true;
+
+		const uint32_t next = node.NeighborNext;
+		if (next == sc_InvalidNode || m_Nodes[next].Used || node.Size + m_Nodes[next].Size < size)
+			return false;
+
+		removeFree(next);
+		const uint32_t remainder = node.Size + m_Nodes[next].Size - size;
+		node.Size = size;
+		if (remainder != 0)
+		{
+			m_Nodes[next].Offset = node.Offset + size;
+			m_Nodes[next].Size = remainder;
+			insertFree(next);
+		}
+		else
+		{
+			node.NeighborNext = m_Nodes[next].NeighborNext;
+			if (node.NeighborNext != sc_InvalidNode)
+				m_Nodes[node.NeighborNext].NeighborPrev = nodeIndex;
+			releaseNode(next);
+		}
+		return true;
+	}
+
+	void OffsetAllocator::Compact(std::vector<Relocation>& relocations)
+	{
+		std::vector<uint32_t> used;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(m_Nodes.size()); ++i)
+		{
+			if (m_Nodes[i].Used)
+				used.push_back(i);
+		}
+		std::sort(used.begin(), used.end(), [&](uint32_t a, uint32_t b) {
+			return m_Nodes[a].Offset < m_Nodes[b].Offset;
+		});
+
+		// Free nodes are dropped, used nodes keep their indices
+		m_FreeNodes.clear();
+		for (uint32_t i = static_cast<uint32_t>(m_Nodes.size()); i-- > 0;)
+		{
+			if (!m_Nodes[i].Used)
+				m_FreeNodes.push_back(i);
+		}
+		m_UsedBinsTop = 0;
+		memset(m_UsedBins, 0, sizeof(m_UsedBins));
+		std::fill(std::begin(m_BinHeads), std::end(m_BinHeads), sc_InvalidNode);
+		m_FreeSize = 0;
+		m_FreeRegions = 0;
+
+		uint32_t offset = 0;
+		uint32_t prev = sc_InvalidNode;
+		for (const uint32_t index : used)
+		{
+			Node& node = m_Nodes[index];
+			if (node.Offset != offset)
+			{
+				relocations.push_back({ index, node.Offset, offset, node.Size });
+				node.Offset = offset;
+			}
+			node.NeighborPrev = prev;
+			node.NeighborNext = sc_InvalidNode;
+			if (prev != sc_InvalidNode)
+				m_Nodes[prev].NeighborNext = index;
+
+			prev = index;
+			offset += node.Size;
+		}
+
+		if (offset != m_Size)
+		{
+			const uint32_t freeIndex = createNode(offset, m_Size - offset);
+			m_Nodes[freeIndex].NeighborPrev = prev;
+			if (prev != sc_InvalidNode)
+				m_Nodes[prev].NeighborNext = freeIndex;
+			insertFree(freeIndex);
+		}
+	}
+
+	void OffsetAllocator::Reset()
+	{
+		m_FreeSize = 0;
+		m_FreeRegions = 0;
+		m_UsedBinsTop = 0;
+		memset(m_UsedBins, 0, sizeof(m_UsedBins));
+		std::fill(std::begin(m_BinHeads), std::end(m_BinHeads), sc_InvalidNode);
+
+		m_Nodes.clear();
+		m_FreeNodes.clear();
+		if (m_Size != 0)
+			insertFree(createNode(0, m_Size));
+	}
+
+	OffsetAllocator::Statistics OffsetAllocator::GetStatistics() const
+	{
+		Statistics result;
+		result.TotalFree = m_FreeSize;
+		result.FreeRegions = m_FreeRegions;
+		if (m_UsedBinsTop != 0)
+		{
+			// Bins are rounded down, the largest range is somewhere in the highest bin
+			const uint32_t top = HighestBit(m_UsedBinsTop);
+			const uint32_t bin = top * sc_BinsPerLeaf + HighestBit(m_UsedBins[top]);
+			for (uint32_t node = m_BinHeads[bin]; node != sc_InvalidNode; node = m_Nodes[node].BinNext)
+				result.LargestFree = std::max(result.LargestFree, m_Nodes[node].Size);
+		}
+		if (m_FreeSize != 0)
+			result.Fragmentation = 100.0f * (1.0f - static_cast<float>(result.LargestFree) / m_FreeSize);
+		return result;
+	}
+
+	uint32_t OffsetAllocator::createNode(uint32_t offset, uint32_t size)
+	{
+		uint32_t index;
+		if (!m_FreeNodes.empty())
+		{
+			index = m_FreeNodes.back();
+			m_FreeNodes.pop_back();
+			m_Nodes[index] = Node();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(m_Nodes.size());
+			m_Nodes.emplace_back();
+		}
+		m_Nodes[index].Offset = offset;
+		m_Nodes[index].Size = size;
+		return index;
+	}
+
+	void OffsetAllocator::releaseNode(uint32_t node)
+	{
+		m_Nodes[node].Used = false;
+		m_Nodes[node].Size = 0;
+		m_FreeNodes.push_back(node);
+	}
+
+	void OffsetAllocator::insertFree(uint32_t nodeIndex)
+	{
+		Node& node = m_Nodes[nodeIndex];
+		const uint32_t bin = SizeToBin(node.Size, false);
+		const uint32_t top = bin / sc_BinsPerLeaf;
+		const uint32_t leaf = bin % sc_BinsPerLeaf;
+
+		m_UsedBinsTop |= 1u << top;
+		m_UsedBins[top] |= static_cast<uint8_t>(1u << leaf);
+
+		node.BinPrev = sc_InvalidNode;
+		node.BinNext = m_BinHeads[bin];
+		if (node.BinNext != sc_InvalidNode)
+			m_Nodes[node.BinNext].BinPrev = nodeIndex;
+		m_BinHeads[bin] = nodeIndex;
+
+		m_FreeSize += node.Size;
+		m_FreeRegions++;
+	}
+
+	void OffsetAllocator::removeFree(uint32_t nodeIndex)
+	{
+		Node& node = m_Nodes[nodeIndex];
+		if (node.BinPrev != sc_InvalidNode)
+		{
+			m_Nodes[node.BinPrev].BinNext = node.BinNext;
+		}
+		else
+		{
+			const uint32_t bin = SizeToBin(node.Size, false);
+			const uint32_t top = bin / sc_BinsPerLeaf;
+			const uint32_t leaf = bin % sc_BinsPerLeaf;
+
+			m_BinHeads[bin] = node.BinNext;
+			if (node.BinNext == sc_InvalidNode)
+			{
+				m_UsedBins[top] &= static_cast<uint8_t>(~(1u << leaf));
+				if (m_UsedBins[top] == 0)
+					m_UsedBinsTop &= ~(1u << top);
+			}
+		}
+		if (node.BinNext != sc_InvalidNode)
+			m_Nodes[node.BinNext].BinPrev = node.BinPrev;
+
+		node.BinPrev = sc_InvalidNode;
+		node.BinNext = sc_InvalidNode;
+		m_FreeSize -= node.Size;
+		m_FreeRegions--;
+	}
+
+	uint32_t OffsetAllocator::findFreeBin(uint32_t minBin) const
+	{
+		const uint32_t top = minBin / sc_BinsPerLeaf;
+		const uint32_t leaf = minBin % sc_BinsPerLeaf;
+		if (top >= sc_NumTopBins)
+			return sc_InvalidNode;
+
+		if (m_UsedBinsTop & (1u << top))
+		{
+			const uint32_t leafMask = m_UsedBins[top] & (~0u << leaf);
+			if (leafMask != 0)
+				return top * sc_BinsPerLeaf + Utils::CountTrailingZeros(leafMask);
+		}
+
+		if (top + 1 >= sc_NumTopBins)
+			return sc_InvalidNode;
+
+		const uint32_t topMask = m_UsedBinsTop & (~0u << (top + 1));
+		if (topMask == 0)
+			return sc_InvalidNode;
+
+		const uint32_t nextTop = Utils::CountTrailingZeros(topMask);
+		return nextTop * sc_BinsPerLeaf + Utils::CountTrailingZeros(m_UsedBins[nextTop]);
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include <vector>
+
+namespace XYZ {
+
+	// Two level segregated fit allocator of offsets in external memory (e.g. GPU buffer).
+	// Free ranges are stored in bins indexed by size with 3 mantissa bits, bitmasks of non empty
+	// bins are searched with bit scan, allocate and free are O(1).
+	// Neighbouring free ranges are merged on free
+	class XYZ_API OffsetAllocator
+	{
+	public:
+		static constexpr uint32_t sc_InvalidNode = UINT32_MAX;
+
+		struct Allocation
+		{
+			uint32_t Offset = 0;
+			uint32_t Node	= sc_InvalidNode;
+
+			bool Valid() const { return Node != sc_InvalidNode; }
+		};
+
+		struct Relocation
+		{
+			uint32_t Node;
+			uint32_t SrcOffset;
+			uint32_t DstOffset;
+			uint32_t Size;
+		};
+
+		struct Statistics
+		{
+			uint32_t TotalFree		= 0;
+			uint32_t LargestFree	= 0;
+			uint32_t FreeRegions	= 0;
+			float	 Fragmentation	= 0.0f; // Percentage of free space not in the largest free region
+		};
+
+	public:
+		OffsetAllocator(uint32_t size);
+
+		// Returns invalid allocation if there is no free range large enough
+		Allocation Allocate(uint32_t size);
+		void	   Free(uint32_t node);
+
+		// Grows allocation in place if the following range is free and large enough
+		bool	   Grow(uint32_t node, uint32_t size);
+
+		// Moves all allocations to the start, nodes stay valid and their offsets are updated.
+		// Relocations are sorted by destination offset and source of relocation can overlap its own destination.
+		// On CPU copy them in order with memmove. vkCmdCopyBuffer forbids overlapping regions, so on GPU
+		// copy all sources to staging buffer first, or upload moved data again
+		void	   Compact(std::vector<Relocation>& relocations);
+		void	   Reset();
+
+		Statistics GetStatistics() const;
+
+		uint32_t GetOffset(uint32_t node) const { return m_Nodes[node].Offset; }
+		uint32_t GetSize(uint32_t node)	  const { return m_Nodes[node].Size; }
+		uint32_t GetUsedSize()			  const { return m_Size - m_FreeSize; }
+		uint32_t GetCapacity()			  const { return m_Size; }
+
+	private:
+		static constexpr uint32_t sc_NumTopBins  = 32;
+		static constexpr uint32_t sc_BinsPerLeaf = 8;
+		static constexpr uint32_t sc_NumLeafBins = sc_NumTopBins * sc_BinsPerLeaf;
+
+		struct Node
+		{
+			uint32_t Offset		  = 0;
+			uint32_t Size		  = 0;
+			uint32_t BinPrev	  = sc_InvalidNode;
+			uint32_t BinNext	  = sc_InvalidNode;
+			uint32_t NeighborPrev = sc_InvalidNode;
+			uint32_t NeighborNext = sc_InvalidNode;
+			bool	 Used		  = false;
+		};
+
+		uint32_t createNode(uint32_t offset, uint32_t size);
+		void	 releaseNode(uint32_t node);
+
+		void	 insertFree(uint32_t node);
+		void	 removeFree(uint32_t node);
+
+		uint32_t findFreeBin(uint32_t minBin) const;
+
+	private:
+		uint32_t m_Size;
+		uint32_t m_FreeSize;
+		uint32_t m_FreeRegions;
+
+		uint32_t m_UsedBinsTop;
+		uint8_t	 m_UsedBins[sc_NumTopBins];
+		uint32_t m_BinHeads[sc_NumLeafBins];
+
+		std::vector<Node>	  m_Nodes;
+		std::vector<uint32_t> m_FreeNodes;
+	};
+}
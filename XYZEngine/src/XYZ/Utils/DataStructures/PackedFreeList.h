@@ -0,0 +1,248 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace XYZ {
+
+	namespace Utils {
+		inline uint32_t CountTrailingZeros(uint64_t value)
+		{
+		#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, value);
+			return static_cast<uint32_t>(index);
+		#else
+			return static_cast<uint32_t>(__builtin_ctzll(value));
+		#endif
+		}
+	}
+
+	// FreeList with free index chain stored separately from elements and live bitmask.
+	// Elements are stored tightly, live elements are iterated word by word skipping free ranges.
+	// Every slot has generation counter, handles detect access to erased / reused slots
+	template <typename T>
+	class PackedFreeList
+	{
+	public:
+		struct Handle
+		{
+			int32_t  Index = -1;
+			uint32_t Generation = 0;
+
+			bool operator==(const Handle& other) const { return Index == other.Index && Generation == other.Generation; }
+			bool operator!=(const Handle& other) const { return !(*this == other); }
+		};
+
+	public:
+		PackedFreeList(int32_t size = 0);
+
+		int32_t Insert(const T& elem);
+
+		template <typename... Args>
+		int32_t Emplace(Args&&... args);
+
+		void Erase(int32_t index);
+		void Erase(Handle handle);
+		void Clear();
+		void Reserve(int32_t size);
+
+		bool Valid(int32_t index) const;
+		bool Valid(Handle handle) const;
+
+		Handle	 GetHandle(int32_t index) const { return { index, m_Generations[index] }; }
+		T*		 TryGet(Handle handle);
+		const T* TryGet(Handle handle) const;
+
+		// Calls func(index, elem) for every live element in increasing index order
+		template <typename Func>
+		void ForEach(Func&& func);
+
+		template <typename Func>
+		void ForEach(Func&& func) const;
+
+		int32_t Range() const { return static_cast<int32_t>(m_Data.size()); }
+		int32_t Size()  const { return m_Size; }
+		int32_t Next()  const;
+
+		T&		 operator[](int32_t index)		 { return m_Data[index]; }
+		const T& operator[](int32_t index) const { return m_Data[index]; }
+
+	private:
+		int32_t allocateSlot();
+
+		void setLive(int32_t index)	  { m_LiveMask[index >> 6] |= (1ull << (index & 63)); }
+		void setFree(int32_t index)	  { m_LiveMask[index >> 6] &= ~(1ull << (index & 63)); }
+		bool isLive(int32_t index) const { return (m_LiveMask[index >> 6] >> (index & 63)) & 1; }
+
+	private:
+		std::vector<T>		  m_Data;
+		std::vector<int32_t>  m_NextFree;
+		std::vector<uint32_t> m_Generations;
+		std::vector<uint64_t> m_LiveMask;
+
+		int32_t m_FirstFree;
+		int32_t m_Size;
+	};
+
+	template<typename T>
+	inline PackedFreeList<T>::PackedFreeList(int32_t size)
+		:
+		m_FirstFree(-1),
+		m_Size(0)
+	{
+		if (size > 0)
+			Reserve(size);
+	}
+
+	template<typename T>
+	inline int32_t PackedFreeList<T>::Insert(const T& elem)
+	{
+		const int32_t index = allocateSlot();
+		m_Data[index] = elem;
+		return index;
+	}
+
+	template<typename T>
+	template<typename ...Args>
+	inline int32_t PackedFreeList<T>::Emplace(Args && ...args)
+	{
+		const int32_t index = allocateSlot();
+		m_Data[index] = T(std::forward<Args>(args)...);
+		return index;
+	}
+
+	template<typename T>
+	inline void PackedFreeList<T>::Erase(int32_t index)
+	{
+		XYZ_ASSERT(Valid(index), "Erasing invalid index {}", index);
+		m_Data[index] = T();
+		m_NextFree[index] = m_FirstFree;
+		m_Generations[index]++;
+		m_FirstFree = index;
+		m_Size--;
+		setFree(index);
+	}
+
+	template<typename T>
+	inline void PackedFreeList<T>::Erase(Handle handle)
+	{
+		XYZ_ASSERT(Valid(handle), "Erasing stale handle {}", handle.Index);
+		Erase(handle.Index);
+	}
+
+	template<typename T>
+	inline void PackedFreeList<T>::Clear()
+	{
+		m_Data.clear();
+		m_NextFree.clear();
+		m_Generations.clear();
+		m_LiveMask.clear();
+		m_FirstFree = -1;
+		m_Size = 0;
+	}
+
+	template<typename T>
+	inline void PackedFreeList<T>::Reserve(int32_t size)
+	{
+		m_Data.reserve(size);
+		m_NextFree.reserve(size);
+		m_Generations.reserve(size);
+		m_LiveMask.reserve((static_cast<size_t>(size) + 63) / 64);
+	}
+
+	template<typename T>
+	inline bool PackedFreeList<T>::Valid(int32_t index) const
+	{
+		return index >= 0 && index < Range() && isLive(index);
+	}
+
+	template<typename T>
+	inline bool PackedFreeList<T>::Valid(Handle handle) const
+	{
+		return Valid(handle.Index) && m_Generations[handle.Index] == handle.Generation;
+	}
+
+	template<typename T>
+	inline T* PackedFreeList<T>::TryGet(Handle handle)
+	{
+		if (Valid(handle))
+			return &m_Data[handle.Index];
+		return nullptr;
+	}
+
+	template<typename T>
+	inline const T* PackedFreeList<T>::TryGet(Handle handle) const
+	{
+		if (Valid(handle))
+			return &m_Data[handle.Index];
+		return nullptr;
+	}
+
+	template<typename T>
+	template<typename Func>
+	inline void PackedFreeList<T>::ForEach(Func&& func)
+	{
+		for (size_t word = 0; word < m_LiveMask.size(); ++word)
+		{
+			uint64_t mask = m_LiveMask[word];
+			while (mask)
+			{
+				const int32_t index = static_cast<int32_t>(word * 64 + Utils::CountTrailingZeros(mask));
+				func(index, m_Data[index]);
+				mask &= mask - 1;
+			}
+		}
+	}
+
+	template<typename T>
+	template<typename Func>
+	inline void PackedFreeList<T>::ForEach(Func&& func) const
+	{
+		for (size_t word = 0; word < m_LiveMask.size(); ++word)
+		{
+			uint64_t mask = m_LiveMask[word];
+			while (mask)
+			{
+				const int32_t index = static_cast<int32_t>(word * 64 + Utils::CountTrailingZeros(mask));
+				func(index, m_Data[index]);
+				mask &= mask - 1;
+			}
+		}
+	}
+
+	template<typename T>
+	inline int32_t PackedFreeList<T>::Next() const
+	{
+		if (m_FirstFree == -1)
+			return Range();
+		return m_FirstFree;
+	}
+
+	template<typename T>
+	inline int32_t PackedFreeList<T>::allocateSlot()
+	{
+		int32_t index = m_FirstFree;
+		if (index != -1)
+		{
+			m_FirstFree = m_NextFree[index];
+		}
+		else
+		{
+			index = Range();
+			m_Data.emplace_back();
+			m_NextFree.push_back(-1);
+			m_Generations.push_back(0);
+			if (static_cast<size_t>(index >> 6) >= m_LiveMask.size())
+				m_LiveMask.push_back(0);
+		}
+		m_NextFree[index] = -1;
+		m_Size++;
+		setLive(index);
+		return index;
+	}
+}
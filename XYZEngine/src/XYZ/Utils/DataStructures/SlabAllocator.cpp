@@ -0,0 +1,426 @@
+#include "stdafx.h"
+#include "SlabAllocator.h"
+
+#include "XYZ/Debug/Profiler.h"
+
+namespace XYZ {
+
+	static constexpr uint32_t sc_ThreadCacheSize = 32; // Maximum number of cached slots per class
+	static constexpr uint32_t sc_TransferSize	 = 16; // Number of slots moved between thread cache and class
+
+	static constexpr std::array<uint32_t, SlabAllocator::sc_NumClasses> sc_ClassSizes = {
+		16,	  32,	48,	  64,	80,	  96,	112, 128,
+		160,  192,	224,  256,	320,  384,	448, 512,
+		640,  768,	896,  1024, 1536, 2048, 3072, 4096
+	};
+
+	static std::array<uint8_t, SlabAllocator::sc_MaxClassSize / SlabAllocator::sc_Granularity + 1> CreateClassLookup()
+	{
+		std::array<uint8_t, SlabAllocator::sc_MaxClassSize / SlabAllocator::sc_Granularity + 1> result{};
+		uint32_t classIndex = 0;
+		for (uint32_t i = 0; i < result.size(); ++i)
+		{
+			while (sc_ClassSizes[classIndex] < i * SlabAllocator::sc_Granularity)
+				classIndex++;
+			result[i] = static_cast<uint8_t>(classIndex);
+		}
+		return result;
+	}
+	static const auto s_ClassLookup = CreateClassLookup();
+
+	static std::atomic_uint64_t s_NextAllocatorID = 1;
+
+	// Marks 64 KiB ranges owned by size class slabs. Large allocations are not aligned to slab size,
+	// so Deallocate checks the map before reading slab header of masked pointer.
+	// Lock free and constant initialized, leaves are never released
+	class SlabMap
+	{
+	public:
+		void Set(const void* slab, bool value)
+		{
+			const uintptr_t key = reinterpret_cast<uintptr_t>(slab) >> sc_SlabBits;
+			XYZ_ASSERT((key >> sc_LeafBits) < sc_RootSize, "Address out of slab map range");
+			std::atomic<std::atomic_uint8_t*>& root = m_Root[key >> sc_LeafBits];
+			std::atomic_uint8_t* leaf = root.load(std::memory_order_acquire);
+			if (!leaf)
+			{
+				// Two threads can create the leaf at once, only one is kept
+				std::atomic_uint8_t* created = new std::atomic_uint8_t[sc_LeafSize]{};
+				if (root.compare_exchange_strong(leaf, created, std::memory_order_acq_rel))
+					leaf = created;
+				else
+					delete[] created;
+			}
+			leaf[key & (sc_LeafSize - 1)].store(value ? 1 : 0, std::memory_order_release);
+		}
+
+		bool Contains(const void* ptr) const
+		{
+			const uintptr_t key = reinterpret_cast<uintptr_t>(ptr) >> sc_SlabBits;
+			if ((key >> sc_LeafBits) >= sc_RootSize)
+				return false;
+
+			const std::atomic_uint8_t* leaf = m_Root[key >> sc_LeafBits].load(std::memory_order_acquire);
+			return leaf && leaf[key & (sc_LeafSize - 1)].load(std::memory_order_acquire) != 0;
+		}
+
+	private:
+		static constexpr uint32_t sc_SlabBits	 = 16; // log2(sc_SlabSize)
+		static constexpr uint32_t sc_LeafBits	 = 16;
+		static constexpr uint32_t sc_LeafSize	 = 1 << sc_LeafBits;
+		static constexpr uint32_t sc_AddressBits = 47; // User space of x64 Windows and Linux
+		static constexpr uint32_t sc_RootSize	 = 1 << (sc_AddressBits - sc_SlabBits - sc_LeafBits);
+
+		static_assert((1u << sc_SlabBits) == SlabAllocator::sc_SlabSize, "Slab map bits do not match slab size");
+
+		std::array<std::atomic<std::atomic_uint8_t*>, sc_RootSize> m_Root{};
+	};
+	static SlabMap s_SlabMap;
+
+
+	struct SlabAllocator::ThreadCache
+	{
+		struct Bin
+		{
+			FreeSlot* Head = nullptr;
+			uint32_t  Count = 0;
+
+			void Push(FreeSlot* slot)
+			{
+				slot->Next = Head;
+				Head = slot;
+				Count++;
+			}
+
+			FreeSlot* Pop()
+			{
+				FreeSlot* slot = Head;
+				Head = slot->Next;
+				Count--;
+				return slot;
+			}
+		};
+
+		// Returns all cached slots to shared state if it still exists
+		void FlushAll()
+		{
+			if (std::shared_ptr<State> state = Owner.lock())
+			{
+				for (uint32_t i = 0; i < sc_NumClasses; ++i)
+					flush(state->Classes[i], i, *this, Bins[i].Count);
+			}
+		}
+
+		struct List
+		{
+			~List()
+			{
+				for (auto& cache : Caches)
+					cache->FlushAll();
+			}
+			std::vector<std::unique_ptr<ThreadCache>> Caches;
+		};
+
+		uint64_t			  AllocatorID = 0;
+		std::weak_ptr<State>  Owner;
+		std::array<Bin, sc_NumClasses> Bins;
+
+		static thread_local List		 s_List;
+		static thread_local ThreadCache* s_Last;
+	};
+
+	thread_local SlabAllocator::ThreadCache::List SlabAllocator::ThreadCache::s_List;
+	thread_local SlabAllocator::ThreadCache*	  SlabAllocator::ThreadCache::s_Last = nullptr;
+
+
+	SlabAllocator::State::State()
+		:
+		ID(s_NextAllocatorID.fetch_add(1, std::memory_order_relaxed))
+	{
+		for (uint32_t i = 0; i < sc_NumClasses; ++i)
+			Classes[i].SlotSize = sc_ClassSizes[i];
+	}
+
+	SlabAllocator::State::~State()
+	{
+		for (auto& sizeClass : Classes)
+		{
+			Slab* slab = sizeClass.Slabs;
+			while (slab)
+			{
+				Slab* next = slab->Next;
+				s_SlabMap.Set(slab, false);
+				::operator delete(slab, std::align_val_t{ sc_SlabSize });
+				slab = next;
+			}
+		}
+		Slab* slab = LargeSlabs;
+		while (slab)
+		{
+			Slab* next = slab->Next;
+			::operator delete(slab);
+			slab = next;
+		}
+	}
+
+
+	SlabAllocator::SlabAllocator()
+		:
+		m_State(std::make_shared<State>()),
+		m_LargeMemoryUsed(0),
+		m_LargeAllocations(0)
+	{
+	}
+
+	SlabAllocator::~SlabAllocator()
+	{
+		const uint32_t numAllocations = GetNumAllocations();
+		if (numAllocations != 0)
+			XYZ_CORE_WARN("Memory not released, number of elements: {} not released memory: {}", numAllocations, GetMemoryUsed());
+
+		#ifdef XYZ_DEBUG
+		for (const auto& [ptr, name] : m_DebugNames)
+			XYZ_CORE_WARN("Allocation with name {} not released", name);
+		#endif //  XYZ_DEBUG
+	}
+
+	void* SlabAllocator::Allocate(uint32_t size, const char* debugName)
+	{
+		XYZ_PROFILE_FUNC("SlabAllocator::Allocate");
+		void* result = nullptr;
+		if (size > sc_MaxClassSize)
+		{
+			result = allocateLarge(size);
+		}
+		else
+		{
+			const uint32_t index = classIndex(size);
+			ThreadCache& cache = getThreadCache(m_State);
+			ThreadCache::Bin& bin = cache.Bins[index];
+			SizeClass& sizeClass = m_State->Classes[index];
+			if (bin.Count == 0)
+				refill(sizeClass, index, cache);
+
+			result = bin.Pop();
+			sizeClass.UsedSlots.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		#ifdef XYZ_DEBUG
+		{
+			std::scoped_lock lock(m_DebugMutex);
+			m_DebugNames[result] = debugName;
+		}
+		#endif
+		return result;
+	}
+
+	void SlabAllocator::Deallocate(const void* val)
+	{
+		XYZ_PROFILE_FUNC("SlabAllocator::Deallocate");
+		#ifdef XYZ_DEBUG
+		{
+			std::scoped_lock lock(m_DebugMutex);
+			m_DebugNames.erase(val);
+		}
+		#endif
+
+		if (!s_SlabMap.Contains(val))
+		{
+			deallocateLarge(reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(val) - sc_SlabHeaderSize));
+			return;
+		}
+
+		const Slab* slab = reinterpret_cast<const Slab*>(reinterpret_cast<uintptr_t>(val) & ~static_cast<uintptr_t>(sc_SlabSize - 1));
+		const uint32_t index = slab->ClassIndex;
+		ThreadCache& cache = getThreadCache(m_State);
+		ThreadCache::Bin& bin = cache.Bins[index];
+		SizeClass& sizeClass = m_State->Classes[index];
+
+		bin.Push(reinterpret_cast<FreeSlot*>(const_cast<void*>(val)));
+		sizeClass.UsedSlots.fetch_sub(1, std::memory_order_relaxed);
+		if (bin.Count > sc_ThreadCacheSize)
+			flush(sizeClass, index, cache, sc_TransferSize);
+	}
+
+	void SlabAllocator::FlushThreadCache()
+	{
+		ThreadCache& cache = getThreadCache(m_State);
+		for (uint32_t i = 0; i < sc_NumClasses; ++i)
+			flush(m_State->Classes[i], i, cache, cache.Bins[i].Count);
+	}
+
+	std::array<SlabAllocator::ClassStats, SlabAllocator::sc_NumClasses> SlabAllocator::GetClassStats() const
+	{
+		std::array<ClassStats, sc_NumClasses> result;
+		for (uint32_t i = 0; i < sc_NumClasses; ++i)
+		{
+			SizeClass& sizeClass = m_State->Classes[i];
+			std::scoped_lock lock(sizeClass.Mutex);
+			result[i].SlotSize  = sizeClass.SlotSize;
+			result[i].SlabCount = sizeClass.SlabCount;
+			result[i].SlotCount = sizeClass.SlabCount * ((sc_SlabSize - sc_SlabHeaderSize) / sizeClass.SlotSize);
+			result[i].UsedSlots = sizeClass.UsedSlots.load(std::memory_order_relaxed);
+		}
+		return result;
+	}
+
+	std::vector<std::string> SlabAllocator::GetDebugNames() const
+	{
+		std::vector<std::string> result;
+		#ifdef XYZ_DEBUG
+		std::scoped_lock lock(m_DebugMutex);
+		result.reserve(m_DebugNames.size());
+		for (const auto& [ptr, name] : m_DebugNames)
+			result.push_back(name);
+		#endif
+		return result;
+	}
+
+	uint32_t SlabAllocator::GetMemoryUsed() const
+	{
+		uint32_t result = m_LargeMemoryUsed.load(std::memory_order_relaxed);
+		for (const SizeClass& sizeClass : m_State->Classes)
+			result += sizeClass.UsedSlots.load(std::memory_order_relaxed) * sizeClass.SlotSize;
+		return result;
+	}
+
+	uint32_t SlabAllocator::GetNumAllocations() const
+	{
+		uint32_t result = m_LargeAllocations.load(std::memory_order_relaxed);
+		for (const SizeClass& sizeClass : m_State->Classes)
+			result += sizeClass.UsedSlots.load(std::memory_order_relaxed);
+		return result;
+	}
+
+	uint32_t SlabAllocator::GetClassSize(uint32_t classIndex)
+	{
+		return sc_ClassSizes[classIndex];
+	}
+
+	void* SlabAllocator::allocateLarge(uint32_t size)
+	{
+		// Plain allocation, aligning every large block to slab size would waste up to 64 KiB per block
+		Slab* slab = static_cast<Slab*>(::operator new(static_cast<size_t>(size) + sc_SlabHeaderSize));
+		slab->ClassIndex = sc_LargeClass;
+		slab->SlotCount = 1;
+		slab->Size = static_cast<size_t>(size) + sc_SlabHeaderSize;
+		slab->Next = nullptr;
+		slab->Previous = nullptr;
+		{
+			std::scoped_lock lock(m_State->LargeMutex);
+			slab->Next = m_State->LargeSlabs;
+			if (m_State->LargeSlabs)
+				m_State->LargeSlabs->Previous = slab;
+			m_State->LargeSlabs = slab;
+		}
+		m_LargeMemoryUsed.fetch_add(size, std::memory_order_relaxed);
+		m_LargeAllocations.fetch_add(1, std::memory_order_relaxed);
+		return reinterpret_cast<uint8_t*>(slab) + sc_SlabHeaderSize;
+	}
+
+	void SlabAllocator::deallocateLarge(Slab* slab)
+	{
+		{
+			std::scoped_lock lock(m_State->LargeMutex);
+			if (slab->Previous)
+				slab->Previous->Next = slab->Next;
+			else
+				m_State->LargeSlabs = slab->Next;
+			if (slab->Next)
+				slab->Next->Previous = slab->Previous;
+		}
+		m_LargeMemoryUsed.fetch_sub(static_cast<uint32_t>(slab->Size - sc_SlabHeaderSize), std::memory_order_relaxed);
+		m_LargeAllocations.fetch_sub(1, std::memory_order_relaxed);
+		::operator delete(slab);
+	}
+
+	SlabAllocator::Slab* SlabAllocator::createSlab(uint32_t classIndex)
+	{
+		XYZ_PROFILE_FUNC("SlabAllocator::createSlab");
+		Slab* slab = static_cast<Slab*>(::operator new(sc_SlabSize, std::align_val_t{ sc_SlabSize }));
+		slab->ClassIndex = classIndex;
+		slab->SlotCount = (sc_SlabSize - sc_SlabHeaderSize) / sc_ClassSizes[classIndex];
+		slab->Size = sc_SlabSize;
+		slab->Next = nullptr;
+		slab->Previous = nullptr;
+		s_SlabMap.Set(slab, true);
+		return slab;
+	}
+
+	uint32_t SlabAllocator::classIndex(uint32_t size)
+	{
+		return s_ClassLookup[(size + sc_Granularity - 1) / sc_Granularity];
+	}
+
+	void SlabAllocator::refill(SizeClass& sizeClass, uint32_t classIndex, ThreadCache& cache)
+	{
+		ThreadCache::Bin& bin = cache.Bins[classIndex];
+		std::scoped_lock lock(sizeClass.Mutex);
+		while (bin.Count < sc_TransferSize && sizeClass.FreeList)
+		{
+			FreeSlot* slot = sizeClass.FreeList;
+			sizeClass.FreeList = slot->Next;
+			bin.Push(slot);
+		}
+		if (bin.Count != 0)
+			return;
+
+		if (sizeClass.BumpPointer == sizeClass.BumpEnd)
+		{
+			Slab* slab = createSlab(classIndex);
+			slab->Next = sizeClass.Slabs;
+			sizeClass.Slabs = slab;
+			sizeClass.SlabCount++;
+			sizeClass.BumpPointer = reinterpret_cast<uint8_t*>(slab) + sc_SlabHeaderSize;
+			sizeClass.BumpEnd = sizeClass.BumpPointer + slab->SlotCount * sizeClass.SlotSize;
+		}
+		while (bin.Count < sc_TransferSize && sizeClass.BumpPointer != sizeClass.BumpEnd)
+		{
+			bin.Push(reinterpret_cast<FreeSlot*>(sizeClass.BumpPointer));
+			sizeClass.BumpPointer += sizeClass.SlotSize;
+		}
+	}
+
+	void SlabAllocator::flush(SizeClass& sizeClass, uint32_t classIndex, ThreadCache& cache, uint32_t count)
+	{
+		if (count == 0)
+			return;
+
+		ThreadCache::Bin& bin = cache.Bins[classIndex];
+		std::scoped_lock lock(sizeClass.Mutex);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			FreeSlot* slot = bin.Pop();
+			slot->Next = sizeClass.FreeList;
+			sizeClass.FreeList = slot;
+		}
+	}
+
+	SlabAllocator::ThreadCache& SlabAllocator::getThreadCache(const std::shared_ptr<State>& state)
+	{
+		ThreadCache* last = ThreadCache::s_Last;
+		if (last && last->AllocatorID == state->ID)
+			return *last;
+
+		auto& caches = ThreadCache::s_List.Caches;
+		for (auto& cache : caches)
+		{
+			if (cache->AllocatorID == state->ID)
+			{
+				ThreadCache::s_Last = cache.get();
+				return *cache;
+			}
+		}
+
+		// Remove caches of destroyed allocators
+		caches.erase(std::remove_if(caches.begin(), caches.end(), [](const auto& cache) {
+			return cache->Owner.expired();
+		}), caches.end());
+
+		auto& cache = caches.emplace_back(std::make_unique<ThreadCache>());
+		cache->AllocatorID = state->ID;
+		cache->Owner = state;
+		ThreadCache::s_Last = cache.get();
+		return *cache;
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace XYZ {
+
+	// Segregated size class allocator. Every size class owns slabs split into equally sized slots,
+	// free slots are linked in intrusive free lists. Allocate / Deallocate are O(1) and thread safe,
+	// every thread keeps small cache of free slots per class so the class mutex is touched only in batches
+	class XYZ_API SlabAllocator
+	{
+	public:
+		static constexpr uint32_t sc_SlabSize		 = 64 * 1024; // Slabs of size classes are aligned to their size
+		static constexpr uint32_t sc_SlabHeaderSize = 64;
+		static constexpr uint32_t sc_Granularity	 = 16;
+		static constexpr uint32_t sc_MaxClassSize	 = 4096; // Bigger allocations get own block from operator new
+		static constexpr uint32_t sc_NumClasses	 = 24;
+		static constexpr uint32_t sc_LargeClass	 = sc_NumClasses;
+
+		struct ClassStats
+		{
+			uint32_t SlotSize;
+			uint32_t SlabCount;
+			uint32_t SlotCount;
+			uint32_t UsedSlots;
+
+			float Occupancy() const { return SlotCount != 0 ? static_cast<float>(UsedSlots) / SlotCount : 0.0f; }
+			// Part of committed memory not used by allocations
+			float Fragmentation() const { return SlabCount != 0 ? 1.0f - static_cast<float>(UsedSlots * SlotSize) / (SlabCount * sc_SlabSize) : 0.0f; }
+		};
+
+	public:
+		SlabAllocator();
+		SlabAllocator(const SlabAllocator& other) = delete;
+		~SlabAllocator();
+
+		SlabAllocator& operator=(const SlabAllocator& other) = delete;
+
+		void* Allocate(uint32_t size, const char* debugName = "");
+		void  Deallocate(const void* val);
+
+		// Returns slots cached by calling thread back to shared free lists
+		void FlushThreadCache();
+
+		std::array<ClassStats, sc_NumClasses> GetClassStats() const;
+		std::vector<std::string>			  GetDebugNames() const; // Empty if XYZ_DEBUG is not defined
+
+		uint32_t GetMemoryUsed()	 const;
+		uint32_t GetNumAllocations() const;
+		uint32_t GetLargeMemoryUsed() const { return m_LargeMemoryUsed.load(std::memory_order_relaxed); }
+
+		static uint32_t GetClassSize(uint32_t classIndex);
+
+	private:
+		struct FreeSlot
+		{
+			FreeSlot* Next;
+		};
+
+		struct Slab
+		{
+			uint32_t ClassIndex;
+			uint32_t SlotCount;
+			size_t	 Size;
+			Slab*	 Next;
+			Slab*	 Previous;
+		};
+
+		struct alignas(64) SizeClass
+		{
+			std::mutex Mutex;
+			FreeSlot*  FreeList = nullptr;
+			uint8_t*   BumpPointer = nullptr;
+			uint8_t*   BumpEnd = nullptr;
+			Slab*	   Slabs = nullptr;
+			uint32_t   SlotSize = 0;
+			uint32_t   SlabCount = 0;
+
+			std::atomic_uint32_t UsedSlots{ 0 };
+		};
+
+		// Shared with thread caches, slabs are released when last reference is gone
+		struct State
+		{
+			State();
+			~State();
+
+			std::array<SizeClass, sc_NumClasses> Classes;
+			uint64_t ID;
+
+			std::mutex	LargeMutex;
+			Slab*		LargeSlabs = nullptr;
+		};
+
+		struct ThreadCache;
+
+	private:
+		void* allocateLarge(uint32_t size);
+		void  deallocateLarge(Slab* slab);
+
+		static Slab*		createSlab(uint32_t classIndex);
+		static uint32_t		classIndex(uint32_t size);
+		static void			refill(SizeClass& sizeClass, uint32_t classIndex, ThreadCache& cache);
+		static void			flush(SizeClass& sizeClass, uint32_t classIndex, ThreadCache& cache, uint32_t count);
+		static ThreadCache& getThreadCache(const std::shared_ptr<State>& state);
+
+	private:
+		std::shared_ptr<State> m_State;
+
+		std::atomic_uint32_t m_LargeMemoryUsed;
+		std::atomic_uint32_t m_LargeAllocations;
+
+		#ifdef XYZ_DEBUG
+		mutable std::mutex m_DebugMutex;
+		std::unordered_map<const void*, std::string> m_DebugNames;
+		#endif
+	};
+}
@@ -0,0 +1,263 @@
+#include "stdafx.h"
+#include "SparseVoxelDAG.h"
+
+#include "HashIndex.h"
+
+#include "XYZ/Debug/Profiler.h"
+
+namespace XYZ {
+
+	// Child reference with this bit set is uniform leaf, lower 8 bits store its color
+	static constexpr uint32_t sc_LeafFlag = 0x80000000;
+
+	static bool IsLeaf(uint32_t ref)
+	{
+		return ref & sc_LeafFlag;
+	}
+
+	static uint8_t LeafColor(uint32_t ref)
+	{
+		return static_cast<uint8_t>(ref & 0xff);
+	}
+
+	static uint32_t Index3D(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint32_t height)
+	{
+		return x + width * (y + height * z);
+	}
+
+	static glm::uvec3 ChildOffset(uint32_t child, uint32_t size)
+	{
+		return glm::uvec3(child & 1, (child >> 1) & 1, (child >> 2) & 1) * size;
+	}
+
+	static bool RayBoxInterval(const Ray& ray, const glm::vec3& min, const glm::vec3& max, float& tEnter, float& tExit)
+	{
+		tEnter = -FLT_MAX;
+		tExit = FLT_MAX;
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			if (ray.Direction[axis] == 0.0f)
+			{
+				if (ray.Origin[axis] < min[axis] || ray.Origin[axis] > max[axis])
+					return false;
+				continue;
+			}
+			const float invDir = 1.0f / ray.Direction[axis];
+			float t0 = (min[axis] - ray.Origin[axis]) * invDir;
+			float t1 = (max[axis] - ray.Origin[axis]) * invDir;
+			if (t0 > t1)
+				std::swap(t0, t1);
+
+			tEnter = std::max(tEnter, t0);
+			tExit = std::min(tExit, t1);
+		}
+		return tEnter <= tExit && tExit >= 0.0f;
+	}
+
+	namespace {
+		class DAGBuilder
+		{
+		public:
+			DAGBuilder(const std::vector<uint8_t>& voxels, uint32_t width, uint32_t height, uint32_t depth, std::vector<uint32_t>& children)
+				: m_Voxels(voxels), m_Width(width), m_Height(height), m_Depth(depth), m_Children(children)
+			{}
+
+			uint32_t Build(uint32_t x, uint32_t y, uint32_t z, uint32_t size)
+			{
+				if (x >= m_Width || y >= m_Height || z >= m_Depth)
+					return sc_LeafFlag; // Outside of grid is empty
+
+				if (size == 1)
+					return sc_LeafFlag | m_Voxels[Index3D(x, y, z, m_Width, m_Height)];
+
+				const uint32_t halfSize = size / 2;
+				uint32_t refs[8];
+				bool uniform = true;
+				for (uint32_t i = 0; i < 8; ++i)
+				{
+					const glm::uvec3 offset = ChildOffset(i, halfSize);
+					refs[i] = Build(x + offset.x, y + offset.y, z + offset.z, halfSize);
+					uniform &= refs[i] == refs[0];
+				}
+				if (uniform && IsLeaf(refs[0]))
+					return refs[0];
+
+				size_t hash = 14695981039346656037ull;
+				for (uint32_t ref : refs)
+					hash = (hash ^ ref) * 1099511628211ull;
+
+				const uint32_t existing = m_Index.Find(hash, [&](uint32_t node) {
+					return memcmp(&m_Children[node * 8], refs, sizeof(refs)) == 0;
+				});
+				if (existing != HashIndex::sc_InvalidValue)
+					return existing;
+
+				const uint32_t node = static_cast<uint32_t>(m_Children.size() / 8);
+				m_Children.insert(m_Children.end(), std::begin(refs), std::end(refs));
+				m_Index.Insert(hash, node);
+				return node;
+			}
+
+		private:
+			const std::vector<uint8_t>& m_Voxels;
+			uint32_t m_Width;
+			uint32_t m_Height;
+			uint32_t m_Depth;
+
+			std::vector<uint32_t>& m_Children;
+			HashIndex			   m_Index;
+		};
+	}
+
+	SparseVoxelDAG::SparseVoxelDAG()
+		:
+		m_Root(sc_LeafFlag),
+		m_Size(1),
+		m_Width(0),
+		m_Height(0),
+		m_Depth(0)
+	{
+	}
+
+	SparseVoxelDAG SparseVoxelDAG::FromGrid(const std::vector<uint8_t>& voxels, uint32_t width, uint32_t height, uint32_t depth)
+	{
+		XYZ_PROFILE_FUNC("SparseVoxelDAG::FromGrid");
+		XYZ_ASSERT(voxels.size() >= static_cast<size_t>(width) * height * depth, "Grid is smaller than its dimensions");
+
+		SparseVoxelDAG result;
+		result.m_Width = width;
+		result.m_Height = height;
+		result.m_Depth = depth;
+
+		const uint32_t maxDimension = std::max(width, std::max(height, depth));
+		while (result.m_Size < maxDimension)
+			result.m_Size *= 2;
+
+		DAGBuilder builder(voxels, width, height, depth, result.m_Children);
+		result.m_Root = builder.Build(0, 0, 0, result.m_Size);
+		result.m_Children.shrink_to_fit();
+		return result;
+	}
+
+	std::vector<uint8_t> SparseVoxelDAG::ToGrid() const
+	{
+		XYZ_PROFILE_FUNC("SparseVoxelDAG::ToGrid");
+		std::vector<uint8_t> result(GetGridMemory(), 0);
+
+		struct StackEntry
+		{
+			uint32_t   Ref;
+			glm::uvec3 Min;
+			uint32_t   Size;
+		};
+		std::vector<StackEntry> stack;
+		stack.push_back({ m_Root, glm::uvec3(0), m_Size });
+		while (!stack.empty())
+		{
+			const StackEntry entry = stack.back();
+			stack.pop_back();
+			if (entry.Min.x >= m_Width || entry.Min.y >= m_Height || entry.Min.z >= m_Depth)
+				continue;
+
+			if (IsLeaf(entry.Ref))
+			{
+				const uint8_t color = LeafColor(entry.Ref);
+				if (color == 0)
+					continue;
+
+				const glm::uvec3 max = glm::min(entry.Min + entry.Size, glm::uvec3(m_Width, m_Height, m_Depth));
+				for (uint32_t z = entry.Min.z; z < max.z; ++z)
+				{
+					for (uint32_t y = entry.Min.y; y < max.y; ++y)
+					{
+						uint8_t* row = &result[Index3D(0, y, z, m_Width, m_Height)];
+						memset(row + entry.Min.x, color, max.x - entry.Min.x);
+					}
+				}
+				continue;
+			}
+			const uint32_t halfSize = entry.Size / 2;
+			for (uint32_t i = 0; i < 8; ++i)
+				stack.push_back({ m_Children[entry.Ref * 8 + i], entry.Min + ChildOffset(i, halfSize), halfSize });
+		}
+		return result;
+	}
+
+	uint8_t SparseVoxelDAG::Get(uint32_t x, uint32_t y, uint32_t z) const
+	{
+		if (x >= m_Width || y >= m_Height || z >= m_Depth)
+			return 0;
+
+		uint32_t ref = m_Root;
+		uint32_t size = m_Size;
+		while (!IsLeaf(ref))
+		{
+			size /= 2;
+			const uint32_t child = ((x & size) ? 1 : 0) | ((y & size) ? 2 : 0) | ((z & size) ? 4 : 0);
+			ref = m_Children[ref * 8 + child];
+		}
+		return LeafColor(ref);
+	}
+
+	bool SparseVoxelDAG::Raycast(const Ray& ray, SparseVoxelDAGHit& hit, float maxDistance) const
+	{
+		struct StackEntry
+		{
+			uint32_t   Ref;
+			glm::uvec3 Min;
+			uint32_t   Size;
+			float	   Enter;
+		};
+		// Children are pushed in reverse order of ray entry, so the first non empty leaf is the closest hit
+		StackEntry stack[8 * 32];
+		uint32_t stackSize = 0;
+
+		float tEnter, tExit;
+		if (!RayBoxInterval(ray, glm::vec3(0.0f), glm::vec3(m_Size), tEnter, tExit) || tEnter > maxDistance)
+			return false;
+
+		stack[stackSize++] = { m_Root, glm::uvec3(0), m_Size, tEnter };
+		while (stackSize != 0)
+		{
+			const StackEntry entry = stack[--stackSize];
+			if (IsLeaf(entry.Ref))
+			{
+				const uint8_t color = LeafColor(entry.Ref);
+				if (color == 0)
+					continue;
+
+				hit.Distance = std::max(entry.Enter, 0.0f);
+				hit.ColorIndex = color;
+				const glm::vec3 point = ray.Origin + ray.Direction * hit.Distance;
+				const glm::vec3 voxel = glm::clamp(glm::floor(point), glm::vec3(entry.Min), glm::vec3(entry.Min + entry.Size - 1u));
+				hit.Voxel = glm::uvec3(voxel);
+				return true;
+			}
+
+			const uint32_t halfSize = entry.Size / 2;
+			StackEntry children[8];
+			uint32_t childCount = 0;
+			for (uint32_t i = 0; i < 8; ++i)
+			{
+				const uint32_t ref = m_Children[entry.Ref * 8 + i];
+				if (ref == sc_LeafFlag)
+					continue; // Empty leaf
+
+				const glm::uvec3 min = entry.Min + ChildOffset(i, halfSize);
+				if (RayBoxInterval(ray, glm::vec3(min), glm::vec3(min + halfSize), tEnter, tExit) && tEnter <= maxDistance)
+					children[childCount++] = { ref, min, halfSize, tEnter };
+			}
+			std::sort(children, children + childCount, [](const StackEntry& a, const StackEntry& b) {
+				return a.Enter > b.Enter;
+			});
+			for (uint32_t i = 0; i < childCount; ++i)
+				stack[stackSize++] = children[i];
+		}
+		return false;
+	}
+
+	float SparseVoxelDAG::GetCompressionRatio() const
+	{
+		return static_cast<float>(GetGridMemory()) / static_cast<float>(GetMemoryUsed());
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+#include "XYZ/Utils/Math/Ray.h"
+
+#include <glm/glm.hpp>
+
+namespace XYZ {
+
+	struct SparseVoxelDAGHit
+	{
+		glm::uvec3 Voxel;
+		uint8_t	   ColorIndex = 0;
+		float	   Distance = 0.0f;
+	};
+
+	// Voxel octree where identical subtrees are stored only once and uniform subtrees collapse into single leaf.
+	// Every node stores eight child references, reference is either index of another node or color of uniform leaf.
+	// Color index 0 is treated as empty space
+	class XYZ_API SparseVoxelDAG
+	{
+	public:
+		SparseVoxelDAG();
+
+		static SparseVoxelDAG FromGrid(const std::vector<uint8_t>& voxels, uint32_t width, uint32_t height, uint32_t depth);
+
+		std::vector<uint8_t> ToGrid() const;
+
+		// Returns 0 for voxels outside of grid
+		uint8_t Get(uint32_t x, uint32_t y, uint32_t z) const;
+
+		// Ray is in voxel space, grid starts at origin and voxel has size 1
+		bool Raycast(const Ray& ray, SparseVoxelDAGHit& hit, float maxDistance = FLT_MAX) const;
+
+		size_t GetMemoryUsed()		 const { return (m_Children.size() + 1) * sizeof(uint32_t); }
+		size_t GetGridMemory()		 const { return static_cast<size_t>(m_Width) * m_Height * m_Depth; }
+		float  GetCompressionRatio() const;
+
+		uint32_t GetNodeCount() const { return static_cast<uint32_t>(m_Children.size() / 8); }
+		uint32_t GetWidth()		const { return m_Width; }
+		uint32_t GetHeight()	const { return m_Height; }
+		uint32_t GetDepth()		const { return m_Depth; }
+
+	private:
+		std::vector<uint32_t> m_Children;
+		uint32_t m_Root;
+		uint32_t m_Size;
+		uint32_t m_Width;
+		uint32_t m_Height;
+		uint32_t m_Depth;
+	};
+}
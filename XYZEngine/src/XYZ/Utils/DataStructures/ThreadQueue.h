@@ -1,16 +1,29 @@
 #pragma once
 #include "XYZ/Core/Core.h"
+#include "LockFreeQueue.h"
 
 #include <mutex>
 #include <deque>
+#include <thread>
 
 namespace XYZ {
-	template <typename T>
+
+	// Default policy, unbounded std::deque guarded by mutex
+	struct ThreadQueueMutexPolicy {};
+
+	// Bounded lock free queues, push fails when queue is full
+	template <size_t Capacity>
+	struct ThreadQueueLockFreePolicy {};
+
+	template <size_t Capacity>
+	struct ThreadQueueSPSCPolicy {};
+
+	template <typename T, typename Policy = ThreadQueueMutexPolicy>
 	class XYZ_API ThreadQueue
 	{
 	public:
 		ThreadQueue() = default;
-		ThreadQueue(const ThreadQueue<T>&) = delete;
+		ThreadQueue(const ThreadQueue&) = delete;
 
 		const T& Front()
 		{
@@ -82,6 +95,48 @@ namespace XYZ {
 			return temp;
 		}
 
+		bool TryPush(const T& elem)
+		{
+			PushBack(elem);
+			return true;
+		}
+
+		bool TryPush(T&& elem)
+		{
+			EmplaceBack(std::move(elem));
+			return true;
+		}
+
+		template <typename ...Args>
+		bool TryEmplace(Args&&... args)
+		{
+			std::scoped_lock lock(m_Mutex);
+			m_Queue.emplace_back(std::forward<Args>(args)...);
+			return true;
+		}
+
+		bool TryPop(T& elem)
+		{
+			std::scoped_lock lock(m_Mutex);
+			if (m_Queue.empty())
+				return false;
+			elem = std::move(m_Queue.front());
+			m_Queue.pop_front();
+			return true;
+		}
+
+		size_t TryPopBatch(T* elems, size_t maxCount)
+		{
+			std::scoped_lock lock(m_Mutex);
+			const size_t count = std::min(m_Queue.size(), maxCount);
+			for (size_t i = 0; i < count; ++i)
+			{
+				elems[i] = std::move(m_Queue.front());
+				m_Queue.pop_front();
+			}
+			return count;
+		}
+
 
 		std::mutex& GetMutex() { return m_Mutex; }
 
@@ -89,4 +144,78 @@ namespace XYZ {
 		std::deque<T> m_Queue;
 		std::mutex m_Mutex;
 	};
-}
\ No newline at end of file
+
+	template <typename T, typename Queue>
+	class LockFreeThreadQueue
+	{
+	public:
+		LockFreeThreadQueue(size_t capacity)
+			: m_Queue(capacity)
+		{}
+		LockFreeThreadQueue(const LockFreeThreadQueue&) = delete;
+
+		bool TryPush(const T& elem) { return m_Queue.TryPush(elem); }
+		bool TryPush(T&& elem)		{ return m_Queue.TryPush(std::move(elem)); }
+
+		// Blocks while queue is full
+		void PushBack(const T& elem)
+		{
+			while (!m_Queue.TryPush(elem))
+				std::this_thread::yield();
+		}
+
+		void EmplaceBack(T&& elem)
+		{
+			while (!m_Queue.TryPush(std::move(elem)))
+				std::this_thread::yield();
+		}
+
+		template <typename ...Args>
+		bool TryEmplace(Args&&... args) { return m_Queue.TryEmplace(std::forward<Args>(args)...); }
+
+		bool   TryPop(T& elem)						 { return m_Queue.TryPop(elem); }
+		size_t TryPopBatch(T* elems, size_t maxCount) { return m_Queue.TryPopBatch(elems, maxCount); }
+
+		void   Clear()		   { m_Queue.Clear(); }
+		bool   Empty()	 const { return m_Queue.Empty(); }
+		size_t Size()	 const { return m_Queue.Size(); }
+		size_t Capacity() const { return m_Queue.Capacity(); }
+
+		// Ring queue can only push at back and pop at front, element references are not stable after pop
+		template <typename U = T>
+		void Front() { static_assert(sizeof(U) == 0, "Front is not supported by lock free ThreadQueue, use TryPop"); }
+
+		template <typename U = T>
+		void Back() { static_assert(sizeof(U) == 0, "Back is not supported by lock free ThreadQueue"); }
+
+		template <typename U = T>
+		void PushFront(const U&) { static_assert(sizeof(U) == 0, "PushFront is not supported by lock free ThreadQueue"); }
+
+		template <typename U = T>
+		void EmplaceFront(U&&) { static_assert(sizeof(U) == 0, "EmplaceFront is not supported by lock free ThreadQueue"); }
+
+		template <typename U = T>
+		void PopBack() { static_assert(sizeof(U) == 0, "PopBack is not supported by lock free ThreadQueue, use TryPop"); }
+
+		template <typename U = T>
+		void GetMutex() { static_assert(sizeof(U) == 0, "Lock free ThreadQueue has no mutex"); }
+
+	private:
+		Queue m_Queue;
+	};
+
+	template <typename T, size_t Capacity>
+	class ThreadQueue<T, ThreadQueueLockFreePolicy<Capacity>> : public LockFreeThreadQueue<T, MPMCQueue<T>>
+	{
+	public:
+		ThreadQueue() : LockFreeThreadQueue<T, MPMCQueue<T>>(Capacity) {}
+	};
+
+	// TryPush must be called only from one producer thread and TryPop only from one consumer thread
+	template <typename T, size_t Capacity>
+	class ThreadQueue<T, ThreadQueueSPSCPolicy<Capacity>> : public LockFreeThreadQueue<T, SPSCQueue<T>>
+	{
+	public:
+		ThreadQueue() : LockFreeThreadQueue<T, SPSCQueue<T>>(Capacity) {}
+	};
+}
@@ -171,9 +171,11 @@ namespace XYZ {
 		AABB c;
 		c.Min.x = std::min(a.Min.x, b.Min.x);
 		c.Min.y = std::min(a.Min.y, b.Min.y);
+		c.Min.z = std::min(a.Min.z, b.Min.z);
 
 		c.Max.x = std::max(a.Max.x, b.Max.x);
 		c.Max.y = std::max(a.Max.y, b.Max.y);
+		c.Max.z = std::max(a.Max.z, b.Max.z);
 		return c;
 	}
 
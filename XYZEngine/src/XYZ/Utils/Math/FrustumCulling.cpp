@@ -0,0 +1,232 @@
+#include "stdafx.h"
+#include "FrustumCulling.h"
+
+#include "XYZ/Core/ThreadPool.h"
+#include "XYZ/Debug/Profiler.h"
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define XYZ_CULLING_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define XYZ_CULLING_SSE2
+#endif
+
+namespace XYZ {
+
+	void AABBSoA::Push(const AABB& aabb)
+	{
+		MinX.push_back(aabb.Min.x);
+		MinY.push_back(aabb.Min.y);
+		MinZ.push_back(aabb.Min.z);
+		MaxX.push_back(aabb.Max.x);
+		MaxY.push_back(aabb.Max.y);
+		MaxZ.push_back(aabb.Max.z);
+	}
+
+	void AABBSoA::Resize(size_t count)
+	{
+		MinX.resize(count);
+		MinY.resize(count);
+		MinZ.resize(count);
+		MaxX.resize(count);
+		MaxY.resize(count);
+		MaxZ.resize(count);
+	}
+
+	void AABBSoA::Copy(const AABBSoA& source, size_t offset)
+	{
+		XYZ_ASSERT(offset + source.Size() <= Size(), "Boxes out of range");
+		std::copy(source.MinX.begin(), source.MinX.end(), MinX.begin() + offset);
+		std::copy(source.MinY.begin(), source.MinY.end(), MinY.begin() + offset);
+		std::copy(source.MinZ.begin(), source.MinZ.end(), MinZ.begin() + offset);
+		std::copy(source.MaxX.begin(), source.MaxX.end(), MaxX.begin() + offset);
+		std::copy(source.MaxY.begin(), source.MaxY.end(), MaxY.begin() + offset);
+		std::copy(source.MaxZ.begin(), source.MaxZ.end(), MaxZ.begin() + offset);
+	}
+
+	void AABBSoA::Reserve(size_t count)
+	{
+		MinX.reserve(count);
+		MinY.reserve(count);
+		MinZ.reserve(count);
+		MaxX.reserve(count);
+		MaxY.reserve(count);
+		MaxZ.reserve(count);
+	}
+
+	void AABBSoA::Clear()
+	{
+		MinX.clear();
+		MinY.clear();
+		MinZ.clear();
+		MaxX.clear();
+		MaxY.clear();
+		MaxZ.clear();
+	}
+
+	namespace Math {
+
+		static constexpr uint32_t sc_ParallelBatchWords = 64; // 4096 boxes per job
+
+		// Box is outside of plane if its corner furthest along plane normal is behind the plane,
+		// the corner is selected per plane, so every box costs three multiply adds per plane
+		struct CullingPlane
+		{
+			const float* X;
+			const float* Y;
+			const float* Z;
+			float Nx, Ny, Nz, Distance;
+		};
+
+		static void PrepareCullingPlanes(const Frustum& frustum, const AABBSoA& boxes, CullingPlane planes[6])
+		{
+			const Plane* faces[6] = {
+				&frustum.NearFace, &frustum.FarFace,
+				&frustum.LeftFace, &frustum.RightFace,
+				&frustum.TopFace,  &frustum.BottomFace
+			};
+			for (uint32_t i = 0; i < 6; ++i)
+			{
+				const glm::vec3& n = faces[i]->Normal;
+				planes[i].X = n.x >= 0.0f ? boxes.MaxX.data() : boxes.MinX.data();
+				planes[i].Y = n.y >= 0.0f ? boxes.MaxY.data() : boxes.MinY.data();
+				planes[i].Z = n.z >= 0.0f ? boxes.MaxZ.data() : boxes.MinZ.data();
+				planes[i].Nx = n.x;
+				planes[i].Ny = n.y;
+				planes[i].Nz = n.z;
+				planes[i].Distance = faces[i]->Distance;
+			}
+		}
+
+		static uint64_t CullScalar(const CullingPlane planes[6], uint32_t begin, uint32_t end, uint32_t bitOffset)
+		{
+			uint64_t mask = 0;
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				bool visible = true;
+				for (uint32_t p = 0; p < 6; ++p)
+				{
+					const CullingPlane& plane = planes[p];
+					visible &= plane.X[i] * plane.Nx + plane.Y[i] * plane.Ny + plane.Z[i] * plane.Nz - plane.Distance >= 0.0f;
+				}
+				mask |= static_cast<uint64_t>(visible) << (i - begin + bitOffset);
+			}
+			return mask;
+		}
+
+		// Culls up to 64 boxes starting at begin, returns visibility mask
+		static uint64_t CullWord(const CullingPlane planes[6], uint32_t begin, uint32_t end)
+		{
+			uint64_t mask = 0;
+			uint32_t i = begin;
+		#if defined(XYZ_CULLING_AVX2)
+			for (; i + 8 <= end; i += 8)
+			{
+				__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (uint32_t p = 0; p < 6; ++p)
+				{
+					const CullingPlane& plane = planes[p];
+					__m256 dist = _mm256_mul_ps(_mm256_loadu_ps(plane.X + i), _mm256_set1_ps(plane.Nx));
+					dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_loadu_ps(plane.Y + i), _mm256_set1_ps(plane.Ny)));
+					dist = _mm256_add_ps(dist, _mm256_mul_ps(_mm256_loadu_ps(plane.Z + i), _mm256_set1_ps(plane.Nz)));
+					dist = _mm256_sub_ps(dist, _mm256_set1_ps(plane.Distance));
+					visible = _mm256_and_ps(visible, _mm256_cmp_ps(dist, _mm256_setzero_ps(), _CMP_GE_OQ));
+				}
+				mask |= static_cast<uint64_t>(_mm256_movemask_ps(visible)) << (i - begin);
+			}
+		#elif defined(XYZ_CULLING_SSE2)
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (uint32_t p = 0; p < 6; ++p)
+				{
+					const CullingPlane& plane = planes[p];
+					__m128 dist = _mm_mul_ps(_mm_loadu_ps(plane.X + i), _mm_set1_ps(plane.Nx));
+					dist = _mm_add_ps(dist, _mm_mul_ps(_mm_loadu_ps(plane.Y + i), _mm_set1_ps(plane.Ny)));
+					dist = _mm_add_ps(dist, _mm_mul_ps(_mm_loadu_ps(plane.Z + i), _mm_set1_ps(plane.Nz)));
+					dist = _mm_sub_ps(dist, _mm_set1_ps(plane.Distance));
+					visible = _mm_and_ps(visible, _mm_cmpge_ps(dist, _mm_setzero_ps()));
+				}
+				mask |= static_cast<uint64_t>(_mm_movemask_ps(visible)) << (i - begin);
+			}
+		#endif
+			return mask | CullScalar(planes, i, end, i - begin);
+		}
+
+		static void CullWords(const CullingPlane planes[6], uint32_t count, uint32_t firstWord, uint32_t lastWord, uint64_t* visibleMask)
+		{
+			for (uint32_t word = firstWord; word < lastWord; ++word)
+			{
+				const uint32_t begin = word * 64;
+				const uint32_t end = std::min(begin + 64, count);
+				visibleMask[word] = CullWord(planes, begin, end);
+			}
+		}
+
+		static Plane NormalizePlane(const glm::vec4& plane)
+		{
+			const float length = glm::length(glm::vec3(plane));
+			Plane result;
+			result.Normal = glm::vec3(plane) / length;
+			result.Distance = -plane.w / length;
+			return result;
+		}
+
+		Frustum ExtractFrustum(const glm::mat4& viewProjection)
+		{
+			const glm::mat4 m = glm::transpose(viewProjection);
+			Frustum frustum;
+			frustum.LeftFace	= NormalizePlane(m[3] + m[0]);
+			frustum.RightFace	= NormalizePlane(m[3] - m[0]);
+			frustum.BottomFace	= NormalizePlane(m[3] + m[1]);
+			frustum.TopFace		= NormalizePlane(m[3] - m[1]);
+			frustum.NearFace	= NormalizePlane(m[2]);
+			frustum.FarFace		= NormalizePlane(m[3] - m[2]);
+			return frustum;
+		}
+
+		void CullAABBs(const Frustum& frustum, const AABBSoA& boxes, uint64_t* visibleMask)
+		{
+			XYZ_PROFILE_FUNC("Math::CullAABBs");
+			CullingPlane planes[6];
+			PrepareCullingPlanes(frustum, boxes, planes);
+
+			const uint32_t count = boxes.Size();
+			CullWords(planes, count, 0, CullingMaskSize(count), visibleMask);
+		}
+
+		void CullAABBs(const Frustum& frustum, const AABBSoA& boxes, uint64_t* visibleMask, ThreadPool& pool)
+		{
+			XYZ_PROFILE_FUNC("Math::CullAABBs");
+			CullingPlane planes[6];
+			PrepareCullingPlanes(frustum, boxes, planes);
+
+			const uint32_t count = boxes.Size();
+			pool.ParallelFor(CullingMaskSize(count), sc_ParallelBatchWords, [&](uint32_t begin, uint32_t end) {
+				CullWords(planes, count, begin, end, visibleMask);
+			});
+		}
+
+		uint32_t CullAABBsCompact(const Frustum& frustum, const AABBSoA& boxes, uint32_t* visibleIndices)
+		{
+			XYZ_PROFILE_FUNC("Math::CullAABBsCompact");
+			CullingPlane planes[6];
+			PrepareCullingPlanes(frustum, boxes, planes);
+
+			const uint32_t count = boxes.Size();
+			uint32_t visibleCount = 0;
+			for (uint32_t begin = 0; begin < count; begin += 64)
+			{
+				const uint32_t end = std::min(begin + 64, count);
+				const uint64_t mask = CullWord(planes, begin, end);
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					visibleIndices[visibleCount] = i;
+					visibleCount += static_cast<uint32_t>((mask >> (i - begin)) & 1);
+				}
+			}
+			return visibleCount;
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+#include "XYZ/Utils/Math/AABB.h"
+
+#include <vector>
+
+namespace XYZ {
+
+	class ThreadPool;
+
+	// Bounding boxes stored as separate arrays, so batch culling can load multiple boxes per instruction
+	struct XYZ_API AABBSoA
+	{
+		std::vector<float> MinX, MinY, MinZ;
+		std::vector<float> MaxX, MaxY, MaxZ;
+
+		void Push(const AABB& aabb);
+		void Resize(size_t count);
+		// Copies all boxes of source starting at offset, boxes have to be allocated
+		void Copy(const AABBSoA& source, size_t offset);
+		void Reserve(size_t count);
+		void Clear();
+
+		uint32_t Size() const { return static_cast<uint32_t>(MinX.size()); }
+	};
+
+	namespace Math {
+
+		// Planes are extracted from view projection matrix with depth in range [0, 1]
+		XYZ_API Frustum ExtractFrustum(const glm::mat4& viewProjection);
+
+		inline uint32_t CullingMaskSize(uint32_t count) { return (count + 63) / 64; }
+
+		// Writes one bit per box, visibleMask must hold CullingMaskSize(boxes.Size()) words.
+		// Uses AVX2 / SSE2 if available at compile time, scalar code otherwise
+		XYZ_API void CullAABBs(const Frustum& frustum, const AABBSoA& boxes, uint64_t* visibleMask);
+
+		// Splits boxes to batches executed by thread pool, calling thread participates
+		XYZ_API void CullAABBs(const Frustum& frustum, const AABBSoA& boxes, uint64_t* visibleMask, ThreadPool& pool);
+
+		// Writes indices of visible boxes, visibleIndices must hold boxes.Size() indices. Returns number of visible boxes
+		XYZ_API uint32_t CullAABBsCompact(const Frustum& frustum, const AABBSoA& boxes, uint32_t* visibleIndices);
+	}
+}
@@ -4,9 +4,160 @@
 
 #include "PerlinNoise.hpp"
 
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define XYZ_PERLIN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define XYZ_PERLIN_SSE2
+#endif
+
 namespace XYZ {
 
-	static thread_local siv::PerlinNoise s_Noise(rand());
+	static siv::PerlinNoise s_Noise;
+
+	static constexpr uint32_t sc_RowBlockSize = 64;
+
+	// Noise of one row is linear in fx inside lattice cell, except for fade: Even + (Odd - Even) * Fade(fx),
+	// where Even = EvenSlope * fx + EvenOffset and Odd = OddSlope * (fx - 1) + OddOffset
+	struct PerlinRowCell
+	{
+		float EvenSlope;
+		float EvenOffset;
+		float OddSlope;
+		float OddOffset;
+	};
+
+	static float Fade(float t)
+	{
+		return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+	}
+
+	static void Gradient(uint8_t hash, float& gx, float& gy, float& gz)
+	{
+		const uint8_t h = hash & 15;
+		gx = 0.0f; gy = 0.0f; gz = 0.0f;
+		float& u = h < 8 ? gx : gy;
+		float& v = h < 4 ? gy : (h == 12 || h == 14) ? gx : gz;
+		u = (h & 1) == 0 ? 1.0f : -1.0f;
+		v = (h & 2) == 0 ? 1.0f : -1.0f;
+	}
+
+	// Adds weight * gradient(hash) . (0, y, z) to offset and weight * gradient.x to slope
+	static void AccumulateCorner(uint8_t hash, float y, float z, float weight, float& slope, float& offset)
+	{
+		float gx, gy, gz;
+		Gradient(hash, gx, gy, gz);
+		slope += weight * gx;
+		offset += weight * (gy * y + gz * z);
+	}
+
+	static PerlinRowCell CreateRowCell(const siv::PerlinNoise::state_type& p, int32_t ix, int32_t iy, float fy, float v, float fz, float w)
+	{
+		const uint8_t A = (p[ix & 255] + iy) & 255;
+		const uint8_t B = (p[(ix + 1) & 255] + iy) & 255;
+		const uint8_t AA = p[A];
+		const uint8_t AB = p[(A + 1) & 255];
+		const uint8_t BA = p[B];
+		const uint8_t BB = p[(B + 1) & 255];
+
+		const float w00 = (1.0f - w) * (1.0f - v);
+		const float w01 = (1.0f - w) * v;
+		const float w10 = w * (1.0f - v);
+		const float w11 = w * v;
+
+		PerlinRowCell cell{};
+		AccumulateCorner(p[AA], fy, fz, w00, cell.EvenSlope, cell.EvenOffset);
+		AccumulateCorner(p[AB], fy - 1.0f, fz, w01, cell.EvenSlope, cell.EvenOffset);
+		AccumulateCorner(p[(AA + 1) & 255], fy, fz - 1.0f, w10, cell.EvenSlope, cell.EvenOffset);
+		AccumulateCorner(p[(AB + 1) & 255], fy - 1.0f, fz - 1.0f, w11, cell.EvenSlope, cell.EvenOffset);
+
+		AccumulateCorner(p[BA], fy, fz, w00, cell.OddSlope, cell.OddOffset);
+		AccumulateCorner(p[BB], fy - 1.0f, fz, w01, cell.OddSlope, cell.OddOffset);
+		AccumulateCorner(p[(BA + 1) & 255], fy, fz - 1.0f, w10, cell.OddSlope, cell.OddOffset);
+		AccumulateCorner(p[(BB + 1) & 255], fy - 1.0f, fz - 1.0f, w11, cell.OddSlope, cell.OddOffset);
+		return cell;
+	}
+
+	// Splits coordinate to wrapped lattice index and fraction, in double so far coordinates keep float precision
+	static int32_t SplitCoordinate(double value, float& fraction)
+	{
+		const double base = std::floor(value);
+		fraction = static_cast<float>(value - base);
+		return static_cast<int32_t>(static_cast<int64_t>(base) & 255);
+	}
+
+	struct PerlinRowBlock
+	{
+		float Fx[sc_RowBlockSize];
+		float EvenSlope[sc_RowBlockSize];
+		float EvenOffset[sc_RowBlockSize];
+		float OddSlope[sc_RowBlockSize];
+		float OddOffset[sc_RowBlockSize];
+	};
+
+	static void AccumulateBlock(const PerlinRowBlock& block, float amplitude, float* result, uint32_t count)
+	{
+		uint32_t i = 0;
+	#if defined(XYZ_PERLIN_AVX2)
+		const __m256 amp = _mm256_set1_ps(amplitude);
+		const __m256 one = _mm256_set1_ps(1.0f);
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 fx = _mm256_loadu_ps(block.Fx + i);
+			__m256 fade = _mm256_sub_ps(_mm256_mul_ps(fx, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f));
+			fade = _mm256_add_ps(_mm256_mul_ps(fade, fx), _mm256_set1_ps(10.0f));
+			fade = _mm256_mul_ps(fade, _mm256_mul_ps(fx, _mm256_mul_ps(fx, fx)));
+
+			const __m256 even = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(block.EvenSlope + i), fx), _mm256_loadu_ps(block.EvenOffset + i));
+			const __m256 odd = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(block.OddSlope + i), _mm256_sub_ps(fx, one)), _mm256_loadu_ps(block.OddOffset + i));
+			const __m256 noise = _mm256_add_ps(even, _mm256_mul_ps(_mm256_sub_ps(odd, even), fade));
+			_mm256_storeu_ps(result + i, _mm256_add_ps(_mm256_loadu_ps(result + i), _mm256_mul_ps(noise, amp)));
+		}
+	#elif defined(XYZ_PERLIN_SSE2)
+		const __m128 amp = _mm_set1_ps(amplitude);
+		const __m128 one = _mm_set1_ps(1.0f);
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 fx = _mm_loadu_ps(block.Fx + i);
+			__m128 fade = _mm_sub_ps(_mm_mul_ps(fx, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+			fade = _mm_add_ps(_mm_mul_ps(fade, fx), _mm_set1_ps(10.0f));
+			fade = _mm_mul_ps(fade, _mm_mul_ps(fx, _mm_mul_ps(fx, fx)));
+
+			const __m128 even = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block.EvenSlope + i), fx), _mm_loadu_ps(block.EvenOffset + i));
+			const __m128 odd = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block.OddSlope + i), _mm_sub_ps(fx, one)), _mm_loadu_ps(block.OddOffset + i));
+			const __m128 noise = _mm_add_ps(even, _mm_mul_ps(_mm_sub_ps(odd, even), fade));
+			_mm_storeu_ps(result + i, _mm_add_ps(_mm_loadu_ps(result + i), _mm_mul_ps(noise, amp)));
+		}
+	#endif
+		for (; i < count; ++i)
+		{
+			const float fx = block.Fx[i];
+			const float even = block.EvenSlope[i] * fx + block.EvenOffset[i];
+			const float odd = block.OddSlope[i] * (fx - 1.0f) + block.OddOffset[i];
+			result[i] += (even + (odd - even) * Fade(fx)) * amplitude;
+		}
+	}
+
+	static void RemapClamp(float* result, uint32_t count)
+	{
+		uint32_t i = 0;
+	#if defined(XYZ_PERLIN_AVX2)
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 value = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(result + i), _mm256_set1_ps(0.5f)), _mm256_set1_ps(0.5f));
+			_mm256_storeu_ps(result + i, _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f)));
+		}
+	#elif defined(XYZ_PERLIN_SSE2)
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 value = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(result + i), _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f));
+			_mm_storeu_ps(result + i, _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f)));
+		}
+	#endif
+		for (; i < count; ++i)
+			result[i] = std::min(std::max(result[i] * 0.5f + 0.5f, 0.0f), 1.0f);
+	}
 
 	void Perlin::SetSeed(uint32_t seed)
 	{
@@ -17,5 +168,56 @@ namespace XYZ {
 	{
 		return s_Noise.octave2D_01(x, y, octaves);
 	}
-	
-}
\ No newline at end of file
+
+	void Perlin::Octave2DRow(float* result, double x, double y, double stepX, uint32_t count, uint32_t octaves)
+	{
+		XYZ_ASSERT(stepX >= 0.0, "Row is evaluated in positive direction of x axis");
+		const auto& permutation = s_Noise.serialize();
+
+		// Noise2D is evaluated in constant z plane
+		float fz;
+		const int32_t iz = SplitCoordinate(SIVPERLIN_DEFAULT_Z, fz);
+		XYZ_ASSERT(iz == 0, "SIVPERLIN_DEFAULT_Z must lie in lattice cell 0, row cells use iz = 0");
+		const float w = Fade(fz);
+
+		memset(result, 0, count * sizeof(float));
+
+		PerlinRowBlock block;
+		double scale = 1.0;
+		float amplitude = 1.0f;
+		for (uint32_t octave = 0; octave < octaves; ++octave)
+		{
+			float fy, fx0;
+			const int32_t iy = SplitCoordinate(y * scale, fy);
+			const int32_t ix0 = SplitCoordinate(x * scale, fx0);
+			const float v = Fade(fy);
+			const float step = static_cast<float>(stepX * scale);
+
+			int32_t lastCell = -1;
+			PerlinRowCell cell{};
+			for (uint32_t blockStart = 0; blockStart < count; blockStart += sc_RowBlockSize)
+			{
+				const uint32_t blockCount = std::min(sc_RowBlockSize, count - blockStart);
+				for (uint32_t i = 0; i < blockCount; ++i)
+				{
+					const float t = fx0 + static_cast<float>(blockStart + i) * step;
+					const int32_t cellOffset = static_cast<int32_t>(t);
+					if (cellOffset != lastCell)
+					{
+						cell = CreateRowCell(permutation, ix0 + cellOffset, iy, fy, v, fz, w);
+						lastCell = cellOffset;
+					}
+					block.Fx[i] = t - static_cast<float>(cellOffset);
+					block.EvenSlope[i] = cell.EvenSlope;
+					block.EvenOffset[i] = cell.EvenOffset;
+					block.OddSlope[i] = cell.OddSlope;
+					block.OddOffset[i] = cell.OddOffset;
+				}
+				AccumulateBlock(block, amplitude, result + blockStart, blockCount);
+			}
+			scale *= 2.0;
+			amplitude *= 0.5f;
+		}
+		RemapClamp(result, count);
+	}
+}
@@ -3,6 +3,7 @@
 
 namespace XYZ {
 
+	// Noise state is shared by all threads, SetSeed must not run while noise is evaluated
 	class Perlin
 	{
 	public:
@@ -10,5 +11,8 @@ namespace XYZ {
 
 		static double Octave2D(double x, double y, uint32_t octaves);
 
+		// Writes Octave2D of count samples starting at x, y with step along x axis, evaluated in float.
+		// Permutation hashing is done once per lattice cell, samples are evaluated with AVX2 / SSE2 if available
+		static void Octave2DRow(float* result, double x, double y, double stepX, uint32_t count, uint32_t octaves);
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,38 @@
+#include "stdafx.h"
+#include "MemoryMappedFile.h"
+
+namespace XYZ {
+
+	MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& path)
+	{
+		Open(path);
+	}
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		Close();
+	}
+
+	MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			m_Data = other.m_Data;
+			m_Size = other.m_Size;
+			m_FileHandle = other.m_FileHandle;
+			m_MappingHandle = other.m_MappingHandle;
+
+			other.m_Data = nullptr;
+			other.m_Size = 0;
+			other.m_FileHandle = nullptr;
+			other.m_MappingHandle = nullptr;
+		}
+		return *this;
+	}
+}
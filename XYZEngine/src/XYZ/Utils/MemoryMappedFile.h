@@ -0,0 +1,36 @@
+#pragma once
+#include "XYZ/Core/Core.h"
+
+#include <filesystem>
+
+namespace XYZ {
+
+	// Read only view of whole file, platform implementation in Platform/<OS>/<OS>MemoryMappedFile.cpp
+	class XYZ_API MemoryMappedFile
+	{
+	public:
+		MemoryMappedFile() = default;
+		MemoryMappedFile(const std::filesystem::path& path);
+		~MemoryMappedFile();
+
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+		MemoryMappedFile(MemoryMappedFile&& other) noexcept;
+		MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
+
+		// Empty or missing files can not be mapped
+		bool Open(const std::filesystem::path& path);
+		void Close();
+
+		bool		   IsOpen()	 const { return m_Data != nullptr; }
+		const uint8_t* GetData() const { return m_Data; }
+		size_t		   GetSize() const { return m_Size; }
+
+	private:
+		const uint8_t* m_Data = nullptr;
+		size_t		   m_Size = 0;
+		void*		   m_FileHandle = nullptr;
+		void*		   m_MappingHandle = nullptr;
+	};
+}